@@ -142,6 +142,12 @@ FVoxelInvokerSettings UVoxelSimpleInvokerComponent::GetInvokerSettings_Implement
 	Settings.LODToSet = LODToSet;
 	Settings.LODBounds = GetVoxelBounds(LODRange);
 
+	if (LookAheadTime > 0)
+	{
+		const FVector PredictedGlobalPosition = InvokerGlobalPosition + GetInvokerVelocity() * LookAheadTime;
+		Settings.PredictedOffset = VoxelWorld->GlobalToLocal(PredictedGlobalPosition) - VoxelWorld->GlobalToLocal(InvokerGlobalPosition);
+	}
+
 	Settings.bUseForCollisions = bUseForCollisions;
 	Settings.CollisionsBounds = GetVoxelBounds(CollisionsRange);
 
@@ -156,6 +162,12 @@ FVector UVoxelSimpleInvokerComponent::GetInvokerGlobalPosition_Implementation()
 	return GetComponentLocation();
 }
 
+FVector UVoxelSimpleInvokerComponent::GetInvokerVelocity_Implementation() const
+{
+	const AActor* Owner = GetOwner();
+	return Owner ? Owner->GetVelocity() : FVector::ZeroVector;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -165,7 +177,7 @@ FVector UVoxelInvokerWithPredictionComponent::GetInvokerGlobalPosition_Implement
 	FVector Position = GetComponentLocation();
 	if (bEnablePrediction)
 	{
-		Position += GetOwner()->GetVelocity() * PredictionTime;
+		Position += GetInvokerVelocity() * PredictionTime;
 	}
 	return Position;
 }
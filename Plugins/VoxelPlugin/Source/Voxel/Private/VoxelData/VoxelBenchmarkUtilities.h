@@ -0,0 +1,77 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelData.inl"
+#include "VoxelData/VoxelDataLock.h"
+#include "VoxelGenerators/VoxelEmptyGenerator.h"
+
+// Worlds and edits shared by the data benchmark console commands
+namespace FVoxelBenchmarkUtilities
+{
+	// Empty generator, so that only the edits are measured
+	inline TVoxelSharedRef<FVoxelData> CreateData(int32 Depth, bool bEnableMultiplayer = false)
+	{
+		const auto Generator = MakeVoxelShared<FVoxelEmptyGeneratorInstance>(1);
+		Generator->Init(FVoxelGeneratorInit());
+		return FVoxelData::Create(FVoxelDataSettings(Depth, Generator, bEnableMultiplayer, false));
+	}
+
+	// Edits a terrain-like surface spanning the entire world between -HalfHeight and HalfHeight, like a sculpted planet surface
+	inline void EditSurface(FVoxelData& Data, int32 HalfHeight = 2 * DATA_CHUNK_SIZE)
+	{
+		const FVoxelIntBox& WorldBounds = Data.WorldBounds;
+		const FVoxelIntBox Bounds(
+			FIntVector(WorldBounds.Min.X, WorldBounds.Min.Y, -HalfHeight),
+			FIntVector(WorldBounds.Max.X, WorldBounds.Max.Y, HalfHeight));
+
+		FVoxelWriteScopeLock Lock(Data, Bounds, "Voxel Benchmark");
+		Data.Set<FVoxelValue>(Bounds, [&](int32 X, int32 Y, int32 Z, FVoxelValue& OutValue)
+		{
+			const float Height = 12.f * FMath::Sin(X / 37.f) * FMath::Cos(Y / 29.f);
+			OutValue = FVoxelValue((Z - Height) / 4.f);
+		});
+	}
+
+	// Digs a crater. If bPaint, also paints its surface. Returns the number of values and materials changed
+	inline int32 DigSphere(FVoxelData& Data, const FIntVector& Center, int32 Radius, bool bPaint = false)
+	{
+		const FVoxelIntBox Bounds = FVoxelIntBox(Center).Extend(Radius);
+
+		int32 NumEditedVoxels = 0;
+		const auto Dig = [&](int32 X, int32 Y, int32 Z, FVoxelValue& Value)
+		{
+			const float Distance = FVector(X - Center.X, Y - Center.Y, Z - Center.Z).Size() - Radius;
+			const FVoxelValue NewValue = FVoxelValue(FMath::Max(Value.ToFloat(), -Distance / 4.f));
+			NumEditedVoxels += NewValue != Value;
+			Value = NewValue;
+			return Distance;
+		};
+
+		FVoxelWriteScopeLock Lock(Data, Bounds, "Voxel Benchmark");
+		if (bPaint)
+		{
+			Data.Set<FVoxelValue, FVoxelMaterial>(Bounds, [&](int32 X, int32 Y, int32 Z, FVoxelValue& Value, FVoxelMaterial& Material)
+			{
+				if (Dig(X, Y, Z, Value) < 2)
+				{
+					const FVoxelMaterial NewMaterial = FVoxelMaterial::CreateFromColor(FColor::Red);
+					NumEditedVoxels += NewMaterial != Material;
+					Material = NewMaterial;
+				}
+			});
+		}
+		else
+		{
+			Data.Set<FVoxelValue>(Bounds, [&](int32 X, int32 Y, int32 Z, FVoxelValue& Value)
+			{
+				Dig(X, Y, Z, Value);
+			});
+		}
+
+		return NumEditedVoxels;
+	}
+}
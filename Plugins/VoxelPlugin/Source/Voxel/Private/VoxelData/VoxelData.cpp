@@ -6,6 +6,7 @@
 #include "VoxelData/VoxelDataLock.h"
 #include "VoxelData/VoxelDataOctree.h"
 #include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelData/VoxelRegionSave.h"
 #include "VoxelData/VoxelDataUtilities.h"
 
 #include "VoxelDiff.h"
@@ -92,6 +93,19 @@ FVoxelDataSettings::FVoxelDataSettings(
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// Datas with undo enabled, for the global undo memory budget. Only used on the game thread, but datas can be created on any thread
+static FCriticalSection GVoxelUndoRedoDatasSection;
+static TArray<TVoxelWeakPtr<FVoxelData>> GVoxelUndoRedoDatas;
+
+static void AddUndoRedoData(const TVoxelSharedRef<FVoxelData>& Data)
+{
+	if (Data->bEnableUndoRedo)
+	{
+		FScopeLock Lock(&GVoxelUndoRedoDatasSection);
+		GVoxelUndoRedoDatas.Add(Data);
+	}
+}
+
 FVoxelData::FVoxelData(const FVoxelDataSettings& Settings)
 	: IVoxelData(Settings.Depth, Settings.WorldBounds, Settings.bEnableMultiplayer, Settings.bEnableUndoRedo, Settings.Generator)
 	, Octree(MakeUnique<FVoxelDataOctreeParent>(Depth))
@@ -115,12 +129,17 @@ TVoxelSharedRef<FVoxelData> FVoxelData::Create(const FVoxelDataSettings& Setting
 			}
 		});
 	}
-	return MakeShareable(Data);
+
+	const TVoxelSharedRef<FVoxelData> SharedData = MakeShareable(Data);
+	AddUndoRedoData(SharedData);
+	return SharedData;
 }
 
 TVoxelSharedRef<FVoxelData> FVoxelData::Clone() const
 {
-	return MakeShareable(new FVoxelData(FVoxelDataSettings(WorldBounds, Generator, bEnableMultiplayer, bEnableUndoRedo)));
+	const TVoxelSharedRef<FVoxelData> SharedData = MakeShareable(new FVoxelData(FVoxelDataSettings(WorldBounds, Generator, bEnableMultiplayer, bEnableUndoRedo)));
+	AddUndoRedoData(SharedData);
+	return SharedData;
 }
 
 FVoxelData::~FVoxelData()
@@ -177,6 +196,9 @@ public:
 		return MoveTemp(LockedOctrees);
 	}
 
+	// Bounds of the nodes locked for write, to wait for the optimistic readers
+	FVoxelIntBoxWithValidity WriteLockedBounds;
+
 private:
 	TArray<FVoxelOctreeId> LockedOctrees;
 
@@ -190,6 +212,12 @@ private:
 		if (Octree.IsLeafOrHasNoChildren())
 		{
 			LockedOctrees.Add(Octree.GetId());
+
+			if (LockType == EVoxelLockType::Write)
+			{
+				Octree.Version++;
+				WriteLockedBounds += Octree.GetBounds();
+			}
 		}
 		else
 		{
@@ -244,6 +272,10 @@ private:
 				!LockedOctrees.IsValidIndex(LockedOctreesIndex) ||
 				!Octree.IsInOctree(LockedOctrees[LockedOctreesIndex].Position));
 
+			if (LockType == EVoxelLockType::Write)
+			{
+				Octree.Version++;
+			}
 			Octree.Mutex.Unlock(LockType);
 		}
 		else if (Octree.IsInOctree(LockedOctrees[LockedOctreesIndex].Position))
@@ -259,17 +291,85 @@ private:
 	}
 };
 
+// Checks that no node in Bounds is locked for write. Optimistic reads must already be published
+static bool CanReadOptimistically(const FVoxelDataOctreeBase& Octree, const FVoxelIntBox& Bounds)
+{
+	// Also check parents: a node locked for write might be getting children
+	if (Octree.IsBeingWritten())
+	{
+		return false;
+	}
+	if (Octree.IsLeafOrHasNoChildren())
+	{
+		return true;
+	}
+	for (auto& Child : Octree.AsParent().GetChildren())
+	{
+		if (Child.GetBounds().Intersect(Bounds) && !CanReadOptimistically(Child, Bounds))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 TUniquePtr<FVoxelDataLockInfo> FVoxelData::Lock(EVoxelLockType LockType, const FVoxelIntBox& Bounds, FName Name) const
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 	ensure(Bounds.IsValid());
 
-	MainLock.Lock(EVoxelLockType::Read);
-
 	auto LockInfo = TUniquePtr<FVoxelDataLockInfo>(new FVoxelDataLockInfo());
 	LockInfo->Name = Name;
 	LockInfo->LockType = LockType;
-	LockInfo->LockedOctrees = FVoxelDataOctreeLocker(LockType, Bounds, Name).Lock(GetOctree());
+
+	if (LockType == EVoxelLockType::Read && FVoxelDataOptimisticReads::IsEnabled())
+	{
+		const int32 Slot = OptimisticReads.Enter(Bounds);
+		if (Slot != -1)
+		{
+			if (CanReadOptimistically(GetOctree(), Bounds))
+			{
+				INC_DWORD_STAT(STAT_VoxelDataOptimisticReads);
+				LockInfo->OptimisticReadSlot = Slot;
+				return LockInfo;
+			}
+			OptimisticReads.Leave(Slot);
+		}
+		INC_DWORD_STAT(STAT_VoxelDataOptimisticReadsFallbacks);
+	}
+
+	if (LockType == EVoxelLockType::Write)
+	{
+		if (const TVoxelSharedPtr<FVoxelRegionSaveLoader> Loader = GetRegionSaveLoader())
+		{
+			// Edits made before their region is loaded would hide the saved chunks. Done before locking, as the load locks the regions itself
+			Loader->LoadRegionsBeforeWrite(const_cast<FVoxelData&>(*this), Bounds);
+		}
+	}
+
+	MainLock.Lock(EVoxelLockType::Read);
+
+	FVoxelDataOctreeLocker Locker(LockType, Bounds, Name);
+	LockInfo->LockedOctrees = Locker.Lock(GetOctree());
+
+	// Recorded while locked: a delta save taken after this either sees the node, or waits for our unlock
+	if (LockType == EVoxelLockType::Write && DeltaSaves.bEnabled.load())
+	{
+		AddWrittenNodes(LockInfo->LockedOctrees);
+	}
+	// Same for multiplayer diffs
+	if (LockType == EVoxelLockType::Write && bEnableMultiplayer)
+	{
+		FScopeLock MultiplayerLock(&MultiplayerWrites.Section);
+		MultiplayerWrites.WrittenNodes.Append(LockInfo->LockedOctrees);
+	}
+
+	// Done even if optimistic reads are disabled, as some might still be running
+	if (Locker.WriteLockedBounds.IsValid())
+	{
+		OptimisticReads.WaitForReaders(Locker.WriteLockedBounds.GetBox());
+	}
+
 	return LockInfo;
 }
 
@@ -279,6 +379,13 @@ void FVoxelData::Unlock(TUniquePtr<FVoxelDataLockInfo> LockInfo) const
 
 	check(LockInfo.IsValid());
 
+	if (LockInfo->OptimisticReadSlot != -1)
+	{
+		OptimisticReads.Leave(LockInfo->OptimisticReadSlot);
+		LockInfo->OptimisticReadSlot = -1;
+		return;
+	}
+
 	FVoxelDataOctreeUnlocker(LockInfo->LockType, LockInfo->LockedOctrees).Unlock(GetOctree());
 	
 	MainLock.Unlock(EVoxelLockType::Read);
@@ -295,6 +402,7 @@ void FVoxelData::ClearData()
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
 	MainLock.Lock(EVoxelLockType::Write);
+	OptimisticReads.Block();
 	{
 		// Clear the data to have clean memory reports
 		FVoxelOctreeUtilities::IterateAllLeaves(GetOctree(), [&](FVoxelDataOctreeLeaf& Leaf)
@@ -311,11 +419,25 @@ void FVoxelData::ClearData()
 
 		Octree = MakeUnique<FVoxelDataOctreeParent>(Depth);
 	}
+	OptimisticReads.Unblock();
 	MainLock.Unlock(EVoxelLockType::Write);
 
 	UndoRedo = {};
 	MarkAsDirty();
 
+	SetRegionSaveLoader(nullptr);
+
+	{
+		// The octree was replaced: the next save needs to be a base save
+		FScopeLock Lock(&DeltaSaves.Section);
+		DeltaSaves.bEnabled = false;
+		DeltaSaves.WrittenNodes.Empty();
+	}
+	{
+		FScopeLock Lock(&MultiplayerWrites.Section);
+		MultiplayerWrites.WrittenNodes.Empty();
+	}
+
 #define CLEAR(Type, Stat) \
 	{ \
 		auto& ItemsData = GetItemsData<Type>(); \
@@ -589,9 +711,67 @@ TVoxelRange<v_flt> FVoxelData::GetCustomOutputRange(TVoxelRange<v_flt> DefaultVa
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// Adds a leaf to a save, replacing the values equal to the generator ones by special values, see CVarStoreSpecialValueForGeneratorValuesInSaves
+static void AddLeafToSave(
+	const FVoxelData& Data,
+	const FVoxelDataOctreeLeaf& Leaf,
+	FVoxelSaveBuilder& Builder,
+	TArray<TUniquePtr<TVoxelDataOctreeLeafData<FVoxelValue>>>& BuffersToDelete)
+{
+	const TVoxelDataOctreeLeafData<FVoxelValue>* ValuesPtr = &Leaf.Values;
+	
+	if (CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnAnyThread() != 0)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Diffing with generator");
+		
+		// Only if dirty and not compressed to a single value
+		if (Leaf.Values.IsDirty() && !Leaf.Values.IsSingleValue())
+		{
+			auto UniquePtr = MakeUnique<TVoxelDataOctreeLeafData<FVoxelValue>>();
+			UniquePtr->CreateData(Data);
+			UniquePtr->SetIsDirty(true, Data);
+
+			const FVoxelIntBox LeafBounds = Leaf.GetBounds();
+			LeafBounds.Iterate([&](int32 X, int32 Y, int32 Z)
+			{
+				const FVoxelCellIndex Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(LeafBounds.Min, X, Y, Z);
+				const FVoxelValue Value = Leaf.Values.Get(Index);
+				// Empty stack: items not loaded when loading in LoadFromSave
+				const FVoxelValue GeneratorValue = Data.Generator->Get<FVoxelValue>(X, Y, Z, 0, FVoxelItemStack::Empty);
+
+				if (GeneratorValue == Value)
+				{
+					UniquePtr->GetRef(Index) = FVoxelValue::Special();
+				}
+				else
+				{
+					UniquePtr->GetRef(Index) = Value;
+				}
+			});
+
+			UniquePtr->TryCompressToSingleValue(Data);
+			ValuesPtr = UniquePtr.Get();
+			BuffersToDelete.Emplace(MoveTemp(UniquePtr));
+		}
+	}
+	
+	Builder.AddChunk(Leaf.Position, *ValuesPtr, Leaf.Materials);
+}
+
 void FVoxelData::GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+{
+	GetSaveImpl(OutSave, OutObjects, false);
+}
+
+void FVoxelData::GetSaveImpl(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, bool bStartDeltaSaveChain)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (const TVoxelSharedPtr<FVoxelRegionSaveLoader> Loader = GetRegionSaveLoader())
+	{
+		// The regions not loaded yet are only in the region save
+		Loader->LoadAllRegions(*this);
+	}
 	
 	FVoxelReadScopeLock Lock(*this, FVoxelIntBox::Infinite, "GetSave");
 
@@ -601,49 +781,102 @@ void FVoxelData::GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxel
 
 	FVoxelOctreeUtilities::IterateAllLeaves(*Octree, [&](FVoxelDataOctreeLeaf& Leaf)
 	{
-		TVoxelDataOctreeLeafData<FVoxelValue>* ValuesPtr = &Leaf.Values;
+		AddLeafToSave(*this, Leaf, Builder, BuffersToDelete);
+	});
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Items");
 		
-		if (CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnGameThread() != 0)
+		for (auto& Item : AssetItemsData.Items)
 		{
-			VOXEL_ASYNC_SCOPE_COUNTER("Diffing with generator");
-			
-			// Only if dirty and not compressed to a single value
-			if (Leaf.Values.IsDirty() && !Leaf.Values.IsSingleValue())
-			{
-				auto UniquePtr = MakeUnique<TVoxelDataOctreeLeafData<FVoxelValue>>();
-				UniquePtr->CreateData(*this);
-				UniquePtr->SetIsDirty(true, *this);
+			Builder.AddAssetItem(Item->Item);
+		}
+	}
 
-				const FVoxelIntBox LeafBounds = Leaf.GetBounds();
-				LeafBounds.Iterate([&](int32 X, int32 Y, int32 Z)
-				{
-					const FVoxelCellIndex Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(LeafBounds.Min, X, Y, Z);
-					const FVoxelValue Value = Leaf.Values.Get(Index);
-					// Empty stack: items not loaded when loading in LoadFromSave
-					const FVoxelValue GeneratorValue = Generator->Get<FVoxelValue>(X, Y, Z, 0, FVoxelItemStack::Empty);
+	Builder.Save(OutSave, OutObjects);
 
-					if (GeneratorValue == Value)
-					{
-						UniquePtr->GetRef(Index) = FVoxelValue::Special();
-					}
-					else
-					{
-						UniquePtr->GetRef(Index) = Value;
-					}
-				});
+	if (bStartDeltaSaveChain)
+	{
+		// Still locked: no write lock can be held, so all the writes before this are in the save
+		FScopeLock DeltaSavesLock(&DeltaSaves.Section);
+		DeltaSaves.bEnabled = true;
+		DeltaSaves.BaseGuid = OutSave.GetGuid();
+		DeltaSaves.Epoch = 0;
+		DeltaSaves.WrittenNodes.Empty();
+	}
+	
+	VOXEL_ASYNC_SCOPE_COUNTER("ClearData");
+	for (auto& Buffer : BuffersToDelete)
+	{
+		// For correct memory reports
+		Buffer->ClearData(*this);
+	}
+}
 
-				UniquePtr->TryCompressToSingleValue(*this);
-				ValuesPtr = UniquePtr.Get();
-				BuffersToDelete.Emplace(MoveTemp(UniquePtr));
-			}
+static FVoxelIntBox GetNodeBounds(const FVoxelOctreeId& Node)
+{
+	const int32 HalfSize = (DATA_CHUNK_SIZE / 2) << Node.Height;
+	return FVoxelIntBox(Node.Position - HalfSize, Node.Position + HalfSize);
+}
+
+void FVoxelData::GetBaseSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+{
+	GetSaveImpl(OutSave, OutObjects, true);
+}
+
+bool FVoxelData::GetDeltaSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FGuid& OutBaseGuid, uint32& OutEpoch)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	TArray<FVoxelIntBox> WrittenBounds;
+	{
+		FScopeLock DeltaSavesLock(&DeltaSaves.Section);
+		if (!DeltaSaves.bEnabled)
+		{
+			return false;
 		}
-		
-		Builder.AddChunk(Leaf.Position, *ValuesPtr, Leaf.Materials);
-	});
+
+		WrittenBounds.Reserve(DeltaSaves.WrittenNodes.Num());
+		for (const FVoxelOctreeId& Node : DeltaSaves.WrittenNodes)
+		{
+			WrittenBounds.Add(GetNodeBounds(Node));
+		}
+		// Writes from now on are in the next delta. Writes still locked are waited for by our read lock
+		DeltaSaves.WrittenNodes.Reset();
+
+		OutBaseGuid = DeltaSaves.BaseGuid;
+		OutEpoch = ++DeltaSaves.Epoch;
+	}
+
+	FVoxelSaveBuilder Builder(Depth);
+	TArray<TUniquePtr<TVoxelDataOctreeLeafData<FVoxelValue>>> BuffersToDelete;
+
+	// Only lock around the written nodes
+	FVoxelReadScopeLock Lock(*this, WrittenBounds.Num() > 0 ? FVoxelIntBox(WrittenBounds) : FVoxelIntBox(), "GetDeltaSave", WrittenBounds.Num() > 0);
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Leaves");
+
+		// A leaf can be in several written nodes
+		TSet<const FVoxelDataOctreeLeaf*> AddedLeaves;
+		for (const FVoxelIntBox& Bounds : WrittenBounds)
+		{
+			FVoxelOctreeUtilities::IterateLeavesInBounds(*Octree, Bounds, [&](FVoxelDataOctreeLeaf& Leaf)
+			{
+				bool bIsAlreadyInSet = false;
+				AddedLeaves.Add(&Leaf, &bIsAlreadyInSet);
+				if (!bIsAlreadyInSet)
+				{
+					AddLeafToSave(*this, Leaf, Builder, BuffersToDelete);
+				}
+			});
+		}
+	}
 
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Items");
 		
+		FScopeLock ItemsLock(&AssetItemsData.Section);
 		for (auto& Item : AssetItemsData.Items)
 		{
 			Builder.AddAssetItem(Item->Item);
@@ -658,6 +891,117 @@ void FVoxelData::GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxel
 		// For correct memory reports
 		Buffer->ClearData(*this);
 	}
+
+	return true;
+}
+
+void FVoxelData::AddWrittenNodes(const TArray<FVoxelOctreeId>& Nodes) const
+{
+	FScopeLock Lock(&DeltaSaves.Section);
+	if (DeltaSaves.bEnabled)
+	{
+		DeltaSaves.WrittenNodes.Append(Nodes);
+	}
+}
+
+template<typename T>
+static void AddLeafToMultiplayerDiff(const FVoxelData& Data, FVoxelDataOctreeLeaf& Leaf, TVoxelMultiplayerDiff<T>& OutDiff)
+{
+	const TVoxelDataOctreeLeafData<T>& DataHolder = Leaf.GetData<T>();
+	const FIntVector Min = Leaf.GetMin();
+
+	Leaf.Multiplayer->AddToDiffAndReset<T>([&](FVoxelCellIndex Index)
+	{
+		if (DataHolder.HasData())
+		{
+			return DataHolder.Get(Index);
+		}
+		
+		// Reverted to the generator
+		const FIntVector Position = Min + FVoxelDataOctreeUtilities::CoordinatesFromIndex(Index);
+		return Leaf.GetFromGeneratorAndAssets<T>(*Data.Generator, Position.X, Position.Y, Position.Z, 0);
+	}, OutDiff);
+}
+
+void FVoxelData::GetMultiplayerDiffs(TArray<FVoxelMultiplayerLeafDiff>& OutDiffs)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	ensure(bEnableMultiplayer);
+
+	TArray<FVoxelIntBox> WrittenBounds;
+	{
+		FScopeLock MultiplayerLock(&MultiplayerWrites.Section);
+		WrittenBounds.Reserve(MultiplayerWrites.WrittenNodes.Num());
+		for (const FVoxelOctreeId& Node : MultiplayerWrites.WrittenNodes)
+		{
+			WrittenBounds.Add(GetNodeBounds(Node));
+		}
+		MultiplayerWrites.WrittenNodes.Reset();
+	}
+
+	if (WrittenBounds.Num() == 0)
+	{
+		return;
+	}
+
+	// The leaves multiplayer data is only written under write locks, which are excluded by this read lock
+	FVoxelReadScopeLock Lock(*this, FVoxelIntBox(WrittenBounds), "GetMultiplayerDiffs");
+
+	for (const FVoxelIntBox& Bounds : WrittenBounds)
+	{
+		FVoxelOctreeUtilities::IterateLeavesInBounds(*Octree, Bounds, [&](FVoxelDataOctreeLeaf& Leaf)
+		{
+			// Also skips leaves in several written nodes, as they are reset the first time
+			if (!Leaf.Multiplayer.IsValid() ||
+				(!Leaf.Multiplayer->IsNetworkDirty<FVoxelValue>() && !Leaf.Multiplayer->IsNetworkDirty<FVoxelMaterial>()))
+			{
+				return;
+			}
+
+			FVoxelMultiplayerLeafDiff Diff;
+			Diff.Position = Leaf.GetMin();
+			AddLeafToMultiplayerDiff(*this, Leaf, Diff.Values);
+			AddLeafToMultiplayerDiff(*this, Leaf, Diff.Materials);
+
+			if (Diff.Values.Num() > 0 || Diff.Materials.Num() > 0)
+			{
+				OutDiffs.Add(MoveTemp(Diff));
+			}
+		});
+	}
+}
+
+// Replaces the special values of a leaf that was just loaded from a save by the generator values, see CVarStoreSpecialValueForGeneratorValuesInSaves
+static void LoadGeneratorValues(FVoxelData& Data, FVoxelDataOctreeLeaf& Leaf)
+{
+	if (CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnAnyThread() == 0)
+	{
+		return;
+	}
+
+	VOXEL_ASYNC_SCOPE_COUNTER("Loading generator values");
+
+	// If we are dirty and we are not a single value, or if we are a single special value
+	if (Leaf.Values.IsDirty() && (!Leaf.Values.IsSingleValue() || Leaf.Values.GetSingleValue() == FVoxelValue::Special()))
+	{
+		Leaf.Values.PrepareForWrite(Data);
+
+		const FVoxelIntBox LeafBounds = Leaf.GetBounds();
+		LeafBounds.Iterate([&](int32 X, int32 Y, int32 Z)
+		{
+			const FVoxelCellIndex Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(LeafBounds.Min, X, Y, Z);
+			FVoxelValue& Value = Leaf.Values.GetRef(Index);
+
+			if (Value == FVoxelValue::Special())
+			{
+				// Use the generator value, ignoring all assets and items as they are not loaded
+				// The same is done when checking on save
+				Value = Data.Generator->Get<FVoxelValue>(X, Y, Z, 0, FVoxelItemStack::Empty);
+			}
+		});
+
+		Leaf.Values.TryCompressToSingleValue(Data);
+	}
 }
 
 bool FVoxelData::LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const FVoxelPlaceableItemLoadInfo& LoadInfo, TArray<FVoxelIntBox>* OutBoundsToUpdate)
@@ -700,35 +1044,7 @@ bool FVoxelData::LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const
 			if (CurrentPosition == Tree.Position)
 			{
 				Loader.ExtractChunk(ChunkIndex, *this, Leaf.Values, Leaf.Materials);
-				
-				if (CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnGameThread() != 0)
-				{
-					VOXEL_ASYNC_SCOPE_COUNTER("Loading generator values");
-					
-					// If we are dirty and we are not a single value, or if we are a single special value
-					if (Leaf.Values.IsDirty() && (!Leaf.Values.IsSingleValue() || Leaf.Values.GetSingleValue() == FVoxelValue::Special()))
-					{
-						if (Leaf.Values.IsSingleValue())
-						{
-							Leaf.Values.ExpandSingleValue(*this);
-						}
-
-						OctreeBounds.Iterate([&](int32 X, int32 Y, int32 Z)
-						{
-							const FVoxelCellIndex Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(OctreeBounds.Min, X, Y, Z);
-							FVoxelValue& Value = Leaf.Values.GetRef(Index);
-
-							if (Value == FVoxelValue::Special())
-							{
-								// Use the generator value, ignoring all assets and items as they are not loaded
-								// The same is done when checking on save
-								Value = Generator->Get<FVoxelValue>(X, Y, Z, 0, FVoxelItemStack::Empty);
-							}
-						});
-
-						Leaf.Values.TryCompressToSingleValue(*this);
-					}
-				}
+				LoadGeneratorValues(*this, Leaf);
 
 				ChunkIndex++;
 				if (OutBoundsToUpdate)
@@ -761,6 +1077,61 @@ bool FVoxelData::LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const
 	return !Loader.GetError();
 }
 
+void FVoxelData::LoadRegionFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const FVoxelIntBox& RegionBounds, TArray<FVoxelIntBox>& OutBoundsToUpdate)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	FVoxelWriteScopeLock Lock(*this, RegionBounds, FUNCTION_FNAME);
+
+	FVoxelSaveLoader Loader(Save);
+
+	int32 NumEditedChunks = 0;
+	for (int32 ChunkIndex = 0; ChunkIndex < Loader.NumChunks(); ChunkIndex++)
+	{
+		const FIntVector Position = Loader.GetChunkPosition(ChunkIndex);
+		// Save depth can be bigger than ours
+		if (!ensure(RegionBounds.Contains(Position)) || !Octree->IsInOctree(Position))
+		{
+			continue;
+		}
+
+		FVoxelDataOctreeLeaf& Leaf = *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(*Octree, Position);
+		if (!ensure(Leaf.Position == Position))
+		{
+			continue;
+		}
+
+		if (Leaf.Values.IsDirty() || Leaf.Materials.IsDirty())
+		{
+			// Should not happen, as write locks load their regions first
+			NumEditedChunks++;
+			continue;
+		}
+
+		Loader.ExtractChunk(ChunkIndex, *this, Leaf.Values, Leaf.Materials);
+		LoadGeneratorValues(*this, Leaf);
+
+		OutBoundsToUpdate.Add(Leaf.GetBounds());
+	}
+
+	if (NumEditedChunks > 0)
+	{
+		LOG_VOXEL(Warning, TEXT("Region %s: discarded the saved data of %d chunks that were edited before the region was loaded"), *RegionBounds.ToString(), NumEditedChunks);
+	}
+}
+
+void FVoxelData::SetRegionSaveLoader(const TVoxelSharedPtr<FVoxelRegionSaveLoader>& Loader)
+{
+	FScopeLock Lock(&RegionSaveLoaderSection);
+	RegionSaveLoader = Loader;
+}
+
+TVoxelSharedPtr<FVoxelRegionSaveLoader> FVoxelData::GetRegionSaveLoader() const
+{
+	FScopeLock Lock(&RegionSaveLoaderSection);
+	return RegionSaveLoader;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -780,12 +1151,18 @@ static TAutoConsoleVariable<int32> CVarResetDataChunksWhenUndoingAddItem(
 	TEXT("If true, will reset all data chunks affected by AddItem when undoing it. If false, these chunks will be left untouched. In both cases, undo is imperfect"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarUndoRedoMemoryBudget(
+	TEXT("voxel.data.UndoRedo.MemoryBudget"),
+	512,
+	TEXT("Max memory, in MB, used by the undo/redo frames of all the voxel datas. Above that, SaveFrame evicts the least recently saved undo frames, of any data. 0 for no limit"),
+	ECVF_Default);
+
 bool FVoxelData::Undo(TArray<FVoxelIntBox>& OutBoundsToUpdate)
 {
 	VOXEL_FUNCTION_COUNTER();
 	CHECK_UNDO_REDO();
 
-	if (UndoRedo.HistoryPosition <= 0)
+	if (UndoRedo.HistoryPosition <= UndoRedo.MinHistoryPosition)
 	{
 		return false;
 	}
@@ -795,6 +1172,8 @@ bool FVoxelData::Undo(TArray<FVoxelIntBox>& OutBoundsToUpdate)
 
 	UndoRedo.RedoUniqueIds.Add(UndoRedo.CurrentFrameUniqueId);
 	UndoRedo.CurrentFrameUniqueId = UndoRedo.UndoUniqueIds.Pop(UE_505_SWITCH(false, EAllowShrinking::No));
+
+	UndoRedo.RedoFramesSaveOrder.Add(UndoRedo.UndoFramesSaveOrder.Pop(UE_505_SWITCH(false, EAllowShrinking::No)));
 		
 	const auto Bounds = UndoRedo.UndoFramesBounds.Pop();
 	UndoRedo.RedoFramesBounds.Add(Bounds);
@@ -840,6 +1219,8 @@ bool FVoxelData::Redo(TArray<FVoxelIntBox>& OutBoundsToUpdate)
 
 	UndoRedo.UndoUniqueIds.Add(UndoRedo.CurrentFrameUniqueId);
 	UndoRedo.CurrentFrameUniqueId = UndoRedo.RedoUniqueIds.Pop(UE_505_SWITCH(false, EAllowShrinking::No));
+
+	UndoRedo.UndoFramesSaveOrder.Add(UndoRedo.RedoFramesSaveOrder.Pop(UE_505_SWITCH(false, EAllowShrinking::No)));
 	
 	const auto Bounds = UndoRedo.RedoFramesBounds.Pop();
 	UndoRedo.UndoFramesBounds.Add(Bounds);
@@ -853,6 +1234,7 @@ bool FVoxelData::Redo(TArray<FVoxelIntBox>& OutBoundsToUpdate)
 		if (Leaf.UndoRedo.IsValid() && Leaf.UndoRedo->CanUndoRedo<EVoxelUndoRedo::Redo>(UndoRedo.HistoryPosition))
 		{
 			Leaf.UndoRedo->UndoRedo<EVoxelUndoRedo::Redo>(*this, Leaf, UndoRedo.HistoryPosition);
+			UndoRedo.LeavesToCompress.Add(&Leaf);
 			OutBoundsToUpdate.Add(Leaf.GetBounds());
 		}
 	});
@@ -922,6 +1304,17 @@ void FVoxelData::SaveFrame(const FVoxelIntBox& Bounds)
 		}
 		UndoRedo.LeavesWithRedoStackStack.Reset();
 
+		// Compress the undo frames pushed down by Redo
+		for (auto* Leaf : UndoRedo.LeavesToCompress)
+		{
+			if (ensure(Leaf->UndoRedo.IsValid()))
+			{
+				// Note: no need to lock, see above
+				Leaf->UndoRedo->CompressOldUndoFrames();
+			}
+		}
+		UndoRedo.LeavesToCompress.Reset();
+
 #if VOXEL_DEBUG
 		// Not thread safe, but for debug only so should be ok
 		FVoxelOctreeUtilities::IterateAllLeaves(GetOctree(), [&](FVoxelDataOctreeLeaf& Leaf)
@@ -947,11 +1340,45 @@ void FVoxelData::SaveFrame(const FVoxelIntBox& Bounds)
 
 	UndoRedo.UndoUniqueIds.Add(UndoRedo.CurrentFrameUniqueId);
 	UndoRedo.RedoUniqueIds.Reset();
+
+	static uint64 SaveFrameCounter = 0;
+	UndoRedo.UndoFramesSaveOrder.Add(SaveFrameCounter++);
+	UndoRedo.RedoFramesSaveOrder.Reset();
 	// Assign new unique id to this frame
 	UndoRedo.CurrentFrameUniqueId = UndoRedo.FrameUniqueIdCounter++;
 
-	ensure(UndoRedo.UndoFramesBounds.Num() == UndoRedo.HistoryPosition);
-	ensure(UndoRedo.UndoUniqueIds.Num() == UndoRedo.HistoryPosition);
+	const int64 MemoryBudget = int64(CVarUndoRedoMemoryBudget.GetValueOnGameThread()) * 1024 * 1024;
+	if (MemoryBudget > 0 && FVoxelDataOctreeLeafUndoRedo::GetFramesAllocatedSize() > MemoryBudget)
+	{
+		EvictOldestUndoFrames(MemoryBudget);
+	}
+
+	ensure(UndoRedo.UndoFramesBounds.Num() == UndoRedo.HistoryPosition - UndoRedo.MinHistoryPosition);
+	ensure(UndoRedo.UndoUniqueIds.Num() == UndoRedo.HistoryPosition - UndoRedo.MinHistoryPosition);
+	ensure(UndoRedo.UndoFramesSaveOrder.Num() == UndoRedo.HistoryPosition - UndoRedo.MinHistoryPosition);
+}
+
+void FVoxelData::GetUndoRedoFramesStats(TArray<FVoxelUndoRedoFrameStats>& OutStats)
+{
+	VOXEL_FUNCTION_COUNTER();
+	CHECK_UNDO_REDO_VOID();
+
+	OutStats.Reset();
+	OutStats.SetNum(UndoRedo.MaxHistoryPosition - UndoRedo.MinHistoryPosition + 1);
+	for (int32 Index = 0; Index < OutStats.Num(); Index++)
+	{
+		OutStats[Index].HistoryPosition = UndoRedo.MinHistoryPosition + Index;
+	}
+
+	// Frame stacks are game thread only, the lock is only to keep the leaves alive
+	FVoxelReadScopeLock Lock(*this, FVoxelIntBox::Infinite, FUNCTION_FNAME);
+	FVoxelOctreeUtilities::IterateAllLeaves(GetOctree(), [&](FVoxelDataOctreeLeaf& Leaf)
+	{
+		if (Leaf.UndoRedo.IsValid())
+		{
+			Leaf.UndoRedo->AddFramesStats(UndoRedo.MinHistoryPosition, OutStats);
+		}
+	});
 }
 
 bool FVoxelData::IsCurrentFrameEmpty()
@@ -971,6 +1398,73 @@ bool FVoxelData::IsCurrentFrameEmpty()
 	return bValue;
 }
 
+void FVoxelData::EvictOldestUndoFrames(int64 MemoryBudget)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Pin the datas so that none is destroyed while evicting, without holding the registry lock
+	TArray<TVoxelSharedPtr<FVoxelData>> Datas;
+	{
+		FScopeLock Lock(&GVoxelUndoRedoDatasSection);
+		GVoxelUndoRedoDatas.RemoveAllSwap([&](const TVoxelWeakPtr<FVoxelData>& WeakData)
+		{
+			const TVoxelSharedPtr<FVoxelData> Data = WeakData.Pin();
+			if (!Data.IsValid())
+			{
+				return true;
+			}
+			Datas.Add(Data);
+			return false;
+		});
+	}
+
+	while (FVoxelDataOctreeLeafUndoRedo::GetFramesAllocatedSize() > MemoryBudget)
+	{
+		// Least recently saved frame. Always keep the last frame of each data
+		FVoxelData* OldestData = nullptr;
+		for (const TVoxelSharedPtr<FVoxelData>& Data : Datas)
+		{
+			const TArray<uint64>& SaveOrder = Data->UndoRedo.UndoFramesSaveOrder;
+			if (SaveOrder.Num() > 1 && (!OldestData || SaveOrder[0] < OldestData->UndoRedo.UndoFramesSaveOrder[0]))
+			{
+				OldestData = Data.Get();
+			}
+		}
+		if (!OldestData)
+		{
+			break;
+		}
+		OldestData->EvictOldestUndoFrame();
+	}
+}
+
+void FVoxelData::EvictOldestUndoFrame()
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(UndoRedo.UndoFramesBounds.Num() > 0);
+
+	const FVoxelIntBox Bounds = UndoRedo.UndoFramesBounds[0];
+	UndoRedo.UndoFramesBounds.RemoveAt(0);
+	UndoRedo.UndoUniqueIds.RemoveAt(0);
+	UndoRedo.UndoFramesSaveOrder.RemoveAt(0);
+
+	{
+		// Bounds contain all the leaves with a frame for this history position
+		FVoxelReadScopeLock Lock(*this, Bounds, FUNCTION_FNAME);
+		FVoxelOctreeUtilities::IterateLeavesInBounds(GetOctree(), Bounds, [&](FVoxelDataOctreeLeaf& Leaf)
+		{
+			if (Leaf.UndoRedo.IsValid())
+			{
+				Leaf.UndoRedo->RemoveOldestUndoFrame(UndoRedo.MinHistoryPosition);
+			}
+		});
+	}
+
+	UndoRedo.MinHistoryPosition++;
+	
+	LOG_VOXEL(Verbose, TEXT("Undo memory budget exceeded: evicted the frame of history position %d"), UndoRedo.MinHistoryPosition - 1);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
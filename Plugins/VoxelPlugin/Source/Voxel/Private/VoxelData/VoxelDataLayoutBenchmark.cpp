@@ -0,0 +1,155 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelValue.h"
+#include "VoxelData/VoxelDataOctree.h"
+#include "HAL/IConsoleManager.h"
+
+// Compares the linear and Morton data chunk layouts on the access patterns of the data code,
+// independently of VOXEL_DATA_CHUNK_MORTON_LAYOUT
+namespace FVoxelDataLayoutBenchmark
+{
+	struct FLinearLayout
+	{
+		static constexpr const TCHAR* Name = TEXT("Linear");
+
+		FORCEINLINE static uint32 GetIndex(int32 X, int32 Y, int32 Z)
+		{
+			return FVoxelDataOctreeUtilities::LinearIndexFromCoordinates(X, Y, Z);
+		}
+	};
+	struct FMortonLayout
+	{
+		static constexpr const TCHAR* Name = TEXT("Morton");
+
+		FORCEINLINE static uint32 GetIndex(int32 X, int32 Y, int32 Z)
+		{
+			return FVoxelUtilities::MortonEncode3D(X, Y, Z);
+		}
+	};
+
+	// Prevents the compiler from optimizing the loops away
+	int32 GSink = 0;
+
+	template<typename TLambda>
+	double Time(int32 NumChunks, int32 NumRuns, TLambda Lambda)
+	{
+		double BestTime = MAX_dbl;
+		for (int32 Run = 0; Run < NumRuns; Run++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Chunk = 0; Chunk < NumChunks; Chunk++)
+			{
+				Lambda(Chunk);
+			}
+			BestTime = FMath::Min(BestTime, FPlatformTime::Seconds() - StartTime);
+		}
+		return double(NumChunks) * VOXELS_PER_DATA_CHUNK / BestTime / 1e6;
+	}
+
+	template<typename TLayout>
+	void Run(int32 NumChunks, int32 NumRuns)
+	{
+		constexpr int32 Size = DATA_CHUNK_SIZE;
+
+		// Big enough to not fit in cache
+		TArray<FVoxelValue> Chunks;
+		Chunks.SetNumUninitialized(NumChunks * VOXELS_PER_DATA_CHUNK);
+		for (int32 Index = 0; Index < Chunks.Num(); Index++)
+		{
+			Chunks[Index] = FVoxelValue(FMath::Sin(Index * 0.01f));
+		}
+
+		TArray<FVoxelValue> Output;
+		Output.SetNumUninitialized(VOXELS_PER_DATA_CHUNK);
+
+		// FVoxelData::Get: chunk -> query zone, Z inner loop
+		const double CopySpeed = Time(NumChunks, NumRuns, [&](int32 Chunk)
+		{
+			const FVoxelValue* RESTRICT Data = &Chunks[Chunk * VOXELS_PER_DATA_CHUNK];
+			for (int32 X = 0; X < Size; X++)
+			{
+				for (int32 Y = 0; Y < Size; Y++)
+				{
+					for (int32 Z = 0; Z < Size; Z++)
+					{
+						Output[X + Size * Y + Size * Size * Z] = Data[TLayout::GetIndex(X, Y, Z)];
+					}
+				}
+			}
+			GSink += Output[Chunk % VOXELS_PER_DATA_CHUNK].IsEmpty();
+		});
+
+		// Sphere tools: FVoxelIntBox::Iterate + read-modify-write inside a sphere
+		const double SphereSpeed = Time(NumChunks, NumRuns, [&](int32 Chunk)
+		{
+			FVoxelValue* RESTRICT Data = &Chunks[Chunk * VOXELS_PER_DATA_CHUNK];
+			constexpr float Radius = Size / 2.f;
+			for (int32 X = 0; X < Size; X++)
+			{
+				for (int32 Y = 0; Y < Size; Y++)
+				{
+					for (int32 Z = 0; Z < Size; Z++)
+					{
+						const float DistanceSquared = FVector(X - Radius, Y - Radius, Z - Radius).SizeSquared();
+						if (DistanceSquared < Radius * Radius)
+						{
+							FVoxelValue& Value = Data[TLayout::GetIndex(X, Y, Z)];
+							Value = FVoxelValue(FMath::Min(Value.ToFloat(), FMath::Sqrt(DistanceSquared) - Radius));
+						}
+					}
+				}
+			}
+		});
+
+		// Smooth tools & normals: 6-neighborhood reads
+		const double NeighborsSpeed = Time(NumChunks, NumRuns, [&](int32 Chunk)
+		{
+			const FVoxelValue* RESTRICT Data = &Chunks[Chunk * VOXELS_PER_DATA_CHUNK];
+			for (int32 X = 1; X < Size - 1; X++)
+			{
+				for (int32 Y = 1; Y < Size - 1; Y++)
+				{
+					for (int32 Z = 1; Z < Size - 1; Z++)
+					{
+						const float Sum =
+							Data[TLayout::GetIndex(X - 1, Y, Z)].ToFloat() +
+							Data[TLayout::GetIndex(X + 1, Y, Z)].ToFloat() +
+							Data[TLayout::GetIndex(X, Y - 1, Z)].ToFloat() +
+							Data[TLayout::GetIndex(X, Y + 1, Z)].ToFloat() +
+							Data[TLayout::GetIndex(X, Y, Z - 1)].ToFloat() +
+							Data[TLayout::GetIndex(X, Y, Z + 1)].ToFloat();
+						Output[FVoxelDataOctreeUtilities::LinearIndexFromCoordinates(X, Y, Z)] = FVoxelValue(Sum / 6);
+					}
+				}
+			}
+			GSink += Output[Chunk % VOXELS_PER_DATA_CHUNK].IsEmpty();
+		});
+
+		LOG_VOXEL(Log, TEXT("%s layout: copy %.1f MVoxels/s, sphere edit %.1f MVoxels/s, neighborhood reads %.1f MVoxels/s"),
+			TLayout::Name,
+			CopySpeed,
+			SphereSpeed,
+			NeighborsSpeed);
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 NumChunks = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4096);
+		const int32 NumRuns = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 5);
+
+		LOG_VOXEL(Log, TEXT("Benchmarking data chunk layouts: %d chunks (%lldMB), best of %d runs. Current layout: %s"),
+			NumChunks,
+			int64(NumChunks) * VOXELS_PER_DATA_CHUNK * sizeof(FVoxelValue) >> 20,
+			NumRuns,
+			VOXEL_DATA_CHUNK_MORTON_LAYOUT ? TEXT("Morton") : TEXT("Linear"));
+
+		Run<FLinearLayout>(NumChunks, NumRuns);
+		Run<FMortonLayout>(NumChunks, NumRuns);
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkLayouts(
+	TEXT("voxel.data.BenchmarkLayouts"),
+	TEXT("Compares the linear and Morton data chunk layouts. Args: [NumChunks = 4096] [NumRuns = 5]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelDataLayoutBenchmark::Benchmark));
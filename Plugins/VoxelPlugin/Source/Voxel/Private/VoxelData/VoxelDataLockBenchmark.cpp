@@ -0,0 +1,160 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelData.inl"
+#include "VoxelData/VoxelDataLock.h"
+#include "VoxelGenerators/VoxelEmptyGenerator.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/Async.h"
+
+// Mesher-like readers and editor-like writers hammering the same data, with and without optimistic reads
+namespace FVoxelDataLockBenchmark
+{
+	struct FThreadResult
+	{
+		int64 NumLocks = 0;
+		double TotalLockTime = 0;
+		double MaxLockTime = 0;
+
+		void Add(double LockTime)
+		{
+			NumLocks++;
+			TotalLockTime += LockTime;
+			MaxLockTime = FMath::Max(MaxLockTime, LockTime);
+		}
+		void Merge(const FThreadResult& Other)
+		{
+			NumLocks += Other.NumLocks;
+			TotalLockTime += Other.TotalLockTime;
+			MaxLockTime = FMath::Max(MaxLockTime, Other.MaxLockTime);
+		}
+	};
+
+	struct FResult
+	{
+		FThreadResult Reads;
+		FThreadResult Writes;
+	};
+
+	FIntVector GetRandomPosition(const FVoxelData& Data, FRandomStream& Stream, int32 Size)
+	{
+		const FVoxelIntBox& Bounds = Data.WorldBounds;
+		return FIntVector(
+			Stream.RandRange(Bounds.Min.X, Bounds.Max.X - Size),
+			Stream.RandRange(Bounds.Min.Y, Bounds.Max.Y - Size),
+			Stream.RandRange(Bounds.Min.Z, Bounds.Max.Z - Size));
+	}
+
+	FResult Run(FVoxelData& Data, int32 NumReaders, int32 NumWriters, double Duration)
+	{
+		FThreadSafeBool bStop = false;
+
+		TArray<FThreadResult> Results;
+		Results.SetNum(NumReaders + NumWriters);
+
+		TArray<TFuture<void>> Futures;
+		for (int32 Index = 0; Index < NumReaders + NumWriters; Index++)
+		{
+			const bool bIsWriter = Index >= NumReaders;
+			Futures.Add(Async(EAsyncExecution::Thread, [&Data, &bStop, &Result = Results[Index], bIsWriter, Index]()
+			{
+				FRandomStream Stream(Index);
+				while (!bStop)
+				{
+					if (bIsWriter)
+					{
+						// Small edit, like a sculpt tool
+						const FIntVector Position = GetRandomPosition(Data, Stream, 8);
+						const FVoxelIntBox Bounds(Position, Position + FIntVector(8));
+
+						const double StartTime = FPlatformTime::Seconds();
+						FVoxelWriteScopeLock Lock(Data, Bounds, "Lock Benchmark Write");
+						Result.Add(FPlatformTime::Seconds() - StartTime);
+
+						const float Value = Stream.FRandRange(-1.f, 1.f);
+						Data.Set<FVoxelValue>(Bounds, [&](int32 X, int32 Y, int32 Z, FVoxelValue& OutValue)
+						{
+							OutValue = FVoxelValue(Value);
+						});
+					}
+					else
+					{
+						// Same bounds as a LOD 0 marching cubes chunk
+						const FIntVector Position = GetRandomPosition(Data, Stream, RENDER_CHUNK_SIZE + 3) / RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE;
+						const FVoxelIntBox Bounds(Position, Position + FIntVector(RENDER_CHUNK_SIZE + 3));
+
+						const double StartTime = FPlatformTime::Seconds();
+						FVoxelReadScopeLock Lock(Data, Bounds, "Lock Benchmark Read");
+						Result.Add(FPlatformTime::Seconds() - StartTime);
+
+						Data.Get<FVoxelValue>(Bounds);
+					}
+				}
+			}));
+		}
+
+		FPlatformProcess::Sleep(Duration);
+		bStop = true;
+
+		for (auto& Future : Futures)
+		{
+			Future.Wait();
+		}
+
+		FResult Result;
+		for (int32 Index = 0; Index < Results.Num(); Index++)
+		{
+			(Index < NumReaders ? Result.Reads : Result.Writes).Merge(Results[Index]);
+		}
+		return Result;
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 NumReaders = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16);
+		const int32 NumWriters = FMath::Max(0, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1);
+		const double Duration = FMath::Max(0.1f, Args.Num() > 2 ? FCString::Atof(*Args[2]) : 2.f);
+
+		IConsoleVariable* OptimisticReads = IConsoleManager::Get().FindConsoleVariable(TEXT("voxel.data.OptimisticReads"));
+		if (!ensure(OptimisticReads))
+		{
+			return;
+		}
+#if DO_THREADSAFE_CHECKS
+		LOG_VOXEL(Warning, TEXT("Optimistic reads are always disabled with DO_THREADSAFE_CHECKS: both runs will lock the octree"));
+#endif
+
+		const int32 OldOptimisticReads = OptimisticReads->GetInt();
+
+		LOG_VOXEL(Log, TEXT("Benchmarking data locks: %d readers, %d writers, %.1fs per run"), NumReaders, NumWriters, Duration);
+
+		for (const bool bOptimistic : { false, true })
+		{
+			OptimisticReads->Set(bOptimistic ? 1 : 0, ECVF_SetByConsole);
+
+			// New data every run, so that both start with the same octree
+			const auto Generator = MakeVoxelShared<FVoxelEmptyGeneratorInstance>(1);
+			Generator->Init(FVoxelGeneratorInit());
+			const auto Data = FVoxelData::Create(FVoxelDataSettings(4, Generator, false, false), 2);
+
+			const FResult Result = Run(*Data, NumReaders, NumWriters, Duration);
+
+			LOG_VOXEL(Log, TEXT("%s: %.0f reads/s (avg lock %.2fus, max %.2fms), %.0f writes/s (avg lock %.2fus, max %.2fms)"),
+				bOptimistic ? TEXT("Optimistic reads") : TEXT("Octree locker"),
+				Result.Reads.NumLocks / Duration,
+				Result.Reads.TotalLockTime / FMath::Max<int64>(1, Result.Reads.NumLocks) * 1e6,
+				Result.Reads.MaxLockTime * 1e3,
+				Result.Writes.NumLocks / Duration,
+				Result.Writes.TotalLockTime / FMath::Max<int64>(1, Result.Writes.NumLocks) * 1e6,
+				Result.Writes.MaxLockTime * 1e3);
+		}
+
+		OptimisticReads->Set(OldOptimisticReads, ECVF_SetByConsole);
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkLocks(
+	TEXT("voxel.data.BenchmarkLocks"),
+	TEXT("Compares read locks locking the data octree with optimistic reads. Args: [NumReaders = 16] [NumWriters = 1] [Duration = 2]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelDataLockBenchmark::Benchmark));
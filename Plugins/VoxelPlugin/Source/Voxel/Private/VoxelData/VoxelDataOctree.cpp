@@ -4,6 +4,7 @@
 #include "VoxelData/VoxelDataUtilities.h"
 #include "VoxelGenerators/VoxelGeneratorInstance.h"
 #include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "HAL/IConsoleManager.h"
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreesMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelUndoRedoMemory);
@@ -16,6 +17,20 @@ DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeDirtyMaterialsMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeCachedValuesMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeCachedMaterialsMemory);
 
+DEFINE_STAT(STAT_VoxelDataOctreePaletteSavedMemory);
+DEFINE_STAT(STAT_VoxelDataOctreePaletteBuffersCount);
+
+static TAutoConsoleVariable<int32> CVarUsePaletteCompression(
+	TEXT("voxel.data.UsePaletteCompression"),
+	1,
+	TEXT("If true, data leaves with few distinct values or materials are stored palette-indexed when compressed"),
+	ECVF_Default);
+
+bool FVoxelDataOctreeLeafPaletteSettings::IsEnabled()
+{
+	return CVarUsePaletteCompression.GetValueOnAnyThread() != 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
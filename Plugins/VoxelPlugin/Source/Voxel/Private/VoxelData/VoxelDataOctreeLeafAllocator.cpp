@@ -0,0 +1,183 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelData/VoxelDataOctreeLeafAllocator.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/LockFreeList.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreePooledBuffersMemory);
+
+static TAutoConsoleVariable<int32> CVarUseLeafPool(
+	TEXT("voxel.data.LeafPool.Enable"),
+	1,
+	TEXT("If true, data leaf buffers are recycled through a pool instead of being freed"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarLeafPoolMaxMemory(
+	TEXT("voxel.data.LeafPool.MaxMemory"),
+	256,
+	TEXT("Max memory, in MB, kept in the data leaf buffers pool. Buffers freed above that are returned to the system"),
+	ECVF_Default);
+
+static FAutoConsoleCommand CmdTrimLeafPool(
+	TEXT("voxel.data.LeafPool.Trim"),
+	TEXT("Frees all the data leaf buffers kept in the pool"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const int64 PooledMemory = FVoxelDataOctreeLeafAllocator::GetPooledMemory();
+		FVoxelDataOctreeLeafAllocator::Trim();
+		LOG_VOXEL(Log, TEXT("Leaf pool trimmed: %lldKB -> %lldKB"), PooledMemory / 1024, FVoxelDataOctreeLeafAllocator::GetPooledMemory() / 1024);
+	}));
+
+namespace FVoxelDataOctreeLeafAllocatorImpl
+{
+	constexpr int32 NumBuffers = int32(EVoxelDataOctreeLeafBuffer::Num);
+	// Small enough to not matter when a thread dies, big enough to absorb the alloc/free bursts of a single edit
+	constexpr int32 ThreadCacheSize = 16;
+
+	TLockFreePointerListUnordered<void, PLATFORM_CACHE_LINE_SIZE> GlobalFreeLists[NumBuffers];
+
+	// Memory in the global free lists, used to enforce the cap
+	FThreadSafeCounter64 GlobalPooledMemory;
+	// Memory in the global free lists + in the thread caches
+	FThreadSafeCounter64 TotalPooledMemory;
+
+	FORCEINLINE void OnPooled(int32 Size)
+	{
+		TotalPooledMemory.Add(Size);
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreePooledBuffersMemory, Size);
+	}
+	FORCEINLINE void OnUnpooled(int32 Size)
+	{
+		TotalPooledMemory.Subtract(Size);
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreePooledBuffersMemory, Size);
+	}
+
+	void* PopGlobal(EVoxelDataOctreeLeafBuffer Buffer)
+	{
+		void* Ptr = GlobalFreeLists[int32(Buffer)].Pop();
+		if (Ptr)
+		{
+			GlobalPooledMemory.Subtract(FVoxelDataOctreeLeafAllocator::GetBufferSize(Buffer));
+		}
+		return Ptr;
+	}
+	// Ptr must already be accounted in TotalPooledMemory
+	void PushGlobal(EVoxelDataOctreeLeafBuffer Buffer, void* Ptr)
+	{
+		const int32 Size = FVoxelDataOctreeLeafAllocator::GetBufferSize(Buffer);
+		const int64 MaxMemory = int64(FMath::Max(0, CVarLeafPoolMaxMemory.GetValueOnAnyThread())) << 20;
+
+		if (GlobalPooledMemory.Add(Size) + Size > MaxMemory)
+		{
+			GlobalPooledMemory.Subtract(Size);
+			OnUnpooled(Size);
+			FMemory::Free(Ptr);
+			return;
+		}
+
+		GlobalFreeLists[int32(Buffer)].Push(Ptr);
+	}
+
+	struct FThreadCache
+	{
+		void* Buffers[NumBuffers][ThreadCacheSize];
+		int32 Num[NumBuffers] = {};
+
+		~FThreadCache()
+		{
+			for (int32 Buffer = 0; Buffer < NumBuffers; Buffer++)
+			{
+				for (int32 Index = 0; Index < Num[Buffer]; Index++)
+				{
+					PushGlobal(EVoxelDataOctreeLeafBuffer(Buffer), Buffers[Buffer][Index]);
+				}
+				Num[Buffer] = 0;
+			}
+		}
+	};
+	thread_local FThreadCache ThreadCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelDataOctreeLeafAllocator::Allocate(EVoxelDataOctreeLeafBuffer Buffer)
+{
+	using namespace FVoxelDataOctreeLeafAllocatorImpl;
+	checkVoxelSlow(int32(Buffer) < NumBuffers);
+
+	const int32 Size = GetBufferSize(Buffer);
+
+	FThreadCache& Cache = ThreadCache;
+	int32& Num = Cache.Num[int32(Buffer)];
+	if (Num > 0)
+	{
+		OnUnpooled(Size);
+		return Cache.Buffers[int32(Buffer)][--Num];
+	}
+
+	if (void* Ptr = PopGlobal(Buffer))
+	{
+		OnUnpooled(Size);
+		return Ptr;
+	}
+
+	return FMemory::Malloc(Size);
+}
+
+void FVoxelDataOctreeLeafAllocator::Free(EVoxelDataOctreeLeafBuffer Buffer, void* Ptr)
+{
+	using namespace FVoxelDataOctreeLeafAllocatorImpl;
+	checkVoxelSlow(int32(Buffer) < NumBuffers);
+	checkVoxelSlow(Ptr);
+
+	// All the buffers come from FMemory::Malloc, so toggling this at runtime is safe
+	if (!CVarUseLeafPool.GetValueOnAnyThread())
+	{
+		FMemory::Free(Ptr);
+		return;
+	}
+
+	OnPooled(GetBufferSize(Buffer));
+
+	FThreadCache& Cache = ThreadCache;
+	int32& Num = Cache.Num[int32(Buffer)];
+	if (Num < ThreadCacheSize)
+	{
+		Cache.Buffers[int32(Buffer)][Num++] = Ptr;
+		return;
+	}
+
+	PushGlobal(Buffer, Ptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDataOctreeLeafAllocator::Trim(int64 MaxPooledMemory)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	using namespace FVoxelDataOctreeLeafAllocatorImpl;
+
+	// Free the biggest buffers first
+	for (const EVoxelDataOctreeLeafBuffer Buffer : { EVoxelDataOctreeLeafBuffer::Materials, EVoxelDataOctreeLeafBuffer::Values, EVoxelDataOctreeLeafBuffer::MaterialChannel })
+	{
+		while (GlobalPooledMemory.GetValue() > MaxPooledMemory)
+		{
+			void* Ptr = PopGlobal(Buffer);
+			if (!Ptr)
+			{
+				break;
+			}
+			OnUnpooled(GetBufferSize(Buffer));
+			FMemory::Free(Ptr);
+		}
+	}
+}
+
+int64 FVoxelDataOctreeLeafAllocator::GetPooledMemory()
+{
+	return FVoxelDataOctreeLeafAllocatorImpl::TotalPooledMemory.GetValue();
+}
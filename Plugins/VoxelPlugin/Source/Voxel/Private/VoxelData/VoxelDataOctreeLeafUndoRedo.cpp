@@ -2,6 +2,16 @@
 
 #include "VoxelData/VoxelDataOctreeLeafUndoRedo.h"
 #include "VoxelData/VoxelDataOctree.h"
+#include "VoxelUtilities/VoxelSerializationUtilities.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarUndoRedoNumUncompressedFrames(
+	TEXT("voxel.data.UndoRedo.NumUncompressedFrames"),
+	4,
+	TEXT("Number of frames at the top of each leaf undo and redo stacks that are kept uncompressed, so that undoing recent frames is as fast as without compression. -1 to never compress frames"),
+	ECVF_Default);
+
+static FThreadSafeCounter64 GVoxelUndoRedoFramesAllocatedSize;
 
 FVoxelDataOctreeLeafUndoRedo::FVoxelDataOctreeLeafUndoRedo(const FVoxelDataOctreeLeaf& Leaf)
 	: CurrentFrame(MakeUnique<FFrame>(Leaf))
@@ -30,6 +40,7 @@ void FVoxelDataOctreeLeafUndoRedo::SaveFrame(const FVoxelDataOctreeLeaf& Leaf, i
 		CurrentFrame->HistoryPosition = HistoryPosition;
 		AddFrameToStack<EVoxelUndoRedo::Undo>(CurrentFrame);
 		check(!CurrentFrame);
+		CompressOldUndoFrames();
 
 		CurrentFrame = MakeUnique<FFrame>(Leaf);
 
@@ -47,18 +58,28 @@ void FVoxelDataOctreeLeafUndoRedo::ClearFramesOfType()
 {
 	const auto ClearFrame = [](FFrame& Frame)
 	{
+		if (Frame.IsCompressed())
+		{
+			Frame.Decompress();
+		}
 		FVoxelUtilities::TValuesMaterialsSelector<T>::Get(Frame).Empty();
+		Frame.bNotWorthCompressing = false;
 	};
 	
 	ClearFrame(*CurrentFrame);
 	for (auto& Frame : UndoFramesStack)
 	{
 		ClearFrame(*Frame);
+		Frame->UpdateStats();
 	}
 	for (auto& Frame : RedoFramesStack)
 	{
 		ClearFrame(*Frame);
+		Frame->UpdateStats();
 	}
+
+	// Compress again what the other type left, so that the history doesn't go back to its raw size
+	CompressOldUndoFrames();
 }
 
 template VOXEL_API void FVoxelDataOctreeLeafUndoRedo::ClearFramesOfType<FVoxelValue>();
@@ -70,8 +91,14 @@ void FVoxelDataOctreeLeafUndoRedo::UndoRedo(const IVoxelData& Data, FVoxelDataOc
 	check(CurrentFrame->IsEmpty());
 	check(CanUndoRedo<Type>(HistoryPosition));
 
-	const TUniquePtr<const FFrame> Frame = GetFramesStack<Type>().Pop(UE_505_SWITCH(false, EAllowShrinking::No));
+	const TUniquePtr<FFrame> Frame = GetFramesStack<Type>().Pop(UE_505_SWITCH(false, EAllowShrinking::No));
 	check(Frame->HistoryPosition == HistoryPosition);
+
+	if (Frame->IsCompressed())
+	{
+		// Only older frames are compressed
+		Frame->Decompress();
+	}
 	
 	TUniquePtr<FFrame> NewFrame = MakeUnique<FFrame>(Leaf);
 	// If Type is Undo NewFrame is a redo frame, so + 1. Else it's an undo frame so -1
@@ -95,7 +122,7 @@ void FVoxelDataOctreeLeafUndoRedo::UndoRedo(const IVoxelData& Data, FVoxelDataOc
 			
 			DataHolder.CreateData(Data, [&](T* RESTRICT DataPtr)
 			{
-				TVoxelQueryZone<T> QueryZone(Leaf.GetBounds(), DataPtr);
+				TVoxelQueryZone<T> QueryZone = TVoxelQueryZone<T>::ForDataChunk(Leaf.GetBounds(), DataPtr);
 				Leaf.GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
 			});
 		}
@@ -118,6 +145,10 @@ void FVoxelDataOctreeLeafUndoRedo::UndoRedo(const IVoxelData& Data, FVoxelDataOc
 			auto& ValueRef = DataHolder.GetRef(ModifiedValue.Index);
 			
 			NewFrameDataPtr[Index] = TModifiedValue<T>(ModifiedValue.Index, ValueRef);
+			if (Leaf.Multiplayer.IsValid() && ValueRef != ModifiedValue.Value)
+			{
+				Leaf.Multiplayer->MarkIndexDirty<T>(ModifiedValue.Index, ValueRef);
+			}
 			ValueRef = ModifiedValue.Value;
 		}
 
@@ -134,11 +165,192 @@ void FVoxelDataOctreeLeafUndoRedo::UndoRedo(const IVoxelData& Data, FVoxelDataOc
 template VOXEL_API void FVoxelDataOctreeLeafUndoRedo::UndoRedo<EVoxelUndoRedo::Undo>(const IVoxelData&, FVoxelDataOctreeLeaf&, int32);
 template VOXEL_API void FVoxelDataOctreeLeafUndoRedo::UndoRedo<EVoxelUndoRedo::Redo>(const IVoxelData&, FVoxelDataOctreeLeaf&, int32);
 
+void FVoxelDataOctreeLeafUndoRedo::RemoveOldestUndoFrame(int32 HistoryPosition)
+{
+	if (UndoFramesStack.Num() > 0 && UndoFramesStack[0]->HistoryPosition == HistoryPosition)
+	{
+		UndoFramesStack.RemoveAt(0);
+	}
+	ensure(UndoFramesStack.Num() == 0 || UndoFramesStack[0]->HistoryPosition > HistoryPosition);
+}
+
+void FVoxelDataOctreeLeafUndoRedo::AddFramesStats(int32 MinHistoryPosition, TArray<FVoxelUndoRedoFrameStats>& OutStats) const
+{
+	const auto AddFrame = [&](const FFrame& Frame)
+	{
+		if (!ensure(OutStats.IsValidIndex(Frame.HistoryPosition - MinHistoryPosition)))
+		{
+			return;
+		}
+
+		FVoxelUndoRedoFrameStats& Stats = OutStats[Frame.HistoryPosition - MinHistoryPosition];
+		Stats.NumLeaves++;
+		Stats.NumCompressedLeaves += Frame.IsCompressed();
+		Stats.AllocatedSize += Frame.AllocatedSize;
+	};
+	
+	for (auto& Frame : UndoFramesStack)
+	{
+		AddFrame(*Frame);
+	}
+	for (auto& Frame : RedoFramesStack)
+	{
+		AddFrame(*Frame);
+	}
+}
+
+int64 FVoxelDataOctreeLeafUndoRedo::GetFramesAllocatedSize()
+{
+	return GVoxelUndoRedoFramesAllocatedSize.GetValue();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelDataOctreeLeafUndoRedo::FFrame::~FFrame()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelUndoRedoMemory, AllocatedSize);
+	GVoxelUndoRedoFramesAllocatedSize.Subtract(AllocatedSize);
+}
+
 void FVoxelDataOctreeLeafUndoRedo::FFrame::UpdateStats() const
 {
 	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelUndoRedoMemory, AllocatedSize);
-	AllocatedSize = sizeof(FFrame) + Values.GetAllocatedSize() + Materials.GetAllocatedSize();
+	GVoxelUndoRedoFramesAllocatedSize.Subtract(AllocatedSize);
+	AllocatedSize = sizeof(FFrame) + Values.GetAllocatedSize() + Materials.GetAllocatedSize() + CompressedData.GetAllocatedSize();
 	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelUndoRedoMemory, AllocatedSize);
+	GVoxelUndoRedoFramesAllocatedSize.Add(AllocatedSize);
+}
+
+void FVoxelDataOctreeLeafUndoRedo::FFrame::Compress()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(!IsCompressed() && !IsEmpty());
+
+	TArray<uint8> EncodedData;
+	EncodedData.Reserve(
+		Values.Num() * (sizeof(FVoxelCellIndex) + sizeof(FVoxelValue)) +
+		Materials.Num() * (sizeof(FVoxelCellIndex) + sizeof(FVoxelMaterial)));
+	Encode(Values, EncodedData);
+	Encode(Materials, EncodedData);
+
+	const EVoxelCompressionCodec::Type NewCodec = FVoxelSerializationUtilities::GetAvailableCodec(EVoxelCompressionCodec::LZ4);
+	TArray<uint8> NewCompressedData;
+	if (!FVoxelSerializationUtilities::CompressBlock(NewCodec, EVoxelCompressionLevel::BestSpeed, EncodedData.GetData(), EncodedData.Num(), NewCompressedData) ||
+		NewCompressedData.Num() >= int64(Values.GetAllocatedSize() + Materials.GetAllocatedSize()))
+	{
+		// Not worth it: keep the frame uncompressed
+		bNotWorthCompressing = true;
+		return;
+	}
+
+	CompressedData = MoveTemp(NewCompressedData);
+	UncompressedSize = EncodedData.Num();
+	NumCompressedValues = Values.Num();
+	NumCompressedMaterials = Materials.Num();
+	Codec = NewCodec;
+
+	Values.Empty();
+	Materials.Empty();
+
+	UpdateStats();
+}
+
+void FVoxelDataOctreeLeafUndoRedo::FFrame::Decompress()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(IsCompressed());
+
+	TArray<uint8> EncodedData;
+	EncodedData.SetNumUninitialized(UncompressedSize);
+	verify(FVoxelSerializationUtilities::DecompressBlock(
+		EVoxelCompressionCodec::Type(Codec),
+		CompressedData.GetData(),
+		CompressedData.Num(),
+		EncodedData.GetData(),
+		EncodedData.Num()));
+
+	const uint8* Ptr = EncodedData.GetData();
+	Decode(Ptr, NumCompressedValues, Values);
+	Decode(Ptr, NumCompressedMaterials, Materials);
+	check(Ptr == EncodedData.GetData() + EncodedData.Num());
+
+	CompressedData.Empty();
+	UncompressedSize = 0;
+	NumCompressedValues = 0;
+	NumCompressedMaterials = 0;
+
+	UpdateStats();
+}
+
+// Indices are sorted and stored as the gaps between them, values as the XOR with the previous value. Both are split in byte planes,
+// so that runs of edited voxels and smooth values become runs of identical bytes that the codec compresses well
+template<typename T>
+void FVoxelDataOctreeLeafUndoRedo::FFrame::Encode(TArray<TModifiedValue<T>>& Data, TArray<uint8>& Out)
+{
+	// The order doesn't matter when applying, as a frame has each index at most once
+	Data.Sort([](const TModifiedValue<T>& A, const TModifiedValue<T>& B) { return A.Index < B.Index; });
+
+	const int32 Num = Data.Num();
+	const int32 Offset = Out.Num();
+	Out.AddUninitialized(Num * (sizeof(FVoxelCellIndex) + sizeof(T)));
+
+	uint8* RESTRICT const IndicesPtr = Out.GetData() + Offset;
+	uint8* RESTRICT const ValuesPtr = IndicesPtr + Num * sizeof(FVoxelCellIndex);
+
+	FVoxelCellIndex PreviousIndex = 0;
+	uint8 PreviousBytes[sizeof(T)] = {};
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		const TModifiedValue<T>& ModifiedValue = Data[Index];
+
+		const FVoxelCellIndex Gap = FVoxelCellIndex(ModifiedValue.Index - PreviousIndex);
+		PreviousIndex = ModifiedValue.Index;
+		for (int32 Byte = 0; Byte < int32(sizeof(FVoxelCellIndex)); Byte++)
+		{
+			IndicesPtr[Byte * Num + Index] = uint8(Gap >> (8 * Byte));
+		}
+
+		uint8 Bytes[sizeof(T)];
+		FMemory::Memcpy(Bytes, &ModifiedValue.Value, sizeof(T));
+		for (int32 Byte = 0; Byte < int32(sizeof(T)); Byte++)
+		{
+			ValuesPtr[Byte * Num + Index] = Bytes[Byte] ^ PreviousBytes[Byte];
+			PreviousBytes[Byte] = Bytes[Byte];
+		}
+	}
+}
+
+template<typename T>
+void FVoxelDataOctreeLeafUndoRedo::FFrame::Decode(const uint8*& Ptr, int32 Num, TArray<TModifiedValue<T>>& OutData)
+{
+	const uint8* RESTRICT const IndicesPtr = Ptr;
+	const uint8* RESTRICT const ValuesPtr = IndicesPtr + Num * sizeof(FVoxelCellIndex);
+	Ptr = ValuesPtr + Num * sizeof(T);
+
+	OutData.Reset(Num);
+
+	FVoxelCellIndex PreviousIndex = 0;
+	uint8 PreviousBytes[sizeof(T)] = {};
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		FVoxelCellIndex Gap = 0;
+		for (int32 Byte = 0; Byte < int32(sizeof(FVoxelCellIndex)); Byte++)
+		{
+			Gap = FVoxelCellIndex(Gap | (IndicesPtr[Byte * Num + Index] << (8 * Byte)));
+		}
+		PreviousIndex += Gap;
+
+		for (int32 Byte = 0; Byte < int32(sizeof(T)); Byte++)
+		{
+			PreviousBytes[Byte] ^= ValuesPtr[Byte * Num + Index];
+		}
+
+		T Value;
+		FMemory::Memcpy(&Value, PreviousBytes, sizeof(T));
+		OutData.Emplace(PreviousIndex, Value);
+	}
 }
 
 template<EVoxelUndoRedo Type>
@@ -155,3 +367,26 @@ void FVoxelDataOctreeLeafUndoRedo::AddFrameToStack(TUniquePtr<FFrame>& Frame)
 	GetFramesStack<Type>().Add(MoveTemp(Frame));
 	check(!Frame);
 }
+
+void FVoxelDataOctreeLeafUndoRedo::CompressOldUndoFrames()
+{
+	const int32 NumUncompressedFrames = CVarUndoRedoNumUncompressedFrames.GetValueOnAnyThread();
+	if (NumUncompressedFrames < 0)
+	{
+		return;
+	}
+
+	// A frame is only decompressed when it's popped, so the frames below a compressed one are already compressed
+	for (int32 Index = UndoFramesStack.Num() - 1 - NumUncompressedFrames; Index >= 0; Index--)
+	{
+		FFrame& Frame = *UndoFramesStack[Index];
+		if (Frame.IsCompressed())
+		{
+			break;
+		}
+		if (!Frame.IsEmpty() && !Frame.bNotWorthCompressing)
+		{
+			Frame.Compress();
+		}
+	}
+}
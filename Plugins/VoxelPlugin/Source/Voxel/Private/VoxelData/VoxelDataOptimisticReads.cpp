@@ -0,0 +1,116 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelData/VoxelDataOptimisticReads.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_VoxelDataOptimisticReads);
+DEFINE_STAT(STAT_VoxelDataOptimisticReadsFallbacks);
+
+static TAutoConsoleVariable<int32> CVarOptimisticReads(
+	TEXT("voxel.data.OptimisticReads"),
+	1,
+	TEXT("If true, read locks will not lock the data octree mutexes unless the bounds are being written to"),
+	ECVF_Default);
+
+bool FVoxelDataOptimisticReads::IsEnabled()
+{
+#if DO_THREADSAFE_CHECKS
+	return false;
+#else
+	return CVarOptimisticReads.GetValueOnAnyThread() != 0;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 FVoxelDataOptimisticReads::Enter(const FVoxelIntBox& Bounds)
+{
+	// Spread the threads across the slots to avoid fighting over the first ones
+	const int32 StartIndex = FPlatformTLS::GetCurrentThreadId() % NumSlots;
+	for (int32 Offset = 0; Offset < NumSlots; Offset++)
+	{
+		const int32 SlotIndex = (StartIndex + Offset) % NumSlots;
+		FSlot& Slot = Slots[SlotIndex];
+
+		uint64 State = Slot.State.load(std::memory_order_relaxed);
+		if ((State & State_Mask) != State_Free)
+		{
+			continue;
+		}
+
+		const uint64 Sequence = State & ~uint64(State_Mask);
+		if (!Slot.State.compare_exchange_strong(State, Sequence | State_Claimed))
+		{
+			continue;
+		}
+
+		Slot.Bounds = Bounds;
+		Slot.State.store(Sequence | State_Published);
+
+		// Must be checked after publishing, see Block
+		if (NumBlockers.load() > 0)
+		{
+			Leave(SlotIndex);
+			return -1;
+		}
+
+		return SlotIndex;
+	}
+
+	return -1;
+}
+
+void FVoxelDataOptimisticReads::Leave(int32 SlotIndex)
+{
+	checkVoxelSlow(0 <= SlotIndex && SlotIndex < NumSlots);
+
+	FSlot& Slot = Slots[SlotIndex];
+	const uint64 State = Slot.State.load(std::memory_order_relaxed);
+	checkVoxelSlow((State & State_Mask) == State_Published);
+
+	Slot.State.store((State & ~uint64(State_Mask)) + State_Mask + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDataOptimisticReads::WaitForReaders(const FVoxelIntBox& Bounds) const
+{
+	for (const FSlot& Slot : Slots)
+	{
+		const uint64 State = Slot.State.load();
+		// A claimed reader has not checked the versions yet: it will see ours
+		if ((State & State_Mask) != State_Published)
+		{
+			continue;
+		}
+
+		const FVoxelIntBox ReaderBounds = Slot.Bounds;
+		if (Slot.State.load() != State || !ReaderBounds.Intersect(Bounds))
+		{
+			continue;
+		}
+
+		VOXEL_ASYNC_SCOPE_COUNTER("Wait For Optimistic Readers");
+		while (Slot.State.load() == State)
+		{
+			FPlatformProcess::Sleep(0.0f);
+		}
+	}
+}
+
+void FVoxelDataOptimisticReads::Block()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	NumBlockers++;
+	WaitForReaders(FVoxelIntBox::Infinite);
+}
+
+void FVoxelDataOptimisticReads::Unblock()
+{
+	ensure(NumBlockers-- > 0);
+}
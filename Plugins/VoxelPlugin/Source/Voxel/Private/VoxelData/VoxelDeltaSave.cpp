@@ -0,0 +1,325 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelData/VoxelDeltaSave.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelSave.h"
+#include "VoxelData/VoxelSaveUtilities.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<int32> CVarDeltaSaveMaxDeltas(
+	TEXT("voxel.data.DeltaSaveMaxDeltas"),
+	256,
+	TEXT("Delta saves: number of deltas in the journal after which they are compacted into a new base save"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDeltaSaveMaxJournalSizePercent(
+	TEXT("voxel.data.DeltaSaveMaxJournalSizePercent"),
+	100,
+	TEXT("Delta saves: the deltas are compacted into a new base save once the journal is bigger than this percentage of the base save"),
+	ECVF_Default);
+
+// "VXDS"
+static constexpr uint32 GVoxelDeltaSaveMagic = 0x56584453;
+
+// The base save and the journal are sequences of records: the base save has a single one, with an epoch of 0
+namespace FVoxelDeltaSaveRecord
+{
+	struct FHeader
+	{
+		uint32 Magic = GVoxelDeltaSaveMagic;
+		int32 Version = FVoxelDeltaSaveVersion::LatestVersion;
+		FGuid BaseGuid;
+		uint32 Epoch = 0;
+		int32 PayloadSize = 0;
+		uint32 PayloadCrc = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header)
+		{
+			Ar << Header.Magic;
+			Ar << Header.Version;
+			Ar << Header.BaseGuid;
+			Ar << Header.Epoch;
+			Ar << Header.PayloadSize;
+			Ar << Header.PayloadCrc;
+			return Ar;
+		}
+	};
+
+	void Write(
+		const FGuid& BaseGuid,
+		uint32 Epoch,
+		const FVoxelUncompressedWorldSaveImpl& Save,
+		const TArray<FVoxelObjectArchiveEntry>& Objects,
+		TArray<uint8>& OutRecord)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		TArray<uint8> Payload;
+		{
+			FVoxelCompressedWorldSaveImpl CompressedSave;
+			UVoxelSaveUtilities::CompressVoxelSave(Save, CompressedSave);
+
+			FMemoryWriter Writer(Payload);
+			TArray<FVoxelObjectArchiveEntry> ObjectsCopy = Objects;
+			Writer << ObjectsCopy;
+			CompressedSave.Serialize(Writer);
+		}
+
+		FHeader Header;
+		Header.BaseGuid = BaseGuid;
+		Header.Epoch = Epoch;
+		Header.PayloadSize = Payload.Num();
+		Header.PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+
+		OutRecord.Reset();
+		FMemoryWriter Writer(OutRecord);
+		Writer << Header;
+		Writer.Serialize(Payload.GetData(), Payload.Num());
+	}
+
+	// Returns false if the record is truncated or corrupted
+	bool Read(FArchive& Ar, FHeader& OutHeader, TArray<uint8>& OutPayload)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		Ar << OutHeader;
+		if (Ar.IsError() ||
+			OutHeader.Magic != GVoxelDeltaSaveMagic ||
+			OutHeader.Version > FVoxelDeltaSaveVersion::LatestVersion ||
+			OutHeader.PayloadSize < 0 ||
+			OutHeader.PayloadSize > Ar.TotalSize() - Ar.Tell())
+		{
+			return false;
+		}
+
+		OutPayload.SetNumUninitialized(OutHeader.PayloadSize);
+		Ar.Serialize(OutPayload.GetData(), OutPayload.Num());
+
+		return !Ar.IsError() && FCrc::MemCrc32(OutPayload.GetData(), OutPayload.Num()) == OutHeader.PayloadCrc;
+	}
+
+	bool Decompress(const TArray<uint8>& Payload, FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		FMemoryReader Reader(Payload);
+		Reader << OutObjects;
+
+		FVoxelCompressedWorldSaveImpl CompressedSave;
+		CompressedSave.Serialize(Reader);
+
+		return !Reader.IsError() && UVoxelSaveUtilities::DecompressVoxelSave(CompressedSave, OutSave);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelDeltaSaveWriter::FVoxelDeltaSaveWriter(const TVoxelSharedRef<FVoxelData>& Data, const FString& BasePath)
+	: Data(Data)
+	, BasePath(BasePath)
+	, JournalPath(GetJournalPath(BasePath))
+{
+}
+
+bool FVoxelDeltaSaveWriter::Save()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const TVoxelSharedPtr<FVoxelData> DataPtr = Data.Pin();
+	if (!ensure(DataPtr))
+	{
+		return false;
+	}
+
+	const int32 MaxDeltas = FMath::Max(0, CVarDeltaSaveMaxDeltas.GetValueOnAnyThread());
+	const int32 MaxJournalSizePercent = FMath::Max(0, CVarDeltaSaveMaxJournalSizePercent.GetValueOnAnyThread());
+	if (!BaseGuid.IsValid() ||
+		NumDeltas >= MaxDeltas ||
+		JournalSize * 100 > BaseSize * MaxJournalSizePercent)
+	{
+		return Compact();
+	}
+
+	FVoxelUncompressedWorldSaveImpl DeltaSave;
+	TArray<FVoxelObjectArchiveEntry> Objects;
+	FGuid DeltaBaseGuid;
+	uint32 Epoch = 0;
+	if (!DataPtr->GetDeltaSave(DeltaSave, Objects, DeltaBaseGuid, Epoch) ||
+		DeltaBaseGuid != BaseGuid ||
+		Epoch != uint32(NumDeltas + 1))
+	{
+		// The data was cleared or loaded, or deltas were taken by someone else: the journal can't be continued
+		return Compact();
+	}
+
+	TArray<uint8> Record;
+	FVoxelDeltaSaveRecord::Write(BaseGuid, Epoch, DeltaSave, Objects, Record);
+
+	const TUniquePtr<FArchive> Writer = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*JournalPath, FILEWRITE_Append));
+	if (!Writer)
+	{
+		LOG_VOXEL(Error, TEXT("Failed to open delta save journal %s"), *JournalPath);
+		// This delta is lost: the next save needs to be a base save
+		BaseGuid.Invalidate();
+		return false;
+	}
+
+	Writer->Serialize(Record.GetData(), Record.Num());
+	if (!Writer->Close())
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write delta save journal %s"), *JournalPath);
+		BaseGuid.Invalidate();
+		return false;
+	}
+
+	NumDeltas++;
+	JournalSize += Record.Num();
+
+	return true;
+}
+
+bool FVoxelDeltaSaveWriter::Compact()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const TVoxelSharedPtr<FVoxelData> DataPtr = Data.Pin();
+	if (!ensure(DataPtr))
+	{
+		return false;
+	}
+
+	BaseGuid.Invalidate();
+
+	FVoxelUncompressedWorldSaveImpl BaseSave;
+	TArray<FVoxelObjectArchiveEntry> Objects;
+	DataPtr->GetBaseSave(BaseSave, Objects);
+
+	TArray<uint8> Record;
+	FVoxelDeltaSaveRecord::Write(BaseSave.GetGuid(), 0, BaseSave, Objects, Record);
+
+	// If we crash after the move the journal is of the previous base save, and its deltas are skipped by Load
+	const FString TempPath = BasePath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Record, *TempPath) ||
+		!IFileManager::Get().Move(*BasePath, *TempPath, true))
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write base save %s"), *BasePath);
+		return false;
+	}
+	if (IFileManager::Get().FileExists(*JournalPath) && !IFileManager::Get().Delete(*JournalPath))
+	{
+		LOG_VOXEL(Warning, TEXT("Failed to delete delta save journal %s"), *JournalPath);
+	}
+
+	LOG_VOXEL(Log, TEXT("Compacted %d delta saves (%lldKB) into base save %s (%lldKB)"),
+		NumDeltas,
+		JournalSize / 1024,
+		*BasePath,
+		int64(Record.Num()) / 1024);
+
+	BaseGuid = BaseSave.GetGuid();
+	NumDeltas = 0;
+	BaseSize = Record.Num();
+	JournalSize = 0;
+
+	return true;
+}
+
+bool FVoxelDeltaSaveWriter::Load(const FString& BasePath, FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	TArray<TUniquePtr<FVoxelUncompressedWorldSaveImpl>> Saves;
+
+	FGuid BaseGuid;
+	{
+		TArray<uint8> BaseRecord;
+		if (!FFileHelper::LoadFileToArray(BaseRecord, *BasePath))
+		{
+			LOG_VOXEL(Error, TEXT("Failed to read base save %s"), *BasePath);
+			return false;
+		}
+
+		FMemoryReader Reader(BaseRecord);
+		FVoxelDeltaSaveRecord::FHeader Header;
+		TArray<uint8> Payload;
+
+		auto& BaseSave = Saves.Add_GetRef(MakeUnique<FVoxelUncompressedWorldSaveImpl>());
+		if (!FVoxelDeltaSaveRecord::Read(Reader, Header, Payload) ||
+			!ensure(Header.Epoch == 0) ||
+			!FVoxelDeltaSaveRecord::Decompress(Payload, *BaseSave, OutObjects))
+		{
+			LOG_VOXEL(Error, TEXT("Base save %s is corrupted"), *BasePath);
+			return false;
+		}
+		BaseGuid = Header.BaseGuid;
+	}
+
+	const FString JournalPath = GetJournalPath(BasePath);
+	if (const TUniquePtr<FArchive> Reader = TUniquePtr<FArchive>(IFileManager::Get().CreateFileReader(*JournalPath)))
+	{
+		int32 NumSkippedDeltas = 0;
+		uint32 NextEpoch = 1;
+		while (Reader->Tell() < Reader->TotalSize())
+		{
+			const int64 Offset = Reader->Tell();
+
+			FVoxelDeltaSaveRecord::FHeader Header;
+			TArray<uint8> Payload;
+			if (!FVoxelDeltaSaveRecord::Read(*Reader, Header, Payload))
+			{
+				// Most likely a crash while appending
+				LOG_VOXEL(Warning, TEXT("Delta save journal %s is truncated or corrupted at offset %lld: ignoring the rest of it"), *JournalPath, Offset);
+				break;
+			}
+
+			if (Header.BaseGuid != BaseGuid)
+			{
+				// Delta of a previous base save, that was not deleted after compacting
+				NumSkippedDeltas++;
+				continue;
+			}
+			if (Header.Epoch != NextEpoch)
+			{
+				LOG_VOXEL(Warning, TEXT("Delta save journal %s: delta %u is missing, ignoring the ones after it"), *JournalPath, NextEpoch);
+				break;
+			}
+
+			auto Save = MakeUnique<FVoxelUncompressedWorldSaveImpl>();
+			TArray<FVoxelObjectArchiveEntry> Objects;
+			if (!FVoxelDeltaSaveRecord::Decompress(Payload, *Save, Objects))
+			{
+				LOG_VOXEL(Warning, TEXT("Delta save journal %s: delta %u is corrupted, ignoring the ones after it"), *JournalPath, NextEpoch);
+				break;
+			}
+
+			// Placeable items are the ones of the last delta
+			OutObjects = MoveTemp(Objects);
+			Saves.Add(MoveTemp(Save));
+			NextEpoch++;
+		}
+
+		if (NumSkippedDeltas > 0)
+		{
+			LOG_VOXEL(Log, TEXT("Delta save journal %s: skipped %d deltas of another base save"), *JournalPath, NumSkippedDeltas);
+		}
+	}
+
+	TArray<const FVoxelUncompressedWorldSaveImpl*> SavesToMerge;
+	for (const auto& Save : Saves)
+	{
+		SavesToMerge.Add(Save.Get());
+	}
+	FVoxelSaveBuilder::MergeSaves(SavesToMerge, OutSave);
+
+	LOG_VOXEL(Log, TEXT("Loaded base save %s with %d delta saves"), *BasePath, Saves.Num() - 1);
+
+	return true;
+}
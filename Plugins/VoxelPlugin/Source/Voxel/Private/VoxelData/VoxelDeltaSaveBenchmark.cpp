@@ -0,0 +1,94 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelData/VoxelBenchmarkUtilities.h"
+#include "VoxelData/VoxelDeltaSave.h"
+#include "VoxelData/VoxelSave.h"
+#include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+// Autosave cost of a large edited world when a single crater is dug between each save: full save vs delta save
+namespace FVoxelDeltaSaveBenchmark
+{
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 Depth = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 6, 1, 12);
+		const int32 NumSaves = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20);
+
+		const FString BasePath = FPaths::ProjectSavedDir() / TEXT("Voxel") / TEXT("DeltaSaveBenchmark.voxelsave");
+
+		const TVoxelSharedRef<FVoxelData> Data = FVoxelBenchmarkUtilities::CreateData(Depth);
+
+		// Sculpted ground spanning the entire world
+		FVoxelBenchmarkUtilities::EditSurface(*Data, DATA_CHUNK_SIZE);
+
+		FVoxelDeltaSaveWriter Writer(Data, BasePath);
+
+		double FullSaveTime;
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Writer.Compact();
+			FullSaveTime = FPlatformTime::Seconds() - StartTime;
+		}
+		const int64 BaseSize = IFileManager::Get().FileSize(*BasePath);
+
+		FRandomStream Stream(0);
+		double DeltaSaveTime = 0;
+		for (int32 Index = 0; Index < NumSaves; Index++)
+		{
+			const FIntVector Center(
+				Stream.RandRange(Data->WorldBounds.Min.X, Data->WorldBounds.Max.X - 1),
+				Stream.RandRange(Data->WorldBounds.Min.Y, Data->WorldBounds.Max.Y - 1),
+				0);
+			FVoxelBenchmarkUtilities::DigSphere(*Data, Center, 8);
+
+			const double StartTime = FPlatformTime::Seconds();
+			Writer.Save();
+			DeltaSaveTime += FPlatformTime::Seconds() - StartTime;
+		}
+
+		// Restore base + deltas and compare with the world
+		double LoadTime;
+		int32 NumMismatches = 0;
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			FVoxelUncompressedWorldSaveImpl Save;
+			TArray<FVoxelObjectArchiveEntry> Objects;
+			FVoxelDeltaSaveWriter::Load(BasePath, Save, Objects);
+
+			const TVoxelSharedRef<FVoxelData> LoadedData = FVoxelBenchmarkUtilities::CreateData(Depth);
+			LoadedData->LoadFromSave(Save, {});
+
+			LoadTime = FPlatformTime::Seconds() - StartTime;
+
+			FVoxelReadScopeLock Lock(*Data, FVoxelIntBox::Infinite, "Delta Save Benchmark");
+			FVoxelReadScopeLock LoadedLock(*LoadedData, FVoxelIntBox::Infinite, "Delta Save Benchmark");
+			for (int32 Index = 0; Index < 100000; Index++)
+			{
+				const FIntVector Position(
+					Stream.RandRange(Data->WorldBounds.Min.X, Data->WorldBounds.Max.X - 1),
+					Stream.RandRange(Data->WorldBounds.Min.Y, Data->WorldBounds.Max.Y - 1),
+					Stream.RandRange(-DATA_CHUNK_SIZE, DATA_CHUNK_SIZE - 1));
+
+				NumMismatches += Data->GetValue(Position, 0) != LoadedData->GetValue(Position, 0);
+			}
+		}
+
+		LOG_VOXEL(Log, TEXT("Full save: %.1fms, %lldKB"), FullSaveTime * 1000, BaseSize / 1024);
+		LOG_VOXEL(Log, TEXT("Delta save after digging one crater: %.2fms on average, %lldB on average"),
+			DeltaSaveTime * 1000 / NumSaves,
+			Writer.GetJournalSize() / FMath::Max(1, Writer.GetNumDeltas()));
+		LOG_VOXEL(Log, TEXT("Loading base + %d deltas: %.1fms. %d mismatches with the saved world"), Writer.GetNumDeltas(), LoadTime * 1000, NumMismatches);
+
+		IFileManager::Get().Delete(*BasePath);
+		IFileManager::Get().Delete(*FVoxelDeltaSaveWriter::GetJournalPath(BasePath));
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkDeltaSave(
+	TEXT("voxel.data.BenchmarkDeltaSave"),
+	TEXT("Compares the cost of a full save and of a delta save after a small edit. Args: [Depth = 6] [NumSaves = 20]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelDeltaSaveBenchmark::Benchmark));
@@ -0,0 +1,502 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelData/VoxelRegionSave.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/LargeMemoryWriter.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelRegionSavesMemory);
+
+// "VXRS"
+static constexpr uint32 GVoxelRegionSaveMagic = 0x56585253;
+
+// Number of regions decompressed at once by LoadAllRegions
+static constexpr int32 GVoxelRegionSaveLoadAllBatchSize = 64;
+
+// Set while this thread loads regions in a data, as that takes write locks on them
+static thread_local bool GVoxelIsLoadingRegions = false;
+
+FVoxelRegionWorldSave::~FVoxelRegionWorldSave()
+{
+	// Region must be released before its handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelRegionSavesMemory, AllocatedSize);
+}
+
+bool FVoxelRegionWorldSave::Write(
+	const FVoxelUncompressedWorldSaveImpl& Save,
+	const TArray<FVoxelObjectArchiveEntry>& InObjects,
+	int32 InRegionDepth,
+	const FString& Path)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (!ensure(Save.GetDepth() >= 0) ||
+		!ensure(0 <= InRegionDepth && InRegionDepth <= Save.GetDepth()))
+	{
+		return false;
+	}
+
+	FVoxelRegionWorldSave RegionSave;
+	RegionSave.Guid = Save.Guid;
+	RegionSave.Depth = Save.Depth;
+	RegionSave.RegionDepth = InRegionDepth;
+	RegionSave.UserFlags = Save.UserFlags;
+	RegionSave.ItemsVersion = Save.Version;
+	RegionSave.PlaceableItems = Save.PlaceableItems;
+	RegionSave.Objects = InObjects;
+
+	const int32 RegionSize = RegionSave.GetRegionSize();
+
+	// The chunks keep their order in each region, which is the one of the data octree
+	TMap<FIntVector, TArray<int32>> RegionsChunks;
+	for (int32 ChunkIndex = 0; ChunkIndex < Save.Chunks.Num(); ChunkIndex++)
+	{
+		const FIntVector Key = FVoxelUtilities::DivideFloor(Save.Chunks[ChunkIndex].Position, RegionSize);
+		RegionsChunks.FindOrAdd(Key).Add(ChunkIndex);
+	}
+
+	TArray<FIntVector> Keys;
+	RegionsChunks.GenerateKeyArray(Keys);
+	Keys.Sort([](const FIntVector& A, const FIntVector& B)
+	{
+		if (A.Z != B.Z) return A.Z < B.Z;
+		if (A.Y != B.Y) return A.Y < B.Y;
+		return A.X < B.X;
+	});
+
+	RegionSave.Regions.SetNum(Keys.Num());
+
+	TArray<TArray<uint8>> Blocks;
+	Blocks.SetNum(Keys.Num());
+
+	FThreadSafeBool bError = false;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Compress regions");
+		ParallelFor(Keys.Num(), [&](int32 RegionIndex)
+		{
+			TArray<FVoxelSaveChunkRef> Chunks;
+			for (const int32 ChunkIndex : RegionsChunks[Keys[RegionIndex]])
+			{
+				Chunks.Add({ &Save, ChunkIndex });
+			}
+
+			FVoxelUncompressedWorldSaveImpl ChunksSave;
+			FVoxelSaveBuilder::CopyChunks(Save, Chunks, ChunksSave);
+
+			FLargeMemoryWriter Writer(ChunksSave.GetAllocatedSize());
+			ChunksSave.Serialize(Writer);
+
+			const int64 UncompressedSize = Writer.Tell();
+			if (!ensureMsgf(UncompressedSize < MAX_int32, TEXT("Region too big: %lld bytes. Use a smaller region depth"), UncompressedSize))
+			{
+				bError = true;
+				return;
+			}
+
+			TArray<uint8>& Block = Blocks[RegionIndex];
+
+			int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+			Block.SetNumUninitialized(CompressedSize);
+			if (!ensure(FCompression::CompressMemory(NAME_Zlib, Block.GetData(), CompressedSize, Writer.GetData(), UncompressedSize)))
+			{
+				bError = true;
+				return;
+			}
+			Block.SetNum(CompressedSize);
+
+			FVoxelRegionSaveEntry& Region = RegionSave.Regions[RegionIndex];
+			Region.Position = Keys[RegionIndex] * RegionSize;
+			Region.NumChunks = Chunks.Num();
+			Region.CompressedSize = CompressedSize;
+			Region.UncompressedSize = UncompressedSize;
+		});
+	}
+
+	if (bError)
+	{
+		return false;
+	}
+
+	int64 Offset = 0;
+	for (int32 RegionIndex = 0; RegionIndex < Keys.Num(); RegionIndex++)
+	{
+		RegionSave.Regions[RegionIndex].Offset = Offset;
+		Offset += Blocks[RegionIndex].Num();
+	}
+
+	const TUniquePtr<FArchive> Writer = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		LOG_VOXEL(Error, TEXT("Failed to create region save %s"), *Path);
+		return false;
+	}
+
+	RegionSave.SerializeDirectory(*Writer);
+	const int64 DirectorySize = Writer->Tell();
+
+	for (TArray<uint8>& Block : Blocks)
+	{
+		Writer->Serialize(Block.GetData(), Block.Num());
+	}
+
+	if (!Writer->Close())
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write region save %s"), *Path);
+		return false;
+	}
+
+	LOG_VOXEL(Log, TEXT("Wrote region save %s: %d chunks in %d regions of %d voxels. Directory: %lldB, regions: %.2fMB"),
+		*Path,
+		Save.Chunks.Num(),
+		RegionSave.Regions.Num(),
+		RegionSize,
+		DirectorySize,
+		Offset / double(1 << 20));
+
+	return true;
+}
+
+TVoxelSharedPtr<const FVoxelRegionWorldSave> FVoxelRegionWorldSave::Open(const FString& Path)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		LOG_VOXEL(Error, TEXT("Region save %s does not exist"), *Path);
+		return nullptr;
+	}
+
+	const TVoxelSharedRef<FVoxelRegionWorldSave> Save = MakeVoxelShared<FVoxelRegionWorldSave>();
+
+	const uint8* FileData = nullptr;
+	int64 FileSize = 0;
+
+	Save->MappedHandle = TUniquePtr<IMappedFileHandle>(PlatformFile.OpenMapped(*Path));
+	if (Save->MappedHandle.IsValid())
+	{
+		FileSize = Save->MappedHandle->GetFileSize();
+		Save->MappedRegion = TUniquePtr<IMappedFileRegion>(Save->MappedHandle->MapRegion(0, FileSize));
+	}
+
+	if (Save->MappedRegion.IsValid())
+	{
+		FileData = Save->MappedRegion->GetMappedPtr();
+	}
+	else
+	{
+		// Platform without memory mapping support: read it instead
+		Save->MappedHandle.Reset();
+		if (!FFileHelper::LoadFileToArray(Save->OwnedData, *Path))
+		{
+			LOG_VOXEL(Error, TEXT("Failed to read region save %s"), *Path);
+			return nullptr;
+		}
+		FileData = Save->OwnedData.GetData();
+		FileSize = Save->OwnedData.Num();
+	}
+
+	// Only the directory is read here: the pages of the regions are only touched when they are loaded
+	FLargeMemoryReader Reader(FileData, FileSize);
+	if (!Save->SerializeDirectory(Reader) || Reader.IsError())
+	{
+		LOG_VOXEL(Error, TEXT("Invalid region save %s"), *Path);
+		return nullptr;
+	}
+
+	Save->BlocksData = FileData + Reader.Tell();
+	Save->BlocksSize = FileSize - Reader.Tell();
+
+	for (const FVoxelRegionSaveEntry& Region : Save->Regions)
+	{
+		if (Region.Offset < 0 ||
+			Region.CompressedSize < 0 ||
+			Region.UncompressedSize < 0 ||
+			Region.Offset + Region.CompressedSize > Save->BlocksSize)
+		{
+			LOG_VOXEL(Error, TEXT("Invalid region save %s: region %s is outside of the file"), *Path, *Region.Position.ToString());
+			return nullptr;
+		}
+	}
+
+	Save->AllocatedSize =
+		Save->OwnedData.GetAllocatedSize() +
+		Save->Regions.GetAllocatedSize() +
+		Save->PlaceableItems.GetAllocatedSize();
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelRegionSavesMemory, Save->AllocatedSize);
+
+	LOG_VOXEL(Log, TEXT("Opened region save %s: %d regions of %d voxels%s"),
+		*Path,
+		Save->Regions.Num(),
+		Save->GetRegionSize(),
+		Save->IsMemoryMapped() ? TEXT(", memory-mapped") : TEXT(""));
+
+	return Save;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelRegionWorldSave::ReadRegion(int32 RegionIndex, FVoxelUncompressedWorldSaveImpl& OutSave) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const FVoxelRegionSaveEntry& Region = Regions[RegionIndex];
+
+	TArray64<uint8> UncompressedData;
+	UncompressedData.SetNumUninitialized(Region.UncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, UncompressedData.GetData(), Region.UncompressedSize, BlocksData + Region.Offset, Region.CompressedSize))
+	{
+		LOG_VOXEL(Error, TEXT("Region save: failed to decompress region %s: corrupted data"), *Region.Position.ToString());
+		return false;
+	}
+
+	FLargeMemoryReader Reader(UncompressedData.GetData(), UncompressedData.Num());
+	OutSave.Serialize(Reader);
+
+	return
+		ensure(Reader.AtEnd() && !Reader.IsError()) &&
+		ensure(OutSave.Chunks.Num() == Region.NumChunks);
+}
+
+void FVoxelRegionWorldSave::GetItemsSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	OutSave.Version = ItemsVersion;
+	OutSave.Guid = Guid;
+	OutSave.Depth = Depth;
+	OutSave.UserFlags = UserFlags;
+	OutSave.PlaceableItems = PlaceableItems;
+	OutSave.UpdateAllocatedSize();
+
+	OutObjects = Objects;
+}
+
+bool FVoxelRegionWorldSave::SerializeDirectory(FArchive& Ar)
+{
+	uint32 Magic = GVoxelRegionSaveMagic;
+	Ar << Magic;
+	if (Magic != GVoxelRegionSaveMagic)
+	{
+		return false;
+	}
+
+	if (Ar.IsSaving())
+	{
+		Version = FVoxelRegionSaveVersion::LatestVersion;
+	}
+	Ar << Version;
+	if (Version > FVoxelRegionSaveVersion::LatestVersion)
+	{
+		LOG_VOXEL(Error, TEXT("Region save was saved with a newer version of the plugin"));
+		return false;
+	}
+
+	Ar << Guid;
+	Ar << Depth;
+	Ar << RegionDepth;
+	Ar << UserFlags;
+
+	Ar << Regions;
+
+	Ar << ItemsVersion;
+	Ar << PlaceableItems;
+
+	Ar << Objects;
+
+	return !Ar.IsError() && Depth >= 0 && 0 <= RegionDepth && RegionDepth <= Depth;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelRegionSaveLoader::FVoxelRegionSaveLoader(const TVoxelSharedRef<const FVoxelRegionWorldSave>& Save)
+	: Save(Save)
+{
+	LoadedRegions.Init(false, Save->NumRegions());
+	NumRegionsLeft = Save->NumRegions();
+}
+
+int32 FVoxelRegionSaveLoader::GetNumRegionsLeft() const
+{
+	FScopeLock Lock(&Section);
+	return NumRegionsLeft;
+}
+
+void FVoxelRegionSaveLoader::GetRegionsToLoad(const TArray<FVoxelIntBox>& Bounds, const TArray<FIntVector>& Positions, TArray<int32>& OutRegions) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	TArray<TPair<uint64, int32>> DistancesAndRegions;
+	{
+		FScopeLock Lock(&Section);
+
+		if (NumRegionsLeft == 0)
+		{
+			return;
+		}
+
+		for (int32 RegionIndex = 0; RegionIndex < Save->NumRegions(); RegionIndex++)
+		{
+			if (LoadedRegions[RegionIndex])
+			{
+				continue;
+			}
+
+			const FVoxelIntBox RegionBounds = Save->GetRegionBounds(RegionIndex);
+			if (!Bounds.ContainsByPredicate([&](const FVoxelIntBox& It) { return It.Intersect(RegionBounds); }))
+			{
+				continue;
+			}
+
+			uint64 Distance = MAX_uint64;
+			for (const FIntVector& Position : Positions)
+			{
+				Distance = FMath::Min(Distance, RegionBounds.ComputeSquaredDistanceFromBoxToPoint(Position));
+			}
+			DistancesAndRegions.Emplace(Distance, RegionIndex);
+		}
+	}
+
+	DistancesAndRegions.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B) { return A.Key < B.Key; });
+
+	OutRegions.Reserve(OutRegions.Num() + DistancesAndRegions.Num());
+	for (const auto& It : DistancesAndRegions)
+	{
+		OutRegions.Add(It.Value);
+	}
+}
+
+bool FVoxelRegionSaveLoader::LoadRegions(FVoxelData& Data, const TArray<int32>& RegionIndices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	FScopeLock LoadLock(&LoadSection);
+
+	TArray<int32> RegionsToLoad;
+	{
+		FScopeLock Lock(&Section);
+		for (const int32 RegionIndex : RegionIndices)
+		{
+			if (ensure(LoadedRegions.IsValidIndex(RegionIndex)) && !LoadedRegions[RegionIndex])
+			{
+				RegionsToLoad.AddUnique(RegionIndex);
+			}
+		}
+	}
+
+	if (RegionsToLoad.Num() == 0)
+	{
+		return true;
+	}
+
+	TArray<TUniquePtr<FVoxelUncompressedWorldSaveImpl>> RegionSaves;
+	RegionSaves.SetNum(RegionsToLoad.Num());
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Decompress regions");
+		ParallelFor(RegionsToLoad.Num(), [&](int32 Index)
+		{
+			auto RegionSave = MakeUnique<FVoxelUncompressedWorldSaveImpl>();
+			if (Save->ReadRegion(RegionsToLoad[Index], *RegionSave))
+			{
+				RegionSaves[Index] = MoveTemp(RegionSave);
+			}
+		});
+	}
+
+	bool bSuccess = true;
+	TArray<FVoxelIntBox> LoadedBounds;
+	TGuardValue<bool> IsLoadingRegions(GVoxelIsLoadingRegions, true);
+	for (int32 Index = 0; Index < RegionsToLoad.Num(); Index++)
+	{
+		// Corrupted regions are still marked as loaded, to not try again every frame
+		if (RegionSaves[Index].IsValid())
+		{
+			Data.LoadRegionFromSave(*RegionSaves[Index], Save->GetRegionBounds(RegionsToLoad[Index]), LoadedBounds);
+			RegionSaves[Index].Reset();
+		}
+		else
+		{
+			bSuccess = false;
+		}
+	}
+
+	{
+		FScopeLock Lock(&Section);
+		for (const int32 RegionIndex : RegionsToLoad)
+		{
+			LoadedRegions[RegionIndex] = true;
+			NumRegionsLeft--;
+		}
+		BoundsToUpdate.Append(LoadedBounds);
+	}
+
+	return bSuccess;
+}
+
+void FVoxelRegionSaveLoader::LoadRegionsBeforeWrite(FVoxelData& Data, const FVoxelIntBox& Bounds)
+{
+	if (GVoxelIsLoadingRegions)
+	{
+		return;
+	}
+
+	TArray<int32> RegionsToLoad;
+	GetRegionsToLoad({ Bounds }, {}, RegionsToLoad);
+
+	if (RegionsToLoad.Num() > 0)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+		// Also waits for the regions another thread is loading, as LoadRegions holds LoadSection until they are marked as loaded
+		LoadRegions(Data, RegionsToLoad);
+	}
+}
+
+bool FVoxelRegionSaveLoader::LoadAllRegions(FVoxelData& Data)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	TArray<int32> RegionsToLoad;
+	{
+		FScopeLock Lock(&Section);
+		for (int32 RegionIndex = 0; RegionIndex < Save->NumRegions(); RegionIndex++)
+		{
+			if (!LoadedRegions[RegionIndex])
+			{
+				RegionsToLoad.Add(RegionIndex);
+			}
+		}
+	}
+
+	// In batches, to not have all the regions decompressed at once
+	bool bSuccess = true;
+	for (int32 BatchStart = 0; BatchStart < RegionsToLoad.Num(); BatchStart += GVoxelRegionSaveLoadAllBatchSize)
+	{
+		const int32 BatchNum = FMath::Min(GVoxelRegionSaveLoadAllBatchSize, RegionsToLoad.Num() - BatchStart);
+		bSuccess &= LoadRegions(Data, TArray<int32>(RegionsToLoad.GetData() + BatchStart, BatchNum));
+	}
+	return bSuccess;
+}
+
+void FVoxelRegionSaveLoader::PopBoundsToUpdate(TArray<FVoxelIntBox>& OutBounds)
+{
+	FScopeLock Lock(&Section);
+	OutBounds.Append(BoundsToUpdate);
+	BoundsToUpdate.Reset();
+}
@@ -0,0 +1,166 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelData/VoxelBenchmarkUtilities.h"
+#include "VoxelData/VoxelRegionSave.h"
+#include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Time to load the data needed by the first frame of a large edited world, from a monolithic compressed save and from a region save:
+// the first frame only needs the regions around the invoker, while the monolithic save needs to be entirely decompressed and loaded.
+// Only the data load is timed: meshing and rendering the first frame is the same for both saves, and isn't included
+namespace FVoxelRegionSaveBenchmark
+{
+	int32 CountMismatches(const FVoxelData& A, const FVoxelData& B, int32 NumSamples)
+	{
+		FVoxelReadScopeLock LockA(A, FVoxelIntBox::Infinite, "Region Save Benchmark");
+		FVoxelReadScopeLock LockB(B, FVoxelIntBox::Infinite, "Region Save Benchmark");
+
+		FRandomStream Stream(0);
+		const FVoxelIntBox& Bounds = A.WorldBounds;
+
+		int32 NumMismatches = 0;
+		for (int32 Index = 0; Index < NumSamples; Index++)
+		{
+			const FIntVector Position(
+				Stream.RandRange(Bounds.Min.X, Bounds.Max.X - 1),
+				Stream.RandRange(Bounds.Min.Y, Bounds.Max.Y - 1),
+				Stream.RandRange(-2 * DATA_CHUNK_SIZE, 2 * DATA_CHUNK_SIZE - 1));
+
+			NumMismatches += A.GetValue(Position, 0) != B.GetValue(Position, 0);
+		}
+		return NumMismatches;
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 Depth = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 6, 1, 12);
+		const int32 RegionDepth = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 3, 0, Depth);
+		const int32 LoadDistance = FMath::Max(0, Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 256);
+
+		const FString MonolithicPath = FPaths::ProjectSavedDir() / TEXT("Voxel") / TEXT("RegionSaveBenchmark.voxelsave");
+		const FString RegionPath = FPaths::ProjectSavedDir() / TEXT("Voxel") / TEXT("RegionSaveBenchmark.voxelregions");
+
+		LOG_VOXEL(Log, TEXT("Benchmarking region saves: world of %d voxels, regions of %d voxels, invoker load distance %d"),
+			DATA_CHUNK_SIZE << Depth,
+			DATA_CHUNK_SIZE << RegionDepth,
+			LoadDistance);
+
+		// Build the save
+		const TVoxelSharedRef<FVoxelData> SourceData = FVoxelBenchmarkUtilities::CreateData(Depth);
+		FVoxelBenchmarkUtilities::EditSurface(*SourceData);
+
+		FVoxelUncompressedWorldSaveImpl Save;
+		TArray<FVoxelObjectArchiveEntry> Objects;
+		SourceData->GetSave(Save, Objects);
+
+		{
+			FVoxelCompressedWorldSaveImpl CompressedSave;
+			UVoxelSaveUtilities::CompressVoxelSave(Save, CompressedSave);
+
+			TArray<uint8> Bytes;
+			FMemoryWriter Writer(Bytes);
+			CompressedSave.Serialize(Writer);
+			if (!ensure(FFileHelper::SaveArrayToFile(Bytes, *MonolithicPath)))
+			{
+				return;
+			}
+		}
+		if (!ensure(FVoxelRegionWorldSave::Write(Save, Objects, RegionDepth, RegionPath)))
+		{
+			return;
+		}
+
+		const FVoxelPlaceableItemLoadInfo LoadInfo{};
+		const FIntVector InvokerPosition = FIntVector::ZeroValue;
+
+		// Monolithic: everything needs to be read, decompressed and loaded
+		double MonolithicTime;
+		TVoxelSharedPtr<FVoxelData> MonolithicData;
+		{
+			MonolithicData = FVoxelBenchmarkUtilities::CreateData(Depth);
+
+			const double StartTime = FPlatformTime::Seconds();
+			{
+				TArray<uint8> Bytes;
+				FFileHelper::LoadFileToArray(Bytes, *MonolithicPath);
+
+				FVoxelCompressedWorldSaveImpl CompressedSave;
+				FMemoryReader Reader(Bytes);
+				CompressedSave.Serialize(Reader);
+
+				FVoxelUncompressedWorldSaveImpl UncompressedSave;
+				UVoxelSaveUtilities::DecompressVoxelSave(CompressedSave, UncompressedSave);
+				MonolithicData->LoadFromSave(UncompressedSave, LoadInfo);
+			}
+			MonolithicTime = FPlatformTime::Seconds() - StartTime;
+		}
+
+		// Region: only the directory and the regions around the invoker
+		double RegionFirstFrameTime;
+		double RegionAllTime;
+		int32 NumRegions = 0;
+		int32 NumFirstFrameRegions = 0;
+		TVoxelSharedPtr<FVoxelData> RegionData;
+		{
+			RegionData = FVoxelBenchmarkUtilities::CreateData(Depth);
+
+			const double StartTime = FPlatformTime::Seconds();
+			TVoxelSharedPtr<FVoxelRegionSaveLoader> Loader;
+			{
+				const TVoxelSharedPtr<const FVoxelRegionWorldSave> RegionSave = FVoxelRegionWorldSave::Open(RegionPath);
+				if (!ensure(RegionSave))
+				{
+					return;
+				}
+				NumRegions = RegionSave->NumRegions();
+
+				FVoxelUncompressedWorldSaveImpl ItemsSave;
+				TArray<FVoxelObjectArchiveEntry> ItemsObjects;
+				RegionSave->GetItemsSave(ItemsSave, ItemsObjects);
+				RegionData->LoadFromSave(ItemsSave, LoadInfo);
+
+				Loader = MakeVoxelShared<FVoxelRegionSaveLoader>(RegionSave.ToSharedRef());
+				RegionData->SetRegionSaveLoader(Loader);
+
+				TArray<int32> RegionsToLoad;
+				Loader->GetRegionsToLoad({ FVoxelIntBox(InvokerPosition).Extend(LoadDistance) }, { InvokerPosition }, RegionsToLoad);
+				NumFirstFrameRegions = RegionsToLoad.Num();
+
+				Loader->LoadRegions(*RegionData, RegionsToLoad);
+			}
+			RegionFirstFrameTime = FPlatformTime::Seconds() - StartTime;
+
+			Loader->LoadAllRegions(*RegionData);
+			RegionAllTime = FPlatformTime::Seconds() - StartTime;
+		}
+
+		const int32 NumMismatches = CountMismatches(*MonolithicData, *RegionData, 100000);
+
+		LOG_VOXEL(Log, TEXT("Monolithic save: %lldKB, first frame data loaded after %.1fms"),
+			IFileManager::Get().FileSize(*MonolithicPath) / 1024,
+			MonolithicTime * 1000);
+		LOG_VOXEL(Log, TEXT("Region save: %lldKB, first frame data loaded after %.1fms (%d/%d regions), all regions after %.1fms"),
+			IFileManager::Get().FileSize(*RegionPath) / 1024,
+			RegionFirstFrameTime * 1000,
+			NumFirstFrameRegions,
+			NumRegions,
+			RegionAllTime * 1000);
+		LOG_VOXEL(Log, TEXT("%d mismatches between the worlds loaded from the two saves"), NumMismatches);
+		LOG_VOXEL(Log, TEXT("Only the data load is timed, not the meshing of the first frame"));
+
+		IFileManager::Get().Delete(*MonolithicPath);
+		IFileManager::Get().Delete(*RegionPath);
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkRegionSave(
+	TEXT("voxel.data.BenchmarkRegionSave"),
+	TEXT("Compares the time to load the data of the first frame from a monolithic save and from a region save of an edited world. Meshing is not timed. Args: [Depth = 6] [RegionDepth = 3] [LoadDistance = 256]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelRegionSaveBenchmark::Benchmark));
@@ -0,0 +1,119 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelData/VoxelRegionSaveStreamer.h"
+#include "VoxelData/VoxelRegionSave.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelRender/IVoxelLODManager.h"
+#include "VoxelComponents/VoxelInvokerComponent.h"
+#include "VoxelWorld.h"
+
+static TAutoConsoleVariable<int32> CVarRegionSaveLoadDistance(
+	TEXT("voxel.data.RegionSaveLoadDistance"),
+	2048,
+	TEXT("Region saves: regions closer than this to an invoker are loaded, in voxels. Regions in the LOD and collisions bounds of the invokers are always loaded"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarRegionSaveLoadBudget(
+	TEXT("voxel.data.RegionSaveLoadBudget"),
+	4,
+	TEXT("Region saves: time spent loading regions per frame, in milliseconds. At least one batch of regions is loaded per frame if some need to be"),
+	ECVF_Default);
+
+FVoxelRegionSaveStreamer::FVoxelRegionSaveStreamer(AVoxelWorld& World, const TVoxelSharedRef<FVoxelRegionSaveLoader>& Loader)
+	: World(&World)
+	, Loader(Loader)
+{
+}
+
+void FVoxelRegionSaveStreamer::LoadRegionsAroundInvokers(double MaxTime)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!IsLoaderValid() || Loader->GetNumRegionsLeft() == 0)
+	{
+		return;
+	}
+
+	const int32 LoadDistance = FMath::Max(0, CVarRegionSaveLoadDistance.GetValueOnGameThread());
+
+	TArray<FVoxelIntBox> Bounds;
+	TArray<FIntVector> Positions;
+	for (const TWeakObjectPtr<UVoxelInvokerComponentBase>& Invoker : UVoxelInvokerComponentBase::GetInvokers(World->GetWorld()))
+	{
+		if (!Invoker.IsValid())
+		{
+			continue;
+		}
+
+		const FIntVector Position = Invoker->GetInvokerVoxelPosition(World.Get());
+		const FVoxelInvokerSettings Settings = Invoker->GetInvokerSettings(World.Get());
+
+		FVoxelIntBox InvokerBounds = FVoxelIntBox(Position).Extend(LoadDistance);
+		if (Settings.bUseForLOD)
+		{
+			InvokerBounds = InvokerBounds.Union(Settings.GetLODPathBounds());
+		}
+		if (Settings.bUseForCollisions)
+		{
+			InvokerBounds = InvokerBounds.Union(Settings.CollisionsBounds);
+		}
+
+		Bounds.Add(InvokerBounds);
+		Positions.Add(Position);
+	}
+
+	TArray<int32> RegionsToLoad;
+	Loader->GetRegionsToLoad(Bounds, Positions, RegionsToLoad);
+
+	// Regions are decompressed in parallel: load them by batches of the number of threads
+	const int32 BatchSize = FMath::Max(1, FPlatformMisc::NumberOfCores());
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 BatchStart = 0; BatchStart < RegionsToLoad.Num(); BatchStart += BatchSize)
+	{
+		const int32 BatchNum = FMath::Min(BatchSize, RegionsToLoad.Num() - BatchStart);
+		if (!Loader->LoadRegions(World->GetData(), TArray<int32>(RegionsToLoad.GetData() + BatchStart, BatchNum)))
+		{
+			LOG_VOXEL(Error, TEXT("Some regions of the region save are corrupted and were not loaded"));
+		}
+
+		if (FPlatformTime::Seconds() - StartTime > MaxTime)
+		{
+			break;
+		}
+	}
+}
+
+void FVoxelRegionSaveStreamer::UpdateLoadedBounds()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!IsLoaderValid())
+	{
+		return;
+	}
+
+	// Also includes the regions loaded by GetSave
+	TArray<FVoxelIntBox> BoundsToUpdate;
+	Loader->PopBoundsToUpdate(BoundsToUpdate);
+
+	if (BoundsToUpdate.Num() > 0)
+	{
+		World->GetLODManager().UpdateBounds(BoundsToUpdate);
+	}
+}
+
+void FVoxelRegionSaveStreamer::Tick(float DeltaTime)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	LoadRegionsAroundInvokers(CVarRegionSaveLoadBudget.GetValueOnGameThread() / 1000.);
+	UpdateLoadedBounds();
+}
+
+bool FVoxelRegionSaveStreamer::IsLoaderValid() const
+{
+	return
+		World.IsValid() &&
+		World->IsCreated() &&
+		World->GetData().GetRegionSaveLoader() == Loader;
+}
@@ -0,0 +1,35 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelTickable.h"
+
+class AVoxelWorld;
+class FVoxelRegionSaveLoader;
+
+// Loads the regions of the region save of a voxel world as its invokers get close to them, see UVoxelDataTools::LoadFromRegionSave
+// Stops once all the regions are loaded, or when the data is loaded from another save
+class FVoxelRegionSaveStreamer : public FVoxelTickable
+{
+public:
+	FVoxelRegionSaveStreamer(AVoxelWorld& World, const TVoxelSharedRef<FVoxelRegionSaveLoader>& Loader);
+
+	// Loads the regions close to the invokers, the closest ones first, until MaxTime is elapsed
+	// At least one batch of regions is loaded per call
+	void LoadRegionsAroundInvokers(double MaxTime);
+	// Sends the bounds of the loaded chunks to the LOD manager
+	void UpdateLoadedBounds();
+
+	//~ Begin FVoxelTickable Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	//~ End FVoxelTickable Interface
+
+private:
+	const TWeakObjectPtr<AVoxelWorld> World;
+	const TVoxelSharedRef<FVoxelRegionSaveLoader> Loader;
+
+	bool IsLoaderValid() const;
+};
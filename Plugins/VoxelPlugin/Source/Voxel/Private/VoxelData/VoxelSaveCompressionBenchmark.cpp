@@ -0,0 +1,127 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelData/VoxelBenchmarkUtilities.h"
+#include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include "VoxelUtilities/VoxelSerializationUtilities.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/LargeMemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Compression and decompression throughput of a large edited world save: single zlib stream vs parallel blocks
+namespace FVoxelSaveCompressionBenchmark
+{
+	double ToMBs(int64 Size, double Time)
+	{
+		return Size / 1024. / 1024. / FMath::Max(Time, 1e-9);
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 Depth = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5, 1, 12);
+
+		const TVoxelSharedRef<FVoxelData> Data = FVoxelBenchmarkUtilities::CreateData(Depth);
+		FVoxelBenchmarkUtilities::EditSurface(*Data);
+
+		FVoxelUncompressedWorldSaveImpl Save;
+		TArray<FVoxelObjectArchiveEntry> Objects;
+		Data->GetSave(Save, Objects);
+
+		FLargeMemoryWriter Writer(Save.GetAllocatedSize());
+		Save.Serialize(Writer);
+		const int64 UncompressedSize = Writer.TotalSize();
+
+		LOG_VOXEL(Log, TEXT("Benchmarking save compression: %d chunks, %lldKB uncompressed"), FVoxelSaveLoader(Save).NumChunks(), UncompressedSize / 1024);
+
+		// Single zlib stream, as before block compression
+		{
+			TArray<uint8> CompressedData;
+
+			double StartTime = FPlatformTime::Seconds();
+			FVoxelSerializationUtilities::CompressData(Writer, CompressedData);
+			const double CompressionTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			{
+				TArray64<uint8> UncompressedData;
+				FVoxelSerializationUtilities::DecompressData(CompressedData, UncompressedData);
+
+				FVoxelUncompressedWorldSaveImpl DecompressedSave;
+				FLargeMemoryReader Reader(UncompressedData.GetData(), UncompressedData.Num());
+				DecompressedSave.Serialize(Reader);
+			}
+			const double DecompressionTime = FPlatformTime::Seconds() - StartTime;
+
+			LOG_VOXEL(Log, TEXT("Single stream (Zlib): %dKB, compression %.1fMB/s, decompression %.1fMB/s"),
+				CompressedData.Num() / 1024,
+				ToMBs(UncompressedSize, CompressionTime),
+				ToMBs(UncompressedSize, DecompressionTime));
+		}
+
+		const TCHAR* CodecNames[] = { TEXT("Zlib"), TEXT("LZ4"), TEXT("Oodle") };
+		static_assert(UE_ARRAY_COUNT(CodecNames) == EVoxelCompressionCodec::Max, "");
+
+		for (int32 CodecIndex = 0; CodecIndex < EVoxelCompressionCodec::Max; CodecIndex++)
+		{
+			const auto Codec = EVoxelCompressionCodec::Type(CodecIndex);
+			if (FVoxelSerializationUtilities::GetAvailableCodec(Codec) != Codec)
+			{
+				LOG_VOXEL(Log, TEXT("Blocks (%s): not available"), CodecNames[CodecIndex]);
+				continue;
+			}
+
+			FVoxelCompressedWorldSaveImpl CompressedSave;
+
+			double StartTime = FPlatformTime::Seconds();
+			UVoxelSaveUtilities::CompressVoxelSave(Save, CompressedSave, Codec);
+			const double CompressionTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			{
+				FVoxelUncompressedWorldSaveImpl DecompressedSave;
+				UVoxelSaveUtilities::DecompressVoxelSave(CompressedSave, DecompressedSave);
+			}
+			const double DecompressionTime = FPlatformTime::Seconds() - StartTime;
+
+			TArray<uint8> Bytes;
+			FMemoryWriter BytesWriter(Bytes);
+			CompressedSave.Serialize(BytesWriter);
+
+			LOG_VOXEL(Log, TEXT("Blocks (%s): %dKB, compression %.1fMB/s, decompression %.1fMB/s"),
+				CodecNames[CodecIndex],
+				Bytes.Num() / 1024,
+				ToMBs(UncompressedSize, CompressionTime),
+				ToMBs(UncompressedSize, DecompressionTime));
+
+			if (Codec != EVoxelCompressionCodec::Zlib)
+			{
+				continue;
+			}
+
+			// Corrupt a byte at the end of the save: only the chunks of the last block should be lost
+			Bytes[Bytes.Num() - 16] ^= 0xFF;
+
+			FVoxelCompressedWorldSaveImpl CorruptedSave;
+			FMemoryReader BytesReader(Bytes);
+			CorruptedSave.Serialize(BytesReader);
+
+			FVoxelUncompressedWorldSaveImpl RecoveredSave;
+			if (UVoxelSaveUtilities::DecompressVoxelSave(CorruptedSave, RecoveredSave))
+			{
+				LOG_VOXEL(Log, TEXT("Corrupted block: recovered %d/%d chunks"), FVoxelSaveLoader(RecoveredSave).NumChunks(), FVoxelSaveLoader(Save).NumChunks());
+			}
+			else
+			{
+				LOG_VOXEL(Log, TEXT("Corrupted block: save could not be recovered"));
+			}
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkSaveCompression(
+	TEXT("voxel.data.BenchmarkSaveCompression"),
+	TEXT("Compares the compression and decompression throughput of a single zlib stream and of parallel blocks with each codec. Args: [Depth = 5]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelSaveCompressionBenchmark::Benchmark));
@@ -1,16 +1,42 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelData/VoxelDataOctree.h"
 #include "VoxelData/VoxelDataOctreeLeafData.h"
 #include "VoxelPlaceableItems/VoxelPlaceableItem.h"
 #include "VoxelMessages.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
 
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
 #include "Serialization/LargeMemoryReader.h"
 #include "Serialization/LargeMemoryWriter.h"
 #include "Serialization/MemoryReader.h"
 #include "Serialization/MemoryWriter.h"
 
+static TAutoConsoleVariable<int32> CVarSaveCompressionBlockSize(
+	TEXT("voxel.data.SaveCompressionBlockSize"),
+	1024,
+	TEXT("Size in KB of the blocks compressed in parallel by CompressVoxelSave. Smaller blocks are more parallel and lose less data when corrupted, but compress less"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSaveCompressionCodec(
+	TEXT("voxel.data.SaveCompressionCodec"),
+	EVoxelCompressionCodec::Zlib,
+	TEXT("Codec used by CompressVoxelSave. 0: Zlib, 1: LZ4, 2: Oodle"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarRecoverCorruptedSaves(
+	TEXT("voxel.data.RecoverCorruptedSaves"),
+	1,
+	TEXT("If 1, DecompressVoxelSave will load the chunks of the valid blocks of a partially corrupted save. If 0, it will fail"),
+	ECVF_Default);
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 FVoxelSaveBuilder::FVoxelSaveBuilder(int32 Depth)
 	: Depth(Depth)
 {
@@ -37,8 +63,8 @@ void FVoxelSaveBuilder::Save(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FV
 		{
 			if (Chunk.Values->IsDirty())
 			{
-				NumValueBuffers += Chunk.Values->DataPtr != nullptr;
-				NumSingleValues += Chunk.Values->DataPtr == nullptr;
+				NumValueBuffers += !Chunk.Values->IsSingleValue();
+				NumSingleValues += Chunk.Values->IsSingleValue();
 			}
 
 			if (Chunk.Materials->IsDirty())
@@ -74,10 +100,12 @@ void FVoxelSaveBuilder::Save(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FV
 		
 		if (Chunk.Values->IsDirty())
 		{
-			if (Chunk.Values->DataPtr)
+			if (!Chunk.Values->IsSingleValue())
 			{
+				// Also decodes palette compressed values
 				NewChunk.ValuesIndex = OutSave.ValueBuffers.AddUninitialized(VOXELS_PER_DATA_CHUNK);
-				FMemory::Memcpy(&OutSave.ValueBuffers[NewChunk.ValuesIndex], Chunk.Values->DataPtr, sizeof(FVoxelValue) * VOXELS_PER_DATA_CHUNK);
+				Chunk.Values->CopyTo(&OutSave.ValueBuffers[NewChunk.ValuesIndex]);
+				FVoxelDataOctreeUtilities::ChunkLayoutToLinear(&OutSave.ValueBuffers[NewChunk.ValuesIndex]);
 			}
 			else
 			{
@@ -100,10 +128,11 @@ void FVoxelSaveBuilder::Save(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FV
 			{
 				for (int32 Channel = 0; Channel < FVoxelMaterial::NumChannels; Channel++)
 				{
-					if (auto& DataPtr = Chunk.Materials->Channels_DataPtr[Channel])
+					if (Chunk.Materials->Channels_DataPtr[Channel])
 					{
 						const int32 Index = OutSave.MaterialBuffers.AddUninitialized(VOXELS_PER_DATA_CHUNK);
-						FMemory::Memcpy(&OutSave.MaterialBuffers[Index], DataPtr, sizeof(uint8) * VOXELS_PER_DATA_CHUNK);
+						Chunk.Materials->Channels_CopyTo(Channel, &OutSave.MaterialBuffers[Index]);
+						FVoxelDataOctreeUtilities::ChunkLayoutToLinear(&OutSave.MaterialBuffers[Index]);
 
 						MaterialIndices.GetRaw(Channel) = Index;
 					}
@@ -123,9 +152,11 @@ void FVoxelSaveBuilder::Save(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FV
 					MaterialIndices.GetRaw(Channel) = OutSave.MaterialBuffers.AddUninitialized(VOXELS_PER_DATA_CHUNK);
 				}
 
+				// Saves are in linear order
 				for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
 				{
-					const FVoxelMaterial& Material = Chunk.Materials->Main_DataPtr[Index];
+					const FIntVector Position = FVoxelDataOctreeUtilities::CoordinatesFromLinearIndex(Index);
+					const FVoxelMaterial& Material = Chunk.Materials->Main_DataPtr[FVoxelDataOctreeUtilities::IndexFromCoordinates(Position.X, Position.Y, Position.Z)];
 					
 					for (int32 Channel = 0; Channel < FVoxelMaterial::NumChannels; Channel++)
 					{
@@ -172,6 +203,180 @@ void FVoxelSaveBuilder::AddAssetItem(const FVoxelAssetItem& AssetItem)
 	AssetItems.Add(AssetItem);
 }
 
+void FVoxelSaveBuilder::CopyChunks(
+	const FVoxelUncompressedWorldSaveImpl& HeaderSave,
+	const TArray<FVoxelSaveChunkRef>& Chunks,
+	FVoxelUncompressedWorldSaveImpl& OutSave)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	using FChunkSave = FVoxelUncompressedWorldSaveImpl::FVoxelChunkSave;
+	constexpr uint32 SingleValueFlag = FVoxelUncompressedWorldSaveImpl::MaterialIndexSingleValueFlag;
+
+	OutSave.Guid = HeaderSave.Guid;
+	OutSave.Depth = HeaderSave.Depth;
+	OutSave.UserFlags = HeaderSave.UserFlags;
+
+	// The arrays can't grow: count first
+	{
+		int32 NumValueBuffers = 0;
+		int32 NumSingleValues = 0;
+
+		int32 NumMaterialsIndices = 0;
+		int32 NumMaterialBuffers = 0;
+		int32 NumSingleMaterials = 0;
+
+		for (const FVoxelSaveChunkRef& ChunkRef : Chunks)
+		{
+			const FVoxelUncompressedWorldSaveImpl& Save = *ChunkRef.Save;
+			const FChunkSave& Chunk = Save.Chunks[ChunkRef.ChunkIndex];
+			if (Chunk.ValuesIndex >= 0)
+			{
+				NumValueBuffers += !Chunk.bSingleValue;
+				NumSingleValues += Chunk.bSingleValue;
+			}
+			if (Chunk.MaterialsIndex >= 0)
+			{
+				NumMaterialsIndices++;
+
+				const auto& MaterialIndices = Save.MaterialsIndices[Chunk.MaterialsIndex];
+				for (int32 Channel = 0; Channel < FVoxelMaterial::NumChannels; Channel++)
+				{
+					const bool bSingleMaterial = MaterialIndices.GetRaw(Channel) & SingleValueFlag;
+					NumMaterialBuffers += !bSingleMaterial;
+					NumSingleMaterials += bSingleMaterial;
+				}
+			}
+		}
+
+		OutSave.ValueBuffers.Empty(NumValueBuffers * VOXELS_PER_DATA_CHUNK);
+		OutSave.SingleValues.Empty(NumSingleValues);
+
+		OutSave.MaterialsIndices.Empty(NumMaterialsIndices);
+		OutSave.MaterialBuffers.Empty(NumMaterialBuffers * VOXELS_PER_DATA_CHUNK);
+		OutSave.SingleMaterials.Empty(NumSingleMaterials);
+
+		OutSave.Chunks.Empty(Chunks.Num());
+	}
+
+	for (const FVoxelSaveChunkRef& ChunkRef : Chunks)
+	{
+		const FVoxelUncompressedWorldSaveImpl& Save = *ChunkRef.Save;
+		const FChunkSave& Chunk = Save.Chunks[ChunkRef.ChunkIndex];
+
+		FChunkSave NewChunk;
+		NewChunk.Position = Chunk.Position;
+		NewChunk.bSingleValue = Chunk.bSingleValue;
+
+		if (Chunk.ValuesIndex >= 0)
+		{
+			if (Chunk.bSingleValue)
+			{
+				NewChunk.ValuesIndex = OutSave.SingleValues.Add(Save.SingleValues[Chunk.ValuesIndex]);
+			}
+			else
+			{
+				NewChunk.ValuesIndex = OutSave.ValueBuffers.AddUninitialized(VOXELS_PER_DATA_CHUNK);
+				FMemory::Memcpy(&OutSave.ValueBuffers[NewChunk.ValuesIndex], &Save.ValueBuffers[Chunk.ValuesIndex], sizeof(FVoxelValue) * VOXELS_PER_DATA_CHUNK);
+			}
+		}
+
+		if (Chunk.MaterialsIndex >= 0)
+		{
+			const auto& MaterialIndices = Save.MaterialsIndices[Chunk.MaterialsIndex];
+
+			TVoxelMaterialStorage<uint32> NewMaterialIndices;
+			for (int32 Channel = 0; Channel < FVoxelMaterial::NumChannels; Channel++)
+			{
+				const uint32 MaterialIndex = MaterialIndices.GetRaw(Channel);
+				if (MaterialIndex & SingleValueFlag)
+				{
+					NewMaterialIndices.GetRaw(Channel) = OutSave.SingleMaterials.Add(Save.SingleMaterials[MaterialIndex & ~SingleValueFlag]) | SingleValueFlag;
+				}
+				else
+				{
+					const int32 NewIndex = OutSave.MaterialBuffers.AddUninitialized(VOXELS_PER_DATA_CHUNK);
+					FMemory::Memcpy(&OutSave.MaterialBuffers[NewIndex], &Save.MaterialBuffers[MaterialIndex], sizeof(uint8) * VOXELS_PER_DATA_CHUNK);
+					NewMaterialIndices.GetRaw(Channel) = NewIndex;
+				}
+			}
+
+			NewChunk.MaterialsIndex = OutSave.MaterialsIndices.Add(NewMaterialIndices);
+		}
+
+		OutSave.Chunks.Add(NewChunk);
+	}
+
+	ensure(OutSave.Chunks.GetSlack() == 0);
+	ensure(OutSave.ValueBuffers.GetSlack() == 0);
+	ensure(OutSave.MaterialBuffers.GetSlack() == 0);
+
+	OutSave.UpdateAllocatedSize();
+}
+
+void FVoxelSaveBuilder::MergeSaves(
+	const TArray<const FVoxelUncompressedWorldSaveImpl*>& Saves,
+	FVoxelUncompressedWorldSaveImpl& OutSave)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (!ensure(Saves.Num() > 0))
+	{
+		return;
+	}
+
+	const FVoxelUncompressedWorldSaveImpl& FirstSave = *Saves[0];
+	const FVoxelUncompressedWorldSaveImpl& LastSave = *Saves.Last();
+
+	TMap<FIntVector, FVoxelSaveChunkRef> ChunksMap;
+	for (const FVoxelUncompressedWorldSaveImpl* Save : Saves)
+	{
+		ensure(Save->Depth == FirstSave.Depth);
+		for (int32 ChunkIndex = 0; ChunkIndex < Save->Chunks.Num(); ChunkIndex++)
+		{
+			ChunksMap.Add(Save->Chunks[ChunkIndex].Position, { Save, ChunkIndex });
+		}
+	}
+
+	TArray<FVoxelSaveChunkRef> Chunks;
+	ChunksMap.GenerateValueArray(Chunks);
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Sort");
+
+		// Depth first order of the octree is the Morton order of the positions relative to the octree min, with X in the lowest bit
+		// Compare the most significant bit that differs instead of computing the codes, which could overflow
+		const FIntVector OctreeMin = FIntVector(-(DATA_CHUNK_SIZE << FirstSave.Depth) / 2);
+		Chunks.Sort([&](const FVoxelSaveChunkRef& ChunkA, const FVoxelSaveChunkRef& ChunkB)
+		{
+			const FIntVector A = ChunkA.Save->Chunks[ChunkA.ChunkIndex].Position - OctreeMin;
+			const FIntVector B = ChunkB.Save->Chunks[ChunkB.ChunkIndex].Position - OctreeMin;
+
+			const auto LessMostSignificantBit = [](uint32 X, uint32 Y) { return X < Y && X < (X ^ Y); };
+
+			int32 Axis = 2;
+			uint32 MaxXor = uint32(A.Z) ^ uint32(B.Z);
+			for (int32 OtherAxis = 1; OtherAxis >= 0; OtherAxis--)
+			{
+				const uint32 Xor = uint32(A[OtherAxis]) ^ uint32(B[OtherAxis]);
+				if (LessMostSignificantBit(MaxXor, Xor))
+				{
+					Axis = OtherAxis;
+					MaxXor = Xor;
+				}
+			}
+			return A[Axis] < B[Axis];
+		});
+	}
+
+	CopyChunks(FirstSave, Chunks, OutSave);
+
+	OutSave.Guid = FGuid::NewGuid();
+	OutSave.Version = LastSave.Version;
+	OutSave.PlaceableItems = LastSave.PlaceableItems;
+	OutSave.UpdateAllocatedSize();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -198,6 +403,7 @@ void FVoxelSaveLoader::ExtractChunk(
 			{
 				check(Save.ValueBuffers.Num() >= Chunk.ValuesIndex + VOXELS_PER_DATA_CHUNK);
 				FMemory::Memcpy(DataPtr, &Save.ValueBuffers[Chunk.ValuesIndex], sizeof(FVoxelValue) * VOXELS_PER_DATA_CHUNK);
+				FVoxelDataOctreeUtilities::LinearToChunkLayout(DataPtr);
 			});
 		}
 		OutValues.SetIsDirty(true, Memory);
@@ -233,6 +439,7 @@ void FVoxelSaveLoader::ExtractChunk(
 					
 					check(Save.MaterialBuffers.Num() >= ChannelIndex + VOXELS_PER_DATA_CHUNK);
 					FMemory::Memcpy(DataPtr, &Save.MaterialBuffers[ChannelIndex], sizeof(uint8) * VOXELS_PER_DATA_CHUNK);
+					FVoxelDataOctreeUtilities::LinearToChunkLayout(DataPtr);
 				}
 			}
 		}
@@ -247,6 +454,7 @@ void FVoxelSaveLoader::ExtractChunk(
 						DataPtr[Index].GetRaw(Channel) = Save.MaterialBuffers[MaterialIndices.GetRaw(Channel) + Index];
 					}
 				}
+				FVoxelDataOctreeUtilities::LinearToChunkLayout(DataPtr);
 			});
 		}
 		OutMaterials.SetIsDirty(true, Memory);
@@ -286,18 +494,160 @@ void UVoxelSaveUtilities::CompressVoxelSave(const FVoxelUncompressedWorldSave& U
 	CompressVoxelSave(UncompressedSave.Const(), OutCompressedSave.NewMutable());
 }
 
-void UVoxelSaveUtilities::CompressVoxelSave(const FVoxelUncompressedWorldSaveImpl& UncompressedSave, FVoxelCompressedWorldSaveImpl& OutCompressedSave)
+// CompressedData of saves with FVoxelSaveVersion::BlockCompression:
+// FBlocksHeader, a FBlockHeader per block, and the compressed blocks
+// Each block is a serialized FVoxelUncompressedWorldSaveImpl: the first one only has the placeable items, the others a range of the chunks
+namespace FVoxelSaveBlockCompression
+{
+	// "VXBC"
+	static constexpr uint32 Magic = 0x56584243;
+
+	struct FBlocksHeader
+	{
+		uint32 Magic = FVoxelSaveBlockCompression::Magic;
+		uint8 Codec = 0;
+		int32 NumBlocks = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlocksHeader& Header)
+		{
+			Ar << Header.Magic;
+			Ar << Header.Codec;
+			Ar << Header.NumBlocks;
+			return Ar;
+		}
+	};
+
+	// FVoxelCompressedWorldSaveImpl::Serialize always writes the latest version, even for data compressed before BlockCompression
+	inline bool IsBlockCompressed(int32 Version, const TArray<uint8>& CompressedData)
+	{
+		if (Version < FVoxelSaveVersion::BlockCompression || CompressedData.Num() < sizeof(uint32))
+		{
+			return false;
+		}
+
+		uint32 DataMagic;
+		FMemory::Memcpy(&DataMagic, CompressedData.GetData(), sizeof(uint32));
+		return DataMagic == Magic;
+	}
+
+	struct FBlockHeader
+	{
+		int32 CompressedSize = 0;
+		int32 UncompressedSize = 0;
+		// Of the uncompressed data
+		uint32 Crc = 0;
+		int32 NumChunks = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlockHeader& Header)
+		{
+			Ar << Header.CompressedSize;
+			Ar << Header.UncompressedSize;
+			Ar << Header.Crc;
+			Ar << Header.NumChunks;
+			return Ar;
+		}
+	};
+}
+
+void UVoxelSaveUtilities::CompressVoxelSave(
+	const FVoxelUncompressedWorldSaveImpl& UncompressedSave,
+	FVoxelCompressedWorldSaveImpl& OutCompressedSave,
+	EVoxelCompressionCodec::Type Codec,
+	EVoxelCompressionLevel::Type CompressionLevel)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
-	
+	using namespace FVoxelSaveBlockCompression;
+
+	if (Codec == EVoxelCompressionCodec::Max)
+	{
+		Codec = EVoxelCompressionCodec::Type(FMath::Clamp<int32>(CVarSaveCompressionCodec.GetValueOnAnyThread(), 0, EVoxelCompressionCodec::Max - 1));
+	}
+	Codec = FVoxelSerializationUtilities::GetAvailableCodec(Codec);
+	// Resolve the voxel default on this thread
+	CompressionLevel = EVoxelCompressionLevel::Type(FVoxelSerializationUtilities::GetCompressionLevel(CompressionLevel));
+
+	OutCompressedSave.Version = FVoxelSaveVersion::LatestVersion;
 	OutCompressedSave.Depth = UncompressedSave.GetDepth();
 	OutCompressedSave.Guid = UncompressedSave.GetGuid();
 
-	FLargeMemoryWriter MemoryWriter(UncompressedSave.GetAllocatedSize());
-	const_cast<FVoxelUncompressedWorldSaveImpl&>(UncompressedSave).Serialize(MemoryWriter);
-	
-	FVoxelSerializationUtilities::CompressData(MemoryWriter, OutCompressedSave.CompressedData);
-	
+	// Split the chunks in ranges of roughly the block size
+	TArray<TArray<FVoxelSaveChunkRef>> ChunkBlocks;
+	{
+		const int32 NumChunks = UncompressedSave.Chunks.Num();
+		const int64 BytesPerChunk = FMath::Max<int64>(1, UncompressedSave.GetAllocatedSize() / FMath::Max(1, NumChunks));
+		const int64 BlockSize = FMath::Max(1, CVarSaveCompressionBlockSize.GetValueOnAnyThread()) * 1024ll;
+		const int32 ChunksPerBlock = FMath::Max<int32>(1, BlockSize / BytesPerChunk);
+
+		// First block is for the placeable items
+		ChunkBlocks.Emplace();
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ChunkIndex++)
+		{
+			if (ChunkIndex % ChunksPerBlock == 0)
+			{
+				ChunkBlocks.Emplace().Reserve(FMath::Min(ChunksPerBlock, NumChunks - ChunkIndex));
+			}
+			ChunkBlocks.Last().Add({ &UncompressedSave, ChunkIndex });
+		}
+	}
+
+	TArray<FBlockHeader> BlockHeaders;
+	TArray<TArray<uint8>> CompressedBlocks;
+	BlockHeaders.SetNum(ChunkBlocks.Num());
+	CompressedBlocks.SetNum(ChunkBlocks.Num());
+
+	ParallelFor(ChunkBlocks.Num(), [&](int32 BlockIndex)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Compress Block");
+
+		FVoxelUncompressedWorldSaveImpl BlockSave;
+		FVoxelSaveBuilder::CopyChunks(UncompressedSave, ChunkBlocks[BlockIndex], BlockSave);
+		if (BlockIndex == 0)
+		{
+			BlockSave.PlaceableItems = UncompressedSave.PlaceableItems;
+		}
+
+		FLargeMemoryWriter MemoryWriter(BlockSave.GetAllocatedSize());
+		BlockSave.Serialize(MemoryWriter);
+
+		FBlockHeader& Header = BlockHeaders[BlockIndex];
+		check(MemoryWriter.TotalSize() <= MAX_int32);
+		Header.UncompressedSize = MemoryWriter.TotalSize();
+		Header.Crc = FCrc::MemCrc32(MemoryWriter.GetData(), Header.UncompressedSize);
+		Header.NumChunks = BlockSave.Chunks.Num();
+
+		FVoxelSerializationUtilities::CompressBlock(Codec, CompressionLevel, MemoryWriter.GetData(), Header.UncompressedSize, CompressedBlocks[BlockIndex]);
+		Header.CompressedSize = CompressedBlocks[BlockIndex].Num();
+	});
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Concatenate");
+
+		int64 TotalSize = 0;
+		for (const TArray<uint8>& CompressedBlock : CompressedBlocks)
+		{
+			TotalSize += CompressedBlock.Num();
+		}
+
+		FBlocksHeader Header;
+		Header.Codec = Codec;
+		Header.NumBlocks = CompressedBlocks.Num();
+
+		OutCompressedSave.CompressedData.Reset();
+		FMemoryWriter Writer(OutCompressedSave.CompressedData);
+		Writer << Header;
+		for (FBlockHeader& BlockHeader : BlockHeaders)
+		{
+			Writer << BlockHeader;
+		}
+
+		check(Writer.Tell() + TotalSize <= MAX_int32);
+		OutCompressedSave.CompressedData.Reserve(Writer.Tell() + TotalSize);
+		for (const TArray<uint8>& CompressedBlock : CompressedBlocks)
+		{
+			OutCompressedSave.CompressedData.Append(CompressedBlock);
+		}
+	}
+
 	OutCompressedSave.UpdateAllocatedSize();
 }
 
@@ -315,6 +665,10 @@ bool UVoxelSaveUtilities::DecompressVoxelSave(const FVoxelCompressedWorldSaveImp
 	{
 		return false;
 	}
+	else if (FVoxelSaveBlockCompression::IsBlockCompressed(CompressedSave.Version, CompressedSave.CompressedData))
+	{
+		return DecompressVoxelSaveBlocks(CompressedSave, OutUncompressedSave);
+	}
 	else
 	{
 		TArray64<uint8> UncompressedData;
@@ -330,4 +684,131 @@ bool UVoxelSaveUtilities::DecompressVoxelSave(const FVoxelCompressedWorldSaveImp
 
 		return true;
 	}
-}
\ No newline at end of file
+}
+
+bool UVoxelSaveUtilities::DecompressVoxelSaveBlocks(const FVoxelCompressedWorldSaveImpl& CompressedSave, FVoxelUncompressedWorldSaveImpl& OutUncompressedSave)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	using namespace FVoxelSaveBlockCompression;
+
+	FMemoryReader Reader(CompressedSave.CompressedData);
+
+	FBlocksHeader Header;
+	Reader << Header;
+	if (Reader.IsError() ||
+		Header.Magic != Magic ||
+		Header.Codec >= EVoxelCompressionCodec::Max ||
+		Header.NumBlocks <= 0 ||
+		Header.NumBlocks > CompressedSave.CompressedData.Num())
+	{
+		FVoxelMessages::Error("DecompressVoxelSave failed: Corrupted header");
+		return false;
+	}
+
+	TArray<FBlockHeader> BlockHeaders;
+	TArray<int64> BlockOffsets;
+	BlockHeaders.SetNum(Header.NumBlocks);
+	BlockOffsets.SetNum(Header.NumBlocks);
+	for (FBlockHeader& BlockHeader : BlockHeaders)
+	{
+		Reader << BlockHeader;
+	}
+
+	int64 Offset = Reader.Tell();
+	for (int32 BlockIndex = 0; BlockIndex < Header.NumBlocks; BlockIndex++)
+	{
+		const FBlockHeader& BlockHeader = BlockHeaders[BlockIndex];
+		BlockOffsets[BlockIndex] = Offset;
+		Offset += BlockHeader.CompressedSize;
+
+		if (BlockHeader.CompressedSize < 0 || BlockHeader.UncompressedSize < 0 || BlockHeader.NumChunks < 0)
+		{
+			Reader.SetError();
+		}
+	}
+	if (Reader.IsError() || Offset != CompressedSave.CompressedData.Num())
+	{
+		FVoxelMessages::Error("DecompressVoxelSave failed: Corrupted header");
+		return false;
+	}
+
+	const EVoxelCompressionCodec::Type Codec = EVoxelCompressionCodec::Type(Header.Codec);
+
+	// Blocks failing their checksum are left null
+	TArray<TUniquePtr<FVoxelUncompressedWorldSaveImpl>> Blocks;
+	Blocks.SetNum(Header.NumBlocks);
+
+	ParallelFor(Header.NumBlocks, [&](int32 BlockIndex)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Decompress Block");
+
+		const FBlockHeader& BlockHeader = BlockHeaders[BlockIndex];
+
+		TArray<uint8> UncompressedData;
+		UncompressedData.SetNumUninitialized(BlockHeader.UncompressedSize);
+		if (!FVoxelSerializationUtilities::DecompressBlock(
+			Codec,
+			CompressedSave.CompressedData.GetData() + BlockOffsets[BlockIndex],
+			BlockHeader.CompressedSize,
+			UncompressedData.GetData(),
+			BlockHeader.UncompressedSize))
+		{
+			return;
+		}
+		if (FCrc::MemCrc32(UncompressedData.GetData(), UncompressedData.Num()) != BlockHeader.Crc)
+		{
+			return;
+		}
+
+		auto Block = MakeUnique<FVoxelUncompressedWorldSaveImpl>();
+		FMemoryReader BlockReader(UncompressedData);
+		Block->Serialize(BlockReader);
+		if (BlockReader.IsError() || !BlockReader.AtEnd() || Block->Chunks.Num() != BlockHeader.NumChunks)
+		{
+			return;
+		}
+
+		Blocks[BlockIndex] = MoveTemp(Block);
+	});
+
+	if (!Blocks[0])
+	{
+		FVoxelMessages::Error("DecompressVoxelSave failed: Corrupted placeable items");
+		return false;
+	}
+
+	TArray<FVoxelSaveChunkRef> Chunks;
+	int32 NumLostChunks = 0;
+	for (int32 BlockIndex = 1; BlockIndex < Header.NumBlocks; BlockIndex++)
+	{
+		const FVoxelUncompressedWorldSaveImpl* Block = Blocks[BlockIndex].Get();
+		if (!Block)
+		{
+			NumLostChunks += BlockHeaders[BlockIndex].NumChunks;
+			continue;
+		}
+		for (int32 ChunkIndex = 0; ChunkIndex < Block->Chunks.Num(); ChunkIndex++)
+		{
+			Chunks.Add({ Block, ChunkIndex });
+		}
+	}
+
+	if (NumLostChunks > 0)
+	{
+		if (!CVarRecoverCorruptedSaves.GetValueOnAnyThread())
+		{
+			FVoxelMessages::Error(FString::Printf(TEXT("DecompressVoxelSave failed: %d chunks are corrupted"), NumLostChunks));
+			return false;
+		}
+		FVoxelMessages::Error(FString::Printf(TEXT("DecompressVoxelSave: %d chunks are corrupted and were reset. The rest of the save was recovered"), NumLostChunks));
+	}
+
+	// Blocks are consecutive ranges of chunks: the order expected by LoadFromSave is kept
+	const FVoxelUncompressedWorldSaveImpl& FirstBlock = *Blocks[0];
+	FVoxelSaveBuilder::CopyChunks(FirstBlock, Chunks, OutUncompressedSave);
+	OutUncompressedSave.Version = FirstBlock.Version;
+	OutUncompressedSave.PlaceableItems = FirstBlock.PlaceableItems;
+	OutUncompressedSave.UpdateAllocatedSize();
+
+	return true;
+}
@@ -544,6 +544,10 @@ void FVoxelDebugManager::Tick(float DeltaTime)
 				if (InvokerSettings.bUseForLOD)
 				{
 					DRAW_BOUNDS(InvokerSettings.LODBounds, LODColor, true);
+					if (InvokerSettings.PredictedOffset != FIntVector::ZeroValue)
+					{
+						DRAW_BOUNDS(InvokerSettings.LODBounds.Translate(InvokerSettings.PredictedOffset), LODColor, true);
+					}
 				}
 				if (InvokerSettings.bUseForCollisions)
 				{
@@ -5,6 +5,13 @@
 #include "VoxelQueuedWork.h"
 #include "Misc/QueuedThreadPool.h"
 #include "VoxelMinimal.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarUseWorkStealingPool(
+	TEXT("voxel.threading.WorkStealing"),
+	0,
+	TEXT("If true, new voxel pools will use per-thread queues with work stealing instead of a single queue. Priority categories are still respected, but priorities within a category are only exact per thread"),
+	ECVF_Default);
 
 FVoxelDefaultPool::FVoxelDefaultPool(
 	int32 ThreadCount,
@@ -16,7 +23,10 @@ FVoxelDefaultPool::FVoxelDefaultPool(
 		ThreadCount,
 		1024 * 1024,
 		EThreadPriority::TPri_Normal,
-		bConstantPriorities)))
+		bConstantPriorities,
+		CVarUseWorkStealingPool.GetValueOnAnyThread()
+		? EVoxelQueuedThreadPoolScheduler::WorkStealing
+		: EVoxelQueuedThreadPoolScheduler::GlobalQueue)))
 {
 	for (int32 Index = 0; Index < 256; Index++)
 	{
@@ -6,6 +6,7 @@
 #include "VoxelMaterial.h"
 #include "VoxelMessages.h"
 #include "IVoxelPool.h"
+#include "VoxelData/VoxelDataOctreeLeafAllocator.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
 
 #include "Containers/Ticker.h"
@@ -15,6 +16,7 @@
 #include "Misc/PackageName.h"
 #include "Misc/MessageDialog.h"
 #include "Misc/ConfigCacheIni.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
 void FVoxelModule::StartupModule()
@@ -72,6 +74,11 @@ void FVoxelModule::StartupModule()
 #endif
 	}
 
+	FCoreDelegates::GetMemoryTrimDelegate().AddLambda([]()
+	{
+		FVoxelDataOctreeLeafAllocator::Trim();
+	});
+
 	FVoxelSerializationUtilities::TestCompression(128, EVoxelCompressionLevel::BestSpeed);
 	FVoxelSerializationUtilities::TestCompression(128, EVoxelCompressionLevel::BestCompression);
 	
@@ -181,6 +188,7 @@ void FVoxelModule::StartupModule()
 void FVoxelModule::ShutdownModule()
 {
 	IVoxelPool::Shutdown();
+	FVoxelDataOctreeLeafAllocator::Trim();
 }
 
 IMPLEMENT_MODULE(FVoxelModule, Voxel)
\ No newline at end of file
@@ -0,0 +1,585 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMultiplayer/VoxelEditReplication.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelDataLock.h"
+#include "VoxelData/VoxelDataOctree.h"
+#include "VoxelUtilities/VoxelOctreeUtilities.h"
+#include "VoxelUtilities/VoxelSerializationUtilities.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<int32> CVarMultiplayerMaxPacketSize(
+	TEXT("voxel.multiplayer.MaxPacketSize"),
+	64,
+	TEXT("Edit replication: max uncompressed size of a packet, in KB. A single leaf bigger than that is still sent in one packet"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMultiplayerCodec(
+	TEXT("voxel.multiplayer.Codec"),
+	EVoxelCompressionCodec::LZ4,
+	TEXT("Edit replication: codec of the packets. 0: Zlib, 1: LZ4, 2: Oodle"),
+	ECVF_Default);
+
+// "VXER"
+static constexpr uint32 GVoxelEditReplicationMagic = 0x56584552;
+
+/**
+ * A packet is a FHeader followed by the compressed leaves
+ * A leaf is its min / DATA_CHUNK_SIZE, then its values and its materials. For each:
+ * - the number of edited voxels
+ * - the edited voxels linear indices, as (number of unedited voxels, number of edited voxels) runs
+ * - the XOR of the new and old values of the edited voxels, first byte of all the voxels first
+ * All integers are variable length encoded
+ */
+namespace FVoxelEditReplicationPacket
+{
+	struct FHeader
+	{
+		uint32 Magic = GVoxelEditReplicationMagic;
+		int32 Version = FVoxelEditReplicationVersion::LatestVersion;
+		uint8 Codec = 0;
+		int32 NumLeaves = 0;
+		int32 UncompressedSize = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header)
+		{
+			Ar << Header.Magic;
+			Ar << Header.Version;
+			Ar << Header.Codec;
+			Ar << Header.NumLeaves;
+			Ar << Header.UncompressedSize;
+			return Ar;
+		}
+	};
+
+	void WriteUint(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(uint8(Value) | 0x80);
+			Value >>= 7;
+		}
+		Out.Add(uint8(Value));
+	}
+	void WriteInt(TArray<uint8>& Out, int32 Value)
+	{
+		// Zigzag, so that small negative values are small too
+		WriteUint(Out, (uint32(Value) << 1) ^ uint32(Value >> 31));
+	}
+
+	struct FReader
+	{
+		const uint8* Ptr = nullptr;
+		const uint8* End = nullptr;
+		bool bError = false;
+
+		uint32 ReadUint()
+		{
+			uint32 Value = 0;
+			for (int32 Shift = 0; Shift < 32; Shift += 7)
+			{
+				if (Ptr == End)
+				{
+					break;
+				}
+				const uint8 Byte = *Ptr++;
+				Value |= uint32(Byte & 0x7F) << Shift;
+				if (!(Byte & 0x80))
+				{
+					return Value;
+				}
+			}
+			bError = true;
+			return 0;
+		}
+		int32 ReadInt()
+		{
+			const uint32 Value = ReadUint();
+			return int32(Value >> 1) ^ -int32(Value & 1);
+		}
+		const uint8* ReadBytes(int32 Num)
+		{
+			if (End - Ptr < Num)
+			{
+				bError = true;
+				return nullptr;
+			}
+			const uint8* Result = Ptr;
+			Ptr += Num;
+			return Result;
+		}
+	};
+
+	template<typename T>
+	FORCEINLINE T Xor(const T& A, const T& B)
+	{
+		uint8 Bytes[sizeof(T)];
+		uint8 OtherBytes[sizeof(T)];
+		FMemory::Memcpy(Bytes, &A, sizeof(T));
+		FMemory::Memcpy(OtherBytes, &B, sizeof(T));
+		for (int32 Byte = 0; Byte < int32(sizeof(T)); Byte++)
+		{
+			Bytes[Byte] ^= OtherBytes[Byte];
+		}
+
+		T Result = A;
+		FMemory::Memcpy(&Result, Bytes, sizeof(T));
+		return Result;
+	}
+
+	// Merges the diffs of a leaf, in edit order, into the XOR of the latest values with the ones before the first diff, by linear index
+	template<typename T>
+	void GetXors(const TArray<TVoxelSharedRef<const FVoxelMultiplayerLeafDiff>>& Diffs, TArray<TVoxelDiff<T>>& OutXors)
+	{
+		TMap<FVoxelCellIndex, TPair<T, T>> OldAndNewValues;
+		for (const auto& Diff : Diffs)
+		{
+			const TVoxelMultiplayerDiff<T>& DiffT = FVoxelUtilities::TValuesMaterialsSelector<T>::Get(*Diff);
+			for (int32 Index = 0; Index < DiffT.Num(); Index++)
+			{
+				if (TPair<T, T>* Existing = OldAndNewValues.Find(DiffT.Indices[Index]))
+				{
+					Existing->Value = DiffT.NewValues[Index];
+				}
+				else
+				{
+					OldAndNewValues.Add(DiffT.Indices[Index], { DiffT.OldValues[Index], DiffT.NewValues[Index] });
+				}
+			}
+		}
+
+		OutXors.Reserve(OldAndNewValues.Num());
+		for (const auto& It : OldAndNewValues)
+		{
+			if (It.Value.Key != It.Value.Value)
+			{
+				const FIntVector Position = FVoxelDataOctreeUtilities::CoordinatesFromIndex(It.Key);
+				const FVoxelCellIndex LinearIndex = FVoxelDataOctreeUtilities::LinearIndexFromCoordinates(Position.X, Position.Y, Position.Z);
+				OutXors.Emplace(LinearIndex, Xor(It.Value.Key, It.Value.Value));
+			}
+		}
+		OutXors.Sort([](const TVoxelDiff<T>& A, const TVoxelDiff<T>& B) { return A.Index < B.Index; });
+	}
+
+	template<typename T>
+	void WriteXors(TArray<uint8>& Out, const TArray<TVoxelDiff<T>>& Xors)
+	{
+		WriteUint(Out, Xors.Num());
+
+		int32 Position = 0;
+		for (int32 Index = 0; Index < Xors.Num();)
+		{
+			int32 RunLength = 1;
+			while (Index + RunLength < Xors.Num() && Xors[Index + RunLength].Index == Xors[Index].Index + RunLength)
+			{
+				RunLength++;
+			}
+
+			WriteUint(Out, Xors[Index].Index - Position);
+			WriteUint(Out, RunLength);
+
+			Position = Xors[Index].Index + RunLength;
+			Index += RunLength;
+		}
+
+		// Byte planes: the high bytes of small changes are all 0
+		const int32 Offset = Out.AddUninitialized(Xors.Num() * sizeof(T));
+		for (int32 Index = 0; Index < Xors.Num(); Index++)
+		{
+			uint8 Bytes[sizeof(T)];
+			FMemory::Memcpy(Bytes, &Xors[Index].Value, sizeof(T));
+			for (int32 Byte = 0; Byte < int32(sizeof(T)); Byte++)
+			{
+				Out[Offset + Byte * Xors.Num() + Index] = Bytes[Byte];
+			}
+		}
+	}
+
+	template<typename T>
+	void ReadXors(FReader& Reader, TArray<TVoxelDiff<T>>& OutXors)
+	{
+		const uint32 Num = Reader.ReadUint();
+		if (Reader.bError || Num > VOXELS_PER_DATA_CHUNK)
+		{
+			Reader.bError = true;
+			return;
+		}
+
+		OutXors.SetNum(Num);
+
+		uint32 Position = 0;
+		for (uint32 Index = 0; Index < Num;)
+		{
+			const uint32 Gap = Reader.ReadUint();
+			const uint32 RunLength = Reader.ReadUint();
+			if (Reader.bError || Gap > VOXELS_PER_DATA_CHUNK || RunLength == 0 || RunLength > Num - Index || Gap + RunLength > VOXELS_PER_DATA_CHUNK - Position)
+			{
+				Reader.bError = true;
+				return;
+			}
+
+			Position += Gap;
+			for (uint32 Run = 0; Run < RunLength; Run++)
+			{
+				OutXors[Index++].Index = Position++;
+			}
+		}
+
+		const uint8* Bytes = Reader.ReadBytes(Num * int32(sizeof(T)));
+		if (!Bytes)
+		{
+			return;
+		}
+		for (uint32 Index = 0; Index < Num; Index++)
+		{
+			uint8 ValueBytes[sizeof(T)];
+			for (int32 Byte = 0; Byte < int32(sizeof(T)); Byte++)
+			{
+				ValueBytes[Byte] = Bytes[Byte * Num + Index];
+			}
+			FMemory::Memcpy(&OutXors[Index].Value, ValueBytes, sizeof(T));
+		}
+	}
+
+	struct FLeaf
+	{
+		FIntVector Min;
+		TArray<TVoxelDiff<FVoxelValue>> Values;
+		TArray<TVoxelDiff<FVoxelMaterial>> Materials;
+	};
+
+	template<typename T>
+	void ApplyXors(FVoxelData& Data, FVoxelDataOctreeLeaf& Leaf, const TArray<TVoxelDiff<T>>& Xors)
+	{
+		if (Xors.Num() == 0)
+		{
+			return;
+		}
+
+		const FIntVector Min = Leaf.GetMin();
+		const TVoxelDiff<T>* CurrentXor = nullptr;
+		FVoxelDataOctreeSetter::Set<T>(Data, Leaf, [&](auto Lambda)
+		{
+			for (const TVoxelDiff<T>& XorDiff : Xors)
+			{
+				CurrentXor = &XorDiff;
+				const FIntVector Position = Min + FVoxelDataOctreeUtilities::CoordinatesFromLinearIndex(XorDiff.Index);
+				Lambda(Position.X, Position.Y, Position.Z);
+			}
+		}, [&](int32, int32, int32, T& Value)
+		{
+			Value = Xor(Value, CurrentXor->Value);
+		});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelEditReplicationServer::FVoxelEditReplicationServer(const TVoxelSharedRef<FVoxelData>& Data)
+	: Data(Data)
+{
+	ensure(Data->bEnableMultiplayer);
+}
+
+int32 FVoxelEditReplicationServer::AddClient()
+{
+	const int32 ClientId = NextClientId++;
+	Clients.Add(ClientId);
+	return ClientId;
+}
+
+void FVoxelEditReplicationServer::RemoveClient(int32 ClientId)
+{
+	ensure(Clients.Remove(ClientId) == 1);
+}
+
+void FVoxelEditReplicationServer::SetClientInvokers(int32 ClientId, const TArray<FIntVector>& InvokerPositions)
+{
+	if (FClient* Client = Clients.Find(ClientId))
+	{
+		Client->Invokers = InvokerPositions;
+		Client->bNeedsSort = Client->Invokers.Num() > 0;
+	}
+}
+
+void FVoxelEditReplicationServer::Tick()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const TVoxelSharedPtr<FVoxelData> PinnedData = Data.Pin();
+	if (!ensure(PinnedData))
+	{
+		return;
+	}
+
+	TArray<FVoxelMultiplayerLeafDiff> Diffs;
+	PinnedData->GetMultiplayerDiffs(Diffs);
+
+	for (FVoxelMultiplayerLeafDiff& Diff : Diffs)
+	{
+		// Shared by all the clients
+		const TVoxelSharedRef<const FVoxelMultiplayerLeafDiff> SharedDiff = MakeVoxelShared<FVoxelMultiplayerLeafDiff>(MoveTemp(Diff));
+		for (auto& It : Clients)
+		{
+			FClient& Client = It.Value;
+
+			auto* PendingDiffs = Client.PendingLeaves.Find(SharedDiff->Position);
+			if (!PendingDiffs)
+			{
+				PendingDiffs = &Client.PendingLeaves.Add(SharedDiff->Position);
+				Client.SendOrder.Add(SharedDiff->Position);
+				Client.bNeedsSort |= Client.Invokers.Num() > 0;
+			}
+			PendingDiffs->Add(SharedDiff);
+
+			if (Client.EncodedLeafPayload.Num() > 0 && Client.EncodedLeaf == SharedDiff->Position)
+			{
+				Client.EncodedLeafPayload.Reset();
+			}
+		}
+	}
+}
+
+bool FVoxelEditReplicationServer::GetNextPacket(int32 ClientId, TArray<uint8>& OutPacket)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	using namespace FVoxelEditReplicationPacket;
+
+	FClient* Client = Clients.Find(ClientId);
+	if (!ensure(Client) || Client->PendingLeaves.Num() == 0)
+	{
+		return false;
+	}
+
+	if (Client->bNeedsSort)
+	{
+		SortPendingLeaves(*Client);
+	}
+
+	const int32 MaxPacketSize = FMath::Max(1, CVarMultiplayerMaxPacketSize.GetValueOnAnyThread()) * 1024;
+
+	FHeader Header;
+	TArray<uint8> Payload;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Encode");
+
+		TArray<uint8> LeafPayload;
+		TArray<TVoxelDiff<FVoxelValue>> ValueXors;
+		TArray<TVoxelDiff<FVoxelMaterial>> MaterialXors;
+		while (Client->NumSentLeaves + Header.NumLeaves < Client->SendOrder.Num())
+		{
+			const FIntVector Leaf = Client->SendOrder[Client->NumSentLeaves + Header.NumLeaves];
+
+			if (Client->EncodedLeafPayload.Num() > 0 && Client->EncodedLeaf == Leaf)
+			{
+				LeafPayload = MoveTemp(Client->EncodedLeafPayload);
+				Client->EncodedLeafPayload.Reset();
+			}
+			else
+			{
+				const auto& Diffs = Client->PendingLeaves.FindChecked(Leaf);
+
+				ValueXors.Reset();
+				MaterialXors.Reset();
+				GetXors(Diffs, ValueXors);
+				GetXors(Diffs, MaterialXors);
+
+				LeafPayload.Reset();
+				WriteInt(LeafPayload, Leaf.X / DATA_CHUNK_SIZE);
+				WriteInt(LeafPayload, Leaf.Y / DATA_CHUNK_SIZE);
+				WriteInt(LeafPayload, Leaf.Z / DATA_CHUNK_SIZE);
+				WriteXors(LeafPayload, ValueXors);
+				WriteXors(LeafPayload, MaterialXors);
+			}
+
+			if (Header.NumLeaves > 0 && Payload.Num() + LeafPayload.Num() > MaxPacketSize)
+			{
+				// Kept for the next packet
+				Client->EncodedLeaf = Leaf;
+				Client->EncodedLeafPayload = MoveTemp(LeafPayload);
+				break;
+			}
+
+			Payload.Append(LeafPayload);
+			Header.NumLeaves++;
+		}
+	}
+
+	const EVoxelCompressionCodec::Type Codec = FVoxelSerializationUtilities::GetAvailableCodec(
+		EVoxelCompressionCodec::Type(FMath::Clamp<int32>(CVarMultiplayerCodec.GetValueOnAnyThread(), 0, EVoxelCompressionCodec::Max - 1)));
+
+	Header.Codec = Codec;
+	Header.UncompressedSize = Payload.Num();
+
+	TArray<uint8> CompressedPayload;
+	if (!FVoxelSerializationUtilities::CompressBlock(Codec, EVoxelCompressionLevel::BestSpeed, Payload.GetData(), Payload.Num(), CompressedPayload))
+	{
+		// The leaves stay pending, and are sent again by the next call
+		LOG_VOXEL(Error, TEXT("Edit replication: failed to compress a packet of %d leaves"), Header.NumLeaves);
+		return false;
+	}
+
+	// Only now that the packet is valid: the leaves are sent
+	for (int32 Index = 0; Index < Header.NumLeaves; Index++)
+	{
+		Client->PendingLeaves.Remove(Client->SendOrder[Client->NumSentLeaves + Index]);
+	}
+	Client->NumSentLeaves += Header.NumLeaves;
+
+	// Amortized: only done once most of the leaves were sent
+	if (Client->NumSentLeaves > Client->SendOrder.Num() / 2)
+	{
+		Client->SendOrder.RemoveAt(0, Client->NumSentLeaves, UE_505_SWITCH(false, EAllowShrinking::No));
+		Client->NumSentLeaves = 0;
+	}
+
+	OutPacket.Reset();
+	FMemoryWriter Writer(OutPacket);
+	Writer << Header;
+	OutPacket.Append(CompressedPayload);
+
+	return true;
+}
+
+void FVoxelEditReplicationServer::SortPendingLeaves(FClient& Client)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	Client.bNeedsSort = false;
+
+	Client.SendOrder.RemoveAt(0, Client.NumSentLeaves, UE_505_SWITCH(false, EAllowShrinking::No));
+	Client.NumSentLeaves = 0;
+
+	TArray<TPair<uint64, FIntVector>> LeavesWithDistances;
+	LeavesWithDistances.Reserve(Client.SendOrder.Num());
+	for (const FIntVector& Leaf : Client.SendOrder)
+	{
+		const FVoxelIntBox Bounds(Leaf, Leaf + DATA_CHUNK_SIZE);
+
+		uint64 Distance = MAX_uint64;
+		for (const FIntVector& Invoker : Client.Invokers)
+		{
+			Distance = FMath::Min(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint(Invoker));
+		}
+		LeavesWithDistances.Emplace(Distance, Leaf);
+	}
+	// Stable: leaves at the same distance stay in edit order
+	LeavesWithDistances.StableSort([](const TPair<uint64, FIntVector>& A, const TPair<uint64, FIntVector>& B) { return A.Key < B.Key; });
+
+	for (int32 Index = 0; Index < LeavesWithDistances.Num(); Index++)
+	{
+		Client.SendOrder[Index] = LeavesWithDistances[Index].Value;
+	}
+}
+
+int32 FVoxelEditReplicationServer::GetNumPendingLeaves(int32 ClientId) const
+{
+	const FClient* Client = Clients.Find(ClientId);
+	return Client ? Client->PendingLeaves.Num() : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelEditReplicationClient::FVoxelEditReplicationClient(const TVoxelSharedRef<FVoxelData>& Data)
+	: Data(Data)
+{
+}
+
+bool FVoxelEditReplicationClient::ApplyPacket(const TArray<uint8>& Packet, TArray<FVoxelIntBox>& OutBoundsToUpdate)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	using namespace FVoxelEditReplicationPacket;
+
+	const TVoxelSharedPtr<FVoxelData> PinnedData = Data.Pin();
+	if (!ensure(PinnedData))
+	{
+		return false;
+	}
+
+	FMemoryReader HeaderReader(Packet);
+	FHeader Header;
+	HeaderReader << Header;
+
+	// Upper bound of the size of the leaves, to not allocate garbage sizes
+	const int64 MaxLeafSize = 3 * 5 + 2 * 5 + VOXELS_PER_DATA_CHUNK * (2 * 5 + sizeof(FVoxelValue) + sizeof(FVoxelMaterial));
+	if (HeaderReader.IsError() ||
+		Header.Magic != GVoxelEditReplicationMagic ||
+		Header.Version > FVoxelEditReplicationVersion::LatestVersion ||
+		Header.Codec >= EVoxelCompressionCodec::Max ||
+		Header.NumLeaves < 0 ||
+		Header.UncompressedSize < 0 ||
+		Header.UncompressedSize > Header.NumLeaves * MaxLeafSize)
+	{
+		LOG_VOXEL(Warning, TEXT("Edit replication: corrupted packet header"));
+		return false;
+	}
+
+	const int64 HeaderSize = HeaderReader.Tell();
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(Header.UncompressedSize);
+	if (!FVoxelSerializationUtilities::DecompressBlock(
+		EVoxelCompressionCodec::Type(Header.Codec),
+		Packet.GetData() + HeaderSize,
+		Packet.Num() - HeaderSize,
+		Payload.GetData(),
+		Payload.Num()))
+	{
+		LOG_VOXEL(Warning, TEXT("Edit replication: corrupted packet"));
+		return false;
+	}
+
+	// Decode everything first, to not apply half of a corrupted packet
+	TArray<FLeaf> Leaves;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Decode");
+
+		FReader Reader;
+		Reader.Ptr = Payload.GetData();
+		Reader.End = Payload.GetData() + Payload.Num();
+
+		Leaves.SetNum(Header.NumLeaves);
+		for (FLeaf& Leaf : Leaves)
+		{
+			Leaf.Min.X = Reader.ReadInt() * DATA_CHUNK_SIZE;
+			Leaf.Min.Y = Reader.ReadInt() * DATA_CHUNK_SIZE;
+			Leaf.Min.Z = Reader.ReadInt() * DATA_CHUNK_SIZE;
+			ReadXors(Reader, Leaf.Values);
+			ReadXors(Reader, Leaf.Materials);
+
+			if (Reader.bError || !PinnedData->IsInWorld(Leaf.Min.X, Leaf.Min.Y, Leaf.Min.Z))
+			{
+				Reader.bError = true;
+				break;
+			}
+		}
+
+		if (Reader.bError || Reader.Ptr != Reader.End)
+		{
+			LOG_VOXEL(Warning, TEXT("Edit replication: corrupted packet"));
+			return false;
+		}
+	}
+
+	VOXEL_ASYNC_SCOPE_COUNTER("Apply");
+	for (const FLeaf& Leaf : Leaves)
+	{
+		const FVoxelIntBox Bounds(Leaf.Min, Leaf.Min + DATA_CHUNK_SIZE);
+
+		FVoxelWriteScopeLock Lock(*PinnedData, Bounds, "Edit Replication");
+		FVoxelDataOctreeLeaf& OctreeLeaf = *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(PinnedData->GetOctree(), Leaf.Min.X, Leaf.Min.Y, Leaf.Min.Z);
+		ApplyXors(*PinnedData, OctreeLeaf, Leaf.Values);
+		ApplyXors(*PinnedData, OctreeLeaf, Leaf.Materials);
+
+		OutBoundsToUpdate.Add(Bounds);
+	}
+
+	return true;
+}
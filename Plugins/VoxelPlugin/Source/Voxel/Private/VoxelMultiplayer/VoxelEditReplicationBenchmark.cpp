@@ -0,0 +1,142 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelDiff.h"
+#include "VoxelData/VoxelBenchmarkUtilities.h"
+#include "VoxelMultiplayer/VoxelEditReplication.h"
+#include "HAL/IConsoleManager.h"
+
+// Loopback server and clients: bytes sent per edit, compared to a TVoxelDiff per edited voxel, and time to apply the packets
+// The second client only receives packets every few ticks, like a client with a slow connection
+namespace FVoxelEditReplicationBenchmark
+{
+	struct FClient
+	{
+		TVoxelSharedPtr<FVoxelData> Data;
+		TUniquePtr<FVoxelEditReplicationClient> Replication;
+		int32 ClientId = -1;
+		int32 ReceiveEveryNumTicks = 1;
+
+		int64 NumBytes = 0;
+		int32 NumPackets = 0;
+		double ApplyTime = 0;
+		double MaxApplyTime = 0;
+	};
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 Depth = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5, 1, 12);
+		const int32 NumTicks = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60);
+		const int32 EditsPerTick = FMath::Max(1, Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 4);
+
+		const TVoxelSharedRef<FVoxelData> ServerData = FVoxelBenchmarkUtilities::CreateData(Depth, true);
+		FVoxelEditReplicationServer Server(ServerData);
+
+		TArray<FClient> Clients;
+		Clients.SetNum(2);
+		for (int32 Index = 0; Index < Clients.Num(); Index++)
+		{
+			FClient& Client = Clients[Index];
+			Client.Data = FVoxelBenchmarkUtilities::CreateData(Depth, false);
+			Client.Replication = MakeUnique<FVoxelEditReplicationClient>(Client.Data.ToSharedRef());
+			Client.ClientId = Server.AddClient();
+			Client.ReceiveEveryNumTicks = Index == 0 ? 1 : 4;
+		}
+		Server.SetClientInvokers(Clients[0].ClientId, { FIntVector::ZeroValue });
+		Server.SetClientInvokers(Clients[1].ClientId, { ServerData->WorldBounds.Max / 2 });
+
+		const FVoxelIntBox& WorldBounds = ServerData->WorldBounds;
+
+		FRandomStream Stream(0);
+		int32 NumEdits = 0;
+		int64 NumEditedVoxels = 0;
+		TArray<uint8> Packet;
+		TArray<FVoxelIntBox> BoundsToUpdate;
+		for (int32 Tick = 0; Tick < NumTicks; Tick++)
+		{
+			for (int32 Edit = 0; Edit < EditsPerTick; Edit++)
+			{
+				// Edits close to each other, to also have leaves edited several times before being sent
+				const FIntVector Center(
+					Stream.RandRange(WorldBounds.Min.X / 2, WorldBounds.Max.X / 2 - 1),
+					Stream.RandRange(WorldBounds.Min.Y / 2, WorldBounds.Max.Y / 2 - 1),
+					Stream.RandRange(-4, 4));
+				NumEditedVoxels += FVoxelBenchmarkUtilities::DigSphere(*ServerData, Center, Stream.RandRange(4, 10), Edit == 0);
+				NumEdits++;
+			}
+
+			Server.Tick();
+
+			const bool bLastTick = Tick == NumTicks - 1;
+			for (FClient& Client : Clients)
+			{
+				if (!bLastTick && Tick % Client.ReceiveEveryNumTicks != 0)
+				{
+					continue;
+				}
+
+				while (Server.GetNextPacket(Client.ClientId, Packet))
+				{
+					Client.NumBytes += Packet.Num();
+					Client.NumPackets++;
+
+					const double StartTime = FPlatformTime::Seconds();
+					BoundsToUpdate.Reset();
+					ensure(Client.Replication->ApplyPacket(Packet, BoundsToUpdate));
+					const double Time = FPlatformTime::Seconds() - StartTime;
+
+					Client.ApplyTime += Time;
+					Client.MaxApplyTime = FMath::Max(Client.MaxApplyTime, Time);
+				}
+			}
+		}
+
+		// Each edited voxel as a TVoxelDiff, without counting the chunk positions
+		const int64 NumDiffBytes = NumEditedVoxels * (sizeof(FVoxelCellIndex) + sizeof(FVoxelValue));
+
+		LOG_VOXEL(Log, TEXT("Edit replication: %d edits of %lld voxels in total over %d ticks. A TVoxelDiff per voxel would be %lldB per edit"),
+			NumEdits,
+			NumEditedVoxels,
+			NumTicks,
+			NumDiffBytes / NumEdits);
+
+		for (int32 Index = 0; Index < Clients.Num(); Index++)
+		{
+			const FClient& Client = Clients[Index];
+
+			int32 NumMismatches = 0;
+			{
+				FVoxelReadScopeLock ServerLock(*ServerData, FVoxelIntBox::Infinite, "Edit Replication Benchmark");
+				FVoxelReadScopeLock ClientLock(*Client.Data, FVoxelIntBox::Infinite, "Edit Replication Benchmark");
+
+				FRandomStream SampleStream(1);
+				for (int32 Sample = 0; Sample < 100000; Sample++)
+				{
+					const FIntVector Position(
+						SampleStream.RandRange(WorldBounds.Min.X / 2 - 16, WorldBounds.Max.X / 2 + 15),
+						SampleStream.RandRange(WorldBounds.Min.Y / 2 - 16, WorldBounds.Max.Y / 2 + 15),
+						SampleStream.RandRange(-16, 15));
+
+					NumMismatches +=
+						ServerData->GetValue(Position, 0) != Client.Data->GetValue(Position, 0) ||
+						ServerData->GetMaterial(Position, 0) != Client.Data->GetMaterial(Position, 0);
+				}
+			}
+
+			LOG_VOXEL(Log, TEXT("Client %d (receiving every %d ticks): %lldB per edit (%.1f%% of TVoxelDiff), %d packets, apply %.3fms on average, %.3fms max. %d mismatches with the server"),
+				Index,
+				Client.ReceiveEveryNumTicks,
+				Client.NumBytes / NumEdits,
+				100. * Client.NumBytes / FMath::Max<int64>(1, NumDiffBytes),
+				Client.NumPackets,
+				Client.ApplyTime * 1000 / FMath::Max(1, Client.NumPackets),
+				Client.MaxApplyTime * 1000,
+				NumMismatches);
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkEditReplication(
+	TEXT("voxel.multiplayer.BenchmarkEditReplication"),
+	TEXT("Replicates random edits from a server data to two client datas over loopback, and reports the bytes per edit and the time to apply them. Args: [Depth = 5] [NumTicks = 60] [EditsPerTick = 4]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelEditReplicationBenchmark::Benchmark));
@@ -0,0 +1,5 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelPriorityHandler.h"
+
+FThreadSafeCounter64 FVoxelInvokersMovement::Clock;
@@ -45,6 +45,7 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 
 	, RenderType(InWorld->RenderType)
 	, RenderSharpness(FMath::Max(0, InWorld->RenderSharpness))
+	, bGreedyCubicMeshing(InWorld->bGreedyCubicMeshing)
 	, bCreateMaterialInstances(InPlayType == EVoxelPlayType::Game
 		? InWorld->bCreateMaterialInstances && !InWorld->bMergeChunks
 		: false /* we don't want to created dynamic material instances in editor */)
@@ -71,6 +72,10 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, MeshUpdatesBudget(InPlayType == EVoxelPlayType::Game
 		? FMath::Max(0.001f, InWorld->MeshUpdatesBudget)
 		: 1000)
+	, MeshUpdatesSizeBudget(InPlayType == EVoxelPlayType::Game && InWorld->MeshUpdatesSizeBudget > 0
+		? int64(InWorld->MeshUpdatesSizeBudget) * 1024
+		: MAX_int64)
+	, bStreamMeshUpdates(InWorld->bStreamMeshUpdates)
 
 	, HolesMaterials(InWorld->HolesMaterials)
 	, MaterialsMeshConfigs(InWorld->MaterialsMeshConfigs)
@@ -78,6 +83,7 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, bMergeChunks(InWorld->bMergeChunks)
 	, ChunksClustersSize(FMath::Max(RENDER_CHUNK_SIZE, InWorld->ChunksClustersSize))
 	, bDoNotMergeCollisionsAndNavmesh(InWorld->bMergeChunks && InWorld->bDoNotMergeCollisionsAndNavmesh)
+	, bPoolClustersBuffers(InWorld->bMergeChunks && InWorld->bPoolClustersBuffers)
 
 	, bStaticWorld(InPlayType == EVoxelPlayType::Game
 		? InWorld->bStaticWorld
@@ -112,7 +118,7 @@ IVoxelRenderer::IVoxelRenderer(const FVoxelRendererSettings& Settings)
 {
 }
 
-void IVoxelRenderer::SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities)
+void IVoxelRenderer::SetInvokersPositionsForPriorities(const TArray<FVoxelInvokerPath>& NewInvokersPositionsForPriorities)
 {
 	while (InvokersPositionsForPriorities->GetMax() < NewInvokersPositionsForPriorities.Num())
 	{
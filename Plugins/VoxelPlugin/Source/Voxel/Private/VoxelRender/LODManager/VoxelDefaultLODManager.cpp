@@ -4,6 +4,8 @@
 #include "VoxelRender/LODManager/VoxelRenderOctree.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelIntBox.h"
+#include "VoxelPriorityHandler.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
 #include "IVoxelPool.h"
 #include "VoxelWorldInterface.h"
 #include "VoxelComponents/VoxelInvokerComponent.h"
@@ -16,6 +18,12 @@ static TAutoConsoleVariable<int32> CVarFreezeLODs(
 	TEXT("Stops LOD manager tick"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarLogInvokersLODLatency(
+	TEXT("voxel.lod.LogInvokersLODLatency"),
+	0,
+	TEXT("If true, will log the time between an invoker entering a chunk and that chunk being shown at the invoker LODToSet. Use to tune LookAheadTime"),
+	ECVF_Default);
+
 TVoxelSharedRef<FVoxelDefaultLODManager> FVoxelDefaultLODManager::Create(
 	const FVoxelLODSettings& LODSettings,
 	TWeakObjectPtr<const AVoxelWorldInterface> VoxelWorldInterface,
@@ -161,9 +169,9 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 		Task->ReportBuildTime();
 		if (Task->NewOctree.IsValid()) // Make sure the new octree is valid before using it, else the ids will be out of sync
 		{
-			// Move Octree to OctreeToDelete so that we delete it async, without a huge cost on the game thread
-			ensure(!Task->OctreeToDelete.IsValid());
-			Task->OctreeToDelete = MoveTemp(Octree);
+			// Move Octree to SpareOctree so that the next update reuses it or deletes it async, without a huge cost on the game thread
+			ensure(!Task->SpareOctree.IsValid());
+			Task->SpareOctree = MoveTemp(Octree);
 			
 			Octree = Task->NewOctree;
 
@@ -177,11 +185,21 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 				Octree.Reset();
 				Task->NewOctree.Reset();
 				Task->OldOctree.Reset();
+				Task->SpareOctree.Reset();
 				StopTicking();
 			}
 		}
 		bAsyncTaskWorking = false;
 	}
+
+	if (CVarLogInvokersLODLatency.GetValueOnGameThread() != 0)
+	{
+		UpdateInvokersLODLatencies();
+	}
+	else if (InvokersLODLatencies.Num() > 0)
+	{
+		InvokersLODLatencies.Reset();
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -257,6 +275,11 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component moved"));
 					bNeedUpdate = true;
 				}
+				else if (FVoxelUtilities::SquaredSize(OldSettings.PredictedOffset - NewSettings.PredictedOffset) > SquaredDistanceThreshold)
+				{
+					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component velocity changed"));
+					bNeedUpdate = true;
+				}
 			}
 		}
 	}
@@ -271,12 +294,12 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 		SortedInvokerComponents = MoveTemp(NewSortedInvokerComponents);
 		InvokerComponentsInfos = MoveTemp(NewInvokerComponentsInfos);
 
-		TArray<FIntVector> InvokersPositionsForPriorities;
+		TArray<FVoxelInvokerPath> InvokersPositionsForPriorities;
 		for (auto& It : InvokerComponentsInfos)
 		{
 			if (It.Key->bUseForPriorities)
 			{
-				InvokersPositionsForPriorities.Add(It.Value.LocalPosition);
+				InvokersPositionsForPriorities.Add({ It.Value.LocalPosition, It.Value.Settings.PredictedOffset });
 			}
 		}
 		Settings.Renderer->SetInvokersPositionsForPriorities(InvokersPositionsForPriorities);
@@ -334,6 +357,78 @@ void FVoxelDefaultLODManager::UpdateLODs()
 	bAsyncTaskWorking = true;
 }
 
+void FVoxelDefaultLODManager::UpdateInvokersLODLatencies()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!VoxelWorldInterface.IsValid())
+	{
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds();
+
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FInvokerLODLatency> NewInvokersLODLatencies;
+	for (const auto& It : InvokerComponentsInfos)
+	{
+		const FVoxelInvokerInfo& Info = It.Value;
+		if (!It.Key.IsValid() || !Info.Settings.bUseForLOD)
+		{
+			continue;
+		}
+
+		// Not Info.LocalPosition, as it's only updated once the invoker moved by more than InvokerDistanceThreshold
+		const FIntVector Position = It.Key->GetInvokerVoxelPosition(VoxelWorldInterface.Get());
+		const int32 LOD = FMath::Clamp(Info.Settings.LODToSet, DynamicSettings->MinLOD, DynamicSettings->MaxLOD);
+		const FIntVector ChunkKey = FVoxelUtilities::DivideFloor(Position, RENDER_CHUNK_SIZE << LOD);
+
+		FInvokerLODLatency Latency = InvokersLODLatencies.FindRef(It.Key);
+		if (Latency.LOD != LOD || Latency.ChunkKey != ChunkKey)
+		{
+			if (Latency.LOD != -1 && !Latency.bShown)
+			{
+				NumChunksLeftBeforeLOD++;
+				LOG_VOXEL(Log, TEXT("%s left chunk %s before it was shown at LOD %d (%d chunks left early so far)"),
+					*It.Key->GetName(),
+					*(Latency.ChunkKey * (RENDER_CHUNK_SIZE << Latency.LOD)).ToString(),
+					Latency.LOD,
+					NumChunksLeftBeforeLOD);
+			}
+
+			Latency.ChunkKey = ChunkKey;
+			Latency.LOD = LOD;
+			Latency.EnterTime = Time;
+			Latency.bShown = false;
+		}
+
+		if (!Latency.bShown && Octree.IsValid() && Octree->IsInOctree(Position))
+		{
+			const FVoxelRenderOctree* Chunk = Octree.Get();
+			while (Chunk->HasChildren())
+			{
+				Chunk = &Chunk->GetChild(Position);
+			}
+
+			if (Chunk->Height <= LOD && Chunk->GetSettings().bVisible && Settings.Renderer->IsChunkShown(Chunk->ChunkId))
+			{
+				Latency.bShown = true;
+				NumLODLatencies++;
+				TotalLODLatency += Time - Latency.EnterTime;
+				LOG_VOXEL(Log, TEXT("%s: chunk %s shown at LOD %d after %.1fms (average: %.1fms over %d chunks)"),
+					*It.Key->GetName(),
+					*(ChunkKey * (RENDER_CHUNK_SIZE << LOD)).ToString(),
+					Chunk->Height,
+					(Time - Latency.EnterTime) * 1000,
+					TotalLODLatency / NumLODLatencies * 1000,
+					NumLODLatencies);
+			}
+		}
+
+		NewInvokersLODLatencies.Add(It.Key, Latency);
+	}
+	InvokersLODLatencies = MoveTemp(NewInvokersLODLatencies);
+}
+
 void FVoxelDefaultLODManager::ClearInvokerComponents()
 {
 	SortedInvokerComponents.Reset();
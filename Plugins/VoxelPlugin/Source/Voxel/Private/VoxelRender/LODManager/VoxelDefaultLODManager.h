@@ -85,8 +85,23 @@ private:
 	double LastLODUpdateTime = 0;
 	double LastInvokersUpdateTime = 0;
 
+	// See voxel.lod.LogInvokersLODLatency
+	struct FInvokerLODLatency
+	{
+		// Position of the chunk of size RENDER_CHUNK_SIZE << LOD the invoker is in, divided by its size
+		FIntVector ChunkKey{ ForceInit };
+		int32 LOD = -1;
+		double EnterTime = 0;
+		bool bShown = false;
+	};
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FInvokerLODLatency> InvokersLODLatencies;
+	int32 NumLODLatencies = 0;
+	int32 NumChunksLeftBeforeLOD = 0;
+	double TotalLODLatency = 0;
+
 	void UpdateInvokers();
 	void UpdateLODs();
+	void UpdateInvokersLODLatencies();
 
 	void ClearInvokerComponents();
 };
\ No newline at end of file
@@ -20,6 +20,163 @@ static TAutoConsoleVariable<int32> CVarLogRenderOctreeBuildTime(
 	TEXT("If true, will log the render octree build times"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarIncrementalRenderOctree(
+	TEXT("voxel.renderer.IncrementalRenderOctree"),
+	1,
+	TEXT("If true, LOD updates will only revisit the render octree nodes close to the invokers that changed, and will reuse the previous octree instead of cloning the current one"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarValidateIncrementalRenderOctree(
+	TEXT("voxel.renderer.ValidateIncrementalRenderOctree"),
+	0,
+	TEXT("If true, incremental render octree updates will also be done on the whole octree, and the chunk updates will be checked to be the same. Slow"),
+	ECVF_Default);
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelRenderOctreeSettings::HasSameSettingsExceptInvokers(const FVoxelRenderOctreeSettings& Other) const
+{
+	return
+		MinLOD == Other.MinLOD &&
+		MaxLOD == Other.MaxLOD &&
+		WorldBounds == Other.WorldBounds &&
+		ChunksCullingLOD == Other.ChunksCullingLOD &&
+		bEnableRender == Other.bEnableRender &&
+		bEnableTransitions == Other.bEnableTransitions &&
+		bInvertTransitions == Other.bInvertTransitions &&
+		bEnableCollisions == Other.bEnableCollisions &&
+		bComputeVisibleChunksCollisions == Other.bComputeVisibleChunksCollisions &&
+		VisibleChunksCollisionsMaxLOD == Other.VisibleChunksCollisionsMaxLOD &&
+		bEnableNavmesh == Other.bEnableNavmesh &&
+		bComputeVisibleChunksNavmesh == Other.bComputeVisibleChunksNavmesh &&
+		VisibleChunksNavmeshMaxLOD == Other.VisibleChunksNavmeshMaxLOD;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelRenderOctreeDirtyRegion FVoxelRenderOctreeDirtyRegion::Create(const FVoxelRenderOctreeSettings& OldSettings, const FVoxelRenderOctreeSettings& NewSettings)
+{
+	FVoxelRenderOctreeDirtyRegion DirtyRegion;
+	if (!OldSettings.HasSameSettingsExceptInvokers(NewSettings))
+	{
+		return DirtyRegion;
+	}
+	DirtyRegion.bAll = false;
+
+	// The subdivisions are an OR over all the invokers, so any pairing of the old and new invokers works
+	const int32 NumInvokers = FMath::Max(OldSettings.Invokers.Num(), NewSettings.Invokers.Num());
+	for (int32 Index = 0; Index < NumInvokers; Index++)
+	{
+		const FVoxelInvokerSettings Unused;
+		const bool bHasOld = OldSettings.Invokers.IsValidIndex(Index);
+		const bool bHasNew = NewSettings.Invokers.IsValidIndex(Index);
+		const FVoxelInvokerSettings& Old = bHasOld ? OldSettings.Invokers[Index] : Unused;
+		const FVoxelInvokerSettings& New = bHasNew ? NewSettings.Invokers[Index] : Unused;
+
+		// The difference of two swept boxes isn't the difference of their bounds: use the whole paths if one of them is swept
+		const bool bLODDifference =
+			Old.LODToSet == New.LODToSet &&
+			Old.PredictedOffset == FIntVector::ZeroValue &&
+			New.PredictedOffset == FIntVector::ZeroValue;
+		AddChange(DirtyRegion.LODChanges, bHasOld && Old.bUseForLOD, Old.GetLODPathBounds(), bHasNew && New.bUseForLOD, New.GetLODPathBounds(), bLODDifference);
+		AddChange(DirtyRegion.CollisionsAndNavmeshChanges, bHasOld && Old.bUseForCollisions, Old.CollisionsBounds, bHasNew && New.bUseForCollisions, New.CollisionsBounds, true);
+		AddChange(DirtyRegion.CollisionsAndNavmeshChanges, bHasOld && Old.bUseForNavmesh, Old.NavmeshBounds, bHasNew && New.bUseForNavmesh, New.NavmeshBounds, true);
+	}
+
+	return DirtyRegion;
+}
+
+bool FVoxelRenderOctreeDirtyRegion::IsDirty(const FVoxelIntBox& Bounds, uint32 Size) const
+{
+	if (bAll)
+	{
+		return true;
+	}
+
+	// A change of the subdivision by distance can make the neighbors subdivide, each one at least twice as big as the previous one,
+	// and can change the transitions of the chunks next to them. With inverted transitions, a chunk depends on bigger neighbors,
+	// which are up to twice its size and can be changed by nodes twice as far: nodes further than 4 times their size are not affected
+	const int64 NeighborsExtent = 4 * int64(Size);
+	for (const FChange& Change : LODChanges)
+	{
+		if (Change.Intersect(Bounds, NeighborsExtent))
+		{
+			return true;
+		}
+	}
+	for (const FChange& Change : CollisionsAndNavmeshChanges)
+	{
+		if (Change.Intersect(Bounds, 0))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FVoxelRenderOctreeDirtyRegion::FChange::Intersect(const FVoxelIntBox& InBounds, int64 Extent) const
+{
+	// Same as FVoxelIntBox::Intersect, which is true for empty invoker bounds inside the node
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (InBounds.Min[Axis] - Extent >= Bounds.Max[Axis] || Bounds.Min[Axis] >= InBounds.Max[Axis] + Extent)
+		{
+			return false;
+		}
+	}
+
+	if (!bHasOtherBounds)
+	{
+		return true;
+	}
+
+	// Both bounds are valid, so the overlap is not empty
+	int64 Min[3];
+	int64 Max[3];
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Min[Axis] = FMath::Max<int64>(InBounds.Min[Axis] - Extent, Bounds.Min[Axis]);
+		Max[Axis] = FMath::Min<int64>(InBounds.Max[Axis] + Extent, Bounds.Max[Axis]);
+	}
+
+	// The overlap is a box: it has points outside of OtherBounds unless OtherBounds contains it
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (Min[Axis] < OtherBounds.Min[Axis] || Max[Axis] > OtherBounds.Max[Axis])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FVoxelRenderOctreeDirtyRegion::AddChange(TArray<FChange>& Changes, bool bOldUsed, const FVoxelIntBox& OldBounds, bool bNewUsed, const FVoxelIntBox& NewBounds, bool bUseDifference)
+{
+	if (bOldUsed && bNewUsed && bUseDifference && OldBounds.IsValid() && NewBounds.IsValid())
+	{
+		// Only the nodes in one of the bounds but not in the other one are affected
+		if (OldBounds != NewBounds)
+		{
+			Changes.Add({ OldBounds, NewBounds, true });
+			Changes.Add({ NewBounds, OldBounds, true });
+		}
+		return;
+	}
+
+	if (bOldUsed)
+	{
+		Changes.Add({ OldBounds, {}, false });
+	}
+	if (bNewUsed)
+	{
+		Changes.Add({ NewBounds, {}, false });
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -78,12 +235,6 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 	LOG_TIME_IMPL("Waiting in thread pool", Counter);
 
 	double WorkStartTime = FPlatformTime::Seconds();
-	
-	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Deleting previous octree");
-		OctreeToDelete.Reset();
-		LOG_TIME("Deleting previous octree");
-	}
 
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Resetting arrays");
@@ -91,23 +242,114 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 		NewOctree.Reset();
 		LOG_TIME("Resetting arrays");
 	}
+
+	// The changed nodes of the last update are only valid if it was done on OldOctree
+	const bool bIncremental =
+		CVarIncrementalRenderOctree.GetValueOnAnyThread() != 0 &&
+		OldOctree.IsValid() &&
+		LastNewOctree.Pin() == OldOctree;
 	
+	const FVoxelRenderOctreeDirtyRegion DirtyRegion = bIncremental
+		? FVoxelRenderOctreeDirtyRegion::Create(LastOctreeSettings, OctreeSettings)
+		: FVoxelRenderOctreeDirtyRegion();
+	Log += "; Incremental: " + FString(bIncremental ? "true" : "false");
+
+	if (bIncremental && SpareOctree.IsValid())
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Copying changed nodes");
+		SpareOctree->CopyChangedNodes(*OldOctree, LastChangedNodes);
+		NewOctree = MoveTemp(SpareOctree);
+		LOG_TIME("Copying changed nodes");
+		Log += "; Copied nodes: " + FString::FromInt(LastChangedNodes.Num());
+	}
+	else
+	{
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Deleting previous octree");
+			SpareOctree.Reset();
+			LOG_TIME("Deleting previous octree");
+		}
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Cloning octree");
+			NewOctree = OldOctree.IsValid() ? MakeVoxelShared<FVoxelRenderOctree>(&*OldOctree) : MakeVoxelShared<FVoxelRenderOctree>(OctreeDepth);
+			LOG_TIME("Cloning octree");
+		}
+	}
+
+	TArray<FVoxelOctreeId> ChangedNodes;
+	const bool bChanged = UpdateOctree(*NewOctree, DirtyRegion, ChunkUpdates, ChangedNodes);
+	
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Sort By LODs");
+		// Make sure that LOD 0 chunks are processed first
+		ChunkUpdates.Sort([](const auto& A, const auto& B) { return A.LOD < B.LOD; });
+		LOG_TIME("Sort By LODs");
+	}
+
+	if (!DirtyRegion.bAll && CVarValidateIncrementalRenderOctree.GetValueOnAnyThread() && !NewOctree->IsCanceled())
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Cloning octree");
-		NewOctree = OldOctree.IsValid() ? MakeVoxelShared<FVoxelRenderOctree>(&*OldOctree) : MakeVoxelShared<FVoxelRenderOctree>(OctreeDepth);
-		LOG_TIME("Cloning octree");
+		VOXEL_ASYNC_SCOPE_COUNTER("Validating incremental update");
+		ValidateIncrementalUpdate(DirtyRegion);
+		LOG_TIME("Validating incremental update");
 	}
+
+	if (OldOctree.IsValid())
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Find previous chunks");
+		for (auto& ChunkUpdate : ChunkUpdates)
+		{
+			if (ChunkUpdate.NewSettings.bVisible && !ChunkUpdate.OldSettings.bVisible)
+			{
+				OldOctree->GetVisibleChunksOverlappingBounds(ChunkUpdate.Bounds, ChunkUpdate.PreviousChunks);
+			}
+		}
+	}
+	LOG_TIME("Find previous chunks");
 	
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Deleting old octree");
+		OldOctree.Reset();
+		LOG_TIME("Deleting old octree");
+	}
+
+	NumberOfChunks = NewOctree->CurrentChunksCount;
+	bTooManyChunks = NewOctree->IsCanceled();
+
+	if (bTooManyChunks)
+	{
+		NewOctree.Reset();
+		LastNewOctree.Reset();
+		LastChangedNodes.Reset();
+	}
+	else
+	{
+		LastNewOctree = NewOctree;
+		LastOctreeSettings = OctreeSettings;
+		LastChangedNodes = MoveTemp(ChangedNodes);
+	}
+
+	LOG_TIME_IMPL("Total time working", WorkStartTime);
+}
+
+bool FVoxelRenderOctreeAsyncBuilder::UpdateOctree(
+	FVoxelRenderOctree& Octree,
+	const FVoxelRenderOctreeDirtyRegion& DirtyRegion,
+	TArray<FVoxelChunkUpdate>& OutChunkUpdates,
+	TArray<FVoxelOctreeId>& OutChangedNodes)
+{
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("ResetDivisionType");
-		NewOctree->ResetDivisionType();
+		// The root is always revisited
+		Octree.ChunkSettings.bDirty = true;
+		const int32 NumDirtyNodes = Octree.ResetDivisionType(DirtyRegion);
 		LOG_TIME("ResetDivisionType");
+		Log += "; Revisited nodes: " + FString::FromInt(NumDirtyNodes) + "/" + FString::FromInt(Octree.CurrentChunksCount);
 	}
 
 	bool bChanged;
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("UpdateSubdividedByDistance");
-		bChanged = NewOctree->UpdateSubdividedByDistance(OctreeSettings);
+		bChanged = Octree.UpdateSubdividedByDistance(OctreeSettings);
 		LOG_TIME("UpdateSubdividedByDistance");
 		Log += "; Need to recompute neighbors: " + FString(bChanged ? "true" : "false");
 	}
@@ -116,69 +358,84 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("UpdateSubdividedByNeighbors");
 		int32 UpdateSubdividedByNeighborsCounter = 0;
-		while (NewOctree->UpdateSubdividedByNeighbors(OctreeSettings)) { UpdateSubdividedByNeighborsCounter++; }
+		while (Octree.UpdateSubdividedByNeighbors(OctreeSettings)) { UpdateSubdividedByNeighborsCounter++; }
 		LOG_TIME("UpdateSubdividedByNeighbors");
 		Log += "; Iterations: " + FString::FromInt(UpdateSubdividedByNeighborsCounter);
 	}
 	else
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("ReuseOldNeighbors");
-		NewOctree->ReuseOldNeighbors();
+		Octree.ReuseOldNeighbors();
 	}
 	
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("UpdateSubdividedByOthers");
-		NewOctree->UpdateSubdividedByOthers(OctreeSettings);
+		Octree.UpdateSubdividedByOthers(OctreeSettings);
 		LOG_TIME("UpdateSubdividedByOthers");
 	}
 	
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("DeleteChunks");
-		NewOctree->DeleteChunks(ChunkUpdates);
+		Octree.DeleteChunks(OutChunkUpdates);
 		LOG_TIME("DeleteChunks");
 	}
 	
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("GetUpdates");
-		NewOctree->GetUpdates(NewOctree->UpdateIndex + 1, bChanged, OctreeSettings, ChunkUpdates);
+		Octree.UpdateIndex++;
+		Octree.GetUpdates(bChanged, OctreeSettings, OutChunkUpdates, OutChangedNodes);
 		LOG_TIME("GetUpdates");
+		Log += "; Changed nodes: " + FString::FromInt(OutChangedNodes.Num());
 	}
-	
+
+	return bChanged;
+}
+
+void FVoxelRenderOctreeAsyncBuilder::ValidateIncrementalUpdate(const FVoxelRenderOctreeDirtyRegion& DirtyRegion)
+{
+	check(OldOctree.IsValid());
+
+	const FString IncrementalLog = Log;
+
+	const TVoxelSharedRef<FVoxelRenderOctree> FullOctree = MakeVoxelShared<FVoxelRenderOctree>(&*OldOctree);
+	TArray<FVoxelChunkUpdate> FullChunkUpdates;
+	TArray<FVoxelOctreeId> FullChangedNodes;
+	UpdateOctree(*FullOctree, FVoxelRenderOctreeDirtyRegion(), FullChunkUpdates, FullChangedNodes);
+	FullChunkUpdates.Sort([](const auto& A, const auto& B) { return A.LOD < B.LOD; });
+
+	Log = IncrementalLog;
+
+	if (FullOctree->IsCanceled())
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Sort By LODs");
-		// Make sure that LOD 0 chunks are processed first
-		ChunkUpdates.Sort([](const auto& A, const auto& B) { return A.LOD < B.LOD; });
-		LOG_TIME("Sort By LODs");
+		return;
 	}
 
-	if (OldOctree.IsValid())
+	const auto IsSameUpdate = [](const FVoxelChunkUpdate& A, const FVoxelChunkUpdate& B)
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Find previous chunks");
-		for (auto& ChunkUpdate : ChunkUpdates)
-		{
-			if (ChunkUpdate.NewSettings.bVisible && !ChunkUpdate.OldSettings.bVisible)
-			{
-				OldOctree->GetVisibleChunksOverlappingBounds(ChunkUpdate.Bounds, ChunkUpdate.PreviousChunks);
-			}
-		}
-	}
-	LOG_TIME("Find previous chunks");
-	
+		return
+			A.Id == B.Id &&
+			A.LOD == B.LOD &&
+			A.Bounds == B.Bounds &&
+			A.OldSettings == B.OldSettings &&
+			A.NewSettings == B.NewSettings;
+	};
+
+	bool bSame =
+		FullChunkUpdates.Num() == ChunkUpdates.Num() &&
+		FullOctree->CurrentChunksCount == NewOctree->CurrentChunksCount;
+	for (int32 Index = 0; bSame && Index < ChunkUpdates.Num(); Index++)
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Deleting old octree");
-		OldOctree.Reset();
-		LOG_TIME("Deleting old octree");
+		bSame = IsSameUpdate(FullChunkUpdates[Index], ChunkUpdates[Index]);
 	}
 
-	NumberOfChunks = NewOctree->CurrentChunksCount;
-	bTooManyChunks = NewOctree->IsCanceled();
-
-	if (bTooManyChunks)
+	if (!bSame)
 	{
-		NewOctree.Reset();
+		LOG_VOXEL(Error, TEXT("Incremental render octree update differs from the full update: %d/%d chunk updates, %d/%d nodes (incremental/full)"),
+			ChunkUpdates.Num(),
+			FullChunkUpdates.Num(),
+			NewOctree->CurrentChunksCount,
+			FullOctree->CurrentChunksCount);
 	}
-
-	LOG_TIME_IMPL("Total time working", WorkStartTime);
 }
 
 uint32 FVoxelRenderOctreeAsyncBuilder::GetPriority() const
@@ -234,11 +491,8 @@ FVoxelRenderOctree::FVoxelRenderOctree(const FVoxelRenderOctree* Source)
 FVoxelRenderOctree::FVoxelRenderOctree(const FVoxelRenderOctree& Parent, uint8 ChildIndex)
 	: TSimpleVoxelOctree(Parent, ChildIndex)
 	, Root(Parent.Root)
-	, ChunkId(GetId())
 	, OctreeBounds(GetBounds())
-	, UpdateIndex(Parent.UpdateIndex)
 {
-	check(ChunkId <= Root->RootIdCounter);
 	Root->CurrentChunksCount++;
 
 	INC_DWORD_STAT_BY(STAT_VoxelRenderOctreesCount, 1);
@@ -251,7 +505,6 @@ FVoxelRenderOctree::FVoxelRenderOctree(const FVoxelRenderOctree& Parent, uint8 C
 	, Root(Parent.Root)
 	, ChunkId(SourceChildren[ChildIndex].ChunkId)
 	, OctreeBounds(GetBounds())
-	, UpdateIndex(Parent.UpdateIndex)
 {
 	Root->CurrentChunksCount++;
 
@@ -275,32 +528,41 @@ FVoxelRenderOctree::~FVoxelRenderOctree()
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelRenderOctree::ResetDivisionType()
+int32 FVoxelRenderOctree::ResetDivisionType(const FVoxelRenderOctreeDirtyRegion& DirtyRegion)
 {
+	checkVoxelSlow(ChunkSettings.bDirty);
+	
 	ChunkSettings.OldDivisionType = ChunkSettings.DivisionType;
 	ChunkSettings.DivisionType = EDivisionType::Uninitialized;
 
+	int32 NumDirtyNodes = 1;
 	if (!!HasChildren())
 	{
 		for (auto& Child : GetChildren())
 		{
-			Child.ResetDivisionType();
+			// Clean children are skipped by all the updates, so their children flags don't need to be set
+			Child.ChunkSettings.bDirty = DirtyRegion.IsDirty(Child.OctreeBounds, Child.Size());
+			if (Child.ChunkSettings.bDirty)
+			{
+				NumDirtyNodes += Child.ResetDivisionType(DirtyRegion);
+			}
 		}
 	}
+	return NumDirtyNodes;
 }
 
 bool FVoxelRenderOctree::UpdateSubdividedByDistance(const FVoxelRenderOctreeSettings& Settings)
 {
 	CHECK_MAX_CHUNKS_COUNT_BOOL();
+
+	if (!ChunkSettings.bDirty)
+	{
+		return false;
+	}
 	
 	if (ShouldSubdivideByDistance(Settings))
 	{
-		ChunkSettings.DivisionType = EDivisionType::ByDistance;
-		
-		if (!HasChildren())
-		{
-			CreateChildren();
-		}
+		Subdivide(EDivisionType::ByDistance);
 		
 		bool bChanged = ChunkSettings.OldDivisionType != EDivisionType::ByDistance;
 		for (auto& Child : GetChildren())
@@ -320,16 +582,16 @@ bool FVoxelRenderOctree::UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSet
 {
 	CHECK_MAX_CHUNKS_COUNT_BOOL();
 
+	if (!ChunkSettings.bDirty)
+	{
+		return false;
+	}
+
 	bool bShouldContinue = false;
 
 	if (ChunkSettings.DivisionType == EDivisionType::Uninitialized && ShouldSubdivideByNeighbors(Settings))
 	{
-		ChunkSettings.DivisionType = EDivisionType::ByNeighbors;
-		
-		if (!HasChildren())
-		{
-			CreateChildren();
-		}
+		Subdivide(EDivisionType::ByNeighbors);
 
 		bShouldContinue = true;
 	}
@@ -347,6 +609,11 @@ bool FVoxelRenderOctree::UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSet
 
 void FVoxelRenderOctree::ReuseOldNeighbors()
 {
+	if (!ChunkSettings.bDirty)
+	{
+		return;
+	}
+
 	if (ChunkSettings.OldDivisionType == EDivisionType::ByNeighbors)
 	{
 		ChunkSettings.DivisionType = EDivisionType::ByNeighbors;
@@ -365,14 +632,14 @@ void FVoxelRenderOctree::UpdateSubdividedByOthers(const FVoxelRenderOctreeSettin
 {
 	CHECK_MAX_CHUNKS_COUNT();
 
-	if (ChunkSettings.DivisionType == EDivisionType::Uninitialized && ShouldSubdivideByOthers(Settings))
+	if (!ChunkSettings.bDirty)
 	{
-		ChunkSettings.DivisionType = EDivisionType::ByOthers;
+		return;
+	}
 
-		if (!HasChildren())
-		{
-			CreateChildren();
-		}
+	if (ChunkSettings.DivisionType == EDivisionType::Uninitialized && ShouldSubdivideByOthers(Settings))
+	{
+		Subdivide(EDivisionType::ByOthers);
 	}
 
 	if (ChunkSettings.DivisionType != EDivisionType::Uninitialized)
@@ -388,14 +655,23 @@ void FVoxelRenderOctree::DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates)
 {
 	CHECK_MAX_CHUNKS_COUNT();
 
+	if (!ChunkSettings.bDirty)
+	{
+		// Nothing to delete: same as after the previous update
+		return;
+	}
+
 	if (ChunkSettings.DivisionType == EDivisionType::Uninitialized)
 	{		
 		if (HasChildren())
 		{
 			for (auto& Child : GetChildren())
 			{
-				ensure(Child.ChunkSettings.DivisionType == EDivisionType::Uninitialized);
-				
+				ensure(!Child.ChunkSettings.bDirty || Child.ChunkSettings.DivisionType == EDivisionType::Uninitialized);
+
+				// Clean children were not reset, but are deleted all the same
+				Child.ChunkSettings.bDirty = true;
+				Child.ChunkSettings.DivisionType = EDivisionType::Uninitialized;
 				Child.DeleteChunks(ChunkUpdates);
 				
 				if (Child.ChunkSettings.Settings.HasRenderChunk())
@@ -428,16 +704,26 @@ void FVoxelRenderOctree::DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates)
 ///////////////////////////////////////////////////////////////////////////////
 
 void FVoxelRenderOctree::GetUpdates(
-	uint32 InUpdateIndex,
 	bool bRecomputeTransitionMasks,
 	const FVoxelRenderOctreeSettings& Settings,
 	TArray<FVoxelChunkUpdate>& ChunkUpdates,
+	TArray<FVoxelOctreeId>& ChangedNodes,
 	bool bInVisible)
 {
 	CHECK_MAX_CHUNKS_COUNT();
 
-	UpdateIndex++;
-	check(UpdateIndex == InUpdateIndex);
+	if (!ChunkSettings.bDirty)
+	{
+		// Same settings as after the previous update
+		return;
+	}
+
+	if (ChunkId == 0)
+	{
+		// Assigned in the same order whether the update is incremental or not
+		ChunkId = GetId();
+	}
+	check(ChunkId <= Root->RootIdCounter);
 
 	if (!OctreeBounds.Intersect(Settings.WorldBounds))
 	{
@@ -471,7 +757,7 @@ void FVoxelRenderOctree::GetUpdates(
 
 		for (auto& Child : GetChildren())
 		{
-			Child.GetUpdates(UpdateIndex, bRecomputeTransitionMasks, Settings, ChunkUpdates, bChildrenVisible);
+			Child.GetUpdates(bRecomputeTransitionMasks, Settings, ChunkUpdates, ChangedNodes, bChildrenVisible);
 		}
 	}
 
@@ -543,10 +829,55 @@ void FVoxelRenderOctree::GetUpdates(
 				{}
 			});
 	}
+
+	if (ChunkSettings.Settings != NewSettings || ChunkSettings.DivisionType != ChunkSettings.OldDivisionType)
+	{
+		ChangedNodes.Add({ Position, Height });
+	}
 	
 	ChunkSettings.Settings = NewSettings;
 }
 
+void FVoxelRenderOctree::CopyChangedNodes(const FVoxelRenderOctree& Source, TArray<FVoxelOctreeId> ChangedNodes)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	check(Root == this && Source.Root == &Source && Height == Source.Height);
+
+	RootIdCounter = Source.RootIdCounter;
+	UpdateIndex = Source.UpdateIndex;
+
+	// Parents first, so that the children they create are copied whole
+	ChangedNodes.Sort([](const FVoxelOctreeId& A, const FVoxelOctreeId& B) { return A.Height > B.Height; });
+
+	for (const FVoxelOctreeId& Id : ChangedNodes)
+	{
+		const FVoxelRenderOctree* SourceNode = Source.FindNode(Id);
+		FVoxelRenderOctree* Node = const_cast<FVoxelRenderOctree*>(FindNode(Id));
+		if (!SourceNode)
+		{
+			// Deleted along with its parent
+			ensure(!Node);
+			continue;
+		}
+		if (!ensure(Node))
+		{
+			continue;
+		}
+
+		Node->ChunkSettings = SourceNode->ChunkSettings;
+
+		if (SourceNode->HasChildren() && !Node->HasChildren())
+		{
+			Node->CreateChildren(SourceNode->GetChildren());
+		}
+		else if (!SourceNode->HasChildren() && Node->HasChildren())
+		{
+			Node->DestroyChildren();
+		}
+	}
+}
+
 void FVoxelRenderOctree::GetChunksToUpdateForBounds(const FVoxelIntBox& Bounds, TArray<uint64>& ChunksToUpdate, const FVoxelOnChunkUpdate& OnChunkUpdate) const
 {
 	if (!OctreeBounds.Intersect(Bounds))
@@ -623,7 +954,7 @@ bool FVoxelRenderOctree::ShouldSubdivideByDistance(const FVoxelRenderOctreeSetti
 
 	for (auto& Invoker : Settings.Invokers)
 	{
-		if (Invoker.bUseForLOD && OctreeBounds.Intersect(Invoker.LODBounds) && Height > Invoker.LODToSet)
+		if (Invoker.bUseForLOD && Height > Invoker.LODToSet && Invoker.IntersectLODPath(OctreeBounds))
 		{
 			return true;
 		}
@@ -702,9 +1033,14 @@ bool FVoxelRenderOctree::ShouldSubdivideByOthers(const FVoxelRenderOctreeSetting
 
 ///////////////////////////////////////////////////////////////////////////////
 
+inline bool IsVisibleDivision(FVoxelRenderOctree::EDivisionType DivisionType)
+{
+	return DivisionType == FVoxelRenderOctree::EDivisionType::ByDistance || DivisionType == FVoxelRenderOctree::EDivisionType::ByNeighbors;
+}
+
 inline bool IsVisibleParent(const FVoxelRenderOctree* Chunk)
 {
-	return Chunk->ChunkSettings.DivisionType == FVoxelRenderOctree::EDivisionType::ByDistance || Chunk->ChunkSettings.DivisionType == FVoxelRenderOctree::EDivisionType::ByNeighbors;
+	return IsVisibleDivision(Chunk->ChunkSettings.DivisionType);
 }
 
 const FVoxelRenderOctree* FVoxelRenderOctree::GetVisibleAdjacentChunk(EVoxelDirectionFlag::Type Direction, int32 Index) const
@@ -776,6 +1112,48 @@ const FVoxelRenderOctree* FVoxelRenderOctree::GetVisibleAdjacentChunk(EVoxelDire
 	}
 }
 
+const FVoxelRenderOctree* FVoxelRenderOctree::FindNode(const FVoxelOctreeId& Id) const
+{
+	const FVoxelRenderOctree* Node = this;
+	while (Node->Height > Id.Height)
+	{
+		if (!Node->HasChildren())
+		{
+			return nullptr;
+		}
+		Node = &Node->GetChild(Id.Position);
+	}
+	ensure(Node->Position == Id.Position && Node->Height == Id.Height);
+	return Node;
+}
+
+void FVoxelRenderOctree::Subdivide(EDivisionType DivisionType)
+{
+	ChunkSettings.DivisionType = DivisionType;
+
+	if (!HasChildren())
+	{
+		CreateChildren();
+	}
+	else if (IsVisibleDivision(DivisionType) != IsVisibleDivision(ChunkSettings.OldDivisionType))
+	{
+		// The children were visible chunks and are now hidden, or the other way around: they all need to be updated
+		ResetCleanChildren();
+	}
+}
+
+void FVoxelRenderOctree::ResetCleanChildren()
+{
+	for (auto& Child : GetChildren())
+	{
+		if (!Child.ChunkSettings.bDirty)
+		{
+			Child.ChunkSettings.bDirty = true;
+			Child.ResetDivisionType(FVoxelRenderOctreeDirtyRegion());
+		}
+	}
+}
+
 template<typename T1, typename T2>
 bool FVoxelRenderOctree::IsInvokerInRange(const TArray<FVoxelInvokerSettings>& Invokers, T1 SelectInvoker, T2 GetInvokerBounds) const
 {
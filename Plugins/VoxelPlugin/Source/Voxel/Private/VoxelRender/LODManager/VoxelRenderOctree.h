@@ -6,6 +6,7 @@
 #include "VoxelIntBox.h"
 #include "VoxelMinimal.h"
 #include "VoxelDirection.h"
+#include "VoxelOctreeId.h"
 #include "VoxelSimpleOctree.h"
 #include "VoxelAsyncWork.h"
 #include "VoxelInvokerSettings.h"
@@ -41,6 +42,36 @@ struct FVoxelRenderOctreeSettings
 	bool bEnableNavmesh;
 	bool bComputeVisibleChunksNavmesh;
 	int32 VisibleChunksNavmeshMaxLOD;
+
+	bool HasSameSettingsExceptInvokers(const FVoxelRenderOctreeSettings& Other) const;
+};
+
+// Parts of the world where the invokers changed since the previous update
+// The nodes that are far enough from them are left as they are by the update
+struct FVoxelRenderOctreeDirtyRegion
+{
+	// If true, all the nodes are updated
+	bool bAll = true;
+
+	static FVoxelRenderOctreeDirtyRegion Create(const FVoxelRenderOctreeSettings& OldSettings, const FVoxelRenderOctreeSettings& NewSettings);
+
+	bool IsDirty(const FVoxelIntBox& Bounds, uint32 Size) const;
+	
+private:
+	// The points of Bounds that are not in OtherBounds, or all of Bounds if bHasOtherBounds is false
+	struct FChange
+	{
+		FVoxelIntBox Bounds;
+		FVoxelIntBox OtherBounds;
+		bool bHasOtherBounds = false;
+
+		bool Intersect(const FVoxelIntBox& InBounds, int64 Extent) const;
+	};
+	TArray<FChange> LODChanges;
+	TArray<FChange> CollisionsAndNavmeshChanges;
+
+	// bUseDifference: if false, all of OldBounds and NewBounds are dirty
+	static void AddChange(TArray<FChange>& Changes, bool bOldUsed, const FVoxelIntBox& OldBounds, bool bNewUsed, const FVoxelIntBox& NewBounds, bool bUseDifference);
 };
 
 class FVoxelRenderOctreeAsyncBuilder : public FVoxelAsyncWork
@@ -51,8 +82,9 @@ public:
 	TVoxelSharedPtr<FVoxelRenderOctree> NewOctree;
 	TVoxelSharedPtr<FVoxelRenderOctree> OldOctree;
 
-	// We don't want to do the deletion on the game thread
-	TVoxelSharedPtr<FVoxelRenderOctree> OctreeToDelete;
+	// The octree the game thread was using before OldOctree
+	// The next update brings it up to date and reuses it instead of cloning OldOctree, or deletes it: we don't want to do the deletion on the game thread
+	TVoxelSharedPtr<FVoxelRenderOctree> SpareOctree;
 
 	FVoxelRenderOctreeAsyncBuilder(uint8 OctreeDepth, const FVoxelIntBox& WorldBounds);
 
@@ -82,6 +114,15 @@ private:
 	double Counter = 0;
 	FString Log;
 	int32 NumberOfChunks = 0;
+
+	// The last octree built, its settings and the nodes that changed in it: allows to only update the nodes close to the invokers that changed
+	TVoxelWeakPtr<FVoxelRenderOctree> LastNewOctree;
+	FVoxelRenderOctreeSettings LastOctreeSettings{};
+	TArray<FVoxelOctreeId> LastChangedNodes;
+
+	// Returns whether the subdivision by distance changed
+	bool UpdateOctree(FVoxelRenderOctree& Octree, const FVoxelRenderOctreeDirtyRegion& DirtyRegion, TArray<FVoxelChunkUpdate>& OutChunkUpdates, TArray<FVoxelOctreeId>& OutChangedNodes);
+	void ValidateIncrementalUpdate(const FVoxelRenderOctreeDirtyRegion& DirtyRegion);
 };
 
 class FVoxelRenderOctree : public TSimpleVoxelOctree<RENDER_CHUNK_SIZE, FVoxelRenderOctree>
@@ -92,7 +133,8 @@ private:
 	
 public:
 	FVoxelRenderOctree* const Root;
-	const uint64 ChunkId;
+	// 0 until the node goes through GetUpdates, so that the ids do not depend on the order in which the nodes are created
+	uint64 ChunkId = 0;
 	const FVoxelIntBox OctreeBounds;
 
 	enum class EDivisionType : uint8
@@ -108,9 +150,12 @@ public:
 		FVoxelChunkSettings Settings{};
 		EDivisionType DivisionType = EDivisionType::Uninitialized;
 		EDivisionType OldDivisionType = EDivisionType::Uninitialized;
+		// Whether the current update revisits this node. If false, the node and its children are the same as in the previous update
+		bool bDirty = true;
 	}; 
 	FChunkSettings ChunkSettings;
 	int32 CurrentChunksCount = 0;
+	// Only set on the root
 	uint64 UpdateIndex = 0;
 
 	inline const FVoxelChunkSettings& GetSettings() const { return ChunkSettings.Settings; }
@@ -123,20 +168,25 @@ public:
 
 	~FVoxelRenderOctree();
 
-	void ResetDivisionType();
+	// Resets the nodes in DirtyRegion. Returns the number of nodes reset
+	int32 ResetDivisionType(const FVoxelRenderOctreeDirtyRegion& DirtyRegion);
 	bool UpdateSubdividedByDistance(const FVoxelRenderOctreeSettings& Settings);
 	bool UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSettings& Settings);
 	void ReuseOldNeighbors();
 	void UpdateSubdividedByOthers(const FVoxelRenderOctreeSettings& Settings);
 	void DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates);
 
+	// ChangedNodes: nodes whose division type or settings changed
 	void GetUpdates(
-		uint32 InUpdateIndex,
 		bool bRecomputeTransitionMasks,
 		const FVoxelRenderOctreeSettings& Settings, 
 		TArray<FVoxelChunkUpdate>& ChunkUpdates, 
+		TArray<FVoxelOctreeId>& ChangedNodes,
 		bool bVisible = true);
 
+	// Must be called on a root. Source must be this octree after an update whose ChangedNodes are given
+	void CopyChangedNodes(const FVoxelRenderOctree& Source, TArray<FVoxelOctreeId> ChangedNodes);
+
 	void GetChunksToUpdateForBounds(const FVoxelIntBox& Bounds, TArray<uint64>& ChunksToUpdate, const FVoxelOnChunkUpdate& OnChunkUpdate) const;
 	void GetVisibleChunksOverlappingBounds(const FVoxelIntBox& Bounds, TArray<uint64, TInlineAllocator<8>>& VisibleChunks) const;
 
@@ -148,6 +198,10 @@ private:
 	bool ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings) const;
 	
 	const FVoxelRenderOctree* GetVisibleAdjacentChunk(EVoxelDirectionFlag::Type Direction, int32 Index) const;
+	const FVoxelRenderOctree* FindNode(const FVoxelOctreeId& Id) const;
+
+	void Subdivide(EDivisionType DivisionType);
+	void ResetCleanChildren();
 
 	template<typename T1, typename T2>
 	bool IsInvokerInRange(const TArray<FVoxelInvokerSettings>& Invokers, T1 SelectInvoker, T2 GetInvokerBounds) const;
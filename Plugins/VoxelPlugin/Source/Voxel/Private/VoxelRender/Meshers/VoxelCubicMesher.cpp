@@ -65,12 +65,16 @@ struct FVoxelCubicGeometryVertex : FVector
 };
 static_assert(sizeof(FVoxelCubicGeometryVertex) == sizeof(FVector), "");
 
+// Size: size of the face in voxels, 1 along its normal. Only Global UVs support faces bigger than a voxel
 template<EVoxelDirectionFlag::Type Direction, typename TVertex, typename TMesher>
 FORCEINLINE void AddFace(
 	TMesher& Mesher, int32 Step, FVoxelMaterial Material, 
 	int32 X, int32 Y, int32 Z, 
+	const FIntVector& Size,
 	TArray<uint32>& Indices, TArray<TVertex>& Vertices)
 {
+	checkVoxelSlow(!TVertex::bComputeTextureCoordinate || Mesher.Settings.UVConfig == EVoxelUVConfig::GlobalUVs || Size == FIntVector(1));
+
 	if (TVertex::bComputeMaterial && Mesher.Settings.bOneMaterialPerCubeSide)
 	{
 		uint8 Index = Material.GetSingleIndex();
@@ -163,7 +167,7 @@ FORCEINLINE void AddFace(
 	for (int32 Index = 0; Index < 4; Index++)
 	{
 		const FVector VertexPositionInCube = Positions[Index];
-		const FVector VertexPosition = (VertexPositionInCube + FVector(X, Y, Z)) * Step - FVector(0.5f);
+		const FVector VertexPosition = (VertexPositionInCube * FVector(Size) + FVector(X, Y, Z)) * Step - FVector(0.5f);
 		
 		TVertex Vertex;
 		Vertex.SetPosition(VertexPosition);
@@ -266,8 +270,10 @@ FVoxelIntBox FVoxelCubicMesher::GetBoundsToLock() const
 
 TVoxelSharedPtr<FVoxelChunkMesh> FVoxelCubicMesher::CreateFullChunkImpl(FVoxelMesherTimes& Times)
 {
-	TArray<FVoxelCubicFullVertex> Vertices;
-	TArray<uint32> Indices;
+	const TVoxelMesherScratchArray<FVoxelCubicFullVertex> VerticesStorage;
+	const TVoxelMesherScratchArray<uint32> IndicesStorage;
+	TArray<FVoxelCubicFullVertex>& Vertices = *VerticesStorage;
+	TArray<uint32>& Indices = *IndicesStorage;
 
 	CreateGeometryTemplate(Times, Indices, Vertices);
 
@@ -276,8 +282,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelCubicMesher::CreateFullChunkImpl(FVoxelMe
 	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(
 		Settings,
 		LOD,
-		MoveTemp(Indices),
-		MoveTemp(reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices))));
+		Indices,
+		reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices)));
 }
 
 
@@ -301,6 +307,13 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 
 	TVoxelQueryZone<FVoxelValue> QueryZone(GetBoundsToCheckIsEmptyOn(), FIntVector(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS), LOD, CachedValues);
 	MESHER_TIME_VALUES(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS, Data.Get<FVoxelValue>(QueryZone, LOD));
+
+	// In the other UV configs the UVs are per voxel, so the faces can't be merged
+	if (Settings.bGreedyCubicMeshing && (!T::bComputeTextureCoordinate || Settings.UVConfig == EVoxelUVConfig::GlobalUVs))
+	{
+		CreateGreedyGeometry(Times, Indices, Vertices);
+		return;
+	}
 	
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Iteration");
@@ -310,17 +323,7 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 			{
 				for (int32 Z = 0; Z < RENDER_CHUNK_SIZE; Z++)
 				{
-					const FVoxelValue Value = GetValue(X, Y, Z);
-					if (Value.IsEmpty()) continue;
-
-					const uint8 Flag =
-						(GetValue(X - 1, Y, Z).IsEmpty() << 0) |
-						(GetValue(X + 1, Y, Z).IsEmpty() << 1) |
-						(GetValue(X, Y - 1, Z).IsEmpty() << 2) |
-						(GetValue(X, Y + 1, Z).IsEmpty() << 3) |
-						(GetValue(X, Y, Z - 1).IsEmpty() << 4) |
-						(GetValue(X, Y, Z + 1).IsEmpty() << 5);
-
+					const uint8 Flag = GetFacesFlag(X, Y, Z);
 					if (!Flag) continue;
 
 					FVoxelMaterial Material;
@@ -333,7 +336,7 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 							LOD));
 					}
 
-#define CHECK_SIDE(Direction) if (Flag & Direction) AddFace<Direction>(*this, Step, Material, X, Y, Z, Indices, Vertices)
+#define CHECK_SIDE(Direction) if (Flag & Direction) AddFace<Direction>(*this, Step, Material, X, Y, Z, FIntVector(1), Indices, Vertices)
 					CHECK_SIDE(EVoxelDirectionFlag::XMin);
 					CHECK_SIDE(EVoxelDirectionFlag::XMax);
 					CHECK_SIDE(EVoxelDirectionFlag::YMin);
@@ -347,6 +350,151 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 	}
 }
 
+template<typename T>
+void FVoxelCubicMesher::CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices)
+{
+	constexpr int32 Size = RENDER_CHUNK_SIZE;
+
+	const TVoxelMesherScratchArray<uint8> FlagsStorage{ Size * Size * Size };
+	const TVoxelMesherScratchArray<FVoxelMaterial> MaterialsStorage{ T::bComputeMaterial ? Size * Size * Size : 0 };
+	uint8* RESTRICT const Flags = FlagsStorage->GetData();
+	FVoxelMaterial* RESTRICT const Materials = MaterialsStorage->GetData();
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Flags");
+		for (int32 Z = 0; Z < Size; Z++)
+		{
+			for (int32 Y = 0; Y < Size; Y++)
+			{
+				for (int32 X = 0; X < Size; X++)
+				{
+					const int32 Index = X + Y * Size + Z * Size * Size;
+					
+					const uint8 Flag = GetFacesFlag(X, Y, Z);
+					Flags[Index] = Flag;
+
+					if (T::bComputeMaterial && Flag)
+					{
+						Materials[Index] = MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(
+							X + ChunkPosition.X,
+							Y + ChunkPosition.Y,
+							Z + ChunkPosition.Z,
+							LOD));
+					}
+				}
+			}
+		}
+	}
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Merge");
+		AddGreedyFaces<EVoxelDirectionFlag::XMin>(Flags, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirectionFlag::XMax>(Flags, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirectionFlag::YMin>(Flags, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirectionFlag::YMax>(Flags, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirectionFlag::ZMin>(Flags, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirectionFlag::ZMax>(Flags, Materials, Indices, Vertices);
+	}
+}
+
+template<EVoxelDirectionFlag::Type Direction, typename T>
+void FVoxelCubicMesher::AddGreedyFaces(uint8* RESTRICT Flags, const FVoxelMaterial* RESTRICT Materials, TArray<uint32>& Indices, TArray<T>& Vertices) const
+{
+	constexpr int32 Size = RENDER_CHUNK_SIZE;
+	
+	// The slices are along the face normal, and the quads are grown along U then V
+	constexpr int32 Axis =
+		Direction == EVoxelDirectionFlag::XMin || Direction == EVoxelDirectionFlag::XMax
+		? 0
+		: Direction == EVoxelDirectionFlag::YMin || Direction == EVoxelDirectionFlag::YMax
+		? 1
+		: 2;
+	constexpr int32 AxisU = (Axis + 1) % 3;
+	constexpr int32 AxisV = (Axis + 2) % 3;
+	
+	const FIntVector Strides(1, Size, Size * Size);
+	const int32 Stride = Strides[Axis];
+	const int32 StrideU = Strides[AxisU];
+	const int32 StrideV = Strides[AxisV];
+
+	for (int32 Slice = 0; Slice < Size; Slice++)
+	{
+		for (int32 V = 0; V < Size; V++)
+		{
+			for (int32 U = 0; U < Size; U++)
+			{
+				const int32 Index = Slice * Stride + U * StrideU + V * StrideV;
+				if (!(Flags[Index] & Direction)) continue;
+
+				const auto CanMerge = [&](int32 OtherIndex)
+				{
+					return (Flags[OtherIndex] & Direction) && (!T::bComputeMaterial || Materials[OtherIndex] == Materials[Index]);
+				};
+
+				int32 SizeU = 1;
+				while (U + SizeU < Size && CanMerge(Index + SizeU * StrideU))
+				{
+					SizeU++;
+				}
+
+				int32 SizeV = 1;
+				for (; V + SizeV < Size; SizeV++)
+				{
+					bool bCanMergeRow = true;
+					for (int32 RowU = 0; RowU < SizeU && bCanMergeRow; RowU++)
+					{
+						bCanMergeRow = CanMerge(Index + RowU * StrideU + SizeV * StrideV);
+					}
+					if (!bCanMergeRow) break;
+				}
+
+				for (int32 QuadV = 0; QuadV < SizeV; QuadV++)
+				{
+					for (int32 QuadU = 0; QuadU < SizeU; QuadU++)
+					{
+						Flags[Index + QuadU * StrideU + QuadV * StrideV] &= ~Direction;
+					}
+				}
+
+				FIntVector Position;
+				Position[Axis] = Slice;
+				Position[AxisU] = U;
+				Position[AxisV] = V;
+
+				FIntVector QuadSize(1);
+				QuadSize[AxisU] = SizeU;
+				QuadSize[AxisV] = SizeV;
+
+				FVoxelMaterial Material;
+				if (T::bComputeMaterial)
+				{
+					Material = Materials[Index];
+				}
+				AddFace<Direction>(*this, Step, Material, Position.X, Position.Y, Position.Z, QuadSize, Indices, Vertices);
+
+				// The next faces of the quad are already added
+				U += SizeU - 1;
+			}
+		}
+	}
+}
+
+FORCEINLINE uint8 FVoxelCubicMesher::GetFacesFlag(int32 X, int32 Y, int32 Z) const
+{
+	if (GetValue(X, Y, Z).IsEmpty())
+	{
+		return 0;
+	}
+
+	return
+		(GetValue(X - 1, Y, Z).IsEmpty() << 0) |
+		(GetValue(X + 1, Y, Z).IsEmpty() << 1) |
+		(GetValue(X, Y - 1, Z).IsEmpty() << 2) |
+		(GetValue(X, Y + 1, Z).IsEmpty() << 3) |
+		(GetValue(X, Y, Z - 1).IsEmpty() << 4) |
+		(GetValue(X, Y, Z + 1).IsEmpty() << 5);
+}
+
 FORCEINLINE FVoxelValue FVoxelCubicMesher::GetValue(int32 X, int32 Y, int32 Z) const
 {
 	checkVoxelSlow(
@@ -381,8 +529,10 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelCubicTransitionsMesher::CreateFullChunkIm
 {
 	Accelerator = MakeUnique<FVoxelConstDataAccelerator>(Data, GetBoundsToLock());
 
-	TArray<FVoxelCubicFullVertex> Vertices;
-	TArray<uint32> Indices;
+	const TVoxelMesherScratchArray<FVoxelCubicFullVertex> VerticesStorage;
+	const TVoxelMesherScratchArray<uint32> IndicesStorage;
+	TArray<FVoxelCubicFullVertex>& Vertices = *VerticesStorage;
+	TArray<uint32>& Indices = *IndicesStorage;
 
 	CreateTransitionsForDirection<EVoxelDirectionFlag::XMin>(Times, Indices, Vertices);
 	CreateTransitionsForDirection<EVoxelDirectionFlag::XMax>(Times, Indices, Vertices);
@@ -396,8 +546,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelCubicTransitionsMesher::CreateFullChunkIm
 	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(
 		Settings,
 		LOD,
-		MoveTemp(Indices),
-		MoveTemp(reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices))));
+		Indices,
+		reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -579,7 +729,7 @@ void FVoxelCubicTransitionsMesher::Add2DFace(
 		: 0;
 
 	const FIntVector P = Local2DToGlobal<Direction>(Step / InStep * RENDER_CHUNK_SIZE, LX, LY, LZ);
-	AddFace<FaceDirection>(*this, InStep, Material, P.X, P.Y, P.Z, Indices, Vertices);
+	AddFace<FaceDirection>(*this, InStep, Material, P.X, P.Y, P.Z, FIntVector(1), Indices, Vertices);
 }
 
 template<EVoxelDirectionFlag::Type Direction>
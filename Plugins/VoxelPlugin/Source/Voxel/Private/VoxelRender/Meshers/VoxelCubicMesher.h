@@ -7,6 +7,7 @@
 #include "VoxelContainers/VoxelStaticArray.h"
 #include "VoxelData/VoxelDataAccelerator.h"
 #include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
 
 #define CUBIC_CHUNK_SIZE_WITH_NEIGHBORS (RENDER_CHUNK_SIZE + 2)
 
@@ -23,14 +24,23 @@ protected:
 	
 private:
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
-	TVoxelStaticArray<FVoxelValue, CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS> CachedValues;
+	const TVoxelMesherScratchArray<FVoxelValue> CachedValuesStorage{ CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS };
+	FVoxelValue* RESTRICT const CachedValues = CachedValuesStorage->GetData();
 
 private:
 	template<typename T>
 	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
 
+	// bGreedyCubicMeshing: merges the faces into quads as big as possible, slice by slice
+	template<typename T>
+	void CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
+	// Flags: faces left to add of every voxel, cleared as they are merged
+	template<EVoxelDirectionFlag::Type Direction, typename T>
+	void AddGreedyFaces(uint8* RESTRICT Flags, const FVoxelMaterial* RESTRICT Materials, TArray<uint32>& Indices, TArray<T>& Vertices) const;
+
 private:
 	FVoxelValue GetValue(int32 X, int32 Y, int32 Z) const;
+	uint8 GetFacesFlag(int32 X, int32 Y, int32 Z) const;
 };
 
 class FVoxelCubicTransitionsMesher : public FVoxelTransitionsMesher
@@ -0,0 +1,138 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelRender/Meshers/VoxelMarchingCubeKernel.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelWorld.h"
+#include "HAL/IConsoleManager.h"
+#include "EngineUtils.h"
+
+static TAutoConsoleVariable<int32> CVarMarchingCubesKernel(
+	TEXT("voxel.mesher.MarchingCubesKernel"),
+	1,
+	TEXT("If true, the marching cubes mesher will classify the cells a row at a time using bit masks. If false, will look at the cells one by one"),
+	ECVF_Default);
+
+bool FVoxelMarchingCubeKernel::IsEnabled()
+{
+	return bIsSupported && CVarMarchingCubesKernel.GetValueOnAnyThread() != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Meshes chunks of the marching cubes voxel worlds in the scene with and without the kernel, and checks that the geometry is bit exact
+namespace FVoxelMarchingCubeKernelValidation
+{
+	struct FResult
+	{
+		int32 NumChunks = 0;
+		int32 NumNonEmptyChunks = 0;
+		int32 NumMismatches = 0;
+		double ScalarTime = 0;
+		double KernelTime = 0;
+	};
+
+	void ValidateChunk(const AVoxelWorld& World, int32 LOD, const FIntVector& ChunkPosition, FResult& Result)
+	{
+		TArray<uint32> Indices[2];
+		TArray<FVector> Vertices[2];
+		for (int32 Index = 0; Index < 2; Index++)
+		{
+			CVarMarchingCubesKernel->Set(Index, ECVF_SetByConsole);
+
+			const double StartTime = FPlatformTime::Seconds();
+			World.GetRenderer().CreateGeometry_AnyThread(LOD, ChunkPosition, Indices[Index], Vertices[Index]);
+			(Index == 0 ? Result.ScalarTime : Result.KernelTime) += FPlatformTime::Seconds() - StartTime;
+		}
+
+		Result.NumChunks++;
+		if (Indices[0].Num() > 0)
+		{
+			Result.NumNonEmptyChunks++;
+		}
+
+		const bool bSameIndices =
+			Indices[0].Num() == Indices[1].Num() &&
+			FMemory::Memcmp(Indices[0].GetData(), Indices[1].GetData(), Indices[0].Num() * sizeof(uint32)) == 0;
+		const bool bSameVertices =
+			Vertices[0].Num() == Vertices[1].Num() &&
+			FMemory::Memcmp(Vertices[0].GetData(), Vertices[1].GetData(), Vertices[0].Num() * sizeof(FVector)) == 0;
+
+		if (!bSameIndices || !bSameVertices)
+		{
+			Result.NumMismatches++;
+			LOG_VOXEL(Error, TEXT("%s: LOD %d chunk %s differs: %d/%d indices, %d/%d vertices (scalar/kernel)"),
+				*World.GetName(),
+				LOD,
+				*ChunkPosition.ToString(),
+				Indices[0].Num(),
+				Indices[1].Num(),
+				Vertices[0].Num(),
+				Vertices[1].Num());
+		}
+	}
+
+	void Validate(const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 MaxLOD = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4, 0, 24);
+		const int32 NumChunksPerAxis = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 16);
+
+		if (!FVoxelMarchingCubeKernel::bIsSupported)
+		{
+			LOG_VOXEL(Warning, TEXT("RENDER_CHUNK_SIZE is too big for the marching cubes kernel"));
+			return;
+		}
+
+		const int32 OldValue = CVarMarchingCubesKernel.GetValueOnGameThread();
+
+		for (TActorIterator<AVoxelWorld> It(World); It; ++It)
+		{
+			const AVoxelWorld& VoxelWorld = **It;
+			if (!VoxelWorld.IsCreated() || VoxelWorld.RenderType != EVoxelRenderType::MarchingCubes)
+			{
+				continue;
+			}
+
+			const FVoxelIntBox& WorldBounds = VoxelWorld.GetData().WorldBounds;
+
+			FResult Result;
+			for (int32 LOD = 0; LOD <= MaxLOD; LOD++)
+			{
+				const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
+				// Chunks going from the center of the world to its bounds along every axis: this crosses the surface of most generators, including planets
+				for (int32 Axis = 0; Axis < 3; Axis++)
+				{
+					for (int32 Index = -NumChunksPerAxis; Index < NumChunksPerAxis; Index++)
+					{
+						FIntVector ChunkPosition(0);
+						ChunkPosition[Axis] = Index * ChunkSize;
+
+						if (!WorldBounds.Contains(FVoxelIntBox(ChunkPosition, ChunkPosition + ChunkSize)))
+						{
+							continue;
+						}
+
+						ValidateChunk(VoxelWorld, LOD, ChunkPosition, Result);
+					}
+				}
+			}
+
+			LOG_VOXEL(Log, TEXT("%s: %d chunks (%d not empty), %d mismatches. Scalar: %.2fms, kernel: %.2fms"),
+				*VoxelWorld.GetName(),
+				Result.NumChunks,
+				Result.NumNonEmptyChunks,
+				Result.NumMismatches,
+				Result.ScalarTime * 1000,
+				Result.KernelTime * 1000);
+		}
+
+		CVarMarchingCubesKernel->Set(OldValue, ECVF_SetByConsole);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdValidateMarchingCubesKernel(
+	TEXT("voxel.mesher.ValidateMarchingCubesKernel"),
+	TEXT("Meshes chunks of the marching cubes voxel worlds in the scene with and without voxel.mesher.MarchingCubesKernel, and checks that the geometry is the same. Args: [MaxLOD = 4] [NumChunksPerAxis = 16]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FVoxelMarchingCubeKernelValidation::Validate));
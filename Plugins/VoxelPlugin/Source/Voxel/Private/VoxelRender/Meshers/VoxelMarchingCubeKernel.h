@@ -0,0 +1,94 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelValue.h"
+
+/**
+ * Classifies the marching cubes cells a whole row at once
+ *
+ * The emptiness of a row of values is packed into a 64 bits mask, computed 64 bits of values at a time (SWAR):
+ * this works on every platform and with both 8 and 16 bits values, and is bit exact with FVoxelValue::IsEmpty
+ * The case codes of a row of cells are then read from the masks of its 4 corner rows, and the cells that are
+ * fully empty or full are skipped without being looked at
+ */
+struct FVoxelMarchingCubeKernel
+{
+	// Bits of a row mask. Needs one bit per value of a row, including the end edge
+	static constexpr bool bIsSupported = RENDER_CHUNK_SIZE + 1 <= 64;
+	static constexpr uint64 CellsMask = RENDER_CHUNK_SIZE < 64 ? (uint64(1) << (RENDER_CHUNK_SIZE % 64)) - 1 : MAX_uint64;
+
+	// voxel.mesher.MarchingCubesKernel. Always false if the chunks are too big for the masks
+	static bool IsEnabled();
+
+public:
+	// Bit I is set if Values[I] is empty
+	static uint64 GetEmptyMask(const FVoxelValue* RESTRICT Values, int32 Num)
+	{
+		checkVoxelSlow(Num <= 64);
+
+		constexpr uint64 GatherMultiplier = GetGatherMultiplier();
+
+		uint64 Mask = 0;
+
+		int32 Index = 0;
+		for (; Index + NumLanes <= Num; Index += NumLanes)
+		{
+			uint64 Word;
+			FMemory::Memcpy(&Word, Values + Index, sizeof(Word));
+
+			// Lane > 0: the lane is not 0 (adding LowBits carries into the high bit) and its sign bit is not set
+			const uint64 Positive = ((Word & LowBits) + LowBits) & ~Word & HighBits;
+			// Gather the high bits of the lanes in the top lane, then shift them down
+			Mask |= (((Positive >> (LaneBits - 1)) * GatherMultiplier) >> (64 - LaneBits)) << Index;
+		}
+		for (; Index < Num; Index++)
+		{
+			Mask |= uint64(Values[Index].IsEmpty()) << Index;
+		}
+
+		return Mask;
+	}
+
+	// Masks: empty masks of the corner rows of the cells, in this order: (Y, Z), (Y + 1, Z), (Y, Z + 1), (Y + 1, Z + 1)
+	// Bit LX is set if cell LX has a nontrivial triangulation, ie if its corners are neither all empty nor all full
+	FORCEINLINE static uint64 GetActiveCells(const uint64 Masks[4])
+	{
+		const uint64 AnyEmpty = Masks[0] | Masks[1] | Masks[2] | Masks[3];
+		const uint64 AllEmpty = Masks[0] & Masks[1] & Masks[2] & Masks[3];
+		// Cell LX uses the values LX and LX + 1
+		return (AnyEmpty | (AnyEmpty >> 1)) & ~(AllEmpty & (AllEmpty >> 1)) & CellsMask;
+	}
+	// Same as building the case code from the 8 corners of the cell
+	FORCEINLINE static uint32 GetCaseCode(const uint64 Masks[4], int32 LX)
+	{
+		checkVoxelSlow(0 <= LX && LX < RENDER_CHUNK_SIZE);
+		return
+			(((Masks[0] >> LX) & 0x3) << 0) |
+			(((Masks[1] >> LX) & 0x3) << 2) |
+			(((Masks[2] >> LX) & 0x3) << 4) |
+			(((Masks[3] >> LX) & 0x3) << 6);
+	}
+
+private:
+	static_assert(PLATFORM_LITTLE_ENDIAN, "Lanes are expected to be in memory order");
+
+	static constexpr int32 LaneBits = 8 * sizeof(FVoxelValue);
+	static constexpr int32 NumLanes = 64 / LaneBits;
+	// Sign bit of every lane
+	static constexpr uint64 HighBits = MAX_uint64 / ((uint64(1) << LaneBits) - 1) * (uint64(1) << (LaneBits - 1));
+	static constexpr uint64 LowBits = ~HighBits;
+
+	// Moves bit LaneBits * I to bit 64 - LaneBits + I. The other products either overflow or stay below 64 - LaneBits, and never collide
+	static constexpr uint64 GetGatherMultiplier()
+	{
+		uint64 Multiplier = 0;
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			Multiplier |= uint64(1) << (64 - LaneBits - (LaneBits - 1) * Lane);
+		}
+		return Multiplier;
+	}
+};
@@ -2,6 +2,7 @@
 
 #include "VoxelRender/Meshers/VoxelMarchingCubeMesher.h"
 #include "VoxelRender/Meshers/VoxelMesherUtilities.h"
+#include "VoxelRender/Meshers/VoxelMarchingCubeKernel.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelData/VoxelDataIncludes.h"
 #include "Transvoxel.h"
@@ -25,19 +26,17 @@ class FMarchingCubeHelpers
 {
 public:
 	template<typename T>
-	static TArray<FVoxelMesherVertex> CreateMesherVertices(TArray<T>& Vertices)
+	static void CreateMesherVertices(TArray<T>& Vertices, TArray<FVoxelMesherVertex>& MesherVertices)
 	{
 		VOXEL_ASYNC_FUNCTION_COUNTER();
 
-		TArray<FVoxelMesherVertex> MesherVertices;
-		MesherVertices.SetNumUninitialized(Vertices.Num());
+		MesherVertices.SetNumUninitialized(Vertices.Num(), UE_505_SWITCH(false, EAllowShrinking::No));
 		for (int32 Index = 0; Index < Vertices.Num(); Index++)
 		{
 			auto& Vertex = Vertices[Index];
 			auto& MesherVertex = MesherVertices[Index];
 			MesherVertex.Position = Vertex.Position;
 		}
-		return MesherVertices;
 	}
 	
 	template<typename T, typename TMesher>
@@ -138,7 +137,9 @@ public:
 	{
 		VOXEL_ASYNC_FUNCTION_COUNTER();
 
-		TArray<FVoxelMesherVertex> NewVertices;
+		const TVoxelMesherScratchArray<FVoxelMesherVertex, 1> NewVerticesStorage;
+		TArray<FVoxelMesherVertex>& NewVertices = *NewVerticesStorage;
+		NewVertices.Reserve(Indices.Num());
 		for (int32 I = 0; I < Indices.Num(); I += 3)
 		{
 			uint32& IndexA = Indices[I + 0];
@@ -158,7 +159,8 @@ public:
 			IndexB = NewVertices.Add(VertexB);
 			IndexC = NewVertices.Add(VertexC);
 		}
-		Vertices = MoveTemp(NewVertices);
+		// Both arrays keep their allocations
+		Swap(Vertices, NewVertices);
 	}
 	static void ComputeNormals(FVoxelMarchingCubeMesher& Mesher, TArray<FVoxelMesherVertex>& MesherVertices, TArray<uint32>& Indices)
 	{
@@ -331,13 +333,18 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeMesher::CreateFullChunkImpl(F
 		}
 	};
 	
-	TArray<uint32> Indices;
-	TArray<FLocalVertex> Vertices;
+	const TVoxelMesherScratchArray<uint32> IndicesStorage;
+	const TVoxelMesherScratchArray<FLocalVertex> VerticesStorage;
+	const TVoxelMesherScratchArray<FVoxelMesherVertex> MesherVerticesStorage;
+	TArray<uint32>& Indices = *IndicesStorage;
+	TArray<FLocalVertex>& Vertices = *VerticesStorage;
+	TArray<FVoxelMesherVertex>& MesherVertices = *MesherVerticesStorage;
+	
 	CreateGeometryTemplate(Times, Indices, Vertices);
 
 	FVoxelMesherUtilities::SanitizeMesh(Indices, Vertices);
 
-	TArray<FVoxelMesherVertex> MesherVertices = FMarchingCubeHelpers::CreateMesherVertices(Vertices);
+	FMarchingCubeHelpers::CreateMesherVertices(Vertices, MesherVertices);
 
 	MESHER_TIME_MATERIALS(MesherVertices.Num(), FMarchingCubeHelpers::ComputeMaterials(*this, MesherVertices, Vertices));
 	MESHER_TIME(Normals, FMarchingCubeHelpers::ComputeNormals(*this, MesherVertices, Indices));
@@ -414,8 +421,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeMesher::CreateFullChunkImpl(F
 	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(
 		Settings,
 		LOD,
-		MoveTemp(Indices),
-		MoveTemp(MesherVertices)));
+		Indices,
+		MesherVertices));
 }
 
 void FVoxelMarchingCubeMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices)
@@ -456,283 +463,315 @@ bool FVoxelMarchingCubeMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times,
 	
 	Accelerator = MakeUnique<FVoxelConstDataAccelerator>(Data, GetBoundsToLock());
 
+	const bool bUseKernel = FVoxelMarchingCubeKernel::IsEnabled();
+
+	// Empty masks of the rows of the current and of the next Z slices
+	uint64 SliceMasksA[CHUNK_SIZE_WITH_END_EDGE];
+	uint64 SliceMasksB[CHUNK_SIZE_WITH_END_EDGE];
+	uint64* RESTRICT CurrentSliceMasks = SliceMasksA;
+	uint64* RESTRICT NextSliceMasks = SliceMasksB;
+	if (bUseKernel)
+	{
+		GetSliceMasks(DataSize, 0, CurrentSliceMasks);
+	}
+
 	uint32 VoxelIndex = 0;
 	if (LOD == 0) VoxelIndex += DataSize * DataSize; // Additional voxel for normals
 	for (int32 LZ = 0; LZ < RENDER_CHUNK_SIZE; LZ++)
 	{
+		if (bUseKernel)
+		{
+			GetSliceMasks(DataSize, LZ + 1, NextSliceMasks);
+		}
+
 		if (LOD == 0) VoxelIndex += DataSize; // Additional voxel for normals
 		for (int32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
 		{
 			if (LOD == 0) VoxelIndex += 1; // Additional voxel for normals
+
+			// Set EdgeIndex 0 to -1 if the cell isn't voxelized, eg all corners = 0
+			// Cells only write their own entries of CurrentCache, so this can be done for the whole row first
 			for (int32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
 			{
+				CurrentCache[GetCacheIndex(0, LX, LY)] = -1;
+			}
+
+			if (bUseKernel)
+			{
+				const uint64 RowMasks[4] = { CurrentSliceMasks[LY], CurrentSliceMasks[LY + 1], NextSliceMasks[LY], NextSliceMasks[LY + 1] };
+
+				// Same cells in the same order as the scalar loop below, without looking at the fully empty/full ones
+				uint64 ActiveCells = FVoxelMarchingCubeKernel::GetActiveCells(RowMasks);
+				while (ActiveCells)
 				{
-					CurrentCache[GetCacheIndex(0, LX, LY)] = -1; // Set EdgeIndex 0 to -1 if the cell isn't voxelized, eg all corners = 0
-
-					uint32 CubeIndices[8];
-					CubeIndices[0] = VoxelIndex;
-					CubeIndices[1] = VoxelIndex + 1;
-					CubeIndices[2] = VoxelIndex     + DataSize;
-					CubeIndices[3] = VoxelIndex + 1 + DataSize;
-					CubeIndices[4] = VoxelIndex                + DataSize * DataSize;
-					CubeIndices[5] = VoxelIndex + 1            + DataSize * DataSize;
-					CubeIndices[6] = VoxelIndex     + DataSize + DataSize * DataSize;
-					CubeIndices[7] = VoxelIndex + 1 + DataSize + DataSize * DataSize;
-
-					checkVoxelSlow(CubeIndices[0] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[1] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[2] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[3] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[4] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[5] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[6] < uint32(DataSize * DataSize * DataSize));
-					checkVoxelSlow(CubeIndices[7] < uint32(DataSize * DataSize * DataSize));
-
-					const uint32 CaseCode =
-						(CachedValues[CubeIndices[0]].IsEmpty() << 0) |
-						(CachedValues[CubeIndices[1]].IsEmpty() << 1) |
-						(CachedValues[CubeIndices[2]].IsEmpty() << 2) |
-						(CachedValues[CubeIndices[3]].IsEmpty() << 3) |
-						(CachedValues[CubeIndices[4]].IsEmpty() << 4) |
-						(CachedValues[CubeIndices[5]].IsEmpty() << 5) |
-						(CachedValues[CubeIndices[6]].IsEmpty() << 6) |
-						(CachedValues[CubeIndices[7]].IsEmpty() << 7);
+					const int32 LX = int32(FMath::CountTrailingZeros64(ActiveCells));
+					ActiveCells &= ActiveCells - 1;
+
+					const uint32 CaseCode = FVoxelMarchingCubeKernel::GetCaseCode(RowMasks, LX);
+					checkVoxelSlow(CaseCode == GetCaseCode(DataSize, VoxelIndex + LX));
 
+					if (!CreateCell(Times, Indices, Vertices, DataSize, LX, LY, LZ, VoxelIndex + LX, CaseCode))
+					{
+						return false;
+					}
+				}
+				VoxelIndex += RENDER_CHUNK_SIZE;
+			}
+			else
+			{
+				for (int32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
+				{
+					const uint32 CaseCode = GetCaseCode(DataSize, VoxelIndex);
 					if (CaseCode != 0 && CaseCode != 255)
 					{
-						// Cell has a nontrivial triangulation
+						if (!CreateCell(Times, Indices, Vertices, DataSize, LX, LY, LZ, VoxelIndex, CaseCode))
+						{
+							return false;
+						}
+					}
+					VoxelIndex++;
+				}
+			}
 
-						const uint8 ValidityMask = (LX != 0) + 2 * (LY != 0) + 4 * (LZ != 0);
+			VoxelIndex += 1; // End edge voxel
+			if (LOD == 0) VoxelIndex += 1; // Additional voxel for normals
+		}
+		VoxelIndex += DataSize; // End edge voxel
+		if (LOD == 0) VoxelIndex += DataSize; // Additional voxel for normals
 
-						checkVoxelSlow(0 <= CaseCode && CaseCode < 256);
-						const uint8 CellClass = Transvoxel::regularCellClass[CaseCode];
-						const uint16* RESTRICT VertexData = Transvoxel::regularVertexData[CaseCode];
-						checkVoxelSlow(0 <= CellClass && CellClass < 16);
-						Transvoxel::RegularCellData CellData = Transvoxel::regularCellData[CellClass];
+		// Can't use Unreal Swap on restrict ptrs with clang
+		std::swap(CurrentCache, OldCache);
+		std::swap(CurrentSliceMasks, NextSliceMasks);
+	}
 
-						// Indices of the vertices used in this cube
-						TVoxelStaticArray<int32, 16> VertexIndices;
-						for (int32 I = 0; I < CellData.GetVertexCount(); I++)
-						{
-							int32 VertexIndex = -2;
-							const uint16 EdgeCode = VertexData[I];
+	return true;
+}
 
-							// A: low point / B: high point
-							const uint8 LocalIndexA = (EdgeCode >> 4) & 0x0F;
-							const uint8 LocalIndexB = EdgeCode & 0x0F;
+template<typename T>
+FORCEINLINE bool FVoxelMarchingCubeMesher::CreateCell(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices, int32 DataSize, int32 LX, int32 LY, int32 LZ, uint32 VoxelIndex, uint32 CaseCode)
+{
+	checkVoxelSlow(CaseCode != 0 && CaseCode != 255);
 
-							checkVoxelSlow(0 <= LocalIndexA && LocalIndexA < 8);
-							checkVoxelSlow(0 <= LocalIndexB && LocalIndexB < 8);
+	uint32 CubeIndices[8];
+	GetCubeIndices(DataSize, VoxelIndex, CubeIndices);
 
-							const uint32 IndexA = CubeIndices[LocalIndexA];
-							const uint32 IndexB = CubeIndices[LocalIndexB];
+	const uint8 ValidityMask = (LX != 0) + 2 * (LY != 0) + 4 * (LZ != 0);
 
-							const FVoxelValue& ValueAtA = CachedValues[IndexA];
-							const FVoxelValue& ValueAtB = CachedValues[IndexB];
+	checkVoxelSlow(0 <= CaseCode && CaseCode < 256);
+	const uint8 CellClass = Transvoxel::regularCellClass[CaseCode];
+	const uint16* RESTRICT VertexData = Transvoxel::regularVertexData[CaseCode];
+	checkVoxelSlow(0 <= CellClass && CellClass < 16);
+	Transvoxel::RegularCellData CellData = Transvoxel::regularCellData[CellClass];
 
-							checkVoxelSlow(ValueAtA.IsEmpty() != ValueAtB.IsEmpty());
+	// Indices of the vertices used in this cube
+	TVoxelStaticArray<int32, 16> VertexIndices;
+	for (int32 I = 0; I < CellData.GetVertexCount(); I++)
+	{
+		int32 VertexIndex = -2;
+		const uint16 EdgeCode = VertexData[I];
 
-							uint8 EdgeIndex = ((EdgeCode >> 8) & 0x0F);
-							checkVoxelSlow(1 <= EdgeIndex && EdgeIndex < 4);
+		// A: low point / B: high point
+		const uint8 LocalIndexA = (EdgeCode >> 4) & 0x0F;
+		const uint8 LocalIndexB = EdgeCode & 0x0F;
 
-							// Direction to go to use an already created vertex: 
-							// first bit:  x is different
-							// second bit: y is different
-							// third bit:  z is different
-							// fourth bit: vertex isn't cached
-							uint8 CacheDirection = EdgeCode >> 12;
+		checkVoxelSlow(0 <= LocalIndexA && LocalIndexA < 8);
+		checkVoxelSlow(0 <= LocalIndexB && LocalIndexB < 8);
 
-							if (ValueAtA.IsNull())
-							{
-								EdgeIndex = 0;
-								CacheDirection = LocalIndexA ^ 7;
-							}
-							if (ValueAtB.IsNull())
-							{
-								checkVoxelSlow(!ValueAtA.IsNull());
-								EdgeIndex = 0;
-								CacheDirection = LocalIndexB ^ 7;
-							}
+		const uint32 IndexA = CubeIndices[LocalIndexA];
+		const uint32 IndexB = CubeIndices[LocalIndexB];
 
-							const bool bIsVertexCached = ((ValidityMask & CacheDirection) == CacheDirection) && CacheDirection; // CacheDirection == 0 => LocalIndexB = 0 (as only B can be = 7) and ValueAtB = 0
+		const FVoxelValue& ValueAtA = CachedValues[IndexA];
+		const FVoxelValue& ValueAtB = CachedValues[IndexB];
 
-							if (bIsVertexCached)
-							{
-								checkVoxelSlow(!(CacheDirection & 0x08));
-
-								bool XIsDifferent = !!(CacheDirection & 0x01);
-								bool YIsDifferent = !!(CacheDirection & 0x02);
-								bool ZIsDifferent = !!(CacheDirection & 0x04);
-								
-								VertexIndex = (ZIsDifferent ? OldCache : CurrentCache)[GetCacheIndex(EdgeIndex, LX - XIsDifferent, LY - YIsDifferent)];
-								ensureVoxelSlowNoSideEffects(-1 <= VertexIndex && VertexIndex < Vertices.Num()); // Can happen if the generator is returning different values
-							}
+		checkVoxelSlow(ValueAtA.IsEmpty() != ValueAtB.IsEmpty());
 
-							if (!bIsVertexCached || VertexIndex == -1)
-							{
-								// We are on one the lower edges of the chunk. Compute vertex
-							
-								const FIntVector PositionA((LX + (LocalIndexA & 0x01)) * Step, (LY + ((LocalIndexA & 0x02) >> 1)) * Step, (LZ + ((LocalIndexA & 0x04) >> 2)) * Step);
-								const FIntVector PositionB((LX + (LocalIndexB & 0x01)) * Step, (LY + ((LocalIndexB & 0x02) >> 1)) * Step, (LZ + ((LocalIndexB & 0x04) >> 2)) * Step);
+		uint8 EdgeIndex = ((EdgeCode >> 8) & 0x0F);
+		checkVoxelSlow(1 <= EdgeIndex && EdgeIndex < 4);
 
-								FVector IntersectionPoint;
-								FIntVector MaterialPosition;
+		// Direction to go to use an already created vertex: 
+		// first bit:  x is different
+		// second bit: y is different
+		// third bit:  z is different
+		// fourth bit: vertex isn't cached
+		uint8 CacheDirection = EdgeCode >> 12;
 
-								if (EdgeIndex == 0)
-								{
-									if (ValueAtA.IsNull())
-									{
-										IntersectionPoint = FVector(PositionA);
-										MaterialPosition = PositionA;
-									}
-									else 
-									{
-										checkVoxelSlow(ValueAtB.IsNull());
-										IntersectionPoint = FVector(PositionB);
-										MaterialPosition = PositionB;
-									}
-								}
-								else if (LOD == 0)
-								{
-									// Full resolution
-
-									const float Alpha = ValueAtA.ToFloat() / (ValueAtA.ToFloat() - ValueAtB.ToFloat());
-									checkError(!FMath::IsNaN(Alpha) && FMath::IsFinite(Alpha));
-									
-									switch (EdgeIndex)
-									{
-									case 2: // X
-										IntersectionPoint = FVector(FMath::Lerp<float>(PositionA.X, PositionB.X, Alpha), PositionA.Y, PositionA.Z);
-										break;
-									case 1: // Y
-										IntersectionPoint = FVector(PositionA.X, FMath::Lerp<float>(PositionA.Y, PositionB.Y, Alpha), PositionA.Z);
-										break;
-									case 3: // Z
-										IntersectionPoint = FVector(PositionA.X, PositionA.Y, FMath::Lerp<float>(PositionA.Z, PositionB.Z, Alpha));
-										break;
-									default:
-										checkVoxelSlow(false);
-									}
-
-									// Use the material of the point inside
-									MaterialPosition = !ValueAtA.IsEmpty() ? PositionA : PositionB;
-								}
-								else
-								{
-									// Interpolate
-
-									const bool bIsAlongX = (EdgeIndex == 2);
-									const bool bIsAlongY = (EdgeIndex == 1);
-									const bool bIsAlongZ = (EdgeIndex == 3);
-
-									checkVoxelSlow(!bIsAlongX || (PositionA.Y == PositionB.Y && PositionA.Z == PositionB.Z));
-									checkVoxelSlow(!bIsAlongY || (PositionA.X == PositionB.X && PositionA.Z == PositionB.Z));
-									checkVoxelSlow(!bIsAlongZ || (PositionA.X == PositionB.X && PositionA.Y == PositionB.Y));
-
-									int32 Min = bIsAlongX ? PositionA.X : bIsAlongY ? PositionA.Y : PositionA.Z;
-									int32 Max = bIsAlongX ? PositionB.X : bIsAlongY ? PositionB.Y : PositionB.Z;
-
-									FVoxelValue ValueAtACopy = ValueAtA;
-									FVoxelValue ValueAtBCopy = ValueAtB;
-
-									while (Max - Min != 1)
-									{
-										checkError((Max + Min) % 2 == 0);
-										const int32 Middle = (Max + Min) / 2;
-
-										FVoxelValue ValueAtMiddle = MESHER_TIME_RETURN_VALUES(1, Accelerator->Get<FVoxelValue>(
-											(bIsAlongX ? Middle : PositionA.X) + ChunkPosition.X,
-											(bIsAlongY ? Middle : PositionA.Y) + ChunkPosition.Y,
-											(bIsAlongZ ? Middle : PositionA.Z) + ChunkPosition.Z, LOD));
-
-										if (ValueAtACopy.IsEmpty() == ValueAtMiddle.IsEmpty())
-										{
-											// If min and middle have same sign
-											Min = Middle;
-											ValueAtACopy = ValueAtMiddle;
-										}
-										else
-										{
-											// If max and middle have same sign
-											Max = Middle;
-											ValueAtBCopy = ValueAtMiddle;
-										}
-
-										checkError(Min <= Max);
-									}
-
-									const float Alpha = ValueAtACopy.ToFloat() / (ValueAtACopy.ToFloat() - ValueAtBCopy.ToFloat());
-									checkError(!FMath::IsNaN(Alpha) && FMath::IsFinite(Alpha));
-
-									const float R = FMath::Lerp<float>(Min, Max, Alpha);
-									IntersectionPoint = FVector(
-										bIsAlongX ? R : PositionA.X,
-										bIsAlongY ? R : PositionA.Y,
-										bIsAlongZ ? R : PositionA.Z);
-
-									// Get intersection material
-									if (!ValueAtACopy.IsEmpty())
-									{
-										checkVoxelSlow(ValueAtBCopy.IsEmpty());
-										MaterialPosition = FIntVector(
-											bIsAlongX ? Min : PositionA.X,
-											bIsAlongY ? Min : PositionA.Y,
-											bIsAlongZ ? Min : PositionA.Z);
-									}
-									else
-									{
-										checkVoxelSlow(!ValueAtBCopy.IsEmpty());
-										MaterialPosition = FIntVector(
-											bIsAlongX ? Max : PositionA.X,
-											bIsAlongY ? Max : PositionA.Y,
-											bIsAlongZ ? Max : PositionA.Z);
-									}
-								}
+		if (ValueAtA.IsNull())
+		{
+			EdgeIndex = 0;
+			CacheDirection = LocalIndexA ^ 7;
+		}
+		if (ValueAtB.IsNull())
+		{
+			checkVoxelSlow(!ValueAtA.IsNull());
+			EdgeIndex = 0;
+			CacheDirection = LocalIndexB ^ 7;
+		}
 
-								VertexIndex = Vertices.Num();
+		const bool bIsVertexCached = ((ValidityMask & CacheDirection) == CacheDirection) && CacheDirection; // CacheDirection == 0 => LocalIndexB = 0 (as only B can be = 7) and ValueAtB = 0
 
-								if (Settings.RenderSharpness != 0)
-								{
-									IntersectionPoint = FVector(FVoxelUtilities::RoundToInt(IntersectionPoint * Settings.RenderSharpness)) / Settings.RenderSharpness;
-								}
+		if (bIsVertexCached)
+		{
+			checkVoxelSlow(!(CacheDirection & 0x08));
 
-								Vertices.Add(T(IntersectionPoint, MaterialPosition));
+			bool XIsDifferent = !!(CacheDirection & 0x01);
+			bool YIsDifferent = !!(CacheDirection & 0x02);
+			bool ZIsDifferent = !!(CacheDirection & 0x04);
+			
+			VertexIndex = (ZIsDifferent ? OldCache : CurrentCache)[GetCacheIndex(EdgeIndex, LX - XIsDifferent, LY - YIsDifferent)];
+			ensureVoxelSlowNoSideEffects(-1 <= VertexIndex && VertexIndex < Vertices.Num()); // Can happen if the generator is returning different values
+		}
 
-								checkVoxelSlow((ValueAtB.IsNull() && LocalIndexB == 7) == !CacheDirection);
-								checkVoxelSlow(CacheDirection || EdgeIndex == 0);
+		if (!bIsVertexCached || VertexIndex == -1)
+		{
+			// We are on one the lower edges of the chunk. Compute vertex
+		
+			const FIntVector PositionA((LX + (LocalIndexA & 0x01)) * Step, (LY + ((LocalIndexA & 0x02) >> 1)) * Step, (LZ + ((LocalIndexA & 0x04) >> 2)) * Step);
+			const FIntVector PositionB((LX + (LocalIndexB & 0x01)) * Step, (LY + ((LocalIndexB & 0x02) >> 1)) * Step, (LZ + ((LocalIndexB & 0x04) >> 2)) * Step);
 
-								// Save vertex if not on edge
-								if (CacheDirection & 0x08 || !CacheDirection) // ValueAtB.IsNull() && LocalIndexB == 7 => !CacheDirection
-								{
-									CurrentCache[GetCacheIndex(EdgeIndex, LX, LY)] = VertexIndex;
-								}
-							}
+			FVector IntersectionPoint;
+			FIntVector MaterialPosition;
 
-							VertexIndices[I] = VertexIndex;
-							checkVoxelSlow(0 <= VertexIndex && VertexIndex < Vertices.Num());
-						}
+			if (EdgeIndex == 0)
+			{
+				if (ValueAtA.IsNull())
+				{
+					IntersectionPoint = FVector(PositionA);
+					MaterialPosition = PositionA;
+				}
+				else 
+				{
+					checkVoxelSlow(ValueAtB.IsNull());
+					IntersectionPoint = FVector(PositionB);
+					MaterialPosition = PositionB;
+				}
+			}
+			else if (LOD == 0)
+			{
+				// Full resolution
 
-						// Add triangles
-						// 3 vertex per triangle
-						for (int32 Index = 0; Index < 3 * CellData.GetTriangleCount(); Index += 3)
-						{
-							Indices.Add(VertexIndices[CellData.vertexIndex[Index + 0]]);
-							Indices.Add(VertexIndices[CellData.vertexIndex[Index + 1]]);
-							Indices.Add(VertexIndices[CellData.vertexIndex[Index + 2]]);
-						}
+				const float Alpha = ValueAtA.ToFloat() / (ValueAtA.ToFloat() - ValueAtB.ToFloat());
+				checkError(!FMath::IsNaN(Alpha) && FMath::IsFinite(Alpha));
+				
+				switch (EdgeIndex)
+				{
+				case 2: // X
+					IntersectionPoint = FVector(FMath::Lerp<float>(PositionA.X, PositionB.X, Alpha), PositionA.Y, PositionA.Z);
+					break;
+				case 1: // Y
+					IntersectionPoint = FVector(PositionA.X, FMath::Lerp<float>(PositionA.Y, PositionB.Y, Alpha), PositionA.Z);
+					break;
+				case 3: // Z
+					IntersectionPoint = FVector(PositionA.X, PositionA.Y, FMath::Lerp<float>(PositionA.Z, PositionB.Z, Alpha));
+					break;
+				default:
+					checkVoxelSlow(false);
+				}
+
+				// Use the material of the point inside
+				MaterialPosition = !ValueAtA.IsEmpty() ? PositionA : PositionB;
+			}
+			else
+			{
+				// Interpolate
+
+				const bool bIsAlongX = (EdgeIndex == 2);
+				const bool bIsAlongY = (EdgeIndex == 1);
+				const bool bIsAlongZ = (EdgeIndex == 3);
+
+				checkVoxelSlow(!bIsAlongX || (PositionA.Y == PositionB.Y && PositionA.Z == PositionB.Z));
+				checkVoxelSlow(!bIsAlongY || (PositionA.X == PositionB.X && PositionA.Z == PositionB.Z));
+				checkVoxelSlow(!bIsAlongZ || (PositionA.X == PositionB.X && PositionA.Y == PositionB.Y));
+
+				int32 Min = bIsAlongX ? PositionA.X : bIsAlongY ? PositionA.Y : PositionA.Z;
+				int32 Max = bIsAlongX ? PositionB.X : bIsAlongY ? PositionB.Y : PositionB.Z;
+
+				FVoxelValue ValueAtACopy = ValueAtA;
+				FVoxelValue ValueAtBCopy = ValueAtB;
+
+				while (Max - Min != 1)
+				{
+					checkError((Max + Min) % 2 == 0);
+					const int32 Middle = (Max + Min) / 2;
+
+					FVoxelValue ValueAtMiddle = MESHER_TIME_RETURN_VALUES(1, Accelerator->Get<FVoxelValue>(
+						(bIsAlongX ? Middle : PositionA.X) + ChunkPosition.X,
+						(bIsAlongY ? Middle : PositionA.Y) + ChunkPosition.Y,
+						(bIsAlongZ ? Middle : PositionA.Z) + ChunkPosition.Z, LOD));
+
+					if (ValueAtACopy.IsEmpty() == ValueAtMiddle.IsEmpty())
+					{
+						// If min and middle have same sign
+						Min = Middle;
+						ValueAtACopy = ValueAtMiddle;
+					}
+					else
+					{
+						// If max and middle have same sign
+						Max = Middle;
+						ValueAtBCopy = ValueAtMiddle;
 					}
+
+					checkError(Min <= Max);
+				}
+
+				const float Alpha = ValueAtACopy.ToFloat() / (ValueAtACopy.ToFloat() - ValueAtBCopy.ToFloat());
+				checkError(!FMath::IsNaN(Alpha) && FMath::IsFinite(Alpha));
+
+				const float R = FMath::Lerp<float>(Min, Max, Alpha);
+				IntersectionPoint = FVector(
+					bIsAlongX ? R : PositionA.X,
+					bIsAlongY ? R : PositionA.Y,
+					bIsAlongZ ? R : PositionA.Z);
+
+				// Get intersection material
+				if (!ValueAtACopy.IsEmpty())
+				{
+					checkVoxelSlow(ValueAtBCopy.IsEmpty());
+					MaterialPosition = FIntVector(
+						bIsAlongX ? Min : PositionA.X,
+						bIsAlongY ? Min : PositionA.Y,
+						bIsAlongZ ? Min : PositionA.Z);
+				}
+				else
+				{
+					checkVoxelSlow(!ValueAtBCopy.IsEmpty());
+					MaterialPosition = FIntVector(
+						bIsAlongX ? Max : PositionA.X,
+						bIsAlongY ? Max : PositionA.Y,
+						bIsAlongZ ? Max : PositionA.Z);
 				}
+			}
+
+			VertexIndex = Vertices.Num();
 
-				VoxelIndex++;
+			if (Settings.RenderSharpness != 0)
+			{
+				IntersectionPoint = FVector(FVoxelUtilities::RoundToInt(IntersectionPoint * Settings.RenderSharpness)) / Settings.RenderSharpness;
+			}
+
+			Vertices.Add(T(IntersectionPoint, MaterialPosition));
+
+			checkVoxelSlow((ValueAtB.IsNull() && LocalIndexB == 7) == !CacheDirection);
+			checkVoxelSlow(CacheDirection || EdgeIndex == 0);
+
+			// Save vertex if not on edge
+			if (CacheDirection & 0x08 || !CacheDirection) // ValueAtB.IsNull() && LocalIndexB == 7 => !CacheDirection
+			{
+				CurrentCache[GetCacheIndex(EdgeIndex, LX, LY)] = VertexIndex;
 			}
-			VoxelIndex += 1; // End edge voxel
-			if (LOD == 0) VoxelIndex += 1; // Additional voxel for normals
 		}
-		VoxelIndex += DataSize; // End edge voxel
-		if (LOD == 0) VoxelIndex += DataSize; // Additional voxel for normals
 
-		// Can't use Unreal Swap on restrict ptrs with clang
-		std::swap(CurrentCache, OldCache);
+		VertexIndices[I] = VertexIndex;
+		checkVoxelSlow(0 <= VertexIndex && VertexIndex < Vertices.Num());
+	}
+
+	// Add triangles
+	// 3 vertex per triangle
+	for (int32 Index = 0; Index < 3 * CellData.GetTriangleCount(); Index += 3)
+	{
+		Indices.Add(VertexIndices[CellData.vertexIndex[Index + 0]]);
+		Indices.Add(VertexIndices[CellData.vertexIndex[Index + 1]]);
+		Indices.Add(VertexIndices[CellData.vertexIndex[Index + 2]]);
 	}
 
 	return true;
@@ -750,6 +789,56 @@ FORCEINLINE int32 FVoxelMarchingCubeMesher::GetCacheIndex(int32 EdgeIndex, int32
 	return EdgeIndex + LX * EDGE_INDEX_COUNT + LY * EDGE_INDEX_COUNT * RENDER_CHUNK_SIZE;
 }
 
+FORCEINLINE void FVoxelMarchingCubeMesher::GetCubeIndices(int32 DataSize, uint32 VoxelIndex, uint32 CubeIndices[8])
+{
+	CubeIndices[0] = VoxelIndex;
+	CubeIndices[1] = VoxelIndex + 1;
+	CubeIndices[2] = VoxelIndex     + DataSize;
+	CubeIndices[3] = VoxelIndex + 1 + DataSize;
+	CubeIndices[4] = VoxelIndex                + DataSize * DataSize;
+	CubeIndices[5] = VoxelIndex + 1            + DataSize * DataSize;
+	CubeIndices[6] = VoxelIndex     + DataSize + DataSize * DataSize;
+	CubeIndices[7] = VoxelIndex + 1 + DataSize + DataSize * DataSize;
+
+	checkVoxelSlow(CubeIndices[0] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[1] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[2] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[3] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[4] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[5] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[6] < uint32(DataSize * DataSize * DataSize));
+	checkVoxelSlow(CubeIndices[7] < uint32(DataSize * DataSize * DataSize));
+}
+
+FORCEINLINE uint32 FVoxelMarchingCubeMesher::GetCaseCode(int32 DataSize, uint32 VoxelIndex) const
+{
+	uint32 CubeIndices[8];
+	GetCubeIndices(DataSize, VoxelIndex, CubeIndices);
+
+	return
+		(CachedValues[CubeIndices[0]].IsEmpty() << 0) |
+		(CachedValues[CubeIndices[1]].IsEmpty() << 1) |
+		(CachedValues[CubeIndices[2]].IsEmpty() << 2) |
+		(CachedValues[CubeIndices[3]].IsEmpty() << 3) |
+		(CachedValues[CubeIndices[4]].IsEmpty() << 4) |
+		(CachedValues[CubeIndices[5]].IsEmpty() << 5) |
+		(CachedValues[CubeIndices[6]].IsEmpty() << 6) |
+		(CachedValues[CubeIndices[7]].IsEmpty() << 7);
+}
+
+FORCEINLINE void FVoxelMarchingCubeMesher::GetSliceMasks(int32 DataSize, int32 LZ, uint64* RESTRICT OutMasks) const
+{
+	checkVoxelSlow(0 <= LZ && LZ < CHUNK_SIZE_WITH_END_EDGE);
+
+	// Skip the additional voxels for normals
+	const int32 Offset = LOD == 0 ? 1 : 0;
+	for (int32 LY = 0; LY < CHUNK_SIZE_WITH_END_EDGE; LY++)
+	{
+		const int32 RowStart = Offset + (LY + Offset) * DataSize + (LZ + Offset) * DataSize * DataSize;
+		OutMasks[LY] = FVoxelMarchingCubeKernel::GetEmptyMask(CachedValues + RowStart, CHUNK_SIZE_WITH_END_EDGE);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -791,7 +880,7 @@ bool FVoxelMarchingCubeTransitionsMesher::CreateGeometryForDirection(FVoxelMeshe
 	if (!(TransitionsMask & Direction)) return true;
 	
 #if VOXEL_DEBUG
-	for (auto& Value : Cache2D)
+	for (auto& Value : *Cache2DStorage)
 	{
 		Value = -100;
 	}
@@ -1093,15 +1182,19 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeTransitionsMesher::CreateFull
 		}
 	};
 
-	TArray<uint32> Indices;
-	TArray<FLocalVertex> Vertices;
+	const TVoxelMesherScratchArray<uint32> IndicesStorage;
+	const TVoxelMesherScratchArray<FLocalVertex> VerticesStorage;
+	const TVoxelMesherScratchArray<FVoxelMesherVertex> MesherVerticesStorage;
+	TArray<uint32>& Indices = *IndicesStorage;
+	TArray<FLocalVertex>& Vertices = *VerticesStorage;
+	TArray<FVoxelMesherVertex>& MesherVertices = *MesherVerticesStorage;
 
 	if (!CreateGeometryTemplate(Times, Indices, Vertices))
 	{
 		return {};
 	}
 
-	TArray<FVoxelMesherVertex> MesherVertices = FMarchingCubeHelpers::CreateMesherVertices(Vertices);
+	FMarchingCubeHelpers::CreateMesherVertices(Vertices, MesherVertices);
 
 	MESHER_TIME_MATERIALS(MesherVertices.Num(), FMarchingCubeHelpers::ComputeMaterials(*this, MesherVertices, Vertices));
 	MESHER_TIME(Normals, FMarchingCubeHelpers::ComputeNormals(*this, MesherVertices, Indices));
@@ -1128,7 +1221,7 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeTransitionsMesher::CreateFull
 	// Important: sanitize AFTER translating!
 	FVoxelMesherUtilities::SanitizeMesh(Indices, MesherVertices);
 
-	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(Settings, LOD, MoveTemp(Indices), MoveTemp(MesherVertices)));
+	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(Settings, LOD, Indices, MesherVertices));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6,6 +6,7 @@
 #include "VoxelContainers/VoxelStaticArray.h"
 #include "VoxelData/VoxelDataAccelerator.h"
 #include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
 
 #define CHUNK_SIZE_WITH_END_EDGE (RENDER_CHUNK_SIZE + 1)
 #define CHUNK_SIZE_WITH_NORMALS (RENDER_CHUNK_SIZE + 3)
@@ -38,12 +39,9 @@ public:
 
 private:
 	// Use LOD0 size as it's bigger
-	using FCachedValues = TVoxelStaticArray<FVoxelValue, CHUNK_SIZE_WITH_NORMALS * CHUNK_SIZE_WITH_NORMALS * CHUNK_SIZE_WITH_NORMALS>;
-	using FCache = TVoxelStaticArray<int32, RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * EDGE_INDEX_COUNT>;
-
-	TUniquePtr<FCachedValues> CachedValuesStorage = MakeUnique<FCachedValues>();
-	TUniquePtr<FCache> CacheStorageA = MakeUnique<FCache>();
-	TUniquePtr<FCache> CacheStorageB = MakeUnique<FCache>();
+	const TVoxelMesherScratchArray<FVoxelValue> CachedValuesStorage{ CHUNK_SIZE_WITH_NORMALS * CHUNK_SIZE_WITH_NORMALS * CHUNK_SIZE_WITH_NORMALS };
+	const TVoxelMesherScratchArray<int32, 0> CacheStorageA{ RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * EDGE_INDEX_COUNT };
+	const TVoxelMesherScratchArray<int32, 1> CacheStorageB{ RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * EDGE_INDEX_COUNT };
 	
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
 
@@ -57,10 +55,18 @@ private:
 	// T: will be created as T(IntersectionPoint, MaterialPosition)
 	template<typename T>
 	bool CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
+	// Cell with a nontrivial triangulation. VoxelIndex: index of its first corner in CachedValues
+	template<typename T>
+	bool CreateCell(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices, int32 DataSize, int32 LX, int32 LY, int32 LZ, uint32 VoxelIndex, uint32 CaseCode);
+
+	uint32 GetCaseCode(int32 DataSize, uint32 VoxelIndex) const;
+	// Empty masks of the rows of the Z slice LZ, see FVoxelMarchingCubeKernel
+	void GetSliceMasks(int32 DataSize, int32 LZ, uint64* RESTRICT OutMasks) const;
 
 private:
 	static int32 GetCacheIndex(int32 EdgeIndex, int32 LX, int32 LY);
-	
+	static void GetCubeIndices(int32 DataSize, uint32 VoxelIndex, uint32 CubeIndices[8]);
+
 	friend class FMarchingCubeHelpers;
 };
 
@@ -78,7 +84,8 @@ protected:
 
 private:
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
-	TVoxelStaticArray<int32, RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * TRANSITION_EDGE_INDEX_COUNT> Cache2D;
+	const TVoxelMesherScratchArray<int32> Cache2DStorage{ RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * TRANSITION_EDGE_INDEX_COUNT };
+	int32* RESTRICT const Cache2D = Cache2DStorage->GetData();
 
 private:
 	// T: will be created as T(IntersectionPoint, MaterialPosition, bNeedToTranslate)
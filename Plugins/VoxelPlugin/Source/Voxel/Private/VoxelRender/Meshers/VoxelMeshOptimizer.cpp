@@ -0,0 +1,270 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelRender/Meshers/VoxelMeshOptimizer.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
+
+// Scores from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+struct FVoxelVertexCacheScores
+{
+	static constexpr int32 MaxValence = 32;
+
+	// Index: position in the cache
+	float Cache[FVoxelMeshOptimizer::CacheSize];
+	// Index: number of triangles left to emit using the vertex, clamped to MaxValence
+	float Valence[MaxValence + 1];
+
+	FVoxelVertexCacheScores()
+	{
+		for (int32 Position = 0; Position < FVoxelMeshOptimizer::CacheSize; Position++)
+		{
+			if (Position < 3)
+			{
+				// The vertices of the last triangle: a triangle using them is likely to be degenerate or a strip, don't favor it too much
+				Cache[Position] = 0.75f;
+			}
+			else
+			{
+				Cache[Position] = FMath::Pow(1.f - float(Position - 3) / (FVoxelMeshOptimizer::CacheSize - 3), 1.5f);
+			}
+		}
+
+		Valence[0] = 0.f;
+		for (int32 NumTriangles = 1; NumTriangles <= MaxValence; NumTriangles++)
+		{
+			// Favor the vertices with few triangles left, so that they are not left alone
+			Valence[NumTriangles] = 2.f / FMath::Sqrt(float(NumTriangles));
+		}
+	}
+
+	FORCEINLINE float GetScore(int32 CachePosition, int32 NumTriangles) const
+	{
+		if (NumTriangles == 0)
+		{
+			return 0.f;
+		}
+		return (CachePosition >= 0 ? Cache[CachePosition] : 0.f) + Valence[FMath::Min(NumTriangles, MaxValence)];
+	}
+};
+
+void FVoxelMeshOptimizer::OptimizeVertexCache(TArray<uint32>& Indices, int32 NumVertices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	check(Indices.Num() % 3 == 0);
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	static const FVoxelVertexCacheScores Scores;
+
+	const TVoxelMesherScratchArray<int32, 8> NumLiveTrianglesStorage(NumVertices);
+	const TVoxelMesherScratchArray<int32, 9> AdjacencyOffsetsStorage(NumVertices);
+	const TVoxelMesherScratchArray<int32, 10> AdjacencyStorage(Indices.Num());
+	const TVoxelMesherScratchArray<float, 8> VertexScoresStorage(NumVertices);
+	const TVoxelMesherScratchArray<float, 9> TriangleScoresStorage(NumTriangles);
+	const TVoxelMesherScratchArray<bool, 8> EmittedStorage(NumTriangles);
+	const TVoxelMesherScratchArray<uint32, 8> NewIndicesStorage(Indices.Num());
+
+	// Number of triangles using the vertex that are not emitted yet
+	int32* RESTRICT const NumLiveTriangles = NumLiveTrianglesStorage->GetData();
+	// Adjacency[AdjacencyOffsets[Vertex] + Index] for Index < NumLiveTriangles[Vertex]: these triangles
+	int32* RESTRICT const AdjacencyOffsets = AdjacencyOffsetsStorage->GetData();
+	int32* RESTRICT const Adjacency = AdjacencyStorage->GetData();
+	float* RESTRICT const VertexScores = VertexScoresStorage->GetData();
+	float* RESTRICT const TriangleScores = TriangleScoresStorage->GetData();
+	bool* RESTRICT const Emitted = EmittedStorage->GetData();
+	uint32* RESTRICT const NewIndices = NewIndicesStorage->GetData();
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Adjacency");
+
+		FMemory::Memzero(NumLiveTriangles, NumVertices * sizeof(int32));
+		for (const uint32 Index : Indices)
+		{
+			checkVoxelSlow(Index < uint32(NumVertices));
+			NumLiveTriangles[Index]++;
+		}
+
+		int32 Offset = 0;
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			AdjacencyOffsets[Vertex] = Offset;
+			Offset += NumLiveTriangles[Vertex];
+		}
+
+		FMemory::Memzero(NumLiveTriangles, NumVertices * sizeof(int32));
+		for (int32 Index = 0; Index < Indices.Num(); Index++)
+		{
+			const uint32 Vertex = Indices[Index];
+			Adjacency[AdjacencyOffsets[Vertex] + NumLiveTriangles[Vertex]++] = Index / 3;
+		}
+
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			VertexScores[Vertex] = Scores.GetScore(-1, NumLiveTriangles[Vertex]);
+		}
+		for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+		{
+			TriangleScores[Triangle] =
+				VertexScores[Indices[3 * Triangle + 0]] +
+				VertexScores[Indices[3 * Triangle + 1]] +
+				VertexScores[Indices[3 * Triangle + 2]];
+			Emitted[Triangle] = false;
+		}
+	}
+
+	// The cache is modeled as a LRU: the vertices of the last triangle go first
+	// Vertices pushed past CacheSize are kept for one more iteration, so that their triangles scores are lowered
+	int32 Cache[CacheSize + 3];
+	int32 NewCache[CacheSize + 3];
+	int32 NumCached = 0;
+
+	int32 NumEmitted = 0;
+	// Next triangle to try when no triangle uses a cached vertex
+	int32 InputCursor = 0;
+	int32 Triangle = 0;
+	while (Triangle != -1)
+	{
+		checkVoxelSlow(!Emitted[Triangle]);
+		Emitted[Triangle] = true;
+
+		const uint32 A = Indices[3 * Triangle + 0];
+		const uint32 B = Indices[3 * Triangle + 1];
+		const uint32 C = Indices[3 * Triangle + 2];
+
+		NewIndices[3 * NumEmitted + 0] = A;
+		NewIndices[3 * NumEmitted + 1] = B;
+		NewIndices[3 * NumEmitted + 2] = C;
+		NumEmitted++;
+
+		int32 NumNewCached = 0;
+		NewCache[NumNewCached++] = A;
+		if (B != A) NewCache[NumNewCached++] = B;
+		if (C != A && C != B) NewCache[NumNewCached++] = C;
+		for (int32 Index = 0; Index < NumCached; Index++)
+		{
+			const uint32 Vertex = Cache[Index];
+			if (Vertex != A && Vertex != B && Vertex != C)
+			{
+				NewCache[NumNewCached++] = Vertex;
+			}
+		}
+
+		// Remove the triangle from the adjacency of its vertices. Degenerate triangles are listed once per use of the vertex
+		for (const uint32 Vertex : { A, B, C })
+		{
+			int32* RESTRICT const Triangles = Adjacency + AdjacencyOffsets[Vertex];
+			int32& NumVertexTriangles = NumLiveTriangles[Vertex];
+			for (int32 Index = 0; Index < NumVertexTriangles; Index++)
+			{
+				if (Triangles[Index] == Triangle)
+				{
+					Triangles[Index] = Triangles[NumVertexTriangles - 1];
+					NumVertexTriangles--;
+					break;
+				}
+			}
+		}
+
+		for (int32 Index = 0; Index < NumNewCached; Index++)
+		{
+			const int32 Vertex = NewCache[Index];
+			const float Score = Scores.GetScore(Index < CacheSize ? Index : -1, NumLiveTriangles[Vertex]);
+			const float Delta = Score - VertexScores[Vertex];
+			VertexScores[Vertex] = Score;
+
+			const int32* RESTRICT const Triangles = Adjacency + AdjacencyOffsets[Vertex];
+			for (int32 TriangleIndex = 0; TriangleIndex < NumLiveTriangles[Vertex]; TriangleIndex++)
+			{
+				TriangleScores[Triangles[TriangleIndex]] += Delta;
+			}
+		}
+
+		// Only the triangles using a cached vertex can have a high score
+		Triangle = -1;
+		float BestScore = 0.f;
+		for (int32 Index = 0; Index < NumNewCached; Index++)
+		{
+			const int32 Vertex = NewCache[Index];
+			const int32* RESTRICT const Triangles = Adjacency + AdjacencyOffsets[Vertex];
+			for (int32 TriangleIndex = 0; TriangleIndex < NumLiveTriangles[Vertex]; TriangleIndex++)
+			{
+				const int32 OtherTriangle = Triangles[TriangleIndex];
+				if (TriangleScores[OtherTriangle] > BestScore)
+				{
+					BestScore = TriangleScores[OtherTriangle];
+					Triangle = OtherTriangle;
+				}
+			}
+		}
+
+		NumCached = FMath::Min(NumNewCached, CacheSize);
+		FMemory::Memcpy(Cache, NewCache, NumCached * sizeof(int32));
+
+		if (Triangle == -1)
+		{
+			while (InputCursor < NumTriangles && Emitted[InputCursor])
+			{
+				InputCursor++;
+			}
+			Triangle = InputCursor < NumTriangles ? InputCursor : -1;
+		}
+	}
+	check(NumEmitted == NumTriangles);
+
+	FMemory::Memcpy(Indices.GetData(), NewIndices, Indices.Num() * sizeof(uint32));
+}
+
+void FVoxelMeshOptimizer::OptimizeVertexFetch(TArray<uint32>& Indices, int32 NumVertices, TArray<int32>& OutNewToOld)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const TVoxelMesherScratchArray<int32, 8> OldToNewStorage(NumVertices);
+	int32* RESTRICT const OldToNew = OldToNewStorage->GetData();
+	FMemory::Memset(OldToNew, 0xFF, NumVertices * sizeof(int32));
+
+	OutNewToOld.Reset(NumVertices);
+	for (uint32& Index : Indices)
+	{
+		checkVoxelSlow(Index < uint32(NumVertices));
+		int32& NewIndex = OldToNew[Index];
+		if (NewIndex == -1)
+		{
+			NewIndex = OutNewToOld.Add(Index);
+		}
+		Index = NewIndex;
+	}
+	for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		if (OldToNew[Vertex] == -1)
+		{
+			OutNewToOld.Add(Vertex);
+		}
+	}
+	check(OutNewToOld.Num() == NumVertices);
+}
+
+int32 FVoxelMeshOptimizer::GetNumCacheMisses(const TArray<uint32>& Indices, int32 NumVertices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const TVoxelMesherScratchArray<int32, 8> TimestampsStorage(NumVertices);
+	int32* RESTRICT const Timestamps = TimestampsStorage->GetData();
+	FMemory::Memzero(Timestamps, NumVertices * sizeof(int32));
+
+	// A vertex stays in the cache until CacheSize other vertices are added
+	int32 Time = CacheSize + 1;
+	int32 NumMisses = 0;
+	for (const uint32 Index : Indices)
+	{
+		checkVoxelSlow(Index < uint32(NumVertices));
+		if (Time - Timestamps[Index] > CacheSize)
+		{
+			Timestamps[Index] = Time++;
+			NumMisses++;
+		}
+	}
+	return NumMisses;
+}
@@ -1,6 +1,7 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
 #include "VoxelRender/VoxelMesherAsyncWork.h"
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
@@ -75,6 +76,7 @@ struct FVoxelMesherStats
 		uint64 TotalMaterialsAccesses = 0;
 
 		double TotalDistanceFieldsTime = 0;
+		uint64 TotalScratchAllocations = 0;
 		
 		const auto Print = [&](const TArray<FChunkStats>& Stats)
 		{
@@ -116,6 +118,8 @@ struct FVoxelMesherStats
 
 				Mean.ValuesAccesses += Stat.Times._ValuesAccesses;
 				Mean.MaterialsAccesses += Stat.Times._MaterialsAccesses;
+
+				TotalScratchAllocations += Stat.Times.ScratchAllocations;
 				
 				GlobalTotalTime += Stat.Time;
 			}
@@ -195,6 +199,8 @@ struct FVoxelMesherStats
 		LOG_VOXEL(Log, TEXT("------------------------------"));
 		LOG_VOXEL(Log, TEXT("Values: %llu reads in %fs, avg %.1fns/voxel"), TotalValuesAccesses, TotalValuesTime, TotalValuesTime / TotalValuesAccesses * 1e9);
 		LOG_VOXEL(Log, TEXT("Materials: %llu reads in %fs, avg %.1fns/voxel"), TotalMaterialsAccesses, TotalMaterialsTime, TotalMaterialsTime / TotalMaterialsAccesses * 1e9);
+		const int32 NumChunks = LocalStats.NormalStats.Num() + LocalStats.TransitionsStats.Num() + LocalStats.GeometryStats.Num();
+		LOG_VOXEL(Log, TEXT("Scratch allocations: %llu, avg %.2f/chunk"), TotalScratchAllocations, TotalScratchAllocations / double(FMath::Max(1, NumChunks)));
 	}
 };
 
@@ -226,6 +232,7 @@ FVoxelMesherBase::FVoxelMesherBase(
 	, Settings(Settings)
 	, Data(*Settings.Data)
 	, bIsTransitions(bIsTransitions)
+	, NumScratchAllocationsAtCreation(FVoxelMesherScratch::GetNumAllocations())
 {
 }
 
@@ -293,6 +300,14 @@ void FVoxelMesherBase::FinishCreatingChunk(FVoxelChunkMesh& Chunk) const
 	Chunk.IterateBuffers([](FVoxelChunkMeshBuffers& Buffer) { Buffer.Guid = FGuid::NewGuid(); });
 }
 
+void FVoxelMesherBase::ReportStats(double TotalTime, FVoxelMesherTimes& Times, bool bIsGeometry)
+{
+	// The scratch arrays used by the meshers are released when they are done, except for their fixed size caches that are counted on creation
+	Times.ScratchAllocations = FVoxelMesherScratch::GetNumAllocations() - NumScratchAllocationsAtCreation;
+	LastTimes = Times;
+	FVoxelMesherStats::Report(Settings.World, LOD, TotalTime, Times, bIsTransitions, bIsGeometry);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -346,7 +361,7 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 		}
 
 		const double EndTime = FPlatformTime::Seconds();
-		FVoxelMesherStats::Report(Settings.World, LOD, EndTime - StartTime, Times, false, false);
+		ReportStats(EndTime - StartTime, Times, false);
 	}
 	
 	return Chunk;
@@ -374,7 +389,7 @@ void FVoxelMesher::CreateGeometry(TArray<uint32>& Indices, TArray<FVector>& Vert
 		CreateGeometryImpl(Times, Indices, Vertices);
 		check(!LockInfo.IsValid());
 		const double EndTime = FPlatformTime::Seconds();
-		FVoxelMesherStats::Report(Settings.World, LOD, EndTime - StartTime, Times, false, true);
+		ReportStats(EndTime - StartTime, Times, true);
 	}
 }
 
@@ -424,7 +439,7 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelTransitionsMesher::CreateFullChunk()
 		}
 		
 		const double EndTime = FPlatformTime::Seconds();
-		FVoxelMesherStats::Report(Settings.World, LOD, EndTime - StartTime, Times, true, false);
+		ReportStats(EndTime - StartTime, Times, false);
 	}
 
 	return Chunk;
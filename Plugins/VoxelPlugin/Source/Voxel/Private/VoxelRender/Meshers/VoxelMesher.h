@@ -66,6 +66,10 @@ struct FVoxelMesherTimes
 	
 	uint64 FinishCreatingChunk = 0;
 	uint64 DistanceField = 0;
+
+	// Not a time: number of times the mesher scratch arrays went through the allocator, see TVoxelMesherScratchArray
+	// Should be 0 once all the threads meshed a few chunks
+	uint64 ScratchAllocations = 0;
 };
 
 class FVoxelMesherBase
@@ -91,6 +95,9 @@ public:
 	
 	TVoxelSharedPtr<FVoxelChunkMesh> CreateEmptyChunk() const;
 
+	// Times of the last chunk created by this mesher, 0 if it was empty. Used by voxel.mesher.Benchmark
+	const FVoxelMesherTimes& GetLastTimes() const { return LastTimes; }
+
 protected:
 	virtual FVoxelIntBox GetBoundsToCheckIsEmptyOn() const = 0;
 	virtual FVoxelIntBox GetBoundsToLock() const = 0;
@@ -99,10 +106,14 @@ protected:
 	
 private:
 	TUniquePtr<FVoxelDataLockInfo> LockInfo;
+	// FVoxelMesherScratch::GetNumAllocations when constructed, to also count the scratch arrays of the child classes
+	const uint64 NumScratchAllocationsAtCreation;
+	FVoxelMesherTimes LastTimes;
 
 	void LockData();
 	bool IsEmpty() const;
 	void FinishCreatingChunk(FVoxelChunkMesh& Chunk) const;
+	void ReportStats(double TotalTime, FVoxelMesherTimes& Times, bool bIsGeometry);
 
 	friend class FVoxelMesher;
 	friend class FVoxelTransitionsMesher;
@@ -0,0 +1,99 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+struct FVoxelMesherScratch
+{
+	// Number of times a scratch array of this thread went through the allocator
+	FORCEINLINE static uint64& GetNumAllocations()
+	{
+		thread_local uint64 NumAllocations = 0;
+		return NumAllocations;
+	}
+};
+
+/**
+ * Array reused by all the meshers running on a thread: empty when borrowed, but keeps the allocation of its previous uses,
+ * so that meshing does not go through the allocator once every thread has meshed a few chunks
+ * Slot allows a mesher to borrow several arrays of the same type
+ * If the thread's array is already borrowed (eg, nested meshers), a new array is used instead
+ */
+template<typename T, int32 Slot = 0>
+class TVoxelMesherScratchArray
+{
+public:
+	TVoxelMesherScratchArray()
+	{
+		FStorage& Storage = GetStorage();
+		if (!Storage.bBorrowed)
+		{
+			Storage.bBorrowed = true;
+			Array = &Storage.Array;
+		}
+		else
+		{
+			Array = &FallbackArray;
+		}
+		checkVoxelSlow(Array->Num() == 0);
+		CountedMax = Array->Max();
+	}
+	// For fixed size caches. Elements are not initialized
+	explicit TVoxelMesherScratchArray(int32 Num)
+		: TVoxelMesherScratchArray()
+	{
+		Array->SetNumUninitialized(Num, UE_505_SWITCH(false, EAllowShrinking::No));
+		CountAllocations();
+	}
+	~TVoxelMesherScratchArray()
+	{
+		CountAllocations();
+		if (Array != &FallbackArray)
+		{
+			Array->Reset();
+			GetStorage().bBorrowed = false;
+		}
+	}
+	UE_NONCOPYABLE(TVoxelMesherScratchArray);
+
+	FORCEINLINE TArray<T>& Get() const
+	{
+		return *Array;
+	}
+	FORCEINLINE TArray<T>& operator*() const
+	{
+		return *Array;
+	}
+	FORCEINLINE TArray<T>* operator->() const
+	{
+		return Array;
+	}
+
+private:
+	struct FStorage
+	{
+		TArray<T> Array;
+		bool bBorrowed = false;
+	};
+	FORCEINLINE static FStorage& GetStorage()
+	{
+		thread_local FStorage Storage;
+		return Storage;
+	}
+
+	TArray<T>* Array = nullptr;
+	TArray<T> FallbackArray;
+	int32 CountedMax = 0;
+
+	FORCEINLINE void CountAllocations()
+	{
+		// Not exact if the array grew several times in a row, but good enough to check that we don't allocate
+		if (Array->Max() > CountedMax)
+		{
+			FVoxelMesherScratch::GetNumAllocations()++;
+		}
+		CountedMax = Array->Max();
+	}
+};
@@ -12,7 +12,7 @@ FORCEINLINE int32 AddVertexToBuffer(
 	const FColor* Color = nullptr,
 	const FVector2D* UV = nullptr)
 {
-	const int32 Index = Buffer.Positions.Emplace(Vertex.Position);
+	const int32 Index = Buffer.Positions.Emplace(Vertex.Position, Buffer.LOD);
 	if (Settings.bRenderWorld)
 	{
 		const auto GetColor = [&](FColor InColor)
@@ -31,13 +31,13 @@ FORCEINLINE int32 AddVertexToBuffer(
 		
 		Buffer.Normals.Emplace(Vertex.Normal);
 		Buffer.Tangents.Emplace(Vertex.Tangent);
-		Buffer.TextureCoordinates[0].Emplace(Vertex.TextureCoordinate);
+		Buffer.TextureCoordinates[0].Emplace(FVector2f(Vertex.TextureCoordinate));
 
 		if (MaterialConfig == EVoxelMaterialConfig::MultiIndex)
 		{
 			check(Color && UV);
 			Buffer.Colors.Emplace(GetColor(*Color));
-			Buffer.TextureCoordinates[1].Emplace(*UV);
+			Buffer.TextureCoordinates[1].Emplace(FVector2f(*UV));
 			if (VOXEL_MATERIAL_ENABLE_UV2) Buffer.TextureCoordinates[2].Emplace(Vertex.Material.GetUV_AsFloat(2));
 			if (VOXEL_MATERIAL_ENABLE_UV3) Buffer.TextureCoordinates[3].Emplace(Vertex.Material.GetUV_AsFloat(3));
 		}
@@ -55,12 +55,14 @@ FORCEINLINE int32 AddVertexToBuffer(
 
 inline void ReserveBuffer(
 	FVoxelChunkMeshBuffers& Buffer,
+	int32 LOD,
 	int32 Num,
 	const FVoxelRendererSettings& Settings,
 	EVoxelMaterialConfig MaterialConfig)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 	
+	Buffer.LOD = LOD;
 	Buffer.Positions.Reserve(Num);
 	if (Settings.bRenderWorld)
 	{
@@ -92,8 +94,8 @@ inline void ReserveBuffer(
 TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherUtilities::CreateChunkFromVertices(
 	const FVoxelRendererSettings& Settings, 
 	int32 LOD,
-	TArray<uint32>&& Indices, 
-	TArray<FVoxelMesherVertex>&& Vertices)
+	TArray<uint32>& Indices, 
+	TArray<FVoxelMesherVertex>& Vertices)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
@@ -181,9 +183,10 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherUtilities::CreateChunkFromVertices(
 		Chunk->SetIsSingle(true);
 		FVoxelChunkMeshBuffers& Buffers = Chunk->CreateSingleBuffers();
 
-		Buffers.Indices = MoveTemp(Indices);
+		// Copy instead of moving to keep the scratch allocation, and to not have any slack
+		Buffers.Indices = Indices;
 
-		ReserveBuffer(Buffers, Vertices.Num(), Settings, EVoxelMaterialConfig::RGB);
+		ReserveBuffer(Buffers, LOD, Vertices.Num(), Settings, EVoxelMaterialConfig::RGB);
 		for (auto& Vertex : Vertices)
 		{
 			AddVertexToBuffer(Vertex, Buffers, Settings, EVoxelMaterialConfig::RGB);
@@ -218,7 +221,7 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherUtilities::CreateChunkFromVertices(
 			FVoxelChunkMeshBuffers& Buffer = Chunk->FindOrAddBuffer(MaterialIndices, bAdded);
 			if (bAdded)
 			{
-				ReserveBuffer(Buffer, Vertices.Num(), Settings, EVoxelMaterialConfig::SingleIndex);
+				ReserveBuffer(Buffer, LOD, Vertices.Num(), Settings, EVoxelMaterialConfig::SingleIndex);
 			}
 			
 			TMap<int32, int32>& IndicesMap = IndicesMaps[MaterialIndexToUse];
@@ -327,13 +330,13 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherUtilities::CreateChunkFromVertices(
 				bool bAdded;
 				FVoxelChunkMeshBuffers& Buffer = Chunk->FindOrAddBuffer(VoxelMaterialIndices, bAdded);
 				check(bAdded);
-				ReserveBuffer(Buffer, Vertices.Num(), Settings, EVoxelMaterialConfig::MultiIndex);
+				ReserveBuffer(Buffer, LOD, Vertices.Num(), Settings, EVoxelMaterialConfig::MultiIndex);
 
 				return Buffer;
 			};
 			FVoxelChunkMeshBuffers& Buffer = MakeBuffer();
 
-			Buffer.Indices = MoveTemp(Indices);
+			Buffer.Indices = Indices;
 
 			for (const FVoxelMesherVertex& Vertex : Vertices)
 			{
@@ -7,6 +7,7 @@
 #include "VoxelMaterial.h"
 #include "VoxelDirection.h"
 #include "VoxelRender/VoxelProcMeshTangent.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
 
 struct FVoxelRendererSettings;
 struct FVoxelChunkMesh;
@@ -22,11 +23,12 @@ struct FVoxelMesherVertex
 
 namespace FVoxelMesherUtilities
 {
+	// Indices and Vertices are copied to the chunk buffers, so that they can be mesher scratch arrays
 	TVoxelSharedPtr<FVoxelChunkMesh> CreateChunkFromVertices(
 		const FVoxelRendererSettings& Settings,
 		int32 LOD,
-		TArray<uint32>&& Indices,
-		TArray<FVoxelMesherVertex>&& Vertices);
+		TArray<uint32>& Indices,
+		TArray<FVoxelMesherVertex>& Vertices);
 
 	inline FVector GetTranslatedTransvoxel(const FVector& Vertex, const FVector& Normal, uint8 TransitionsMask, uint8 LOD)
 	{
@@ -121,8 +123,8 @@ namespace FVoxelMesherUtilities
 	{
 		VOXEL_ASYNC_FUNCTION_COUNTER();
 		
-		TArray<uint32> NewIndices;
-		NewIndices.Reserve(Indices.Num());
+		// In place: the write index is always behind the read index
+		int32 NumIndices = 0;
 		check(Indices.Num() % 3 == 0);
 		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
 		{
@@ -139,12 +141,12 @@ namespace FVoxelMesherUtilities
 			const FVector Cross = FVector::CrossProduct(BA, CA);
 			if (Cross.Size() > 1e-4) // See Chaos::FConvexBuilder::IsValidTriangle
 			{
-				NewIndices.Emplace(IndexA);
-				NewIndices.Emplace(IndexB);
-				NewIndices.Emplace(IndexC);
+				Indices[NumIndices++] = IndexA;
+				Indices[NumIndices++] = IndexB;
+				Indices[NumIndices++] = IndexC;
 			}
 		}
-		Indices = MoveTemp(NewIndices);
+		Indices.SetNum(NumIndices, UE_505_SWITCH(false, EAllowShrinking::No));
 	}
 	
 	template<typename T>
@@ -158,22 +160,21 @@ namespace FVoxelMesherUtilities
 			UsedVertices[Index] = true;
 		}
 		
-		TArray<uint32> NewIndices;
-		NewIndices.Empty(Vertices.Num());
-		NewIndices.SetNumUninitialized(Vertices.Num());
+		// Slot 2: the mesher indices & vertex indices might use the other ones
+		const TVoxelMesherScratchArray<uint32, 2> NewIndices(Vertices.Num());
 		
 		int32 WriteIndex = 0;
 		for (int32 ReadIndex = 0; ReadIndex < Vertices.Num(); ReadIndex++)
 		{
 			if (UsedVertices[ReadIndex])
 			{
-				NewIndices[ReadIndex] = WriteIndex;
+				(*NewIndices)[ReadIndex] = WriteIndex;
 				Vertices[WriteIndex] = Vertices[ReadIndex];
 				WriteIndex++;
 			}
 			else
 			{
-				NewIndices[ReadIndex] = -1;
+				(*NewIndices)[ReadIndex] = -1;
 			}
 		}
 		
@@ -182,7 +183,7 @@ namespace FVoxelMesherUtilities
 
 		for (uint32& Index : Indices)
 		{
-			Index = NewIndices[Index];
+			Index = (*NewIndices)[Index];
 			checkVoxelSlow(Index != -1);
 		}
 	}
@@ -544,8 +544,10 @@ void FVoxelSurfaceNetMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TA
 
 TVoxelSharedPtr<FVoxelChunkMesh> FVoxelSurfaceNetMesher::CreateFullChunkImpl(FVoxelMesherTimes& Times)
 {
-	TArray<uint32> Indices;
-	TArray<FVoxelSurfaceNetFullVertex> Vertices;
+	const TVoxelMesherScratchArray<uint32> IndicesStorage;
+	const TVoxelMesherScratchArray<FVoxelSurfaceNetFullVertex> VerticesStorage;
+	TArray<uint32>& Indices = *IndicesStorage;
+	TArray<FVoxelSurfaceNetFullVertex>& Vertices = *VerticesStorage;
 	CreateGeometryTemplate(Times, Indices, Vertices);
 
 	FVoxelMesherUtilities::SanitizeMesh(Indices, Vertices);
@@ -553,8 +555,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelSurfaceNetMesher::CreateFullChunkImpl(FVo
 	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(
 		Settings,
 		LOD,
-		MoveTemp(Indices),
-		MoveTemp(reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices))));
+		Indices,
+		reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices)));
 }
 
 void FVoxelSurfaceNetMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices)
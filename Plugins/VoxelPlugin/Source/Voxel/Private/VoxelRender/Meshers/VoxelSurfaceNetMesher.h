@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "VoxelData/VoxelDataAccelerator.h"
 #include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMesherScratch.h"
 
 /**
  * This code is based on an original implementation kindly provided by Dexyfex
@@ -28,13 +29,20 @@ protected:
 private:
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
 
-	FVoxelValue CachedValues[SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE];
-	float EdgeFactors[SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * 3]; // edge blending factors for each cell, X,Y,Z
-	uint32 VertexIndices[SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE]; // final vertex indices, per voxel. 65535 if no vertex
-	uint8 VertexSNCases[SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE]; // surface net voxel cases for each cell
+	const TVoxelMesherScratchArray<FVoxelValue> CachedValuesStorage{ SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE };
+	const TVoxelMesherScratchArray<float> EdgeFactorsStorage{ SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * 3 };
+	// Slot 1: slot 0 is used for the indices
+	const TVoxelMesherScratchArray<uint32, 1> VertexIndicesStorage{ SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE };
+	const TVoxelMesherScratchArray<uint8> VertexSNCasesStorage{ SN_CHUNK_SIZE * SN_CHUNK_SIZE * SN_CHUNK_SIZE };
+	const TVoxelMesherScratchArray<FIntVector> MaterialPositionsStorage{ SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE };
+
+	FVoxelValue* RESTRICT const CachedValues = CachedValuesStorage->GetData();
+	float* RESTRICT const EdgeFactors = EdgeFactorsStorage->GetData(); // edge blending factors for each cell, X,Y,Z
+	uint32* RESTRICT const VertexIndices = VertexIndicesStorage->GetData(); // final vertex indices, per voxel. 65535 if no vertex
+	uint8* RESTRICT const VertexSNCases = VertexSNCasesStorage->GetData(); // surface net voxel cases for each cell
 
 	// The material position is detected in a first step
-	TVoxelStaticArray<FIntVector, SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE * SN_EXTENDED_CHUNK_SIZE> MaterialPositions;
+	FIntVector* RESTRICT const MaterialPositions = MaterialPositionsStorage->GetData();
 	
 	template<typename TVertex>
 	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<TVertex>& Vertices);
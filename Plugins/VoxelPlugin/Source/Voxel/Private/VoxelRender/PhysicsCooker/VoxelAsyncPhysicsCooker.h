@@ -46,5 +46,6 @@ protected:
 	virtual void DoWork() override;
 	virtual void PostDoWork() override;
 	virtual uint32 GetPriority() const override;
+	virtual bool HasInvokerDistancePriority() const override { return true; }
 	//~ End FVoxelAsyncWork Interface
 };
\ No newline at end of file
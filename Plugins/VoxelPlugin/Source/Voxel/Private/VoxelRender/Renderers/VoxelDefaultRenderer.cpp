@@ -17,12 +17,27 @@
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelRenderer);
 
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voxel Mesh Updates Game Thread Time (ms)"), STAT_VoxelMeshUpdatesTime, STATGROUP_VoxelCounters);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Voxel Mesh Updates Worst Game Thread Time (ms)"), STAT_VoxelMeshUpdatesWorstTime, STATGROUP_VoxelCounters);
+
 static TAutoConsoleVariable<int32> CVarFreezeRenderer(
 	TEXT("voxel.renderer.FreezeRenderer"),
 	0,
 	TEXT("Stops renderer tick"),
 	ECVF_Default);
 
+// Worst time spent applying mesh updates in a single tick, across all the renderers
+static double GVoxelMeshUpdatesWorstTime = 0;
+
+static FAutoConsoleCommand CmdResetMeshUpdatesWorstTime(
+	TEXT("voxel.renderer.ResetMeshUpdatesWorstTime"),
+	TEXT("Resets the Voxel Mesh Updates Worst Game Thread Time stat"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GVoxelMeshUpdatesWorstTime = 0;
+		SET_FLOAT_STAT(STAT_VoxelMeshUpdatesWorstTime, 0);
+	}));
+
 FVoxelDefaultRenderer::FVoxelDefaultRenderer(const FVoxelRendererSettings& Settings)
 	: IVoxelRenderer(Settings)
 	, MeshHandler(Settings.bMergeChunks ? Settings.bDoNotMergeCollisionsAndNavmesh
@@ -635,6 +650,16 @@ int32 FVoxelDefaultRenderer::GetTaskCount() const
 	return UpdateIndex > 0 ? TaskCount.GetValue() : -1;
 }
 
+bool FVoxelDefaultRenderer::IsChunkShown(uint64 ChunkId) const
+{
+	const FChunk* Chunk = ChunksMap.Find(ChunkId);
+	if (!Chunk || !Chunk->Settings.bVisible || Chunk->Tasks.MainTask.IsValid())
+	{
+		return false;
+	}
+	return Chunk->GetState() == EChunkState::DitheringIn || Chunk->GetState() == EChunkState::Showed;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -709,15 +734,27 @@ void FVoxelDefaultRenderer::Tick(float)
 	}
 
 	const double Time = FPlatformTime::Seconds();
-	const double MaxTime = Time + Settings.MeshUpdatesBudget * 0.001f;
+
+	FVoxelMeshUpdatesBudget Budget;
+	Budget.MaxTime = Time + Settings.MeshUpdatesBudget * 0.001f;
+	Budget.SizeLeft = Settings.MeshUpdatesSizeBudget;
 	
 	{
 		VOXEL_SCOPE_COUNTER("MeshHandler Tick");
-		MeshHandler->Tick(MaxTime);
+		MeshHandler->Tick(Budget);
+
+		// Applying the mesh updates is what causes spikes when lots of chunks finish at once
+		const double MeshUpdatesTime = (FPlatformTime::Seconds() - Time) * 1000;
+		INC_FLOAT_STAT_BY(STAT_VoxelMeshUpdatesTime, MeshUpdatesTime);
+		if (MeshUpdatesTime > GVoxelMeshUpdatesWorstTime)
+		{
+			GVoxelMeshUpdatesWorstTime = MeshUpdatesTime;
+			SET_FLOAT_STAT(STAT_VoxelMeshUpdatesWorstTime, MeshUpdatesTime);
+		}
 	}
 	
 	ProcessChunksToRemoveOrShow();
-	ProcessMeshUpdates(MaxTime);
+	ProcessMeshUpdates(Budget.MaxTime);
 	FlushQueuedTasks();
 
 	if (!OnWorldLoadedFired && UpdateIndex > 0 && TaskCount.GetValue() == 0 && TasksCallbacksQueue.IsEmpty())
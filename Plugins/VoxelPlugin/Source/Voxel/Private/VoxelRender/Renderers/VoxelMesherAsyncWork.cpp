@@ -97,8 +97,13 @@ void FVoxelMesherAsyncWork::DoWork()
 		Chunk->SetIsSingle(true);
 		FVoxelChunkMeshBuffers& Buffers = Chunk->CreateSingleBuffers();
 
+		Buffers.LOD = LOD;
 		Buffers.Indices = MoveTemp(Indices);
-		Buffers.Positions = MoveTemp(Vertices);
+		Buffers.Positions.Reserve(Vertices.Num());
+		for (const FVector& Vertex : Vertices)
+		{
+			Buffers.Positions.Emplace(Vertex, LOD);
+		}
 	}
 	
 	FVoxelUtilities::DeleteOnGameThread_AnyThread(PinnedRenderer);
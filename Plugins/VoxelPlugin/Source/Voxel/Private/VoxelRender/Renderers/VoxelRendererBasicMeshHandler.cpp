@@ -90,7 +90,10 @@ private:
 FVoxelRendererBasicMeshHandler::~FVoxelRendererBasicMeshHandler()
 {
 	FlushBuiltDataQueue();
-	FlushActionQueue(MAX_dbl);
+
+	FVoxelMeshUpdatesBudget Budget;
+	Budget.MaxTime = MAX_dbl;
+	FlushActionQueue(Budget);
 	
 	ensure(ChunkInfos.Num() == 0);
 }
@@ -184,14 +187,14 @@ void FVoxelRendererBasicMeshHandler::ClearChunkMaterials()
 	}
 }
 
-void FVoxelRendererBasicMeshHandler::Tick(double MaxTime)
+void FVoxelRendererBasicMeshHandler::Tick(FVoxelMeshUpdatesBudget& Budget)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
+	IVoxelRendererMeshHandler::Tick(Budget);
 
 	FlushBuiltDataQueue();
-	FlushActionQueue(MaxTime);
+	FlushActionQueue(Budget);
 
 	Renderer.Settings.DebugManager->ReportMeshActionQueueNum(ActionQueue.Num());
 }
@@ -219,7 +222,7 @@ void FVoxelRendererBasicMeshHandler::FlushBuiltDataQueue()
 	}
 }
 
-void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
+void FVoxelRendererBasicMeshHandler::FlushActionQueue(FVoxelMeshUpdatesBudget& Budget)
 {
 	VOXEL_FUNCTION_COUNTER();
 	
@@ -227,7 +230,7 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 	// Peek: if UpdateChunk isn't ready yet we don't want to pop the action
 	// Always process dithering in immediately, as else the chunk will be showed until the next tick and then hidden (one frame glitch)
 	while (ActionQueue.Peek(Action) && 
-		(FPlatformTime::Seconds() < MaxTime ||
+		(Budget.HasBudgetLeft() ||
 		 (Action.Action == EAction::DitherChunk && Action.DitherChunk().DitheringType == EDitheringType::Classic_DitherIn)))
 	{
 		auto& ChunkInfo = ChunkInfos[Action.ChunkId];
@@ -294,6 +297,7 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 				for (auto& Section : BuiltMesh.Value)
 				{
 					if (!ensure(Section.Value.IsValid())) continue;
+					Budget.SizeLeft -= Section.Value->GetAllocatedSize();
 					Mesh.AddProcMeshSection(Section.Key, MoveTemp(Section.Value), EVoxelProcMeshSectionUpdate::DelayUpdate);
 				}
 				Mesh.FinishSectionsUpdates();
@@ -18,7 +18,7 @@ public:
 	virtual FChunkId AddChunkImpl(int32 LOD, const FIntVector& Position) final override;
 	virtual void ApplyAction(const FAction& Action) final override;
 	virtual void ClearChunkMaterials() final override;
-	virtual void Tick(double MaxTime) final override;
+	virtual void Tick(FVoxelMeshUpdatesBudget& Budget) final override;
 	//~ End IVoxelRendererMeshHandler Interface
 	
 private:
@@ -99,7 +99,7 @@ private:
 	TVoxelQueueWithNum<FAction, EQueueMode::Spsc> ActionQueue;
 
 	void FlushBuiltDataQueue();
-	void FlushActionQueue(double MaxTime);
+	void FlushActionQueue(FVoxelMeshUpdatesBudget& Budget);
 	void MeshMergeCallback(FChunkInfoRef ChunkInfoRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes);
 
 	friend class FVoxelBasicMeshMergeWork;
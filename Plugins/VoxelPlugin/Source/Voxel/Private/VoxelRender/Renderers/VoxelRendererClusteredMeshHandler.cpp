@@ -6,6 +6,7 @@
 #include "VoxelRender/VoxelChunkMaterials.h"
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelRender/VoxelClusterBufferPool.h"
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelUtilities/VoxelThreadingUtilities.h"
 #include "IVoxelPool.h"
@@ -101,7 +102,10 @@ private:
 FVoxelRendererClusteredMeshHandler::~FVoxelRendererClusteredMeshHandler()
 {
 	FlushBuiltDataQueue();
-	FlushActionQueue(MAX_dbl);
+
+	FVoxelMeshUpdatesBudget Budget;
+	Budget.MaxTime = MAX_dbl;
+	FlushActionQueue(Budget);
 	
 	ensure(ChunkInfos.Num() == 0);
 	ensure(Clusters.Num() == 0);
@@ -239,14 +243,19 @@ void FVoxelRendererClusteredMeshHandler::ClearChunkMaterials()
 	}
 }
 
-void FVoxelRendererClusteredMeshHandler::Tick(double MaxTime)
+void FVoxelRendererClusteredMeshHandler::Tick(FVoxelMeshUpdatesBudget& Budget)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
+	IVoxelRendererMeshHandler::Tick(Budget);
+
+	if (Renderer.Settings.bPoolClustersBuffers && Renderer.Settings.bRenderWorld && !BufferPool.IsValid())
+	{
+		BufferPool = MakeUnique<FVoxelClusterBufferPool>();
+	}
 
 	FlushBuiltDataQueue();
-	FlushActionQueue(MaxTime);
+	FlushActionQueue(Budget);
 
 	Renderer.Settings.DebugManager->ReportMeshActionQueueNum(ActionQueue.Num());
 }
@@ -290,13 +299,13 @@ void FVoxelRendererClusteredMeshHandler::FlushBuiltDataQueue()
 	}
 }
 
-void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
+void FVoxelRendererClusteredMeshHandler::FlushActionQueue(FVoxelMeshUpdatesBudget& Budget)
 {
 	VOXEL_FUNCTION_COUNTER();
 	
 	FAction Action;
 	// Peek: if UpdateChunk isn't ready yet we don't want to pop the action
-	while (ActionQueue.Peek(Action) && FPlatformTime::Seconds() < MaxTime)
+	while (ActionQueue.Peek(Action) && Budget.HasBudgetLeft())
 	{
 		auto& ChunkInfo = ChunkInfos[Action.ChunkId];
 
@@ -343,6 +352,7 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 
 			int32 MeshIndex = 0;
 			CleanUp(Cluster.Meshes);
+			TMap<FSectionKey, TVoxelSharedPtr<const FVoxelClusterBufferAllocation>> BufferAllocations;
 			// Apply built meshes
 			for (auto& BuiltMesh : *BuiltMeshes)
 			{
@@ -362,7 +372,32 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 				Mesh.ClearSections(EVoxelProcMeshSectionUpdate::DelayUpdate);
 				for (auto& Section : BuiltMesh.Value)
 				{
-					Mesh.AddProcMeshSection(Section.Key, MoveTemp(Section.Value), EVoxelProcMeshSectionUpdate::DelayUpdate);
+					TVoxelSharedPtr<const FVoxelClusterBufferAllocation> BufferAllocation;
+					if (BufferPool.IsValid() && Section.Key.bSectionVisible)
+					{
+						TVoxelSharedPtr<const FVoxelClusterBufferAllocation> PreviousBufferAllocation;
+						Cluster.BufferAllocations.RemoveAndCopyValue({ MeshConfig, Section.Key }, PreviousBufferAllocation);
+
+						BufferAllocation = BufferPool->Allocate(*Section.Value, PreviousBufferAllocation);
+						Section.Value->ClusterBufferAllocation = BufferAllocation;
+					}
+
+					// Only the chunks that changed are uploaded when using the pool
+					Budget.SizeLeft -= BufferAllocation.IsValid() ? BufferAllocation->GetUploadSize() : Section.Value->GetAllocatedSize();
+					const int32 SectionIndex = Mesh.AddProcMeshSection(Section.Key, MoveTemp(Section.Value), EVoxelProcMeshSectionUpdate::DelayUpdate);
+
+					if (BufferAllocation.IsValid())
+					{
+						if (SectionIndex == -1)
+						{
+							BufferPool->Free(BufferAllocation);
+						}
+						else
+						{
+							BufferPool->Upload(Mesh.GetProcMeshSectionBuffers(SectionIndex).ToSharedRef());
+							BufferAllocations.Add({ MeshConfig, Section.Key }, BufferAllocation);
+						}
+					}
 				}
 				Mesh.FinishSectionsUpdates();
 
@@ -377,6 +412,10 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 				Mesh.ClearSections(EVoxelProcMeshSectionUpdate::UpdateNow);
 			}
 
+			// Free the sections that are gone
+			FreeBufferAllocations(Cluster);
+			Cluster.BufferAllocations = MoveTemp(BufferAllocations);
+
 			// Handle distance fields
 			const auto& DistanceFieldVolumeData = Action.UpdateChunk().AfterCall.DistanceFieldVolumeData;
 			if (DistanceFieldVolumeData.IsValid())
@@ -406,6 +445,7 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 					{
 						RemoveMesh(*Mesh);
 					}
+					FreeBufferAllocations(Cluster);
 					Clusters.RemoveAt(ChunkInfo.ClusterId);
 				}
 			}
@@ -429,6 +469,18 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 	}
 }
 
+void FVoxelRendererClusteredMeshHandler::FreeBufferAllocations(FCluster& Cluster)
+{
+	if (BufferPool.IsValid())
+	{
+		for (auto& It : Cluster.BufferAllocations)
+		{
+			BufferPool->Free(It.Value);
+		}
+	}
+	Cluster.BufferAllocations.Reset();
+}
+
 void FVoxelRendererClusteredMeshHandler::MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes)
 {
 	CallbackQueue.Enqueue({ ClusterRef, FClusterBuiltData{ UpdateIndex,  MoveTemp(BuiltMeshes) } });
@@ -9,6 +9,9 @@
 #include "VoxelRender/VoxelRenderUtilities.h"
 #include "VoxelRendererMeshHandler.h"
 
+class FVoxelClusterBufferPool;
+struct FVoxelClusterBufferAllocation;
+
 class FVoxelRendererClusteredMeshHandler : public IVoxelRendererMeshHandler
 {
 public:
@@ -19,12 +22,14 @@ public:
 	virtual FChunkId AddChunkImpl(int32 LOD, const FIntVector& Position) final override;
 	virtual void ApplyAction(const FAction& Action) final override;
 	virtual void ClearChunkMaterials() final override;
-	virtual void Tick(double MaxTime) final override;
+	virtual void Tick(FVoxelMeshUpdatesBudget& Budget) final override;
 	//~ End IVoxelRendererMeshHandler Interface
 
 private:
 	DEFINE_TYPED_VOXEL_SPARSE_ARRAY_ID(FClusterId);
 	
+	using FSectionKey = TPair<FVoxelMeshConfig, FVoxelProcMeshSectionSettings>;
+
 	struct FClusterBuiltData
 	{
 		int32 UpdateIndex = -1;
@@ -54,6 +59,9 @@ private:
 		// Shared ptr: used by build task
 		TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>> ChunkMeshesToBuild;
 
+		// Ranges of the sections currently displayed in the buffer pool, reused by the next update
+		TMap<FSectionKey, TVoxelSharedPtr<const FVoxelClusterBufferAllocation>> BufferAllocations;
+
 		static FCluster Create(
 			int32 LOD,
 			const FIntVector& Position)
@@ -74,6 +82,9 @@ private:
 	};
 	TVoxelTypedSparseArray<FClusterId, FCluster> Clusters;
 
+	// Only if bPoolClustersBuffers
+	TUniquePtr<FVoxelClusterBufferPool> BufferPool;
+
 	struct FClusterRef
 	{
 		FClusterId ClusterId;
@@ -138,7 +149,8 @@ private:
 	TVoxelQueueWithNum<FAction, EQueueMode::Spsc> ActionQueue;
 
 	void FlushBuiltDataQueue();
-	void FlushActionQueue(double MaxTime);
+	void FlushActionQueue(FVoxelMeshUpdatesBudget& Budget);
+	void FreeBufferAllocations(FCluster& Cluster);
 	void MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes);
 
 	friend class FVoxelClusteredMeshMergeWork;
@@ -202,7 +202,7 @@ void IVoxelRendererMeshHandler::ShowChunk(FChunkId ChunkId)
 	ApplyAction(Action);
 }
 
-void IVoxelRendererMeshHandler::Tick(double MaxTime)
+void IVoxelRendererMeshHandler::Tick(FVoxelMeshUpdatesBudget& Budget)
 {
 	TickHandler();
 }
@@ -22,6 +22,19 @@ class TAutoConsoleVariable;
 
 extern TAutoConsoleVariable<int32> CVarLogActionQueue;
 
+// Limits the mesh updates applied in a single renderer tick. Shared by all the mesh handlers of a renderer
+struct FVoxelMeshUpdatesBudget
+{
+	double MaxTime = 0;
+	// Size of the mesh buffers that can still be applied, see FVoxelRendererSettingsBase::MeshUpdatesSizeBudget
+	int64 SizeLeft = MAX_int64;
+
+	inline bool HasBudgetLeft() const
+	{
+		return SizeLeft > 0 && FPlatformTime::Seconds() < MaxTime;
+	}
+};
+
 class IVoxelRendererMeshHandler : public IVoxelProceduralMeshComponent_PhysicsCallbackHandler
 {
 public:
@@ -56,7 +69,7 @@ public:
 	// Used for ApplyNewMaterials
 	virtual void ClearChunkMaterials() = 0;
 
-	virtual void Tick(double MaxTime);
+	virtual void Tick(FVoxelMeshUpdatesBudget& Budget);
 
 public:
 	virtual void RecomputeMeshPositions();
@@ -122,14 +122,14 @@ void FVoxelRendererMixedMeshHandler::ClearChunkMaterials()
 	ClusteredMeshHandler->ClearChunkMaterials();
 }
 
-void FVoxelRendererMixedMeshHandler::Tick(double MaxTime)
+void FVoxelRendererMixedMeshHandler::Tick(FVoxelMeshUpdatesBudget& Budget)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
+	IVoxelRendererMeshHandler::Tick(Budget);
 
-	BasicMeshHandler->Tick(MaxTime);
-	ClusteredMeshHandler->Tick(MaxTime);
+	BasicMeshHandler->Tick(Budget);
+	ClusteredMeshHandler->Tick(Budget);
 }
 
 void FVoxelRendererMixedMeshHandler::RecomputeMeshPositions()
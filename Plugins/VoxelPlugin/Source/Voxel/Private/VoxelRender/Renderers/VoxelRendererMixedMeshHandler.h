@@ -18,7 +18,7 @@ public:
 	virtual FChunkId AddChunkImpl(int32 LOD, const FIntVector& Position) override;
 	virtual void ApplyAction(const FAction& Action) override;
 	virtual void ClearChunkMaterials() override;
-	virtual void Tick(double MaxTime) override;
+	virtual void Tick(FVoxelMeshUpdatesBudget& Budget) override;
 
 	virtual void RecomputeMeshPositions() override;
 	virtual void ApplyToAllMeshes(TFunctionRef<void(UVoxelProceduralMeshComponent&)> Lambda) override;
@@ -2,6 +2,7 @@
 
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelRender/Meshers/VoxelMeshOptimizer.h"
 #include "VoxelData/VoxelDataIncludes.h"
 #include "VoxelUtilities/VoxelDistanceFieldUtilities.h"
 
@@ -12,10 +13,6 @@
 #include "ThirdParty/nvtesslib/inc/nvtess.h"
 #endif
 
-#if ENABLE_OPTIMIZE_INDICES
-#include "ThirdParty/ForsythTriOO/Src/forsythtriangleorderoptimizer.h"
-#endif
-
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelChunkMeshMemory);
 
 #if ENABLE_TESSELLATION
@@ -68,7 +65,14 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 #if ENABLE_TESSELLATION
 	if (Indices.Num())
 	{
-		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(Positions, Indices);
+		TArray<FVector> UnpackedPositions;
+		UnpackedPositions.Reserve(GetNumVertices());
+		for (int32 Index = 0; Index < GetNumVertices(); Index++)
+		{
+			UnpackedPositions.Add(GetPosition(Index));
+		}
+		
+		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(UnpackedPositions, Indices);
 		nv::IndexBuffer* PnAENIndexBuffer = nv::tess::buildTessellationBuffer(&StaticMeshRenderBuffer, nv::DBM_PnAenDominantCorner, true);
 		check(PnAENIndexBuffer);
 		const int32 IndexCount = int32(PnAENIndexBuffer->getLength());
@@ -93,15 +97,34 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 
 void FVoxelChunkMeshBuffers::OptimizeIndices()
 {
-#if ENABLE_OPTIMIZE_INDICES
 	VOXEL_ASYNC_FUNCTION_COUNTER();
-	
-	TArray<uint32> OptimizedIndices;
-	OptimizedIndices.AddUninitialized(Indices.Num());
-	const uint16 CacheSize = 32;
-	Forsyth::OptimizeFaces(Indices.GetData(), Indices.Num(), GetNumVertices(), OptimizedIndices.GetData(), CacheSize);
-	Indices = MoveTemp(OptimizedIndices);
-#endif
+
+	const int32 NumVertices = GetNumVertices();
+	FVoxelMeshOptimizer::OptimizeVertexCache(Indices, NumVertices);
+
+	TArray<int32> NewToOld;
+	FVoxelMeshOptimizer::OptimizeVertexFetch(Indices, NumVertices, NewToOld);
+
+	const auto Remap = [&](auto& Array)
+	{
+		if (Array.Num() == 0)
+		{
+			return;
+		}
+		check(Array.Num() == NumVertices);
+
+		auto OldArray = MoveTemp(Array);
+		Array.Empty(NumVertices);
+		for (const int32 OldIndex : NewToOld)
+		{
+			Array.Add(OldArray[OldIndex]);
+		}
+	};
+	Remap(Positions);
+	Remap(Normals);
+	Remap(Tangents);
+	Remap(Colors);
+	for (auto& T : TextureCoordinates) Remap(T);
 }
 
 void FVoxelChunkMeshBuffers::Shrink()
@@ -120,7 +143,7 @@ void FVoxelChunkMeshBuffers::ComputeBounds()
 	Bounds = FBox(ForceInit);
 	for (auto& Vertex : Positions)
 	{
-		Bounds += Vertex;
+		Bounds += Vertex.Unpack(LOD);
 	}
 }
 
@@ -0,0 +1,634 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelRender/VoxelClusterBufferPool.h"
+#include "VoxelMinimal.h"
+
+#include "RenderUtils.h"
+#include "RenderingThread.h"
+#include "Algo/BinarySearch.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelClusterBufferPoolMemory);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Num Voxel Cluster Buffer Arenas"), STAT_NumVoxelClusterBufferArenas, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Cluster Buffer Pool Uploaded Bytes"), STAT_VoxelClusterBufferPoolUploadedBytes, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Cluster Buffer Pool Skipped Bytes"), STAT_VoxelClusterBufferPoolSkippedBytes, STATGROUP_VoxelCounters);
+
+// Game thread only
+static TArray<FVoxelClusterBufferPool*> GVoxelClusterBufferPools;
+
+static FAutoConsoleCommand CmdLogClusterBufferPools(
+	TEXT("voxel.renderer.LogClusterBufferPools"),
+	TEXT("Logs the usage of the GPU buffer pools of the merged chunks, see AVoxelWorld::bPoolClustersBuffers"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (const FVoxelClusterBufferPool* Pool : GVoxelClusterBufferPools)
+		{
+			const FVoxelClusterBufferPoolStats Stats = Pool->GetStats();
+			LOG_VOXEL(Log, TEXT("Cluster buffer pool: %d arenas (%lld created); %d allocations; vertices: %lld/%lld; indices: %lld/%lld; %lldMB allocated; %lldMB uploaded; %lldMB not uploaded thanks to the pool"),
+				Stats.NumArenas,
+				Stats.NumArenasCreated,
+				Stats.NumAllocations,
+				Stats.NumUsedVertices,
+				Stats.NumVertices,
+				Stats.NumUsedIndices,
+				Stats.NumIndices,
+				Stats.AllocatedSize >> 20,
+				Stats.UploadedSize >> 20,
+				Stats.SkippedUploadSize >> 20);
+		}
+	}));
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelRangeAllocator::FVoxelRangeAllocator(int32 Capacity)
+	: Capacity(Capacity)
+{
+	check(Capacity > 0);
+	FreeRanges.Add(FVoxelBufferRange(0, Capacity));
+}
+
+bool FVoxelRangeAllocator::Allocate(int32 Num, FVoxelBufferRange& OutRange)
+{
+	check(Num >= 0);
+	if (Num == 0)
+	{
+		OutRange = FVoxelBufferRange();
+		return true;
+	}
+
+	// Best fit: keeps the large ranges for the large allocations
+	int32 BestIndex = -1;
+	for (int32 Index = 0; Index < FreeRanges.Num(); Index++)
+	{
+		const int32 RangeNum = FreeRanges[Index].Num;
+		if (RangeNum >= Num && (BestIndex == -1 || RangeNum < FreeRanges[BestIndex].Num))
+		{
+			BestIndex = Index;
+			if (RangeNum == Num)
+			{
+				break;
+			}
+		}
+	}
+	if (BestIndex == -1)
+	{
+		return false;
+	}
+
+	FVoxelBufferRange& FreeRange = FreeRanges[BestIndex];
+	OutRange = FVoxelBufferRange(FreeRange.Start, Num);
+	FreeRange.Start += Num;
+	FreeRange.Num -= Num;
+	if (FreeRange.Num == 0)
+	{
+		FreeRanges.RemoveAt(BestIndex);
+	}
+
+	NumUsed += Num;
+	NumAllocations++;
+	return true;
+}
+
+void FVoxelRangeAllocator::Free(const FVoxelBufferRange& Range)
+{
+	if (Range.Num == 0)
+	{
+		return;
+	}
+	check(0 <= Range.Start && Range.End() <= Capacity);
+
+	const int32 Index = Algo::LowerBoundBy(FreeRanges, Range.Start, [](const FVoxelBufferRange& FreeRange) { return FreeRange.Start; });
+	checkf(Index == 0 || FreeRanges[Index - 1].End() <= Range.Start, TEXT("Range freed twice"));
+	checkf(Index == FreeRanges.Num() || Range.End() <= FreeRanges[Index].Start, TEXT("Range freed twice"));
+
+	const bool bMergeWithPrevious = Index > 0 && FreeRanges[Index - 1].End() == Range.Start;
+	const bool bMergeWithNext = Index < FreeRanges.Num() && Range.End() == FreeRanges[Index].Start;
+	if (bMergeWithPrevious && bMergeWithNext)
+	{
+		FreeRanges[Index - 1].Num += Range.Num + FreeRanges[Index].Num;
+		FreeRanges.RemoveAt(Index);
+	}
+	else if (bMergeWithPrevious)
+	{
+		FreeRanges[Index - 1].Num += Range.Num;
+	}
+	else if (bMergeWithNext)
+	{
+		FreeRanges[Index].Start = Range.Start;
+		FreeRanges[Index].Num += Range.Num;
+	}
+	else
+	{
+		FreeRanges.Insert(Range, Index);
+	}
+
+	NumUsed -= Range.Num;
+	NumAllocations--;
+	ensure(NumUsed >= 0 && NumAllocations >= 0);
+}
+
+int32 FVoxelRangeAllocator::GetLargestFreeRange() const
+{
+	int32 Largest = 0;
+	for (const FVoxelBufferRange& FreeRange : FreeRanges)
+	{
+		Largest = FMath::Max(Largest, FreeRange.Num);
+	}
+	return Largest;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelClusterBufferArena::FVoxelClusterBufferArena(int32 NumTexCoords, bool bFullPrecisionUVs)
+	: NumTexCoords(NumTexCoords)
+	, bFullPrecisionUVs(bFullPrecisionUVs)
+	, VertexFactory(GMaxRHIFeatureLevel, "FVoxelClusterBufferArena")
+{
+	INC_DWORD_STAT(STAT_NumVoxelClusterBufferArenas);
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelClusterBufferPoolMemory, GetAllocatedSize());
+}
+
+bool FVoxelClusterBufferArena::IsCompatible(const FVoxelProcMeshBuffers& Buffers) const
+{
+	const auto& StaticMeshBuffer = Buffers.VertexBuffers.StaticMeshVertexBuffer;
+	return
+		int32(StaticMeshBuffer.GetNumTexCoords()) == NumTexCoords &&
+		StaticMeshBuffer.GetUseFullPrecisionUVs() == bFullPrecisionUVs;
+}
+
+int32 FVoxelClusterBufferArena::GetVertexSize() const
+{
+	return
+		sizeof(FVector3f) +
+		2 * sizeof(FPackedNormal) +
+		NumTexCoords * (bFullPrecisionUVs ? sizeof(FVector2f) : sizeof(FVector2DHalf)) +
+		sizeof(FColor);
+}
+
+int64 FVoxelClusterBufferArena::GetAllocatedSize() const
+{
+	return int64(VertexCapacity) * GetVertexSize() + int64(IndexCapacity) * sizeof(uint32);
+}
+
+void FVoxelClusterBufferArena::InitResources_RenderThread(FRHICommandListImmediate& RHICmdList)
+{
+	VOXEL_RENDER_FUNCTION_COUNTER();
+	check(IsInRenderingThread());
+
+	// The initial data is discarded once uploaded: the ranges are written by FVoxelClusterBufferPool::Upload
+	VertexBuffers.PositionVertexBuffer.Init(VertexCapacity, false);
+	VertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(bFullPrecisionUVs);
+	VertexBuffers.StaticMeshVertexBuffer.Init(VertexCapacity, NumTexCoords, false);
+	VertexBuffers.ColorVertexBuffer.Init(VertexCapacity, false);
+	IndexBuffer.AllocateData(IndexCapacity);
+	check(IndexBuffer.Is32Bit());
+
+	VertexBuffers.PositionVertexBuffer.InitResource(UE_503_ONLY(RHICmdList));
+	VertexBuffers.StaticMeshVertexBuffer.InitResource(UE_503_ONLY(RHICmdList));
+	VertexBuffers.ColorVertexBuffer.InitResource(UE_503_ONLY(RHICmdList));
+	IndexBuffer.InitResource(UE_503_ONLY(RHICmdList));
+
+	FLocalVertexFactory::FDataType Data;
+	VertexBuffers.PositionVertexBuffer.BindPositionVertexBuffer(&VertexFactory, Data);
+	VertexBuffers.StaticMeshVertexBuffer.BindTangentVertexBuffer(&VertexFactory, Data);
+	VertexBuffers.StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(&VertexFactory, Data);
+	VertexBuffers.ColorVertexBuffer.BindColorVertexBuffer(&VertexFactory, Data);
+	VertexFactory.SetData(UE_504_ONLY(RHICmdList, ) Data);
+	VertexFactory.InitResource(UE_503_ONLY(RHICmdList));
+}
+
+void FVoxelClusterBufferArena::ReleaseResources_RenderThread()
+{
+	VOXEL_RENDER_FUNCTION_COUNTER();
+	check(IsInRenderingThread());
+
+	VertexBuffers.PositionVertexBuffer.ReleaseResource();
+	VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+	VertexBuffers.ColorVertexBuffer.ReleaseResource();
+	IndexBuffer.ReleaseResource();
+	VertexFactory.ReleaseResource();
+
+	DEC_DWORD_STAT(STAT_NumVoxelClusterBufferArenas);
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelClusterBufferPoolMemory, GetAllocatedSize());
+}
+
+int64 FVoxelClusterBufferAllocation::GetUploadSize() const
+{
+	int64 NumVertices = 0;
+	for (const int32 ChunkIndex : DirtyChunks)
+	{
+		NumVertices += ChunksVertices[ChunkIndex].Num;
+	}
+	return NumVertices * Arena->GetVertexSize() + Indices.Num * sizeof(uint32);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelClusterBufferPool::FVoxelClusterBufferPool()
+{
+	check(IsInGameThread());
+	GVoxelClusterBufferPools.Add(this);
+}
+
+FVoxelClusterBufferPool::~FVoxelClusterBufferPool()
+{
+	check(IsInGameThread());
+	ensure(GVoxelClusterBufferPools.Remove(this) == 1);
+	// The arenas are kept alive by the allocations still used by scene proxies
+}
+
+bool FVoxelClusterBufferPool::CanPool(const FVoxelProcMeshBuffers& Buffers)
+{
+	const int32 NumVertices = Buffers.GetNumVertices();
+	const auto& VertexBuffers = Buffers.VertexBuffers;
+
+	if (Buffers.Chunks.Num() == 0 ||
+		Buffers.GetNumIndices() == 0 ||
+		Buffers.AdjacencyIndexBuffer.GetNumIndices() > 0)
+	{
+		return false;
+	}
+	if (NumVertices > FVoxelClusterBufferArena::VertexCapacity ||
+		Buffers.GetNumIndices() > FVoxelClusterBufferArena::IndexCapacity)
+	{
+		return false;
+	}
+	// Not rendered
+	if (int32(VertexBuffers.StaticMeshVertexBuffer.GetNumVertices()) != NumVertices ||
+		int32(VertexBuffers.ColorVertexBuffer.GetNumVertices()) != NumVertices)
+	{
+		return false;
+	}
+	if (VertexBuffers.StaticMeshVertexBuffer.GetUseHighPrecisionTangentBasis())
+	{
+		return false;
+	}
+#if RHI_RAYTRACING
+	// The ray tracing geometry is built from the section own buffers
+	if (IsRayTracingEnabled())
+	{
+		return false;
+	}
+#endif
+	return true;
+}
+
+TVoxelSharedPtr<const FVoxelClusterBufferAllocation> FVoxelClusterBufferPool::Allocate(
+	const FVoxelProcMeshBuffers& Buffers,
+	const TVoxelSharedPtr<const FVoxelClusterBufferAllocation>& Previous)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	if (!CanPool(Buffers))
+	{
+		Free(Previous);
+		RemoveEmptyArenas();
+		return nullptr;
+	}
+
+	TVoxelSharedPtr<FVoxelClusterBufferAllocation> Allocation;
+	if (Previous.IsValid() && Previous->Arena->IsCompatible(Buffers))
+	{
+		// Frees Previous even if it fails
+		Allocation = AllocateInArena(Previous->Arena, Buffers, Previous.Get());
+	}
+	else
+	{
+		Free(Previous);
+	}
+
+	for (int32 Index = 0; Index < Arenas.Num() && !Allocation.IsValid(); Index++)
+	{
+		if (Arenas[Index]->IsCompatible(Buffers))
+		{
+			Allocation = AllocateInArena(Arenas[Index], Buffers, nullptr);
+		}
+	}
+	if (!Allocation.IsValid())
+	{
+		Allocation = AllocateInArena(CreateArena(Buffers), Buffers, nullptr);
+	}
+	RemoveEmptyArenas();
+
+	if (!ensure(Allocation.IsValid()))
+	{
+		return nullptr;
+	}
+
+	Stats.NumAllocations++;
+
+	int64 NumReusedVertices = 0;
+	for (const FVoxelBufferRange& Range : Allocation->ChunksVertices)
+	{
+		NumReusedVertices += Range.Num;
+	}
+	for (const int32 ChunkIndex : Allocation->DirtyChunks)
+	{
+		NumReusedVertices -= Allocation->ChunksVertices[ChunkIndex].Num;
+	}
+	Stats.SkippedUploadSize += NumReusedVertices * Allocation->Arena->GetVertexSize();
+	INC_DWORD_STAT_BY(STAT_VoxelClusterBufferPoolSkippedBytes, NumReusedVertices * Allocation->Arena->GetVertexSize());
+
+	return Allocation;
+}
+
+void FVoxelClusterBufferPool::Free(const TVoxelSharedPtr<const FVoxelClusterBufferAllocation>& Allocation)
+{
+	check(IsInGameThread());
+
+	if (!Allocation.IsValid())
+	{
+		return;
+	}
+	if (!ensure(!Allocation->bFreed))
+	{
+		return;
+	}
+	Allocation->bFreed = true;
+	Stats.NumAllocations--;
+
+	FVoxelClusterBufferArena& Arena = *Allocation->Arena;
+	for (const FVoxelBufferRange& Range : Allocation->ChunksVertices)
+	{
+		Arena.VertexAllocator.Free(Range);
+	}
+	Arena.IndexAllocator.Free(Allocation->Indices);
+}
+
+static void UploadAllocation_RenderThread(
+	FRHICommandListImmediate& RHICmdList,
+	const FVoxelProcMeshBuffers& Buffers,
+	const FVoxelClusterBufferAllocation& Allocation)
+{
+	VOXEL_RENDER_FUNCTION_COUNTER();
+	check(IsInRenderingThread());
+
+	FVoxelClusterBufferArena& Arena = *Allocation.Arena;
+	const FStaticMeshVertexBuffers& Source = Buffers.VertexBuffers;
+	const int32 NumVertices = Buffers.GetNumVertices();
+
+	const auto CopyVertices = [&](FRHIBuffer* Buffer, const void* Data, uint32 Stride, int32 FirstVertex, const FVoxelBufferRange& Range)
+	{
+		void* RESTRICT Dest = RHICmdList.LockBuffer(Buffer, Range.Start * Stride, Range.Num * Stride, RLM_WriteOnly);
+		FMemory::Memcpy(Dest, static_cast<const uint8*>(Data) + FirstVertex * Stride, Range.Num * Stride);
+		RHICmdList.UnlockBuffer(Buffer);
+	};
+
+	const uint32 TangentStride = Source.StaticMeshVertexBuffer.GetTangentSize() / NumVertices;
+	const uint32 TexCoordStride = Source.StaticMeshVertexBuffer.GetTexCoordSize() / NumVertices;
+
+	for (const int32 ChunkIndex : Allocation.DirtyChunks)
+	{
+		const FVoxelProcMeshBuffersChunk& Chunk = Allocation.Chunks[ChunkIndex];
+		const FVoxelBufferRange& Range = Allocation.ChunksVertices[ChunkIndex];
+		check(Chunk.NumVertices == Range.Num);
+
+		CopyVertices(
+			Arena.VertexBuffers.PositionVertexBuffer.VertexBufferRHI,
+			Source.PositionVertexBuffer.GetVertexData(),
+			Source.PositionVertexBuffer.GetStride(),
+			Chunk.FirstVertex,
+			Range);
+		CopyVertices(
+			Arena.VertexBuffers.StaticMeshVertexBuffer.TangentsVertexBuffer.VertexBufferRHI,
+			Source.StaticMeshVertexBuffer.GetTangentData(),
+			TangentStride,
+			Chunk.FirstVertex,
+			Range);
+		if (TexCoordStride > 0)
+		{
+			CopyVertices(
+				Arena.VertexBuffers.StaticMeshVertexBuffer.TexCoordVertexBuffer.VertexBufferRHI,
+				Source.StaticMeshVertexBuffer.GetTexCoordData(),
+				TexCoordStride,
+				Chunk.FirstVertex,
+				Range);
+		}
+		CopyVertices(
+			Arena.VertexBuffers.ColorVertexBuffer.VertexBufferRHI,
+			Source.ColorVertexBuffer.GetVertexData(),
+			Source.ColorVertexBuffer.GetStride(),
+			Chunk.FirstVertex,
+			Range);
+	}
+
+	// The indices are always rewritten: they point to the vertices ranges of all the chunks
+	FRHIBuffer* IndexBufferRHI = Arena.IndexBuffer.IndexBufferRHI;
+	uint32* RESTRICT Dest = static_cast<uint32*>(RHICmdList.LockBuffer(
+		IndexBufferRHI,
+		Allocation.Indices.Start * sizeof(uint32),
+		Allocation.Indices.Num * sizeof(uint32),
+		RLM_WriteOnly));
+	for (int32 ChunkIndex = 0; ChunkIndex < Allocation.Chunks.Num(); ChunkIndex++)
+	{
+		const FVoxelProcMeshBuffersChunk& Chunk = Allocation.Chunks[ChunkIndex];
+		const int32 Offset = Allocation.ChunksVertices[ChunkIndex].Start - Chunk.FirstVertex;
+		for (int32 Index = Chunk.FirstIndex; Index < Chunk.FirstIndex + Chunk.NumIndices; Index++)
+		{
+			checkVoxelSlow(Index < Allocation.Indices.Num);
+			Dest[Index] = Buffers.IndexBuffer.GetIndex(Index) + Offset;
+		}
+	}
+	RHICmdList.UnlockBuffer(IndexBufferRHI);
+}
+
+void FVoxelClusterBufferPool::Upload(const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	const TVoxelSharedPtr<const FVoxelClusterBufferAllocation> Allocation = Buffers->ClusterBufferAllocation;
+	if (!ensure(Allocation.IsValid()) || !ensure(!Allocation->bFreed))
+	{
+		return;
+	}
+
+	const int64 UploadSize = Allocation->GetUploadSize();
+	Stats.UploadedSize += UploadSize;
+	INC_DWORD_STAT_BY(STAT_VoxelClusterBufferPoolUploadedBytes, UploadSize);
+
+	// Enqueued before the buffers are sent to the scene proxies, so they are always uploaded when first drawn
+	ENQUEUE_RENDER_COMMAND(UploadVoxelClusterBuffers)(
+		[Buffers, Allocation](FRHICommandListImmediate& RHICmdList)
+		{
+			UploadAllocation_RenderThread(RHICmdList, *Buffers, *Allocation);
+		});
+}
+
+FVoxelClusterBufferPoolStats FVoxelClusterBufferPool::GetStats() const
+{
+	FVoxelClusterBufferPoolStats Result = Stats;
+	Result.NumArenas = Arenas.Num();
+	Result.NumVertices = 0;
+	Result.NumUsedVertices = 0;
+	Result.NumIndices = 0;
+	Result.NumUsedIndices = 0;
+	Result.AllocatedSize = 0;
+	for (const auto& Arena : Arenas)
+	{
+		Result.NumVertices += Arena->VertexAllocator.GetCapacity();
+		Result.NumUsedVertices += Arena->VertexAllocator.GetNumUsed();
+		Result.NumIndices += Arena->IndexAllocator.GetCapacity();
+		Result.NumUsedIndices += Arena->IndexAllocator.GetNumUsed();
+		Result.AllocatedSize += Arena->GetAllocatedSize();
+	}
+	return Result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<FVoxelClusterBufferAllocation> FVoxelClusterBufferPool::AllocateInArena(
+	const TVoxelSharedRef<FVoxelClusterBufferArena>& Arena,
+	const FVoxelProcMeshBuffers& Buffers,
+	const FVoxelClusterBufferAllocation* Previous)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TVoxelSharedRef<FVoxelClusterBufferAllocation> Allocation = MakeVoxelShared<FVoxelClusterBufferAllocation>(Arena);
+	Allocation->Chunks = Buffers.Chunks;
+	Allocation->ChunksVertices.SetNum(Buffers.Chunks.Num());
+
+	// Chunks that still have their vertices in the arena
+	TBitArray<> ReusedChunks(false, Buffers.Chunks.Num());
+	if (Previous)
+	{
+		check(&Previous->Arena.Get() == &Arena.Get());
+		if (ensure(!Previous->bFreed))
+		{
+			Previous->bFreed = true;
+			Stats.NumAllocations--;
+
+			TMap<FGuid, int32> PreviousChunks;
+			for (int32 Index = 0; Index < Previous->Chunks.Num(); Index++)
+			{
+				if (Previous->Chunks[Index].NumVertices > 0)
+				{
+					PreviousChunks.Add(Previous->Chunks[Index].GetKey(), Index);
+				}
+			}
+
+			TBitArray<> ReusedPreviousChunks(false, Previous->Chunks.Num());
+			for (int32 Index = 0; Index < Buffers.Chunks.Num(); Index++)
+			{
+				const FVoxelProcMeshBuffersChunk& Chunk = Buffers.Chunks[Index];
+				const int32* PreviousIndex = Chunk.NumVertices > 0 ? PreviousChunks.Find(Chunk.GetKey()) : nullptr;
+				if (PreviousIndex &&
+					!ReusedPreviousChunks[*PreviousIndex] &&
+					Previous->Chunks[*PreviousIndex].HasSameVertices(Chunk))
+				{
+					Allocation->ChunksVertices[Index] = Previous->ChunksVertices[*PreviousIndex];
+					ReusedChunks[Index] = true;
+					ReusedPreviousChunks[*PreviousIndex] = true;
+				}
+			}
+
+			// Free the rest before allocating, so that the new chunks can reuse their ranges
+			for (int32 Index = 0; Index < Previous->Chunks.Num(); Index++)
+			{
+				if (!ReusedPreviousChunks[Index])
+				{
+					Arena->VertexAllocator.Free(Previous->ChunksVertices[Index]);
+				}
+			}
+			Arena->IndexAllocator.Free(Previous->Indices);
+		}
+	}
+
+	bool bSuccess = true;
+	for (int32 Index = 0; Index < Buffers.Chunks.Num() && bSuccess; Index++)
+	{
+		if (ReusedChunks[Index] || Buffers.Chunks[Index].NumVertices == 0)
+		{
+			continue;
+		}
+		bSuccess = Arena->VertexAllocator.Allocate(Buffers.Chunks[Index].NumVertices, Allocation->ChunksVertices[Index]);
+		if (bSuccess)
+		{
+			Allocation->DirtyChunks.Add(Index);
+		}
+	}
+	bSuccess = bSuccess && Arena->IndexAllocator.Allocate(Buffers.GetNumIndices(), Allocation->Indices);
+
+	if (!bSuccess)
+	{
+		// Arena full: free everything, including the reused ranges, the caller will upload everything to another arena
+		for (const FVoxelBufferRange& Range : Allocation->ChunksVertices)
+		{
+			Arena->VertexAllocator.Free(Range);
+		}
+		return nullptr;
+	}
+
+	Allocation->MinVertexIndex = MAX_int32;
+	Allocation->MaxVertexIndex = 0;
+	for (const FVoxelBufferRange& Range : Allocation->ChunksVertices)
+	{
+		if (Range.Num > 0)
+		{
+			Allocation->MinVertexIndex = FMath::Min(Allocation->MinVertexIndex, Range.Start);
+			Allocation->MaxVertexIndex = FMath::Max(Allocation->MaxVertexIndex, Range.End() - 1);
+		}
+	}
+	ensure(Allocation->MinVertexIndex <= Allocation->MaxVertexIndex);
+
+	return Allocation;
+}
+
+TVoxelSharedRef<FVoxelClusterBufferArena> FVoxelClusterBufferPool::CreateArena(const FVoxelProcMeshBuffers& Buffers)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto& StaticMeshBuffer = Buffers.VertexBuffers.StaticMeshVertexBuffer;
+
+	// The render resources are released after the render commands using them
+	const TVoxelSharedRef<FVoxelClusterBufferArena> Arena(
+		new FVoxelClusterBufferArena(StaticMeshBuffer.GetNumTexCoords(), StaticMeshBuffer.GetUseFullPrecisionUVs()),
+		[](FVoxelClusterBufferArena* ArenaToDelete)
+		{
+			ENQUEUE_RENDER_COMMAND(ReleaseVoxelClusterBufferArena)(
+				[ArenaToDelete](FRHICommandListImmediate& RHICmdList)
+				{
+					ArenaToDelete->ReleaseResources_RenderThread();
+					delete ArenaToDelete;
+				});
+		});
+
+	ENQUEUE_RENDER_COMMAND(InitVoxelClusterBufferArena)(
+		[ArenaToInit = &Arena.Get()](FRHICommandListImmediate& RHICmdList)
+		{
+			ArenaToInit->InitResources_RenderThread(RHICmdList);
+		});
+
+	Arenas.Add(Arena);
+	Stats.NumArenasCreated++;
+
+	return Arena;
+}
+
+void FVoxelClusterBufferPool::RemoveEmptyArenas()
+{
+	// Keep one empty arena, to not recreate it when a single cluster moves around
+	bool bKeptEmptyArena = false;
+	Arenas.RemoveAll([&](const TVoxelSharedRef<FVoxelClusterBufferArena>& Arena)
+	{
+		if (Arena->VertexAllocator.GetNumAllocations() > 0 || Arena->IndexAllocator.GetNumAllocations() > 0)
+		{
+			return false;
+		}
+		if (!bKeptEmptyArena)
+		{
+			bKeptEmptyArena = true;
+			return false;
+		}
+		return true;
+	});
+}
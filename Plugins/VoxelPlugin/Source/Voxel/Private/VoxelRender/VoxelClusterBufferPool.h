@@ -0,0 +1,174 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "StaticMeshResources.h"
+#include "VoxelRender/VoxelRawStaticIndexBuffer.h"
+#include "VoxelRender/VoxelProcMeshBuffers.h"
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Cluster Buffer Pool Memory"), STAT_VoxelClusterBufferPoolMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+struct FVoxelBufferRange
+{
+	int32 Start = 0;
+	int32 Num = 0;
+
+	FVoxelBufferRange() = default;
+	FVoxelBufferRange(int32 Start, int32 Num)
+		: Start(Start)
+		, Num(Num)
+	{
+	}
+
+	inline int32 End() const
+	{
+		return Start + Num;
+	}
+};
+
+// Sub-allocates ranges of a buffer of fixed capacity
+// Best fit in a list of free ranges sorted by start, that are merged with their neighbors when freed
+class FVoxelRangeAllocator
+{
+public:
+	explicit FVoxelRangeAllocator(int32 Capacity);
+
+	// Allocating 0 elements always succeeds and returns an empty range
+	bool Allocate(int32 Num, FVoxelBufferRange& OutRange);
+	void Free(const FVoxelBufferRange& Range);
+
+	inline int32 GetCapacity() const { return Capacity; }
+	inline int32 GetNumUsed() const { return NumUsed; }
+	inline int32 GetNumAllocations() const { return NumAllocations; }
+	inline int32 GetNumFreeRanges() const { return FreeRanges.Num(); }
+	int32 GetLargestFreeRange() const;
+
+private:
+	const int32 Capacity;
+	int32 NumUsed = 0;
+	int32 NumAllocations = 0;
+	TArray<FVoxelBufferRange> FreeRanges;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Large vertex & index buffers shared by the clusters with the same vertex format
+// The allocators are only used on the game thread, the render resources only on the render thread
+class FVoxelClusterBufferArena
+{
+public:
+	static constexpr int32 VertexCapacity = 1 << 18;
+	static constexpr int32 IndexCapacity = 1 << 20;
+
+	const int32 NumTexCoords;
+	const bool bFullPrecisionUVs;
+
+	FVoxelRangeAllocator VertexAllocator{ VertexCapacity };
+	FVoxelRangeAllocator IndexAllocator{ IndexCapacity };
+
+	FStaticMeshVertexBuffers VertexBuffers;
+	// Always 32 bit, as the capacity is above 65535
+	FVoxelRawStaticIndexBuffer IndexBuffer{ false };
+	FLocalVertexFactory VertexFactory;
+
+	FVoxelClusterBufferArena(int32 NumTexCoords, bool bFullPrecisionUVs);
+
+	bool IsCompatible(const FVoxelProcMeshBuffers& Buffers) const;
+	// Sum of the strides of all the vertex buffers
+	int32 GetVertexSize() const;
+	int64 GetAllocatedSize() const;
+
+	void InitResources_RenderThread(FRHICommandListImmediate& RHICmdList);
+	void ReleaseResources_RenderThread();
+};
+
+// Ranges of the buffers of a cluster section in an arena
+// The vertices of each chunk have their own range, so that chunks that did not change keep their vertices on the GPU
+// Immutable once uploaded: read by the scene proxies on the render thread
+struct FVoxelClusterBufferAllocation
+{
+	const TVoxelSharedRef<FVoxelClusterBufferArena> Arena;
+
+	// Same order as FVoxelProcMeshBuffers::Chunks
+	TArray<FVoxelProcMeshBuffersChunk> Chunks;
+	TArray<FVoxelBufferRange> ChunksVertices;
+	// Indices into the arena vertex buffers, drawn in a single batch
+	FVoxelBufferRange Indices;
+	int32 MinVertexIndex = 0;
+	int32 MaxVertexIndex = 0;
+
+	// Chunks whose vertices need to be uploaded, the other ones reuse the vertices uploaded for the previous allocation
+	TArray<int32> DirtyChunks;
+
+	explicit FVoxelClusterBufferAllocation(const TVoxelSharedRef<FVoxelClusterBufferArena>& Arena)
+		: Arena(Arena)
+	{
+	}
+
+	// Size of the data sent to the GPU by FVoxelClusterBufferPool::Upload
+	int64 GetUploadSize() const;
+
+private:
+	// Game thread
+	mutable bool bFreed = false;
+
+	friend class FVoxelClusterBufferPool;
+};
+
+struct FVoxelClusterBufferPoolStats
+{
+	int32 NumArenas = 0;
+	int32 NumAllocations = 0;
+	int64 NumVertices = 0;
+	int64 NumUsedVertices = 0;
+	int64 NumIndices = 0;
+	int64 NumUsedIndices = 0;
+	int64 AllocatedSize = 0;
+
+	// Since the creation of the pool
+	int64 NumArenasCreated = 0;
+	int64 UploadedSize = 0;
+	// Size of the vertices of the chunks that did not change, that would have been uploaded without the pool
+	int64 SkippedUploadSize = 0;
+};
+
+// Sub-allocates the GPU buffers of the clusters of a renderer in a few large arenas
+// Rebuilding a cluster then only uploads the chunks that changed, and doesn't create any RHI buffer
+// Game thread only: only the arenas are used by the render thread. The accounting doesn't depend on the RHI
+class FVoxelClusterBufferPool
+{
+public:
+	FVoxelClusterBufferPool();
+	~FVoxelClusterBufferPool();
+
+	// False if the buffers need their own render resources, eg because of tessellation or ray tracing
+	static bool CanPool(const FVoxelProcMeshBuffers& Buffers);
+
+	// Allocates the ranges of Buffers, reusing the vertices ranges of the chunks of Previous that did not change
+	// Previous is always freed. Returns null if the buffers can't be pooled
+	TVoxelSharedPtr<const FVoxelClusterBufferAllocation> Allocate(
+		const FVoxelProcMeshBuffers& Buffers,
+		const TVoxelSharedPtr<const FVoxelClusterBufferAllocation>& Previous);
+	void Free(const TVoxelSharedPtr<const FVoxelClusterBufferAllocation>& Allocation);
+
+	// Sends the dirty chunks and the indices of Buffers->ClusterBufferAllocation to its arena
+	// Must be called before the buffers are sent to a scene proxy
+	void Upload(const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers);
+
+	FVoxelClusterBufferPoolStats GetStats() const;
+
+private:
+	TArray<TVoxelSharedRef<FVoxelClusterBufferArena>> Arenas;
+	FVoxelClusterBufferPoolStats Stats;
+
+	TVoxelSharedPtr<FVoxelClusterBufferAllocation> AllocateInArena(
+		const TVoxelSharedRef<FVoxelClusterBufferArena>& Arena,
+		const FVoxelProcMeshBuffers& Buffers,
+		const FVoxelClusterBufferAllocation* Previous);
+	TVoxelSharedRef<FVoxelClusterBufferArena> CreateArena(const FVoxelProcMeshBuffers& Buffers);
+	void RemoveEmptyArenas();
+};
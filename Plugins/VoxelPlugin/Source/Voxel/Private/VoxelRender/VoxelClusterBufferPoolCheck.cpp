@@ -0,0 +1,191 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelRender/VoxelClusterBufferPool.h"
+#include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelMinimal.h"
+
+#include "RenderingThread.h"
+#include "HAL/IConsoleManager.h"
+
+// Checks the range allocator and the pool accounting, so that they can be validated with -nullrhi
+// Nothing is uploaded: the arenas render resources are only created by the render commands of the pool
+namespace FVoxelClusterBufferPoolCheck
+{
+	struct FChecker
+	{
+		int32 NumChecks = 0;
+		int32 NumFailed = 0;
+
+		void Check(bool bValue, const TCHAR* Expression)
+		{
+			NumChecks++;
+			if (!bValue)
+			{
+				NumFailed++;
+				LOG_VOXEL(Error, TEXT("Cluster buffer pool check failed: %s"), Expression);
+			}
+		}
+	};
+
+#define CHECK_POOL(Expression) Checker.Check(Expression, TEXT(#Expression))
+
+	void CheckRangeAllocator(FChecker& Checker)
+	{
+		FVoxelRangeAllocator Allocator(1000);
+
+		FVoxelBufferRange A;
+		FVoxelBufferRange B;
+		FVoxelBufferRange C;
+		CHECK_POOL(Allocator.Allocate(100, A) && A.Start == 0);
+		CHECK_POOL(Allocator.Allocate(200, B) && B.Start == 100);
+		CHECK_POOL(Allocator.Allocate(300, C) && C.Start == 300);
+		CHECK_POOL(Allocator.GetNumUsed() == 600 && Allocator.GetNumAllocations() == 3);
+
+		FVoxelBufferRange Empty;
+		CHECK_POOL(Allocator.Allocate(0, Empty) && Empty.Num == 0);
+		CHECK_POOL(Allocator.GetNumAllocations() == 3);
+
+		FVoxelBufferRange TooLarge;
+		CHECK_POOL(!Allocator.Allocate(401, TooLarge));
+
+		// Best fit: the hole of B is used instead of the end of the buffer
+		Allocator.Free(B);
+		CHECK_POOL(Allocator.GetNumFreeRanges() == 2);
+		FVoxelBufferRange D;
+		CHECK_POOL(Allocator.Allocate(150, D) && D.Start == 100);
+
+		// Larger than the hole left by D
+		FVoxelBufferRange E;
+		CHECK_POOL(Allocator.Allocate(60, E) && E.Start == 600);
+
+		// Merged with the next range
+		Allocator.Free(D);
+		Allocator.Free(A);
+		CHECK_POOL(Allocator.GetNumFreeRanges() == 2 && Allocator.GetLargestFreeRange() == 340);
+		// Merged with the previous range
+		Allocator.Free(C);
+		CHECK_POOL(Allocator.GetNumFreeRanges() == 2 && Allocator.GetLargestFreeRange() == 600);
+		// Merged with both
+		Allocator.Free(E);
+		CHECK_POOL(Allocator.GetNumFreeRanges() == 1 && Allocator.GetLargestFreeRange() == 1000);
+		CHECK_POOL(Allocator.GetNumUsed() == 0 && Allocator.GetNumAllocations() == 0);
+	}
+
+	FVoxelProcMeshBuffersChunk MakeChunk(const FGuid& Guid, int32 FirstVertex, int32 NumVertices, int32 FirstIndex)
+	{
+		FVoxelProcMeshBuffersChunk Chunk;
+		Chunk.MainGuid = Guid;
+		Chunk.FirstVertex = FirstVertex;
+		Chunk.NumVertices = NumVertices;
+		Chunk.FirstIndex = FirstIndex;
+		Chunk.NumIndices = NumVertices;
+		return Chunk;
+	}
+
+	// One index per vertex: only the sizes matter
+	void InitBuffers(FVoxelProcMeshBuffers& Buffers, const TArray<FVoxelProcMeshBuffersChunk>& Chunks)
+	{
+		int32 NumVertices = 0;
+		for (const FVoxelProcMeshBuffersChunk& Chunk : Chunks)
+		{
+			NumVertices += Chunk.NumVertices;
+		}
+
+		Buffers.VertexBuffers.PositionVertexBuffer.Init(NumVertices);
+		Buffers.VertexBuffers.StaticMeshVertexBuffer.Init(NumVertices, 1);
+		Buffers.VertexBuffers.ColorVertexBuffer.Init(NumVertices);
+
+		TArray<uint32> Indices;
+		Indices.SetNumZeroed(NumVertices);
+		Buffers.IndexBuffer.SetIndices(Indices, EIndexBufferStride::Force32Bit);
+
+		Buffers.Chunks = Chunks;
+	}
+
+	void CheckPool(FChecker& Checker)
+	{
+		FVoxelClusterBufferPool Pool;
+
+		const FGuid GuidA = FGuid::NewGuid();
+		const FGuid GuidB = FGuid::NewGuid();
+		const FGuid GuidC = FGuid::NewGuid();
+
+		FVoxelProcMeshBuffers FirstBuffers;
+		InitBuffers(FirstBuffers, { MakeChunk(GuidA, 0, 100, 0), MakeChunk(GuidB, 100, 200, 100) });
+		CHECK_POOL(FVoxelClusterBufferPool::CanPool(FirstBuffers));
+
+		const TVoxelSharedPtr<const FVoxelClusterBufferAllocation> FirstAllocation = Pool.Allocate(FirstBuffers, nullptr);
+		CHECK_POOL(FirstAllocation.IsValid());
+		if (!FirstAllocation.IsValid())
+		{
+			return;
+		}
+		CHECK_POOL(FirstAllocation->DirtyChunks.Num() == 2);
+		CHECK_POOL(FirstAllocation->ChunksVertices[0].Start == 0 && FirstAllocation->ChunksVertices[1].Start == 100);
+		{
+			const FVoxelClusterBufferPoolStats Stats = Pool.GetStats();
+			CHECK_POOL(Stats.NumArenas == 1 && Stats.NumAllocations == 1);
+			CHECK_POOL(Stats.NumUsedVertices == 300 && Stats.NumUsedIndices == 300);
+			CHECK_POOL(Stats.AllocatedSize == FirstAllocation->Arena->GetAllocatedSize());
+		}
+
+		// A is unchanged, B is replaced by the smaller C
+		FVoxelProcMeshBuffers SecondBuffers;
+		InitBuffers(SecondBuffers, { MakeChunk(GuidA, 0, 100, 0), MakeChunk(GuidC, 100, 50, 100) });
+
+		const int64 SkippedUploadSize = Pool.GetStats().SkippedUploadSize;
+		const TVoxelSharedPtr<const FVoxelClusterBufferAllocation> SecondAllocation = Pool.Allocate(SecondBuffers, FirstAllocation);
+		CHECK_POOL(SecondAllocation.IsValid());
+		if (!SecondAllocation.IsValid())
+		{
+			return;
+		}
+		CHECK_POOL(&SecondAllocation->Arena.Get() == &FirstAllocation->Arena.Get());
+		// A keeps its vertices, C reuses the range freed by B
+		CHECK_POOL(SecondAllocation->DirtyChunks.Num() == 1 && SecondAllocation->DirtyChunks[0] == 1);
+		CHECK_POOL(SecondAllocation->ChunksVertices[0].Start == 0 && SecondAllocation->ChunksVertices[1].Start == 100);
+		{
+			const FVoxelClusterBufferPoolStats Stats = Pool.GetStats();
+			CHECK_POOL(Stats.NumArenas == 1 && Stats.NumAllocations == 1);
+			CHECK_POOL(Stats.NumUsedVertices == 150 && Stats.NumUsedIndices == 150);
+			CHECK_POOL(Stats.SkippedUploadSize - SkippedUploadSize == 100 * SecondAllocation->Arena->GetVertexSize());
+		}
+
+		Pool.Free(SecondAllocation);
+		{
+			const FVoxelClusterBufferPoolStats Stats = Pool.GetStats();
+			CHECK_POOL(Stats.NumAllocations == 0);
+			CHECK_POOL(Stats.NumUsedVertices == 0 && Stats.NumUsedIndices == 0);
+		}
+		CHECK_POOL(SecondAllocation->Arena->VertexAllocator.GetNumFreeRanges() == 1);
+		CHECK_POOL(SecondAllocation->Arena->IndexAllocator.GetNumFreeRanges() == 1);
+	}
+
+#undef CHECK_POOL
+
+	void Check()
+	{
+		check(IsInGameThread());
+
+		FChecker Checker;
+		CheckRangeAllocator(Checker);
+		CheckPool(Checker);
+
+		// Release the arenas of the pool
+		FlushRenderingCommands();
+
+		if (Checker.NumFailed == 0)
+		{
+			LOG_VOXEL(Log, TEXT("Cluster buffer pool: %d checks passed"), Checker.NumChecks);
+		}
+		else
+		{
+			LOG_VOXEL(Error, TEXT("Cluster buffer pool: %d/%d checks failed"), Checker.NumFailed, Checker.NumChecks);
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdCheckClusterBufferPool(
+	TEXT("voxel.renderer.CheckClusterBufferPool"),
+	TEXT("Checks the range allocator and the accounting of the cluster buffer pool: allocate, free, merge and best fit reuse. Works with -nullrhi"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelClusterBufferPoolCheck::Check));
@@ -0,0 +1,409 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelRender/VoxelMeshingBenchmark.h"
+#include "VoxelRender/VoxelMesherAsyncWork.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMeshOptimizer.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelDebug/VoxelDebugManager.h"
+#include "VoxelGenerators/VoxelGenerator.h"
+#include "VoxelGenerators/VoxelGeneratorInstance.inl"
+#include "VoxelUtilities/VoxelExampleUtilities.h"
+#include "VoxelUtilities/VoxelMathUtilities.h"
+#include "VoxelDefaultPool.h"
+#include "VoxelItemStack.h"
+#include "VoxelWorld.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+
+FVoxelMeshingBenchmarkSettings::FVoxelMeshingBenchmarkSettings()
+	: Generators(
+		{
+			TEXT("/Script/VoxelGraph.VoxelExample_Planet"),
+			TEXT("/Script/VoxelGraph.VoxelExample_Cave"),
+			TEXT("/Script/VoxelGraph.VoxelExample_RingWorld"),
+			TEXT("/Script/VoxelExamples.MyVoxelPlanetGenerator")
+		})
+	, RenderTypes({ EVoxelRenderType::MarchingCubes, EVoxelRenderType::Cubic, EVoxelRenderType::SurfaceNets })
+	, LODs({ 0, 1, 2, 3 })
+{
+}
+
+void FVoxelMeshingBenchmarkSettings::Parse(const TCHAR* Params)
+{
+	const auto ParseList = [&](const TCHAR* Name, TArray<FString>& OutValues)
+	{
+		FString Value;
+		if (!FParse::Value(Params, Name, Value, false))
+		{
+			return false;
+		}
+		Value.ParseIntoArray(OutValues, TEXT(","));
+		return true;
+	};
+
+	ParseList(TEXT("Generators="), Generators);
+
+	TArray<FString> Values;
+	if (ParseList(TEXT("RenderTypes="), Values))
+	{
+		RenderTypes.Reset();
+		for (const FString& Value : Values)
+		{
+			const int64 RenderType = StaticEnum<EVoxelRenderType>()->GetValueByNameString(Value);
+			if (RenderType == INDEX_NONE)
+			{
+				LOG_VOXEL(Error, TEXT("Invalid render type: %s"), *Value);
+				continue;
+			}
+			RenderTypes.Add(EVoxelRenderType(RenderType));
+		}
+	}
+	if (ParseList(TEXT("LODs="), Values))
+	{
+		LODs.Reset();
+		for (const FString& Value : Values)
+		{
+			LODs.Add(FMath::Clamp(FCString::Atoi(*Value), 0, 24));
+		}
+	}
+
+	FParse::Value(Params, TEXT("NumChunksPerDirection="), NumChunksPerDirection);
+	FParse::Value(Params, TEXT("NumThreads="), NumThreads);
+	FParse::Value(Params, TEXT("WorldSize="), WorldSizeInVoxels);
+
+	NumChunksPerDirection = FMath::Max(1, NumChunksPerDirection);
+	NumThreads = FMath::Max(1, NumThreads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace FVoxelMeshingBenchmark
+{
+	struct FResult
+	{
+		int32 NumChunks = 0;
+		int32 NumNonEmptyChunks = 0;
+
+		double WallTime = 0;
+		// Sums over the chunks, in seconds
+		double TotalTime = 0;
+		double ValuesTime = 0;
+		double MaterialsTime = 0;
+
+		uint64 NumVertices = 0;
+		uint64 NumIndices = 0;
+		// Memory used by the chunk meshes, see STAT_VoxelChunkMeshMemory
+		uint64 MeshMemory = 0;
+		uint64 ScratchAllocations = 0;
+
+		// Post-transform vertex cache misses, before and after FVoxelChunkMeshBuffers::OptimizeIndices
+		uint64 CacheMissesBefore = 0;
+		uint64 CacheMissesAfter = 0;
+		double OptimizeTime = 0;
+
+		void Merge(const FResult& Other)
+		{
+			NumChunks += Other.NumChunks;
+			NumNonEmptyChunks += Other.NumNonEmptyChunks;
+			TotalTime += Other.TotalTime;
+			ValuesTime += Other.ValuesTime;
+			MaterialsTime += Other.MaterialsTime;
+			NumVertices += Other.NumVertices;
+			NumIndices += Other.NumIndices;
+			MeshMemory += Other.MeshMemory;
+			ScratchAllocations += Other.ScratchAllocations;
+			CacheMissesBefore += Other.CacheMissesBefore;
+			CacheMissesAfter += Other.CacheMissesAfter;
+			OptimizeTime += Other.OptimizeTime;
+		}
+	};
+
+	// Chunks that might contain the surface, going from the world center along every axis
+	// Most of the example generators are planets or rings, so the chunks around the center are usually empty
+	TArray<FIntVector> GetChunks(const FVoxelGeneratorInstance& Generator, const FVoxelIntBox& WorldBounds, int32 LOD, int32 NumChunksPerDirection)
+	{
+		const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
+
+		TArray<FIntVector> Chunks;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			for (const int32 Sign : { -1, 1 })
+			{
+				int32 NumChunks = 0;
+				for (int32 Index = 0; NumChunks < NumChunksPerDirection; Index++)
+				{
+					FIntVector ChunkPosition(0);
+					ChunkPosition[Axis] = Sign > 0 ? Index * ChunkSize : -(Index + 1) * ChunkSize;
+
+					const FVoxelIntBox Bounds(ChunkPosition, ChunkPosition + ChunkSize);
+					if (!WorldBounds.Contains(Bounds))
+					{
+						break;
+					}
+
+					const TVoxelRange<v_flt> Range = Generator.GetValueRange(Bounds, LOD, FVoxelItemStack::Empty);
+					if (Range.Min <= 0 && Range.Max > 0)
+					{
+						Chunks.Add(ChunkPosition);
+						NumChunks++;
+					}
+				}
+			}
+		}
+		return Chunks;
+	}
+
+	FResult MeshChunks(const FVoxelRendererSettings& RendererSettings, int32 LOD, const TArray<FIntVector>& Chunks, int32 NumThreads)
+	{
+		TArray<FResult> ThreadResults;
+		ThreadResults.SetNum(NumThreads);
+
+		FThreadSafeCounter NextChunk;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray<TFuture<void>> Futures;
+		for (int32 ThreadIndex = 0; ThreadIndex < NumThreads; ThreadIndex++)
+		{
+			Futures.Add(Async(EAsyncExecution::Thread, [&, &Result = ThreadResults[ThreadIndex]]()
+			{
+				while (true)
+				{
+					const int32 ChunkIndex = NextChunk.Increment() - 1;
+					if (ChunkIndex >= Chunks.Num())
+					{
+						break;
+					}
+
+					const auto Mesher = FVoxelMesherAsyncWork::GetMesher(RendererSettings, LOD, Chunks[ChunkIndex], false, 0);
+
+					const double ChunkStartTime = FPlatformTime::Seconds();
+					const auto Chunk = Mesher->CreateFullChunk();
+					Result.TotalTime += FPlatformTime::Seconds() - ChunkStartTime;
+
+					const FVoxelMesherTimes& Times = Mesher->GetLastTimes();
+					Result.ValuesTime += FPlatformTime::ToSeconds64(Times._Values);
+					Result.MaterialsTime += FPlatformTime::ToSeconds64(Times._Materials);
+					Result.ScratchAllocations += Times.ScratchAllocations;
+
+					Result.NumChunks++;
+					if (Chunk.IsValid() && !Chunk->IsEmpty())
+					{
+						Result.NumNonEmptyChunks++;
+						Chunk->IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffers)
+						{
+							Result.NumVertices += Buffers.GetNumVertices();
+							Result.NumIndices += Buffers.Indices.Num();
+							Result.MeshMemory += Buffers.GetAllocatedSize();
+
+							// The benchmark world has bOptimizeIndices off: measure the optimization on a copy
+							TArray<uint32> Indices = Buffers.Indices;
+							const int32 NumBufferVertices = Buffers.GetNumVertices();
+							Result.CacheMissesBefore += FVoxelMeshOptimizer::GetNumCacheMisses(Indices, NumBufferVertices);
+
+							const double OptimizeStartTime = FPlatformTime::Seconds();
+							TArray<int32> NewToOld;
+							FVoxelMeshOptimizer::OptimizeVertexCache(Indices, NumBufferVertices);
+							FVoxelMeshOptimizer::OptimizeVertexFetch(Indices, NumBufferVertices, NewToOld);
+							Result.OptimizeTime += FPlatformTime::Seconds() - OptimizeStartTime;
+
+							Result.CacheMissesAfter += FVoxelMeshOptimizer::GetNumCacheMisses(Indices, NumBufferVertices);
+						});
+					}
+				}
+			}));
+		}
+
+		for (auto& Future : Futures)
+		{
+			Future.Wait();
+		}
+
+		FResult Result;
+		Result.WallTime = FPlatformTime::Seconds() - StartTime;
+		for (const FResult& ThreadResult : ThreadResults)
+		{
+			Result.Merge(ThreadResult);
+		}
+
+		// The meshers report the empty chunks to the debug manager on the game thread
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+		return Result;
+	}
+
+	FString ToJson(const FString& Generator, EVoxelRenderType RenderType, int32 LOD, const FResult& Result)
+	{
+		// Values and materials are only queried from the generator, as there are no edits
+		const double GeneratorTime = Result.ValuesTime + Result.MaterialsTime;
+		// Average cache miss ratio: vertices transformed per triangle
+		const double NumTriangles = FMath::Max<double>(Result.NumIndices / 3, 1);
+
+		return FString::Printf(TEXT(
+			"\t\t{ \"generator\": \"%s\", \"renderType\": \"%s\", \"lod\": %d, "
+			"\"chunks\": %d, \"nonEmptyChunks\": %d, \"wallTime\": %f, \"chunksPerSecond\": %f, "
+			"\"totalTime\": %f, \"generatorTime\": %f, \"mesherTime\": %f, "
+			"\"vertices\": %llu, \"indices\": %llu, \"meshMemory\": %llu, \"scratchAllocations\": %llu, "
+			"\"acmrBefore\": %f, \"acmrAfter\": %f, \"optimizeTime\": %f }"),
+			*Generator,
+			*StaticEnum<EVoxelRenderType>()->GetNameStringByValue(int64(RenderType)),
+			LOD,
+			Result.NumChunks,
+			Result.NumNonEmptyChunks,
+			Result.WallTime,
+			Result.NumChunks / FMath::Max(Result.WallTime, 1e-9),
+			Result.TotalTime,
+			GeneratorTime,
+			Result.TotalTime - GeneratorTime,
+			Result.NumVertices,
+			Result.NumIndices,
+			Result.MeshMemory,
+			Result.ScratchAllocations,
+			Result.CacheMissesBefore / NumTriangles,
+			Result.CacheMissesAfter / NumTriangles,
+			Result.OptimizeTime);
+	}
+}
+
+bool FVoxelMeshingBenchmark::Run(const FVoxelMeshingBenchmarkSettings& Settings, FString& OutJson)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	bool bSuccess = true;
+
+	// Never created: only used for its default renderer settings
+	const TStrongObjectPtr<AVoxelWorld> VoxelWorld(NewObject<AVoxelWorld>(GetTransientPackage(), NAME_None, RF_Transient));
+	VoxelWorld->SetWorldSize(Settings.WorldSizeInVoxels);
+
+	const auto Pool = FVoxelDefaultPool::Create(1, true, {}, {});
+
+	TArray<FString> Results;
+	for (const FString& GeneratorPath : Settings.Generators)
+	{
+		UClass* Class = FVoxelExampleUtilities::LoadExampleObject<UClass>(*GeneratorPath);
+		if (!Class || !Class->IsChildOf<UVoxelGenerator>())
+		{
+			LOG_VOXEL(Error, TEXT("Meshing benchmark: invalid generator class %s"), *GeneratorPath);
+			bSuccess = false;
+			continue;
+		}
+		const TStrongObjectPtr<UVoxelGenerator> Generator(NewObject<UVoxelGenerator>(GetTransientPackage(), Class));
+
+		for (const EVoxelRenderType RenderType : Settings.RenderTypes)
+		{
+			VoxelWorld->RenderType = RenderType;
+
+			const auto GeneratorInstance = Generator->GetInstance();
+			GeneratorInstance->Init(VoxelWorld->GetGeneratorInit());
+
+			// New data for every render type, so that they all start without cached values
+			const auto Data = FVoxelData::Create(FVoxelDataSettings(
+				FVoxelUtilities::GetDepthFromSize<DATA_CHUNK_SIZE>(Settings.WorldSizeInVoxels),
+				GeneratorInstance,
+				false,
+				false));
+			const auto DebugManager = FVoxelDebugManager::Create(FVoxelDebugManagerSettings(VoxelWorld.Get(), EVoxelPlayType::Game, Pool, Data, true));
+			const FVoxelRendererSettings RendererSettings(VoxelWorld.Get(), EVoxelPlayType::Game, nullptr, Data, Pool, nullptr, DebugManager, true);
+
+			for (const int32 LOD : Settings.LODs)
+			{
+				const TArray<FIntVector> Chunks = GetChunks(*GeneratorInstance, Data->WorldBounds, LOD, Settings.NumChunksPerDirection);
+				const FResult Result = MeshChunks(RendererSettings, LOD, Chunks, Settings.NumThreads);
+
+				LOG_VOXEL(Log, TEXT("%s %s LOD %d: %d chunks (%d not empty) in %.2fms, %.0f chunks/s"),
+					*Class->GetName(),
+					*StaticEnum<EVoxelRenderType>()->GetNameStringByValue(int64(RenderType)),
+					LOD,
+					Result.NumChunks,
+					Result.NumNonEmptyChunks,
+					Result.WallTime * 1000,
+					Result.NumChunks / FMath::Max(Result.WallTime, 1e-9));
+
+				Results.Add(ToJson(Class->GetName(), RenderType, LOD, Result));
+			}
+
+			DebugManager->Destroy();
+		}
+	}
+
+	OutJson = FString::Printf(TEXT(
+		"{\n"
+		"\t\"renderChunkSize\": %d,\n"
+		"\t\"numThreads\": %d,\n"
+		"\t\"mesherStatsEnabled\": %s,\n"
+		"\t\"results\":\n"
+		"\t[\n"
+		"%s\n"
+		"\t]\n"
+		"}\n"),
+		RENDER_CHUNK_SIZE,
+		Settings.NumThreads,
+		ENABLE_MESHER_STATS ? TEXT("true") : TEXT("false"),
+		*FString::Join(Results, TEXT(",\n")));
+
+	return bSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace FVoxelMeshingBenchmark
+{
+	bool RunAndSave(const TCHAR* Params)
+	{
+		FVoxelMeshingBenchmarkSettings Settings;
+		Settings.Parse(Params);
+
+		FString Output = FPaths::ProjectSavedDir() / TEXT("VoxelMeshingBenchmark.json");
+		FParse::Value(Params, TEXT("Output="), Output);
+
+		FString Json;
+		const bool bSuccess = Run(Settings, Json);
+
+		if (!FFileHelper::SaveStringToFile(Json, *Output))
+		{
+			LOG_VOXEL(Error, TEXT("Meshing benchmark: failed to write %s"), *Output);
+			return false;
+		}
+		LOG_VOXEL(Log, TEXT("Meshing benchmark: results written to %s"), *FPaths::ConvertRelativePathToFull(Output));
+
+		return bSuccess;
+	}
+}
+
+static FAutoConsoleCommand CmdMeshingBenchmark(
+	TEXT("voxel.mesher.Benchmark"),
+	TEXT("Meshes chunks of the example generators with every render type and writes the results to Saved/VoxelMeshingBenchmark.json. Takes the same arguments as the VoxelMeshingBenchmark commandlet, eg -LODs=0,1 -RenderTypes=MarchingCubes"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelMeshingBenchmark::RunAndSave(*FString::Join(Args, TEXT(" ")));
+	}));
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+UVoxelMeshingBenchmarkCommandlet::UVoxelMeshingBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UVoxelMeshingBenchmarkCommandlet::Main(const FString& Params)
+{
+	return FVoxelMeshingBenchmark::RunAndSave(*Params) ? 0 : 1;
+}
@@ -24,6 +24,9 @@
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelPhysicsTriangleMeshesMemory);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Num Voxel Proc Mesh Streamed Updates"), STAT_NumVoxelProcMeshStreamedUpdates, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Num Voxel Proc Mesh Proxies Recreated"), STAT_NumVoxelProcMeshProxiesRecreated, STATGROUP_VoxelCounters);
+
 static TAutoConsoleVariable<int32> CVarShowCollisionsUpdates(
 	TEXT("voxel.renderer.ShowCollisionsUpdates"),
 	0,
@@ -81,6 +84,7 @@ void UVoxelProceduralMeshComponent::Init(
 	bCleanCollisionMesh = RendererSettings.bCleanCollisionMeshes;
 	bClearProcMeshBuffersOnFinishUpdate = RendererSettings.bStaticWorld && !RendererSettings.bRenderWorld; // We still need the buffers if we are rendering!
 	DistanceFieldSelfShadowBias = RendererSettings.DistanceFieldSelfShadowBias;
+	bStreamSectionsUpdates = RendererSettings.bStreamMeshUpdates;
 	RendererSettings.PrimitiveSettings.ApplyToComponent(*this);
 }
 
@@ -309,7 +313,16 @@ void UVoxelProceduralMeshComponent::FinishSectionsUpdates()
 
 	UpdatePhysicalMaterials();
 	UpdateLocalBounds();
-	MarkRenderStateDirty();
+
+	if (bStreamSectionsUpdates && StreamSectionsToSceneProxy())
+	{
+		INC_DWORD_STAT(STAT_NumVoxelProcMeshStreamedUpdates);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_NumVoxelProcMeshProxiesRecreated);
+		MarkRenderStateDirty();
+	}
 
 	if (bNeedToComputeCollisions)
 	{
@@ -337,20 +350,12 @@ FPrimitiveSceneProxy* UVoxelProceduralMeshComponent::CreateSceneProxy()
 	// Sometimes called outside of the render thread at EndPlay
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
-	for (auto& Section : ProcMeshSections)
+	if (!NeedsSceneProxy())
 	{
-		if (Section.Settings.bSectionVisible || FVoxelDebugManager::ShowCollisionAndNavmeshDebug())
-		{
-			return new FVoxelProceduralMeshSceneProxy(this);
-		}
+		return nullptr;
 	}
 
-	if (DistanceFieldData.IsValid())
-	{
-		return new FVoxelProceduralMeshSceneProxy(this);
-	}
-	
-	return nullptr;
+	return new FVoxelProceduralMeshSceneProxy(this);
 }
 
 UBodySetup* UVoxelProceduralMeshComponent::GetBodySetup()
@@ -550,6 +555,45 @@ void UVoxelProceduralMeshComponent::OnComponentDestroyed(bool bDestroyingHierarc
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+bool UVoxelProceduralMeshComponent::NeedsSceneProxy() const
+{
+	for (auto& Section : ProcMeshSections)
+	{
+		if (Section.Settings.bSectionVisible || FVoxelDebugManager::ShowCollisionAndNavmeshDebug())
+		{
+			return true;
+		}
+	}
+
+	return DistanceFieldData.IsValid();
+}
+
+bool UVoxelProceduralMeshComponent::StreamSectionsToSceneProxy()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// If the render state is already dirty the proxy is going to be recreated anyways
+	if (!SceneProxy || IsRenderStateDirty() || !NeedsSceneProxy())
+	{
+		return false;
+	}
+
+	auto& Proxy = static_cast<FVoxelProceduralMeshSceneProxy&>(*SceneProxy);
+
+	TArray<FVoxelProcMeshProxySection> NewSections = FVoxelProceduralMeshSceneProxy::CreateSections(*this);
+	if (!Proxy.CanUpdateSections_GameThread(NewSections))
+	{
+		return false;
+	}
+
+	Proxy.UpdateSections_GameThread(MoveTemp(NewSections));
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 void UVoxelProceduralMeshComponent::UpdatePhysicalMaterials()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -5,6 +5,7 @@
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelRender/VoxelMaterialInterface.h"
 #include "VoxelRender/VoxelToolRendering.h"
+#include "VoxelRender/VoxelClusterBufferPool.h"
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelMinimal.h"
 
@@ -137,6 +138,11 @@ FVoxelProcMeshBuffersRenderData::~FVoxelProcMeshBuffersRenderData()
 #endif
 }
 
+bool FVoxelProcMeshProxySection::HasRenderData() const
+{
+	return RenderData.IsValid() || (Buffers.IsValid() && Buffers->ClusterBufferAllocation.IsValid());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -183,13 +189,48 @@ FVoxelProceduralMeshSceneProxy::FVoxelProceduralMeshSceneProxy(UVoxelProceduralM
 
 	EnableGPUSceneSupportFlags();
 
+	Sections = CreateSections(*Component);
+	for (const FVoxelProcMeshProxySection& Section : Sections)
+	{
+		SectionsMaterials_GameThread.Add(Section.Material);
+	}
+
+	{
+		// Hack to cancel motion blur when mesh components are reused in the same frame
+		const FMatrix PreviousLocalToWorld = Component->GetRenderMatrix();
+		ENQUEUE_RENDER_COMMAND(UpdateTransformCommand)(
+			[this, PreviousLocalToWorld](FRHICommandListImmediate& RHICmdList)
+			{
+				FScene& Scene = static_cast<FScene&>(GetScene());
+				Scene.VelocityData.OverridePreviousTransform(GetPrimitiveComponentId(), PreviousLocalToWorld);
+			});
+	}
+}
+
+FVoxelProceduralMeshSceneProxy::~FVoxelProceduralMeshSceneProxy()
+{
+	for (auto& Section : Sections)
+	{
+		check(!Section.RenderData.IsValid());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TArray<FVoxelProcMeshProxySection> FVoxelProceduralMeshSceneProxy::CreateSections(const UVoxelProceduralMeshComponent& MeshComponent)
+{
+	VOXEL_FUNCTION_COUNTER();
+
 	// Copy each section
-	const int32 NumSections = Component->ProcMeshSections.Num();
-	Sections.SetNum(NumSections);
+	const int32 NumSections = MeshComponent.ProcMeshSections.Num();
+	TArray<FVoxelProcMeshProxySection> NewSections;
+	NewSections.SetNum(NumSections);
 	for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
 	{
-		const auto& SrcSection = Component->ProcMeshSections[SectionIndex];
-		FVoxelProcMeshProxySection& NewSection = Sections[SectionIndex];
+		const auto& SrcSection = MeshComponent.ProcMeshSections[SectionIndex];
+		FVoxelProcMeshProxySection& NewSection = NewSections[SectionIndex];
 
 		ensure(SrcSection.Settings.bSectionVisible || SrcSection.Settings.bEnableCollisions || SrcSection.Settings.bEnableNavmesh);
 
@@ -232,25 +273,45 @@ FVoxelProceduralMeshSceneProxy::FVoxelProceduralMeshSceneProxy(UVoxelProceduralM
 		ensureMsgf(bTessellatedMaterial == bHasAdjacency, TEXT("Invalid tessellated material or non tessellated material is tessellated"));
 		NewSection.bRequiresAdjacencyInformation = bTessellatedMaterial && bHasAdjacency;
 	}
+	return NewSections;
+}
+
+bool FVoxelProceduralMeshSceneProxy::CanUpdateSections_GameThread(const TArray<FVoxelProcMeshProxySection>& NewSections) const
+{
+	check(IsInGameThread());
 
+	// Runtime virtual texture meshes are cached by DrawStaticElements
+	if (RuntimeVirtualTextureMaterialTypes.Num() > 0)
 	{
-		// Hack to cancel motion blur when mesh components are reused in the same frame
-		const FMatrix PreviousLocalToWorld = Component->GetRenderMatrix();
-		ENQUEUE_RENDER_COMMAND(UpdateTransformCommand)(
-			[this, PreviousLocalToWorld](FRHICommandListImmediate& RHICmdList)
-			{
-				FScene& Scene = static_cast<FScene&>(GetScene());
-				Scene.VelocityData.OverridePreviousTransform(GetPrimitiveComponentId(), PreviousLocalToWorld);
-			});
+		return false;
 	}
-}
 
-FVoxelProceduralMeshSceneProxy::~FVoxelProceduralMeshSceneProxy()
-{
-	for (auto& Section : Sections)
+	if (NewSections.Num() != SectionsMaterials_GameThread.Num())
 	{
-		check(!Section.RenderData.IsValid());
+		return false;
 	}
+	for (int32 Index = 0; Index < NewSections.Num(); Index++)
+	{
+		if (NewSections[Index].Material != SectionsMaterials_GameThread[Index])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FVoxelProceduralMeshSceneProxy::UpdateSections_GameThread(TArray<FVoxelProcMeshProxySection>&& NewSections)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+	ensure(CanUpdateSections_GameThread(NewSections));
+
+	// The proxy is destroyed by a render command enqueued after this one, no need to keep it alive
+	ENQUEUE_RENDER_COMMAND(UpdateVoxelProcMeshSections)(
+		[this, NewSections = MoveTemp(NewSections), UpdateTime = FPlatformTime::Seconds()](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			UpdateSections_RenderThread(MoveTemp(NewSections), UpdateTime);
+		});
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -262,15 +323,7 @@ void FVoxelProceduralMeshSceneProxy::CreateRenderThreadResources(UE_504_ONLY(FRH
 	VOXEL_RENDER_FUNCTION_COUNTER();
 	check(IsInRenderingThread());
 	
-	for (auto& Section : Sections)
-	{
-		check(!Section.RenderData.IsValid());
-		check(Section.Buffers.IsValid());
-		if (Section.bSectionVisible || NOT_SHIPPING_NOR_TEST) // Need to init for debug
-		{
-			Section.RenderData = FVoxelProcMeshBuffersRenderData::GetRenderData(Section.Buffers.ToSharedRef(), GetScene().GetFeatureLevel());
-		}
-	}
+	CreateSectionsRenderData();
 }
 
 void FVoxelProceduralMeshSceneProxy::DestroyRenderThreadResources()
@@ -347,7 +400,7 @@ void FVoxelProceduralMeshSceneProxy::GetDynamicMeshElements(const TArray<const F
 		VOXEL_SLOW_SCOPE_COUNTER("Collision and Navmesh Debug");
 		for (auto& Section : Sections)
 		{
-			if (!Section.RenderData.IsValid()) continue;
+			if (!Section.HasRenderData()) continue;
 			
 			const auto* ParentMaterial =
 				EngineShowFlags.Wireframe
@@ -542,7 +595,8 @@ void FVoxelProceduralMeshSceneProxy::GetDynamicRayTracingInstances(FRayTracingMa
 
 	for (const auto& Section : Sections)
 	{
-		if (Section.bSectionVisible && ensure(Section.Material->GetMaterial()->IsValidLowLevel()))
+		// No ray tracing geometry for the sections drawn from the cluster buffer pool, see FVoxelClusterBufferPool::CanPool
+		if (Section.bSectionVisible && Section.RenderData.IsValid() && ensure(Section.Material->GetMaterial()->IsValidLowLevel()))
 		{
 			auto& RenderData = *Section.RenderData;
 #if VOXEL_ENGINE_VERSION >= 505
@@ -642,10 +696,11 @@ void FVoxelProceduralMeshSceneProxy::DrawSection(
 	VOXEL_RENDER_FUNCTION_COUNTER();
 	
 	check(MaterialRenderProxy);
-	check(Section.RenderData.IsValid());
+	check(Section.HasRenderData());
 	
+	const FVoxelClusterBufferAllocation* ClusterBufferAllocation = Section.Buffers->ClusterBufferAllocation.Get();
 
-	Mesh.VertexFactory = &Section.RenderData->VertexFactory;
+	Mesh.VertexFactory = ClusterBufferAllocation ? &ClusterBufferAllocation->Arena->VertexFactory : &Section.RenderData->VertexFactory;
 	Mesh.MaterialRenderProxy = MaterialRenderProxy;
 	Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
 	Mesh.Type = PT_TriangleList;
@@ -663,6 +718,15 @@ void FVoxelProceduralMeshSceneProxy::DrawSection(
 	BatchElement.MinVertexIndex = 0;
 	BatchElement.MaxVertexIndex = Section.Buffers->VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
 
+	if (ClusterBufferAllocation)
+	{
+		// The indices were offset to the chunks ranges when uploaded
+		BatchElement.IndexBuffer = &ClusterBufferAllocation->Arena->IndexBuffer;
+		BatchElement.FirstIndex = ClusterBufferAllocation->Indices.Start;
+		BatchElement.NumPrimitives = ClusterBufferAllocation->Indices.Num / 3;
+		BatchElement.MinVertexIndex = ClusterBufferAllocation->MinVertexIndex;
+		BatchElement.MaxVertexIndex = ClusterBufferAllocation->MaxVertexIndex;
+	}
 
 #if ENABLE_TESSELLATION
 	if (bEnableTessellation)
@@ -682,6 +746,47 @@ void FVoxelProceduralMeshSceneProxy::DrawSection(
 #endif
 }
 
+void FVoxelProceduralMeshSceneProxy::CreateSectionsRenderData()
+{
+	VOXEL_RENDER_FUNCTION_COUNTER();
+	check(IsInRenderingThread());
+
+	for (auto& Section : Sections)
+	{
+		check(!Section.RenderData.IsValid());
+		check(Section.Buffers.IsValid());
+		if (Section.Buffers->ClusterBufferAllocation.IsValid())
+		{
+			// Already uploaded by FVoxelClusterBufferPool::Upload
+			continue;
+		}
+		if (Section.bSectionVisible || NOT_SHIPPING_NOR_TEST) // Need to init for debug
+		{
+			Section.RenderData = FVoxelProcMeshBuffersRenderData::GetRenderData(Section.Buffers.ToSharedRef(), GetScene().GetFeatureLevel());
+		}
+	}
+}
+
+void FVoxelProceduralMeshSceneProxy::UpdateSections_RenderThread(TArray<FVoxelProcMeshProxySection>&& NewSections, double UpdateTime)
+{
+	VOXEL_RENDER_FUNCTION_COUNTER();
+	check(IsInRenderingThread());
+
+	// Create the new render data before releasing the old one, as unchanged buffers share it
+	Swap(Sections, NewSections);
+	CreateSectionsRenderData();
+
+	for (auto& Section : NewSections)
+	{
+		Section.RenderData.Reset();
+	}
+	NewSections.Reset();
+
+	FinishSectionsUpdatesTime = UpdateTime;
+	CreateSceneProxyTime = UpdateTime;
+	bLoggedTime = false;
+}
+
 bool FVoxelProceduralMeshSceneProxy::ShouldDrawComplexCollisions(const FEngineShowFlags& EngineShowFlags) const
 {
 	if (IsCollisionEnabled())
@@ -50,6 +50,9 @@ struct FVoxelProcMeshProxySection
 
 	bool bEnableCollisions_Debug = false;
 	bool bEnableNavmesh_Debug = false;
+
+	// Sections drawn from the cluster buffer pool have no render data of their own
+	bool HasRenderData() const;
 };
 
 class FVoxelProceduralMeshSceneProxy : public FPrimitiveSceneProxy
@@ -82,6 +85,14 @@ public:
 	uint32 GetAllocatedSize() const;
 	//~ End FPrimitiveSceneProxy Interface
 
+public:
+	// The proxy sections of the component, without their render data. Game thread
+	static TArray<FVoxelProcMeshProxySection> CreateSections(const UVoxelProceduralMeshComponent& MeshComponent);
+
+	// If true, the new sections can be sent to this proxy instead of recreating it
+	bool CanUpdateSections_GameThread(const TArray<FVoxelProcMeshProxySection>& NewSections) const;
+	void UpdateSections_GameThread(TArray<FVoxelProcMeshProxySection>&& NewSections);
+
 private:
 	UVoxelProceduralMeshComponent* const Component;
 	const FMaterialRelevance MaterialRelevance;
@@ -95,6 +106,10 @@ private:
 	TArray<FVoxelProcMeshProxySection> Sections;
 	TVoxelSharedPtr<const FDistanceFieldVolumeData> DistanceFieldData;
 
+	// Materials of the last sections sent to the render thread
+	// MaterialRelevance is computed from them, so the proxy must be recreated when they change
+	TArray<TVoxelSharedPtr<FVoxelMaterialInterface>> SectionsMaterials_GameThread;
+
 	double FinishSectionsUpdatesTime = 0;
 	double CreateSceneProxyTime = 0;
 	mutable bool bLoggedTime = false;
@@ -107,4 +122,7 @@ private:
 		bool bWireframe) const;
 	
 	bool ShouldDrawComplexCollisions(const FEngineShowFlags& EngineShowFlags) const;
+
+	void CreateSectionsRenderData();
+	void UpdateSections_RenderThread(TArray<FVoxelProcMeshProxySection>&& NewSections, double UpdateTime);
 };
\ No newline at end of file
@@ -273,7 +273,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		const int32 ChunkNumVertices = Chunk.GetNumVertices();
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
-			PositionBuffer.VertexPosition(VerticesOffset + Index) = FVector3f(Get(Chunk.Positions, Index) + Offset);
+			PositionBuffer.VertexPosition(VerticesOffset + Index) = FVector3f(Get(Chunk.Positions, Index).Unpack(Chunk.LOD) + Offset);
 		}
 	};
 	const auto CopyColors = [&](const FVoxelChunkMeshBuffers& Chunk)
@@ -306,15 +306,15 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
 			{
-				auto& Tangent = Get(Chunk.Tangents, Index);
-				auto& Normal = Get(Chunk.Normals, Index);
+				const FVoxelProcMeshTangent Tangent = Get(Chunk.Tangents, Index).Unpack();
+				const FVector Normal = Get(Chunk.Normals, Index).Unpack();
 				StaticMeshBuffer.SetVertexTangents(VerticesOffset + Index, FVector3f(Tangent.TangentX), FVector3f(Tangent.GetY(Normal)), FVector3f(Normal));
 			}
 			check(Chunk.TextureCoordinates.Num() == NumTextureCoordinates);
 			for (int32 Tex = 0; Tex < NumTextureCoordinates; Tex++)
 			{
-				auto& TextureCoordinate = Get(Chunk.TextureCoordinates[Tex], Index);
-				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, FVector2f(TextureCoordinate));
+				// Converted to half precision by the buffer if bHalfPrecisionCoordinates is true
+				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, Get(Chunk.TextureCoordinates[Tex], Index));
 			}
 		}
 	};
@@ -340,12 +340,17 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		return AdjacencyIndices.Num();
 	};
 	
+	ProcMeshBuffers.Chunks.Reserve(Sections.Num());
 	for (const FVoxelChunkMeshSection& Chunk : Sections)
 	{
 		CHECK_CANCEL();
 		
 		const FVector PositionOffset(Chunk.ChunkPosition - CenterPosition);
 
+		FVoxelProcMeshBuffersChunk& BuffersChunk = ProcMeshBuffers.Chunks.Emplace_GetRef();
+		BuffersChunk.FirstVertex = VerticesOffset;
+		BuffersChunk.FirstIndex = IndicesOffset;
+
 		// Copy main chunk
 		if (Chunk.MainChunk.IsValid() && bShowMainChunks)
 		{
@@ -360,8 +365,8 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 				for (int32 Index = 0; Index < MainChunk.GetNumVertices(); Index++)
 				{
 					PositionBuffer.VertexPosition(VerticesOffset + Index) = FVector3f(FVoxelMesherUtilities::GetTranslatedTransvoxel(
-						Get(MainChunk.Positions, Index),
-						Get(MainChunk.Normals, Index),
+						Get(MainChunk.Positions, Index).Unpack(MainChunk.LOD),
+						Get(MainChunk.Normals, Index).Unpack(),
 						Chunk.TransitionsMask,
 						Chunk.LOD) + PositionOffset);
 				}
@@ -385,6 +390,9 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			
 			VerticesOffset += MainChunk.GetNumVertices();
 			IndicesOffset += MainChunk.Indices.Num();
+
+			BuffersChunk.MainGuid = MainChunk.Guid;
+			BuffersChunk.TransitionsMask = Chunk.bTranslateVertices ? Chunk.TransitionsMask : 0;
 		}
 
 		// Copy transition chunk
@@ -413,7 +421,12 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			
 			VerticesOffset += TransitionChunk.GetNumVertices();
 			IndicesOffset += TransitionChunk.Indices.Num();
+
+			BuffersChunk.TransitionGuid = TransitionChunk.Guid;
 		}
+
+		BuffersChunk.NumVertices = VerticesOffset - BuffersChunk.FirstVertex;
+		BuffersChunk.NumIndices = IndicesOffset - BuffersChunk.FirstIndex;
 	}
 
 	check(VerticesOffset == NumVertices);
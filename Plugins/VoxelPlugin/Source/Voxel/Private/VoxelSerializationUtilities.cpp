@@ -233,19 +233,7 @@ void FVoxelSerializationUtilities::CompressData(
 		return;
 	}
 
-	const auto GetCompressionLevel = [&]()
-	{
-		int32 CompressionLevel = InCompressionLevel;
-		if (CompressionLevel == EVoxelCompressionLevel::VoxelDefault)
-		{
-			CompressionLevel = GetDefault<UVoxelSettings>()->DefaultCompressionLevel;
-		}
-		CompressionLevel = FMath::Clamp(CompressionLevel, -1, 9);
-		static_assert(Z_NO_COMPRESSION == 0, "");
-		static_assert(Z_BEST_COMPRESSION == 9, "");
-		return CompressionLevel;
-	};
-	const int32 CompressionLevel = GetCompressionLevel();
+	const int32 CompressionLevel = GetCompressionLevel(InCompressionLevel);
 
 	const int32 NumChunks = FVoxelUtilities::DivideCeil64(UncompressedDataNum, MaxChunkSize);
 	check(0 < NumChunks && NumChunks < MaxNumChunks);
@@ -492,6 +480,94 @@ bool FVoxelSerializationUtilities::DecompressData(const TArray<uint8>& Compresse
 	}
 }
 
+int32 FVoxelSerializationUtilities::GetCompressionLevel(EVoxelCompressionLevel::Type InCompressionLevel)
+{
+	int32 CompressionLevel = InCompressionLevel;
+	if (CompressionLevel == EVoxelCompressionLevel::VoxelDefault)
+	{
+		CompressionLevel = GetDefault<UVoxelSettings>()->DefaultCompressionLevel;
+	}
+	CompressionLevel = FMath::Clamp(CompressionLevel, -1, 9);
+	static_assert(Z_NO_COMPRESSION == 0, "");
+	static_assert(Z_BEST_COMPRESSION == 9, "");
+	return CompressionLevel;
+}
+
+EVoxelCompressionCodec::Type FVoxelSerializationUtilities::GetAvailableCodec(EVoxelCompressionCodec::Type Codec)
+{
+	switch (Codec)
+	{
+	case EVoxelCompressionCodec::Zlib: return EVoxelCompressionCodec::Zlib;
+	case EVoxelCompressionCodec::LZ4: return FCompression::IsFormatValid(NAME_LZ4) ? Codec : EVoxelCompressionCodec::Zlib;
+	case EVoxelCompressionCodec::Oodle: return FCompression::IsFormatValid(TEXT("Oodle")) ? Codec : EVoxelCompressionCodec::Zlib;
+	default: ensure(false); return EVoxelCompressionCodec::Zlib;
+	}
+}
+
+bool FVoxelSerializationUtilities::CompressBlock(
+	EVoxelCompressionCodec::Type Codec,
+	EVoxelCompressionLevel::Type CompressionLevel,
+	const uint8* UncompressedData,
+	int32 UncompressedSize,
+	TArray<uint8>& OutCompressedData)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(UncompressedSize >= 0);
+
+	if (Codec == EVoxelCompressionCodec::Zlib)
+	{
+		// zlib directly, to have the compression level
+		uLong CompressedSize = compressBound(UncompressedSize);
+		OutCompressedData.SetNumUninitialized(CompressedSize);
+
+		const auto Result = compress2(OutCompressedData.GetData(), &CompressedSize, UncompressedData, UncompressedSize, GetCompressionLevel(CompressionLevel));
+		if (!ensureMsgf(Result == Z_OK, TEXT("Compression failed: %d"), Result))
+		{
+			OutCompressedData.Reset();
+			return false;
+		}
+
+		OutCompressedData.SetNum(CompressedSize, UE_505_SWITCH(false, EAllowShrinking::No));
+		return true;
+	}
+
+	const FName FormatName = Codec == EVoxelCompressionCodec::LZ4 ? NAME_LZ4 : FName(TEXT("Oodle"));
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, UncompressedSize);
+	OutCompressedData.SetNumUninitialized(CompressedSize);
+	if (!ensure(FCompression::CompressMemory(FormatName, OutCompressedData.GetData(), CompressedSize, UncompressedData, UncompressedSize)))
+	{
+		OutCompressedData.Reset();
+		return false;
+	}
+
+	OutCompressedData.SetNum(CompressedSize, UE_505_SWITCH(false, EAllowShrinking::No));
+	return true;
+}
+
+bool FVoxelSerializationUtilities::DecompressBlock(
+	EVoxelCompressionCodec::Type Codec,
+	const uint8* CompressedData,
+	int32 CompressedSize,
+	uint8* OutUncompressedData,
+	int32 UncompressedSize)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (Codec == EVoxelCompressionCodec::Zlib)
+	{
+		uLong ActualUncompressedSize = UncompressedSize;
+		const auto Result = uncompress(OutUncompressedData, &ActualUncompressedSize, CompressedData, CompressedSize);
+		return Result == Z_OK && ActualUncompressedSize == uLong(UncompressedSize);
+	}
+	if (Codec == EVoxelCompressionCodec::LZ4 || Codec == EVoxelCompressionCodec::Oodle)
+	{
+		const FName FormatName = Codec == EVoxelCompressionCodec::LZ4 ? NAME_LZ4 : FName(TEXT("Oodle"));
+		return FCompression::UncompressMemory(FormatName, OutUncompressedData, UncompressedSize, CompressedData, CompressedSize);
+	}
+	return false;
+}
+
 void FVoxelSerializationUtilities::TestCompression(int64 Size, EVoxelCompressionLevel::Type CompressionLevel)
 {
 	LOG_VOXEL(Log, TEXT("Testing compression on %fMB"), double(Size) / double(1 << 20));
@@ -3,6 +3,7 @@
 #include "VoxelThreadPool.h"
 #include "VoxelQueuedWork.h"
 #include "VoxelMinimal.h"
+#include "VoxelPriorityHandler.h"
 #include "IVoxelPool.h"
 
 #include "HAL/Event.h"
@@ -11,9 +12,19 @@
 #include "Misc/ScopeLock.h"
 #include "Misc/ScopeExit.h"
 #include "Async/TaskGraphInterfaces.h"
+#include "Algo/BinarySearch.h"
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("VoxelThreadPoolDummyCounter"), STAT_VoxelThreadPoolDummyCounter, STATGROUP_ThreadPoolAsyncTasks);
 DECLARE_DWORD_COUNTER_STAT(TEXT("Recomputed Voxel Tasks Priorities"), STAT_RecomputedVoxelTasksPriorities, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Stolen Voxel Tasks"), STAT_StolenVoxelTasks, STATGROUP_VoxelCounters);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rebuilt Voxel Tasks Priority Bands"), STAT_RebuiltVoxelTasksPriorityBands, STATGROUP_VoxelCounters);
+
+static TAutoConsoleVariable<int32> CVarPriorityRebuildDistance(
+	TEXT("voxel.threading.PriorityRebuildDistance"),
+	128,
+	TEXT("Queued works with an invoker distance priority are bucketed in distance bands, rebuilt once the invokers moved by more than this many voxels. ")
+	TEXT("Lower values rebuild more often, higher values recompute more priorities per popped work"),
+	ECVF_Default);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -74,11 +85,12 @@ class VOXEL_API FVoxelQueuedThread : public FRunnable
 {
 public:
 	const FString ThreadName;
+	const int32 ThreadIndex;
 	FVoxelQueuedThreadPool* const ThreadPool;
 	/** The event that tells the thread there is work to do. */
 	FEvent* const DoWorkEvent;
 
-	FVoxelQueuedThread(FVoxelQueuedThreadPool* Pool, const FString& ThreadName, uint32 StackSize, EThreadPriority ThreadPriority);
+	FVoxelQueuedThread(FVoxelQueuedThreadPool* Pool, const FString& ThreadName, int32 ThreadIndex, uint32 StackSize, EThreadPriority ThreadPriority);
 	~FVoxelQueuedThread();
 
 	//~ Begin FRunnable Interface
@@ -98,8 +110,9 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-FVoxelQueuedThread::FVoxelQueuedThread(FVoxelQueuedThreadPool* Pool, const FString& ThreadName, uint32 StackSize, EThreadPriority ThreadPriority)
+FVoxelQueuedThread::FVoxelQueuedThread(FVoxelQueuedThreadPool* Pool, const FString& ThreadName, int32 ThreadIndex, uint32 StackSize, EThreadPriority ThreadPriority)
 	: ThreadName(ThreadName)
+	, ThreadIndex(ThreadIndex)
 	, ThreadPool(Pool)
 	, DoWorkEvent(FPlatformProcess::GetSynchEventFromPool()) // Create event BEFORE thread
 	, TimeToDie(false) // BEFORE creating thread
@@ -167,18 +180,134 @@ uint32 FVoxelQueuedThread::Run()
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// TArray heaps are min heaps
+struct FVoxelMaxHeapPredicate
+{
+	template<typename T>
+	FORCEINLINE bool operator()(const T& A, const T& B) const
+	{
+		return B < A;
+	}
+};
+
+class FVoxelWorkStealingQueue
+{
+public:
+	using FWorkQueue = FVoxelQueuedThreadPool::FWorkQueue;
+
+	explicit FVoxelWorkStealingQueue(bool bConstantPriorities)
+		: bConstantPriorities(bConstantPriorities)
+	{
+	}
+
+	FCriticalSection Section;
+	// Highest priority category with works in this queue, -1 if empty
+	// Read without locking by the threads to pick the queue they pop from
+	FThreadSafeCounter64 TopPriorityCategory{ -1 };
+	// Best cached priority within TopPriorityCategory, see FWorkQueue::GetTopCachedPriority. -1 if empty
+	// Not updated atomically with TopPriorityCategory: only used as a hint
+	FThreadSafeCounter64 TopPriority{ -1 };
+
+public:
+	// Section must be locked
+	FWorkQueue& GetWorks(uint32 PriorityCategory)
+	{
+		int32 Index = 0;
+		while (Index < Buckets.Num() && Buckets[Index].PriorityCategory > PriorityCategory)
+		{
+			Index++;
+		}
+		if (Index == Buckets.Num() || Buckets[Index].PriorityCategory != PriorityCategory)
+		{
+			Buckets.Insert(FBucket{ PriorityCategory, FWorkQueue(bConstantPriorities) }, Index);
+		}
+		return Buckets[Index].Works;
+	}
+	// Section must be locked. Null if empty
+	FWorkQueue* GetTopWorks()
+	{
+		for (auto& Bucket : Buckets)
+		{
+			if (Bucket.Works.Num() > 0)
+			{
+				return &Bucket.Works;
+			}
+		}
+		return nullptr;
+	}
+	// Section must be locked
+	void UpdateTopPriority()
+	{
+		for (auto& Bucket : Buckets)
+		{
+			if (Bucket.Works.Num() > 0)
+			{
+				TopPriorityCategory.Set(Bucket.PriorityCategory);
+				// The category is the same for the whole bucket
+				TopPriority.Set(uint32(Bucket.Works.GetTopCachedPriority()));
+				return;
+			}
+		}
+		TopPriorityCategory.Set(-1);
+		TopPriority.Set(-1);
+	}
+	// Section must be locked. Returns the number of works abandoned
+	int32 AbandonAll()
+	{
+		int32 NumAbandoned = 0;
+		for (auto& Bucket : Buckets)
+		{
+			NumAbandoned += Bucket.Works.AbandonAll();
+		}
+		TopPriorityCategory.Set(-1);
+		TopPriority.Set(-1);
+		return NumAbandoned;
+	}
+
+private:
+	const bool bConstantPriorities;
+
+	struct FBucket
+	{
+		uint32 PriorityCategory;
+		FWorkQueue Works;
+	};
+	// Sorted by decreasing priority category
+	// Only a few categories are used, so buckets are never removed
+	TArray<FBucket> Buckets;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 FVoxelQueuedThreadPoolSettings::FVoxelQueuedThreadPoolSettings(
 	const FString& PoolName, 
 	uint32 NumThreads, 
 	uint32 StackSize, 
 	EThreadPriority ThreadPriority, 
-	bool bConstantPriorities)
+	bool bConstantPriorities,
+	EVoxelQueuedThreadPoolScheduler Scheduler)
 	: PoolName(PoolName)
 	, NumThreads(NumThreads)
 	, StackSize(StackSize)
 	, ThreadPriority(ThreadPriority)
 	, bConstantPriorities(bConstantPriorities)
+	, Scheduler(Scheduler)
+{
+}
+
+inline TArray<TUniquePtr<FVoxelWorkStealingQueue>> CreateWorkStealingQueues(const FVoxelQueuedThreadPoolSettings& Settings)
 {
+	TArray<TUniquePtr<FVoxelWorkStealingQueue>> Queues;
+	if (Settings.Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing)
+	{
+		for (uint32 ThreadIndex = 0; ThreadIndex < Settings.NumThreads; ThreadIndex++)
+		{
+			Queues.Add(MakeUnique<FVoxelWorkStealingQueue>(Settings.bConstantPriorities));
+		}
+	}
+	return Queues;
 }
 
 inline TArray<TUniquePtr<FVoxelQueuedThread>> CreateThreads(FVoxelQueuedThreadPool* Pool)
@@ -197,14 +326,16 @@ inline TArray<TUniquePtr<FVoxelQueuedThread>> CreateThreads(FVoxelQueuedThreadPo
 	for (uint32 ThreadIndex = 0; ThreadIndex < NumThreads; ThreadIndex++)
 	{
 		const FString Name = FString::Printf(TEXT("%s Thread %d"), *Settings.PoolName, ThreadIndex);
-		Threads.Add(MakeUnique<FVoxelQueuedThread>(Pool, Name, Settings.StackSize, Settings.ThreadPriority));
+		Threads.Add(MakeUnique<FVoxelQueuedThread>(Pool, Name, ThreadIndex, Settings.StackSize, Settings.ThreadPriority));
 	}
 	return Threads;
 }
 
 FVoxelQueuedThreadPool::FVoxelQueuedThreadPool(const FVoxelQueuedThreadPoolSettings& Settings)
 	: Settings(Settings)
+	, WorkStealingQueues(CreateWorkStealingQueues(Settings))
 	, AllThreads(CreateThreads(this))
+	, QueuedWorks(Settings.bConstantPriorities)
 {
 	QueuedThreads.Reserve(Settings.NumThreads);
 	for (auto& Thread : AllThreads) 
@@ -245,6 +376,8 @@ inline uint32 AddPriorityOffset(uint32 Priority, int32 PriorityOffset)
 
 FORCEINLINE void FVoxelQueuedThreadPool::FQueuedWorkInfo::RecomputePriority(double Time)
 {
+	// Must be read before the invokers positions
+	PriorityStamp = FVoxelInvokersMovement::GetStamp();
 	Priority = AddPriorityOffset(Work->GetPriority(), PriorityOffset);
 	NextPriorityUpdateTime = Time + Work->PriorityDuration;
 }
@@ -262,6 +395,12 @@ void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint3
 		return;
 	}
 
+	if (Settings.Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing)
+	{
+		AddQueuedWorks_WorkStealing(MakeArrayView(&InQueuedWork, 1), PriorityCategory, PriorityOffset);
+		return;
+	}
+
 	FQueuedWorkInfo WorkInfo;
 	{
 		VOXEL_SCOPE_COUNTER("Compute Priority");
@@ -274,15 +413,7 @@ void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint3
 	}
 	{
 		VOXEL_SCOPE_COUNTER("Add Work");
-		if (Settings.bConstantPriorities)
-		{
-			WorkInfo.RecomputePriority(FPlatformTime::Seconds());
-			StaticQueuedWorks.push(WorkInfo);
-		}
-		else
-		{
-			QueuedWorks.Add(WorkInfo);
-		}
+		QueuedWorks.Add(WorkInfo, FPlatformTime::Seconds());
 	}
 
 	{
@@ -315,31 +446,23 @@ void FVoxelQueuedThreadPool::AddQueuedWorks(const TArray<IVoxelQueuedWork*>& InQ
 		return;
 	}
 
+	if (Settings.Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing)
+	{
+		AddQueuedWorks_WorkStealing(InQueuedWorks, PriorityCategory, PriorityOffset);
+		return;
+	}
+
 	{
 		VOXEL_SCOPE_COUNTER("Lock");
 		Section.Lock();
 	}
 
 	{
-		if (!Settings.bConstantPriorities)
-		{
-			VOXEL_SCOPE_COUNTER("Reserve");
-			QueuedWorks.Reserve(QueuedWorks.Num() + InQueuedWorks.Num());
-		}
 		VOXEL_SCOPE_COUNTER("Add Works");
+		const double Time = FPlatformTime::Seconds();
 		for (auto* InQueuedWork : InQueuedWorks)
 		{
-			FQueuedWorkInfo WorkInfo(InQueuedWork, PriorityCategory, PriorityOffset);
-
-			if (Settings.bConstantPriorities)
-			{
-				WorkInfo.RecomputePriority(FPlatformTime::Seconds());
-				StaticQueuedWorks.push(WorkInfo);
-			}
-			else
-			{
-				QueuedWorks.Add(WorkInfo);
-			}
+			QueuedWorks.Add(FQueuedWorkInfo(InQueuedWork, PriorityCategory, PriorityOffset), Time);
 		}
 	}
 
@@ -364,50 +487,18 @@ IVoxelQueuedWork* FVoxelQueuedThreadPool::ReturnToPoolOrGetNextJob(FVoxelQueuedT
 
 	check(InQueuedThread);
 
+	if (Settings.Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing)
+	{
+		return GetNextJob_WorkStealing(*InQueuedThread);
+	}
+
 	FScopeLockWithStats Lock(Section);
 
 	if (QueuedWorks.Num() > 0)
 	{
-		check(!Settings.bConstantPriorities);
 		check(!TimeToDie);
 
-		VOXEL_ASYNC_SCOPE_COUNTER("Voxel Thread Pool Recompute Priorities");
-
-		// Find best work. We recompute every priorities as the priorities can change (eg, the camera might have moved)
-		int32 BestIndex = -1;
-		uint64 BestPriority = 0;
-		int32 NumRecomputed = 0;
-		const double Time = FPlatformTime::Seconds();
-		for (int32 Index = 0; Index < QueuedWorks.Num(); Index++)
-		{
-			auto& WorkInfo = QueuedWorks.GetData()[Index];
-			if (WorkInfo.NextPriorityUpdateTime < Time)
-			{
-				NumRecomputed++;
-				WorkInfo.RecomputePriority(Time);
-			}
-			const uint64 Priority = WorkInfo.GetPriority();
-			if (Priority >= BestPriority)
-			{
-				BestPriority = Priority;
-				BestIndex = Index;
-			}
-		}
-
-		INC_DWORD_STAT_BY(STAT_RecomputedVoxelTasksPriorities, NumRecomputed);
-
-		auto* Work = QueuedWorks[BestIndex].Work;
-		QueuedWorks.RemoveAtSwap(BestIndex);
-		check(Work);
-		return Work;
-	}
-	else if (!StaticQueuedWorks.empty())
-	{
-		check(Settings.bConstantPriorities);
-		auto* Work = StaticQueuedWorks.top().Work;
-		StaticQueuedWorks.pop();
-		check(Work);
-		return Work;
+		return QueuedWorks.Pop();
 	}
 	else
 	{
@@ -426,15 +517,11 @@ void FVoxelQueuedThreadPool::AbandonAllTasks()
 		FScopeLockWithStats Lock(Section);
 		TimeToDie = true;
 		// Clean up all queued objects
-		for (auto& WorkInfo : QueuedWorks)
-		{
-			WorkInfo.Work->Abandon();
-		}
-		QueuedWorks.Reset();
-		while (!StaticQueuedWorks.empty())
+		QueuedWorks.AbandonAll();
+		for (auto& Queue : WorkStealingQueues)
 		{
-			StaticQueuedWorks.top().Work->Abandon();
-			StaticQueuedWorks.pop();
+			FScopeLock QueueLock(&Queue->Section);
+			NumWorkStealingQueuedWorks.Subtract(Queue->AbandonAll());
 		}
 	}
 	// Wait for all threads to finish up
@@ -450,3 +537,407 @@ void FVoxelQueuedThreadPool::AbandonAllTasks()
 		FPlatformProcess::Sleep(0.0f);
 	}
 }
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Invoker distance priorities are bucketed in bands of 32 voxels
+FORCEINLINE uint64 GetPriorityBandKey(uint64 Priority)
+{
+	return Priority >> 5;
+}
+FORCEINLINE uint64 GetPriorityBandMax(uint64 BandKey)
+{
+	return ((BandKey + 1) << 5) - 1;
+}
+
+void FVoxelQueuedThreadPool::FWorkQueue::Add(FQueuedWorkInfo WorkInfo, double Time)
+{
+	if (bConstantPriorities)
+	{
+		WorkInfo.RecomputePriority(Time);
+		Works.HeapPush(WorkInfo, FVoxelMaxHeapPredicate());
+	}
+	else if (WorkInfo.Work->HasInvokerDistancePriority())
+	{
+		// Computed by the threads in Pop, to keep adding works cheap
+		NewWorks.Add(WorkInfo);
+	}
+	else
+	{
+		Works.Add(WorkInfo);
+	}
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::FWorkQueue::Pop()
+{
+	check(Num() > 0);
+
+	if (bConstantPriorities)
+	{
+		FQueuedWorkInfo WorkInfo;
+		Works.HeapPop(WorkInfo, FVoxelMaxHeapPredicate());
+		check(WorkInfo.Work);
+		return WorkInfo.Work;
+	}
+
+	VOXEL_ASYNC_SCOPE_COUNTER("Voxel Thread Pool Recompute Priorities");
+
+	enum class EBestWork
+	{
+		None,
+		Works,
+		Band,
+		MovedWorks
+	};
+	EBestWork BestWork = EBestWork::None;
+	uint64 BestBandKey = 0;
+	int32 BestIndex = -1;
+	uint64 BestPriority = 0;
+
+	int32 NumRecomputed = 0;
+	const double Time = FPlatformTime::Seconds();
+
+	// Find best work. We recompute every priorities as the priorities can change (eg, the camera might have moved)
+	for (int32 Index = 0; Index < Works.Num(); Index++)
+	{
+		auto& WorkInfo = Works.GetData()[Index];
+		if (WorkInfo.NextPriorityUpdateTime < Time)
+		{
+			NumRecomputed++;
+			WorkInfo.RecomputePriority(Time);
+		}
+		const uint64 Priority = WorkInfo.GetPriority();
+		if (Priority >= BestPriority)
+		{
+			BestWork = EBestWork::Works;
+			BestPriority = Priority;
+			BestIndex = Index;
+		}
+	}
+
+	// Banded works whose band changed. Added back once we are done iterating the bands
+	TArray<FQueuedWorkInfo, TInlineAllocator<16>> MovedWorks;
+
+	if (NumBandedWorks + NewWorks.Num() > 0)
+	{
+		if (NumBandedWorks == 0)
+		{
+			BandsStamp = FVoxelInvokersMovement::GetStamp();
+		}
+		else if (FVoxelInvokersMovement::GetMovementSince(BandsStamp) > uint32(FMath::Max(0, CVarPriorityRebuildDistance.GetValueOnAnyThread())))
+		{
+			NumRecomputed += NumBandedWorks;
+			RebuildBands(Time);
+		}
+
+		for (FQueuedWorkInfo WorkInfo : NewWorks)
+		{
+			WorkInfo.RecomputePriority(Time);
+			AddToBand(WorkInfo);
+		}
+		NumRecomputed += NewWorks.Num();
+		NewWorks.Reset();
+
+		// All the banded priorities changed by at most Slack since they were computed,
+		// so a band can only contain the best work if its max priority + Slack is above the best priority
+		const uint64 Stamp = FVoxelInvokersMovement::GetStamp();
+		const uint32 Slack = FVoxelInvokersMovement::GetMovementSince(BandsStamp);
+
+		for (int32 KeyIndex = 0; KeyIndex < BandKeys.Num(); KeyIndex++)
+		{
+			const uint64 BandKey = BandKeys[KeyIndex];
+			if (BestWork != EBestWork::None && GetPriorityBandMax(BandKey) + Slack < BestPriority)
+			{
+				break;
+			}
+
+			TArray<FQueuedWorkInfo>& BandWorks = Bands.FindChecked(BandKey);
+			if (BandWorks.Num() == 0)
+			{
+				Bands.Remove(BandKey);
+				BandKeys.RemoveAt(KeyIndex);
+				KeyIndex--;
+				continue;
+			}
+
+			for (int32 Index = 0; Index < BandWorks.Num();)
+			{
+				FQueuedWorkInfo& WorkInfo = BandWorks.GetData()[Index];
+				if (WorkInfo.PriorityStamp != Stamp)
+				{
+					NumRecomputed++;
+					WorkInfo.RecomputePriority(Time);
+				}
+
+				const uint64 Priority = WorkInfo.GetPriority();
+				const bool bIsBest = BestWork == EBestWork::None || Priority > BestPriority;
+
+				if (GetPriorityBandKey(Priority) != BandKey)
+				{
+					MovedWorks.Add(WorkInfo);
+					// Only swaps with works after Index, so BestIndex stays valid
+					BandWorks.RemoveAtSwap(Index, 1, UE_505_SWITCH(false, EAllowShrinking::No));
+					NumBandedWorks--;
+
+					if (bIsBest)
+					{
+						BestWork = EBestWork::MovedWorks;
+						BestPriority = Priority;
+						BestIndex = MovedWorks.Num() - 1;
+					}
+					continue;
+				}
+
+				if (bIsBest)
+				{
+					BestWork = EBestWork::Band;
+					BestBandKey = BandKey;
+					BestPriority = Priority;
+					BestIndex = Index;
+				}
+				Index++;
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_RecomputedVoxelTasksPriorities, NumRecomputed);
+
+	IVoxelQueuedWork* Work = nullptr;
+	switch (BestWork)
+	{
+	case EBestWork::Works:
+	{
+		Work = Works[BestIndex].Work;
+		Works.RemoveAtSwap(BestIndex);
+		break;
+	}
+	case EBestWork::Band:
+	{
+		TArray<FQueuedWorkInfo>& BandWorks = Bands.FindChecked(BestBandKey);
+		Work = BandWorks[BestIndex].Work;
+		BandWorks.RemoveAtSwap(BestIndex, 1, UE_505_SWITCH(false, EAllowShrinking::No));
+		NumBandedWorks--;
+		break;
+	}
+	case EBestWork::MovedWorks:
+	{
+		Work = MovedWorks[BestIndex].Work;
+		MovedWorks.RemoveAtSwap(BestIndex);
+		break;
+	}
+	default: check(false);
+	}
+
+	for (const FQueuedWorkInfo& WorkInfo : MovedWorks)
+	{
+		AddToBand(WorkInfo);
+	}
+
+	check(Work);
+	return Work;
+}
+
+uint64 FVoxelQueuedThreadPool::FWorkQueue::GetTopCachedPriority() const
+{
+	check(Num() > 0);
+
+	if (bConstantPriorities)
+	{
+		return Works.HeapTop().GetPriority();
+	}
+
+	// Works added since the last Pop have a priority of 0 until Pop computes it
+	uint64 TopPriority = 0;
+	for (const FQueuedWorkInfo& WorkInfo : Works)
+	{
+		TopPriority = FMath::Max(TopPriority, WorkInfo.GetPriority());
+	}
+	// Bands are only cleaned up in Pop, skip the empty ones
+	for (const uint64 BandKey : BandKeys)
+	{
+		if (Bands.FindChecked(BandKey).Num() > 0)
+		{
+			TopPriority = FMath::Max(TopPriority, GetPriorityBandMax(BandKey));
+			break;
+		}
+	}
+	return TopPriority;
+}
+
+int32 FVoxelQueuedThreadPool::FWorkQueue::AbandonAll()
+{
+	const int32 NumAbandoned = Num();
+
+	for (auto& WorkInfo : Works)
+	{
+		WorkInfo.Work->Abandon();
+	}
+	for (auto& WorkInfo : NewWorks)
+	{
+		WorkInfo.Work->Abandon();
+	}
+	for (auto& It : Bands)
+	{
+		for (auto& WorkInfo : It.Value)
+		{
+			WorkInfo.Work->Abandon();
+		}
+	}
+
+	Works.Reset();
+	NewWorks.Reset();
+	Bands.Reset();
+	BandKeys.Reset();
+	NumBandedWorks = 0;
+
+	return NumAbandoned;
+}
+
+void FVoxelQueuedThreadPool::FWorkQueue::AddToBand(const FQueuedWorkInfo& WorkInfo)
+{
+	const uint64 BandKey = GetPriorityBandKey(WorkInfo.GetPriority());
+
+	TArray<FQueuedWorkInfo>* BandWorks = Bands.Find(BandKey);
+	if (!BandWorks)
+	{
+		BandWorks = &Bands.Add(BandKey);
+		BandKeys.Insert(BandKey, Algo::LowerBound(BandKeys, BandKey, TGreater<>()));
+	}
+	BandWorks->Add(WorkInfo);
+	NumBandedWorks++;
+}
+
+void FVoxelQueuedThreadPool::FWorkQueue::RebuildBands(double Time)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	INC_DWORD_STAT(STAT_RebuiltVoxelTasksPriorityBands);
+
+	TArray<FQueuedWorkInfo> AllWorks;
+	AllWorks.Reserve(NumBandedWorks);
+	for (auto& It : Bands)
+	{
+		AllWorks.Append(It.Value);
+	}
+
+	Bands.Reset();
+	BandKeys.Reset();
+	NumBandedWorks = 0;
+	// All the priorities below are computed after this
+	BandsStamp = FVoxelInvokersMovement::GetStamp();
+
+	for (FQueuedWorkInfo& WorkInfo : AllWorks)
+	{
+		WorkInfo.RecomputePriority(Time);
+		AddToBand(WorkInfo);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelQueuedThreadPool::AddQueuedWorks_WorkStealing(TArrayView<IVoxelQueuedWork* const> InQueuedWorks, uint32 PriorityCategory, int32 PriorityOffset)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 NumQueues = WorkStealingQueues.Num();
+	const double Time = FPlatformTime::Seconds();
+
+	// Spread the works across the queues, so that the threads mostly pop from their own
+	for (int32 QueueOffset = 0; QueueOffset < FMath::Min(NumQueues, InQueuedWorks.Num()); QueueOffset++)
+	{
+		FVoxelWorkStealingQueue& Queue = *WorkStealingQueues[(NextWorkStealingQueue + QueueOffset) % NumQueues];
+
+		FScopeLock Lock(&Queue.Section);
+
+		FWorkQueue& Works = Queue.GetWorks(PriorityCategory);
+		int32 NumAdded = 0;
+		for (int32 Index = QueueOffset; Index < InQueuedWorks.Num(); Index += NumQueues)
+		{
+			Works.Add(FQueuedWorkInfo(InQueuedWorks[Index], PriorityCategory, PriorityOffset), Time);
+			NumAdded++;
+		}
+
+		Queue.UpdateTopPriority();
+		// Must be done before waking up the threads, see GetNextJob_WorkStealing
+		NumWorkStealingQueuedWorks.Add(NumAdded);
+	}
+	NextWorkStealingQueue += InQueuedWorks.Num();
+
+	{
+		VOXEL_SCOPE_COUNTER("Wake up threads");
+		FScopeLock Lock(&Section);
+		for (auto* QueuedThread : QueuedThreads)
+		{
+			QueuedThread->DoWorkEvent->Trigger();
+		}
+		QueuedThreads.Reset();
+	}
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::GetNextJob_WorkStealing(FVoxelQueuedThread& Thread)
+{
+	const int32 NumQueues = WorkStealingQueues.Num();
+	check(WorkStealingQueues.IsValidIndex(Thread.ThreadIndex));
+
+	while (true)
+	{
+		// Pop from the queue with the highest priority category, then the best priority within it, preferring our own
+		int32 BestQueueIndex = -1;
+		int64 BestPriorityCategory = -1;
+		int64 BestPriority = -1;
+		for (int32 Offset = 0; Offset < NumQueues; Offset++)
+		{
+			const int32 QueueIndex = (Thread.ThreadIndex + Offset) % NumQueues;
+			const FVoxelWorkStealingQueue& Queue = *WorkStealingQueues[QueueIndex];
+			const int64 PriorityCategory = Queue.TopPriorityCategory.GetValue();
+			if (PriorityCategory < 0 || PriorityCategory < BestPriorityCategory)
+			{
+				continue;
+			}
+
+			const int64 Priority = Queue.TopPriority.GetValue();
+			if (PriorityCategory > BestPriorityCategory || Priority > BestPriority)
+			{
+				BestPriorityCategory = PriorityCategory;
+				BestPriority = Priority;
+				BestQueueIndex = QueueIndex;
+			}
+		}
+
+		if (BestQueueIndex != -1)
+		{
+			FVoxelWorkStealingQueue& Queue = *WorkStealingQueues[BestQueueIndex];
+
+			FScopeLockWithStats Lock(Queue.Section);
+
+			FWorkQueue* Works = Queue.GetTopWorks();
+			if (!Works)
+			{
+				// Emptied by another thread since we read TopPriorityCategory
+				continue;
+			}
+
+			IVoxelQueuedWork* Work = Works->Pop();
+			Queue.UpdateTopPriority();
+			NumWorkStealingQueuedWorks.Decrement();
+
+			if (BestQueueIndex != Thread.ThreadIndex)
+			{
+				INC_DWORD_STAT(STAT_StolenVoxelTasks);
+			}
+			return Work;
+		}
+
+		FScopeLockWithStats Lock(Section);
+		// Works are counted before the threads are woken up under Section:
+		// if there are none now, we will be woken up when new ones are added
+		if (NumWorkStealingQueuedWorks.GetValue() == 0)
+		{
+			QueuedThreads.Add(&Thread);
+			return nullptr;
+		}
+	}
+}
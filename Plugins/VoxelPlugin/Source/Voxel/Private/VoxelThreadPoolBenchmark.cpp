@@ -0,0 +1,157 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelThreadPool.h"
+#include "VoxelQueuedWork.h"
+#include "IVoxelPool.h"
+#include "HAL/IConsoleManager.h"
+
+// Synthetic works with mesher-like priorities, queued in batches like the renderer does
+namespace FVoxelThreadPoolBenchmark
+{
+	struct FState
+	{
+		FThreadSafeCounter NumDone;
+		// Time between the work being queued and it starting, per work
+		TArray<double> Latencies;
+	};
+
+	class FWork : public IVoxelQueuedWork
+	{
+	public:
+		FWork(FState& State, int32 Index, uint32 Priority, double WorkTime)
+			: IVoxelQueuedWork("Thread Pool Benchmark", 0.5)
+			, State(State)
+			, Index(Index)
+			, Priority(Priority)
+			, WorkTime(WorkTime)
+		{
+		}
+
+		double QueueTime = 0;
+
+		//~ Begin IVoxelQueuedWork Interface
+		virtual void DoThreadedWork() override
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			State.Latencies[Index] = StartTime - QueueTime;
+
+			// Busy wait to keep the threads saturated
+			while (FPlatformTime::Seconds() - StartTime < WorkTime)
+			{
+			}
+
+			State.NumDone.Increment();
+		}
+		virtual void Abandon() override
+		{
+			State.NumDone.Increment();
+		}
+		virtual uint32 GetPriority() const override
+		{
+			return Priority;
+		}
+		virtual bool HasInvokerDistancePriority() const override
+		{
+			// Like the meshers. The invokers never move here, so each priority is only computed once
+			return true;
+		}
+		//~ End IVoxelQueuedWork Interface
+
+	private:
+		FState& State;
+		const int32 Index;
+		const uint32 Priority;
+		const double WorkTime;
+	};
+
+	void Run(EVoxelQueuedThreadPoolScheduler Scheduler, bool bConstantPriorities, int32 NumWorks, int32 NumThreads, double WorkTime)
+	{
+		const auto Pool = FVoxelQueuedThreadPool::Create(FVoxelQueuedThreadPoolSettings(
+			TEXT("Voxel Benchmark Pool"),
+			NumThreads,
+			1024 * 1024,
+			EThreadPriority::TPri_Normal,
+			bConstantPriorities,
+			Scheduler));
+
+		FState State;
+		State.Latencies.SetNumZeroed(NumWorks);
+
+		FRandomStream Stream(0);
+		TArray<TUniquePtr<FWork>> Works;
+		Works.Reserve(NumWorks);
+		for (int32 Index = 0; Index < NumWorks; Index++)
+		{
+			// Priorities are usually based on the distance to the invokers
+			const uint32 Distance = Stream.RandRange(0, 1 << 16);
+			Works.Add(MakeUnique<FWork>(State, Index, MAX_uint32 - Distance, WorkTime));
+		}
+
+		const uint32 PriorityCategories[] =
+		{
+			EVoxelTaskType_DefaultPriorityCategories::ChunksMeshing,
+			EVoxelTaskType_DefaultPriorityCategories::VisibleChunksMeshing,
+			EVoxelTaskType_DefaultPriorityCategories::MeshMerge
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		constexpr int32 BatchSize = 1000;
+		for (int32 BatchStart = 0; BatchStart < NumWorks; BatchStart += BatchSize)
+		{
+			TArray<IVoxelQueuedWork*> Batch;
+			for (int32 Index = BatchStart; Index < FMath::Min(NumWorks, BatchStart + BatchSize); Index++)
+			{
+				Works[Index]->QueueTime = FPlatformTime::Seconds();
+				Batch.Add(Works[Index].Get());
+			}
+			Pool->AddQueuedWorks(Batch, PriorityCategories[(BatchStart / BatchSize) % UE_ARRAY_COUNT(PriorityCategories)], 0);
+		}
+
+		const double QueueEndTime = FPlatformTime::Seconds();
+
+		while (State.NumDone.GetValue() < NumWorks)
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		const double EndTime = FPlatformTime::Seconds();
+
+		State.Latencies.Sort();
+		const auto GetPercentile = [&](double Percentile)
+		{
+			return State.Latencies[FMath::Clamp(FMath::FloorToInt(NumWorks * Percentile), 0, NumWorks - 1)] * 1000;
+		};
+
+		LOG_VOXEL(Log, TEXT("%s (%s priorities): %.0f works/s, queueing took %.2fms. Latency: p50 %.1fms, p99 %.1fms, p99.9 %.1fms, max %.1fms"),
+			Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing ? TEXT("Work stealing") : TEXT("Global queue"),
+			bConstantPriorities ? TEXT("constant") : TEXT("dynamic"),
+			NumWorks / (EndTime - StartTime),
+			(QueueEndTime - StartTime) * 1000,
+			GetPercentile(0.5),
+			GetPercentile(0.99),
+			GetPercentile(0.999),
+			State.Latencies.Last() * 1000);
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 NumWorks = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20000);
+		const int32 NumThreads = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 16);
+		const double WorkTime = FMath::Max(0.f, Args.Num() > 2 ? FCString::Atof(*Args[2]) : 20.f) / 1e6;
+
+		LOG_VOXEL(Log, TEXT("Benchmarking thread pools: %d works of %.0fus on %d threads"), NumWorks, WorkTime * 1e6, NumThreads);
+
+		for (const bool bConstantPriorities : { true, false })
+		{
+			Run(EVoxelQueuedThreadPoolScheduler::GlobalQueue, bConstantPriorities, NumWorks, NumThreads, WorkTime);
+			Run(EVoxelQueuedThreadPoolScheduler::WorkStealing, bConstantPriorities, NumWorks, NumThreads, WorkTime);
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkThreadPools(
+	TEXT("voxel.threading.BenchmarkPools"),
+	TEXT("Compares the global queue and the work stealing thread pool schedulers. Args: [NumWorks = 20000] [NumThreads = 16] [WorkMicroseconds = 20]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FVoxelThreadPoolBenchmark::Benchmark));
@@ -5,6 +5,7 @@
 #include "VoxelRender/IVoxelLODManager.h"
 #include "VoxelData/VoxelDataIncludes.h"
 #include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelData/VoxelRegionSave.h"
 #include "VoxelAssets/VoxelHeightmapAsset.h"
 #include "VoxelAssets/VoxelHeightmapAssetSamplerWrapper.h"
 #include "VoxelFeedbackContext.h"
@@ -251,6 +252,48 @@ bool UVoxelDataTools::LoadFromCompressedSave(const AVoxelWorld* World, const FVo
 	return LoadFromSave(World, UncompressedSave, Objects);
 }
 
+bool UVoxelDataTools::SaveToRegionSaveFile(AVoxelWorld* World, const FString& Path, int32 RegionDepth)
+{
+	VOXEL_FUNCTION_COUNTER();
+	CHECK_VOXELWORLD_IS_CREATED();
+
+	auto& Data = World->GetData();
+
+	FVoxelUncompressedWorldSaveImpl Save;
+	TArray<FVoxelObjectArchiveEntry> Objects;
+	Data.GetSave(Save, Objects);
+
+	RegionDepth = FMath::Clamp(RegionDepth, 0, Save.GetDepth());
+
+	return FVoxelRegionWorldSave::Write(Save, Objects, RegionDepth, Path);
+}
+
+bool UVoxelDataTools::LoadFromRegionSaveFile(AVoxelWorld* World, const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+	CHECK_VOXELWORLD_IS_CREATED();
+
+	const TVoxelSharedPtr<const FVoxelRegionWorldSave> RegionSave = FVoxelRegionWorldSave::Open(Path);
+	if (!RegionSave)
+	{
+		FVoxelMessages::Error(FString::Printf(TEXT("LoadFromRegionSaveFile: failed to open %s"), *Path), World);
+		return false;
+	}
+
+	// Clears the data and loads the placeable items: the chunks are loaded by the streamer
+	FVoxelUncompressedWorldSaveImpl ItemsSave;
+	TArray<FVoxelObjectArchiveEntry> Objects;
+	RegionSave->GetItemsSave(ItemsSave, Objects);
+
+	const bool bSuccess = LoadFromSave(World, ItemsSave, Objects);
+
+	const auto Loader = MakeVoxelShared<FVoxelRegionSaveLoader>(RegionSave.ToSharedRef());
+	World->GetData().SetRegionSaveLoader(Loader);
+	World->StreamRegionSave(Loader);
+
+	return bSuccess;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -634,7 +677,7 @@ void UVoxelDataTools::CompressIntoHeightmapImpl(FVoxelData& Data, TVoxelHeightma
 				{
 					DataHolder.CreateData(Data, [&](FVoxelValue* RESTRICT DataPtr)
 					{
-						TVoxelQueryZone<FVoxelValue> QueryZone(Leaf.GetBounds(), DataPtr);
+						TVoxelQueryZone<FVoxelValue> QueryZone = TVoxelQueryZone<FVoxelValue>::ForDataChunk(Leaf.GetBounds(), DataPtr);
 						Leaf.GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
 					});
 					// Reduce memory usage
@@ -17,6 +17,7 @@
 #include "VoxelRender/Renderers/VoxelDefaultRenderer.h"
 #include "VoxelData/VoxelData.h"
 #include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelData/VoxelRegionSaveStreamer.h"
 #include "VoxelMultiplayer/VoxelMultiplayerTcp.h"
 #include "VoxelTools/VoxelBlueprintLibrary.h"
 #include "VoxelTools/VoxelDataTools.h"
@@ -309,6 +310,26 @@ FVoxelIntBox AVoxelWorld::GetWorldBounds() const
 	}
 }
 
+void AVoxelWorld::StreamRegionSave(const TVoxelSharedRef<FVoxelRegionSaveLoader>& Loader)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	check(IsCreated());
+	ensure(Data->GetRegionSaveLoader() == Loader);
+
+	if (RegionSaveStreamer)
+	{
+		RegionSaveStreamer->StopTicking();
+		FVoxelUtilities::DeleteTickable(GetWorld(), RegionSaveStreamer);
+	}
+
+	RegionSaveStreamer = MakeVoxelShared<FVoxelRegionSaveStreamer>(*this, Loader);
+
+	// Load the regions around the invokers right away, so that the first meshes are built with them
+	RegionSaveStreamer->LoadRegionsAroundInvokers(MAX_dbl);
+	RegionSaveStreamer->UpdateLoadedBounds();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -1072,6 +1093,12 @@ void AVoxelWorld::DestroyWorldInternal()
 	
 	LODManager->Destroy();
 	FVoxelUtilities::DeleteTickable(GetWorld(), LODManager);
+
+	if (RegionSaveStreamer)
+	{
+		RegionSaveStreamer->StopTicking();
+		FVoxelUtilities::DeleteTickable(GetWorld(), RegionSaveStreamer);
+	}
 	
 
 	WorldOffset = MakeVoxelShared<FIntVector>(FIntVector::ZeroValue);
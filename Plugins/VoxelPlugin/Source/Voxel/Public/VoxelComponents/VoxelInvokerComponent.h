@@ -128,12 +128,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Invoker|Navmesh", meta = (EditCondition = bUseForNavmesh, ClampMin = 0))
 	float NavmeshRange = 1000;
 
+	// In seconds. If not 0, LODToSet will also be set along the path the invoker will follow during this time at its current velocity,
+	// and the chunks on this path will be computed first. Useful for fast invokers, eg planes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Invoker|Prediction", meta = (ClampMin = 0, UIMax = 10))
+	float LookAheadTime = 0;
+
 public:
 	// VoxelSimpleInvokerComponent's GetInvokerVoxelPosition and GetInvokerSettings functions are calling GetInvokerGlobalPosition to find the global position of the invoker
 	// Defaults to GetComponentPosition
 	UFUNCTION(BlueprintNativeEvent, Category = "Voxel|Invoker")
 	FVector GetInvokerGlobalPosition() const;
 
+	// In cm/s. Used with LookAheadTime to predict where the invoker will be
+	// Defaults to the owner velocity
+	UFUNCTION(BlueprintNativeEvent, Category = "Voxel|Invoker")
+	FVector GetInvokerVelocity() const;
+
 public:
 	//~ Begin UVoxelInvokerComponentBase Interface
 	virtual FIntVector GetInvokerVoxelPosition_Implementation(AVoxelWorldInterface* VoxelWorld) const override;
@@ -143,11 +153,13 @@ public:
 protected:
 	//~ Begin UVoxelSimpleInvokerComponent Interface
 	virtual FVector GetInvokerGlobalPosition_Implementation() const;
+	virtual FVector GetInvokerVelocity_Implementation() const;
 	//~ End UVoxelSimpleInvokerComponent Interface
 };
 
 // Voxel Invokers are used to configure the voxel world LOD, collisions and navmesh
 // Same as simple invoker, but optionally use the velocity to predict the position
+// Unlike LookAheadTime, the current position is not used once the predicted one is far enough from it
 UCLASS(ClassGroup = Voxel, meta = (BlueprintSpawnableComponent))
 class VOXEL_API UVoxelInvokerWithPredictionComponent : public UVoxelSimpleInvokerComponent
 {
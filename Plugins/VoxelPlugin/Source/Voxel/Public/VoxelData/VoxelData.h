@@ -8,8 +8,11 @@
 #include "VoxelValue.h"
 #include "VoxelMaterial.h"
 #include "VoxelSharedMutex.h"
+#include "VoxelOctreeId.h"
 #include "VoxelData/IVoxelData.h"
+#include "VoxelData/VoxelDataOptimisticReads.h"
 #include "HAL/ConsoleManager.h"
+#include <atomic>
 
 class AVoxelWorld;
 class FVoxelData;
@@ -26,6 +29,9 @@ struct FVoxelObjectArchiveEntry;
 struct FVoxelDisableEditsBoxItem;
 struct FVoxelPlaceableItemLoadInfo;
 struct FVoxelUncompressedWorldSaveImpl;
+struct FVoxelMultiplayerLeafDiff;
+struct FVoxelUndoRedoFrameStats;
+class FVoxelRegionSaveLoader;
 
 template<typename T>
 struct TVoxelRange;
@@ -111,6 +117,9 @@ private:
 	// Is locked as read when a lock is done
 	// Lock as write to clear the octree, making sure no octrees are locked
 	mutable FVoxelSharedMutex MainLock;
+	// Read locks that did not lock any octree, see FVoxelDataOptimisticReads
+	// Optimistic readers do not lock MainLock either: ClearData blocks them instead
+	mutable FVoxelDataOptimisticReads OptimisticReads;
 
 public:
 	FORCEINLINE int32 Size() const
@@ -146,6 +155,8 @@ public:
 public:
 	/**
 	 * Lock the bounds
+	 * Read locks are optimistic if voxel.data.OptimisticReads is true: the octree is only locked if the bounds are being written to
+	 * Write locks first load the regions of the region save loader they intersect, see SetRegionSaveLoader
 	 * @param	LockType			Read or write lock
 	 * @param	Bounds				Bounds to lock
 	 * @param	Name				The name of the task locking these bounds, for debug
@@ -275,6 +286,87 @@ public:
 	 */
 	bool LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const FVoxelPlaceableItemLoadInfo& LoadInfo, TArray<FVoxelIntBox>* OutBoundsToUpdate = nullptr);
 
+	/**
+	 * Load the chunks of a single region of a region save. No lock required: only RegionBounds is locked
+	 * Write locks load their regions first (see Lock), so chunks are only edited once their region is loaded
+	 * If a chunk was still edited before, its edits are kept and its saved data is discarded with a warning
+	 * @param	Save						Save with the chunks of the region, see FVoxelRegionWorldSave::ReadRegion
+	 * @param	RegionBounds				Bounds of the region
+	 * @param	OutBoundsToUpdate			The modified bounds
+	 */
+	void LoadRegionFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const FVoxelIntBox& RegionBounds, TArray<FVoxelIntBox>& OutBoundsToUpdate);
+
+	// The regions of a region save that are not loaded yet. GetSave loads them all first, and write locks the ones they intersect
+	// Reads of regions not loaded yet see the generator values until the streamer loads them. ClearData forgets them
+	void SetRegionSaveLoader(const TVoxelSharedPtr<FVoxelRegionSaveLoader>& Loader);
+	TVoxelSharedPtr<FVoxelRegionSaveLoader> GetRegionSaveLoader() const;
+
+private:
+	mutable FCriticalSection RegionSaveLoaderSection;
+	TVoxelSharedPtr<FVoxelRegionSaveLoader> RegionSaveLoader;
+
+public:
+	/**
+	 * Delta saves: the chunks written since the previous save of a chain, see FVoxelDeltaSaveWriter
+	 * A chain starts with a base save, and is broken by ClearData (and thus by LoadFromSave)
+	 */
+
+	// Same as GetSave, and starts a new delta save chain from it. No lock required
+	void GetBaseSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects);
+
+	/**
+	 * Get a save of the chunks written since the previous base or delta save. No lock required: only the written chunks are locked
+	 * Chunks back to their generator values are saved without values or materials, so that they are reset when replayed
+	 * @param	OutSave						The delta save. Its placeable items are all the ones of the world
+	 * @param	OutObjects					Objects referenced by the placeable items
+	 * @param	OutBaseGuid					Guid of the base save of the chain
+	 * @param	OutEpoch					Position of this delta in the chain, starting at 1
+	 * @return false if there is no chain, in which case a base save is needed
+	 */
+	bool GetDeltaSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FGuid& OutBaseGuid, uint32& OutEpoch);
+
+	bool HasDeltaSaveChain() const
+	{
+		return DeltaSaves.bEnabled.load();
+	}
+
+private:
+	struct FDeltaSaves
+	{
+		// Checked by every write lock, without locking Section
+		std::atomic<bool> bEnabled{ false };
+
+		FCriticalSection Section;
+		FGuid BaseGuid;
+		uint32 Epoch = 0;
+		// Nodes locked for write since the last save. Can be parents with no children, that got some during the lock
+		TSet<FVoxelOctreeId> WrittenNodes;
+	};
+	mutable FDeltaSaves DeltaSaves;
+
+	void AddWrittenNodes(const TArray<FVoxelOctreeId>& Nodes) const;
+	void GetSaveImpl(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, bool bStartDeltaSaveChain);
+
+public:
+	/**
+	 * Multiplayer: requires bEnableMultiplayer, see FVoxelEditReplicationServer
+	 */
+
+	/**
+	 * Get the voxels edited since the previous call, with their values at the previous call. No lock required: only the written chunks are locked
+	 * Edits not going through Set (LoadFromSave, ClearData, items) are not included
+	 * Must not be called from several threads at once
+	 */
+	void GetMultiplayerDiffs(TArray<FVoxelMultiplayerLeafDiff>& OutDiffs);
+
+private:
+	struct FMultiplayerWrites
+	{
+		FCriticalSection Section;
+		// Nodes locked for write since the last GetMultiplayerDiffs
+		TSet<FVoxelOctreeId> WrittenNodes;
+	};
+	mutable FMultiplayerWrites MultiplayerWrites;
 
 public:
 	/**
@@ -295,6 +387,10 @@ public:
 	inline int32 GetHistoryPosition() const { return UndoRedo.HistoryPosition; }
 	// Get the max history position, ie HistoryPosition + redo frames. No lock required
 	inline int32 GetMaxHistoryPosition() const { return UndoRedo.MaxHistoryPosition; }
+	// Get the min history position: frames below it were evicted to keep all the datas under voxel.data.UndoRedo.MemoryBudget. No lock required
+	inline int32 GetMinHistoryPosition() const { return UndoRedo.MinHistoryPosition; }
+	// Get the memory used by the frames of each history position, from min to max history position. The current position has no frame. No lock required
+	void GetUndoRedoFramesStats(TArray<FVoxelUndoRedoFrameStats>& OutStats);
 
 	// Dirty state: can use that to track if the data is dirty
 	// MarkAsDirty is called on Undo, Redo, SaveFrame and ClearData
@@ -311,6 +407,7 @@ private:
 	{
 		int32 HistoryPosition = 0;
 		int32 MaxHistoryPosition = 0;
+		int32 MinHistoryPosition = 0;
 		
 		TArray<FVoxelIntBox> UndoFramesBounds;
 		TArray<FVoxelIntBox> RedoFramesBounds;
@@ -318,16 +415,26 @@ private:
 		// Used to clear redo stacks on SaveFrame without iterating the entire octree
 		// Stack: added when undoing, poping when redoing
 		TArray<TArray<FVoxelDataOctreeLeaf*>> LeavesWithRedoStackStack;
+		// Leaves whose undo stack grew in Redo. Their old frames are compressed on the next SaveFrame, to keep Redo fast
+		TSet<FVoxelDataOctreeLeaf*> LeavesToCompress;
 
 		// Each save frame is assigned a unique ID
 		uint64 FrameUniqueIdCounter = 2;
 		uint64 CurrentFrameUniqueId = 1;
 		TArray<uint64> UndoUniqueIds;
 		TArray<uint64> RedoUniqueIds;
+
+		// Order in which the undo/redo frames were saved, across all the datas. Used to evict the oldest frames first
+		TArray<uint64> UndoFramesSaveOrder;
+		TArray<uint64> RedoFramesSaveOrder;
 	};
 	FUndoRedo UndoRedo;
 	bool bIsDirty = false;
 
+	// Evicts the oldest undo frames of all the datas until the frames use less than MemoryBudget
+	static void EvictOldestUndoFrames(int64 MemoryBudget);
+	void EvictOldestUndoFrame();
+
 public:
 	/**
 	 * Placeable items
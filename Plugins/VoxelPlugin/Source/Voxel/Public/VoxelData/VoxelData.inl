@@ -52,7 +52,7 @@ void FVoxelData::CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded)
 		auto& DataHolder = Leaf.GetData<T>();
 		DataHolder.CreateData(*this, [&](T* RESTRICT DataPtr)
 		{
-			TVoxelQueryZone<T> QueryZone(Leaf.GetBounds(), DataPtr);
+			TVoxelQueryZone<T> QueryZone = TVoxelQueryZone<T>::ForDataChunk(Leaf.GetBounds(), DataPtr);
 			Leaf.GetFromGeneratorAndAssets(*Generator, QueryZone, 0);
 		});
 
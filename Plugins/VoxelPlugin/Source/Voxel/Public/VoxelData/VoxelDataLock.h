@@ -11,7 +11,7 @@ class FVoxelDataLockInfo
 public:
 	~FVoxelDataLockInfo()
 	{
-		checkf(LockedOctrees.Num() == 0, TEXT("Data not unlocked by %s!"), *Name.ToString());
+		checkf(LockedOctrees.Num() == 0 && OptimisticReadSlot == -1, TEXT("Data not unlocked by %s!"), *Name.ToString());
 	}
 	
 	FVoxelDataLockInfo(const FVoxelDataLockInfo&) = delete;
@@ -23,6 +23,7 @@ private:
 	FName Name;
 	EVoxelLockType LockType = EVoxelLockType::Read;
 	TArray<FVoxelOctreeId> LockedOctrees; // In depth first order
+	int32 OptimisticReadSlot = -1; // If valid, LockedOctrees is empty
 	
 	friend class FVoxelData;
 };
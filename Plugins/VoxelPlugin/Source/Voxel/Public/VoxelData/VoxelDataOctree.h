@@ -14,18 +14,20 @@
 #include "VoxelData/VoxelDataOctreeLeafUndoRedo.h"
 #include "VoxelData/VoxelDataOctreeLeafMultiplayer.h"
 #include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include <atomic>
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Data Octrees Memory"), STAT_VoxelDataOctreesMemory, STATGROUP_VoxelMemory, VOXEL_API);
 DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Data Octrees Count"), STAT_VoxelDataOctreesCount, STATGROUP_VoxelCounters, VOXEL_API);
 
 namespace FVoxelDataOctreeUtilities
 {
-	FORCEINLINE FVoxelCellIndex IndexFromCoordinates(int32 X, int32 Y, int32 Z)
+	// Linear index, as used by saves
+	FORCEINLINE FVoxelCellIndex LinearIndexFromCoordinates(int32 X, int32 Y, int32 Z)
 	{
 		checkVoxelSlow(0 <= X && X < DATA_CHUNK_SIZE && 0 <= Y && Y < DATA_CHUNK_SIZE && 0 <= Z && Z < DATA_CHUNK_SIZE);
 		return X + DATA_CHUNK_SIZE * Y + DATA_CHUNK_SIZE * DATA_CHUNK_SIZE * Z;
 	}
-	FORCEINLINE FIntVector CoordinatesFromIndex(FVoxelCellIndex Index)
+	FORCEINLINE FIntVector CoordinatesFromLinearIndex(FVoxelCellIndex Index)
 	{
 		return
 		{
@@ -34,6 +36,53 @@ namespace FVoxelDataOctreeUtilities
 			(Index / (DATA_CHUNK_SIZE * DATA_CHUNK_SIZE))
 		};
 	}
+
+	// Index in the data chunk buffers, see VOXEL_DATA_CHUNK_MORTON_LAYOUT
+	FORCEINLINE FVoxelCellIndex IndexFromCoordinates(int32 X, int32 Y, int32 Z)
+	{
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		checkVoxelSlow(0 <= X && X < DATA_CHUNK_SIZE && 0 <= Y && Y < DATA_CHUNK_SIZE && 0 <= Z && Z < DATA_CHUNK_SIZE);
+		return FVoxelUtilities::MortonEncode3D(X, Y, Z);
+#else
+		return LinearIndexFromCoordinates(X, Y, Z);
+#endif
+	}
+	FORCEINLINE FIntVector CoordinatesFromIndex(FVoxelCellIndex Index)
+	{
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		return FVoxelUtilities::MortonDecode3D(Index);
+#else
+		return CoordinatesFromLinearIndex(Index);
+#endif
+	}
+
+	// Reorders a data chunk buffer from linear order to the buffer layout, and back. No-ops with the linear layout
+	template<typename T>
+	void LinearToChunkLayout(T* RESTRICT Data)
+	{
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		TVoxelStaticArray<T, VOXELS_PER_DATA_CHUNK> Copy;
+		FMemory::Memcpy(Copy.GetData(), Data, VOXELS_PER_DATA_CHUNK * sizeof(T));
+		for (FVoxelCellIndex Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			const FIntVector Position = CoordinatesFromLinearIndex(Index);
+			Data[IndexFromCoordinates(Position.X, Position.Y, Position.Z)] = Copy[Index];
+		}
+#endif
+	}
+	template<typename T>
+	void ChunkLayoutToLinear(T* RESTRICT Data)
+	{
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		TVoxelStaticArray<T, VOXELS_PER_DATA_CHUNK> Copy;
+		FMemory::Memcpy(Copy.GetData(), Data, VOXELS_PER_DATA_CHUNK * sizeof(T));
+		for (FVoxelCellIndex Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			const FIntVector Position = CoordinatesFromLinearIndex(Index);
+			Data[Index] = Copy[IndexFromCoordinates(Position.X, Position.Y, Position.Z)];
+		}
+#endif
+	}
 	FORCEINLINE FVoxelCellIndex IndexFromGlobalCoordinates(const FIntVector& Min, int32 X, int32 Y, int32 Z)
 	{
 		X -= Min.X;
@@ -76,6 +125,12 @@ public:
 	void GetFromGeneratorAndAssets(const FVoxelGeneratorInstance& Generator, TVoxelQueryZone<T>& QueryZone, int32 LOD) const;
 
 public:
+	// True if the node is locked for write. Used by optimistic reads instead of locking Mutex
+	FORCEINLINE bool IsBeingWritten() const
+	{
+		return Version.load() & 1;
+	}
+
 #if DO_THREADSAFE_CHECKS
 	bool IsLockedForRead() const { return Mutex.IsLockedForRead() || (Parent && Parent->IsLockedForRead()); }
 	bool IsLockedForWrite() const { return Mutex.IsLockedForWrite() || (Parent && Parent->IsLockedForWrite()); }
@@ -89,6 +144,8 @@ private:
 	// Always valid on a node with no children
 	TUniquePtr<FVoxelPlaceableItemHolder> ItemHolder = MakeUnique<FVoxelPlaceableItemHolder>();
 	FVoxelSharedMutex Mutex;
+	// Incremented when locking and unlocking for write: odd while locked for write
+	std::atomic<uint32> Version{ 0 };
 #if DO_THREADSAFE_CHECKS
 	FVoxelDataOctreeBase* Parent = nullptr;
 #endif
@@ -132,7 +189,7 @@ public:
 		{
 			DataHolder.CreateData(Data, [&](T* RESTRICT DataPtr)
 			{
-				TVoxelQueryZone<T> QueryZone(GetBounds(), DataPtr);
+				TVoxelQueryZone<T> QueryZone = TVoxelQueryZone<T>::ForDataChunk(GetBounds(), DataPtr);
 				GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
 			});
 		}
@@ -230,7 +287,7 @@ struct FVoxelDataOctreeSetter
 				if (OldValue != Ref)
 				{
 					DataHolder.SetIsDirty(true, Data);
-					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<T>(Index);
+					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<T>(Index, OldValue);
 					if (EnableUndoRedo) Leaf.UndoRedo->SavePreviousValue(Index, OldValue);
 				}
 			});
@@ -285,13 +342,13 @@ struct FVoxelDataOctreeSetter
 				if (OldValueA != RefA)
 				{
 					DataHolderA.SetIsDirty(true, Data);
-					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<TA>(Index);
+					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<TA>(Index, OldValueA);
 					if (EnableUndoRedo) Leaf.UndoRedo->SavePreviousValue(Index, OldValueA);
 				}
 				if (OldValueB != RefB)
 				{
 					DataHolderB.SetIsDirty(true, Data);
-					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<TB>(Index);
+					if (EnableMultiplayer) Leaf.Multiplayer->MarkIndexDirty<TB>(Index, OldValueB);
 					if (EnableUndoRedo) Leaf.UndoRedo->SavePreviousValue(Index, OldValueB);
 				}
 			});
@@ -0,0 +1,60 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelValue.h"
+#include "VoxelMaterial.h"
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Pooled Leaf Buffers Memory"), STAT_VoxelDataOctreePooledBuffersMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+// Size classes of the buffers owned by TVoxelDataOctreeLeafData
+enum class EVoxelDataOctreeLeafBuffer : uint8
+{
+	Values,
+	Materials,
+	MaterialChannel,
+	Num
+};
+
+/**
+ * Pool for the fixed-size buffers of TVoxelDataOctreeLeafData
+ * Leaves are constantly allocated & freed when editing or when the cache is cleared: instead of going through the global allocator every time,
+ * freed buffers are kept in a small per-thread cache, then in a global lock-free free list per size class
+ *
+ * Idle buffers are reported in STAT_VoxelDataOctreePooledBuffersMemory, never in the dirty/cached leaf stats
+ * The global free lists are capped by voxel.data.LeafPool.MaxMemory and can be emptied with Trim (also called on memory trim)
+ */
+class VOXEL_API FVoxelDataOctreeLeafAllocator
+{
+public:
+	static void* Allocate(EVoxelDataOctreeLeafBuffer Buffer);
+	static void Free(EVoxelDataOctreeLeafBuffer Buffer, void* Ptr);
+
+	template<typename T>
+	FORCEINLINE static T* Allocate(EVoxelDataOctreeLeafBuffer Buffer)
+	{
+		checkVoxelSlow(GetBufferSize(Buffer) % sizeof(T) == 0);
+		return static_cast<T*>(Allocate(Buffer));
+	}
+
+	FORCEINLINE static int32 GetBufferSize(EVoxelDataOctreeLeafBuffer Buffer)
+	{
+		switch (Buffer)
+		{
+		default: checkVoxelSlow(false);
+		case EVoxelDataOctreeLeafBuffer::Values: return VOXELS_PER_DATA_CHUNK * sizeof(FVoxelValue);
+		case EVoxelDataOctreeLeafBuffer::Materials: return VOXELS_PER_DATA_CHUNK * sizeof(FVoxelMaterial);
+		case EVoxelDataOctreeLeafBuffer::MaterialChannel: return VOXELS_PER_DATA_CHUNK * sizeof(uint8);
+		}
+	}
+
+public:
+	// Frees pooled buffers until at most MaxPooledMemory bytes are left in the global free lists
+	// Buffers in the per-thread caches are not affected: they are bounded and flushed when their thread exits
+	static void Trim(int64 MaxPooledMemory = 0);
+
+	// Memory held by the pool, including the per-thread caches
+	static int64 GetPooledMemory();
+};
@@ -6,6 +6,8 @@
 #include "VoxelValue.h"
 #include "VoxelMaterial.h"
 #include "VoxelData/IVoxelData.h"
+#include "VoxelData/VoxelDataOctreeLeafAllocator.h"
+#include "VoxelData/VoxelDataOctreeLeafPalette.h"
 #include "VoxelUtilities/VoxelMiscUtilities.h"
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Dirty Values Memory"), STAT_VoxelDataOctreeDirtyValuesMemory, STATGROUP_VoxelMemory, VOXEL_API);
@@ -72,12 +74,16 @@ template<>
 class TVoxelDataOctreeLeafData<FVoxelValue>
 {
 	FVoxelValue* RESTRICT DataPtr = nullptr;
+	// Set by Compress when the data has few distinct values, see TVoxelDataOctreeLeafPalette
+	uint8* RESTRICT PaletteDataPtr = nullptr;
 	FVoxelValue SingleValue;
 	bool bIsSingleValue = false;
 	bool bDirty = false;
 
 	static constexpr int32 MemorySize = VOXELS_PER_DATA_CHUNK * sizeof(FVoxelValue);
 
+	using FPalette = TVoxelDataOctreeLeafPalette<FVoxelValue>;
+
 	friend class FVoxelSaveBuilder;
 	friend class FVoxelSaveLoader;
 	
@@ -85,7 +91,7 @@ public:
 	TVoxelDataOctreeLeafData() = default;
 	~TVoxelDataOctreeLeafData()
 	{
-		if (!ensureVoxelSlow(!DataPtr))
+		if (!ensureVoxelSlow(!DataPtr && !PaletteDataPtr))
 		{
 			ClearData(IVoxelDataOctreeMemory());
 		}
@@ -117,6 +123,12 @@ public:
 			TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Decrease(MemorySize, bOldDirty, Memory);
 			TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Increase(MemorySize, bNewDirty, Memory);
 		}
+		if (PaletteDataPtr)
+		{
+			const int32 PaletteMemorySize = FPalette::GetAllocationSize(PaletteDataPtr);
+			TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Decrease(PaletteMemorySize, bOldDirty, Memory);
+			TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Increase(PaletteMemorySize, bNewDirty, Memory);
+		}
 	}
 
 public:
@@ -151,6 +163,11 @@ public:
 				Allocate(Memory);
 				FMemory::Memcpy(DataPtr, Source.DataPtr, MemorySize);
 			}
+			else if (Source.PaletteDataPtr)
+			{
+				PaletteDataPtr = FPalette::Copy(Source.PaletteDataPtr);
+				TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Increase(FPalette::GetAllocationSize(PaletteDataPtr), bDirty, Memory);
+			}
 		}
 		CheckState();
 	}
@@ -163,6 +180,10 @@ public:
 		{
 			Deallocate(Memory);
 		}
+		if (PaletteDataPtr)
+		{
+			Palette_Deallocate(Memory);
+		}
 		bIsSingleValue = false;
 		checkVoxelSlow(!HasData());
 		CheckState();
@@ -172,11 +193,15 @@ public:
 	// Used to determine if it's worth compressing or clearing the cache
 	FORCEINLINE bool HasAllocation() const
 	{
-		return DataPtr != nullptr;
+		return DataPtr || PaletteDataPtr;
 	}
 	FORCEINLINE bool HasData() const
 	{
-		return DataPtr || bIsSingleValue;
+		return DataPtr || PaletteDataPtr || bIsSingleValue;
+	}
+	FORCEINLINE bool IsPaletteCompressed() const
+	{
+		return PaletteDataPtr != nullptr;
 	}
 	
 public:
@@ -186,6 +211,10 @@ public:
 		{
 			TryCompressToSingleValue(Memory);
 		}
+		if (DataPtr && FVoxelDataOctreeLeafPaletteSettings::IsEnabled())
+		{
+			TryCompressToPalette(Memory);
+		}
 	}
 
 public:
@@ -197,11 +226,15 @@ public:
 		{
 			return SingleValue;
 		}
-		else
+		else if (DataPtr)
 		{
-			checkVoxelSlow(DataPtr);
 			return DataPtr[Index];
 		}
+		else
+		{
+			checkVoxelSlow(PaletteDataPtr);
+			return FPalette::Get(PaletteDataPtr, Index);
+		}
 	}
 
 public:
@@ -213,6 +246,10 @@ public:
 		{
 			ExpandSingleValue(Memory);
 		}
+		else if (PaletteDataPtr)
+		{
+			ExpandPalette(Memory);
+		}
 		CheckState();
 	}
 	FORCEINLINE FVoxelValue& GetRef(int32 Index)
@@ -234,10 +271,15 @@ public:
 				DestPtr[Index] = SingleValue;
 			}
 		}
-		else
+		else if (DataPtr)
 		{
 			FMemory::Memcpy(DestPtr, DataPtr, MemorySize);
 		}
+		else
+		{
+			checkVoxelSlow(PaletteDataPtr);
+			FPalette::Decode(PaletteDataPtr, DestPtr);
+		}
 	}
 
 public:
@@ -254,7 +296,7 @@ public:
 	void SetSingleValue(FVoxelValue InSingleValue)
 	{
 		CheckState();
-		check(!DataPtr && !bIsSingleValue);
+		check(!DataPtr && !PaletteDataPtr && !bIsSingleValue);
 		bIsSingleValue = true;
 		SingleValue = InSingleValue;
 		CheckState();
@@ -294,11 +336,40 @@ public:
 		
 		CheckState();
 	}
+	void TryCompressToPalette(const IVoxelDataOctreeMemory& Memory)
+	{
+		CheckState();
+		check(DataPtr);
+
+		FPalette::FEncoder Encoder;
+		if (!FPalette::Analyze([&](int32 Index) { return DataPtr[Index]; }, Encoder))
+		{
+			return;
+		}
+
+		PaletteDataPtr = FPalette::Allocate(Encoder);
+		TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Increase(FPalette::GetAllocationSize(PaletteDataPtr), bDirty, Memory);
+
+		Deallocate(Memory);
+
+		CheckState();
+	}
+	void ExpandPalette(const IVoxelDataOctreeMemory& Memory)
+	{
+		CheckState();
+		check(PaletteDataPtr);
+
+		Allocate(Memory);
+		FPalette::Decode(PaletteDataPtr, DataPtr);
+		Palette_Deallocate(Memory);
+
+		CheckState();
+	}
 	
 private:
 	FORCEINLINE void CheckState() const
 	{
-		checkVoxelSlow(!(DataPtr && bIsSingleValue));
+		checkVoxelSlow(int32(DataPtr != nullptr) + int32(PaletteDataPtr != nullptr) + int32(bIsSingleValue) <= 1);
 		checkVoxelSlow(!bDirty || HasData());
 	}
 	FORCEINLINE static void CheckBounds(int32 Index)
@@ -312,7 +383,7 @@ private:
 		VOXEL_SLOW_FUNCTION_COUNTER();
 
 		check(!DataPtr && !bIsSingleValue);
-		DataPtr = static_cast<FVoxelValue*>(FMemory::Malloc(MemorySize));
+		DataPtr = FVoxelDataOctreeLeafAllocator::Allocate<FVoxelValue>(EVoxelDataOctreeLeafBuffer::Values);
 		
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Increase(MemorySize, bDirty, Memory);
 	}
@@ -321,11 +392,20 @@ private:
 		VOXEL_SLOW_FUNCTION_COUNTER();
 
 		check(DataPtr);
-		FMemory::Free(DataPtr);
+		FVoxelDataOctreeLeafAllocator::Free(EVoxelDataOctreeLeafBuffer::Values, DataPtr);
 		DataPtr = nullptr;
 		
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Decrease(MemorySize, bDirty, Memory);
 	}
+	void Palette_Deallocate(const IVoxelDataOctreeMemory& Memory)
+	{
+		check(PaletteDataPtr);
+		const int32 PaletteMemorySize = FPalette::GetAllocationSize(PaletteDataPtr);
+		FPalette::Free(PaletteDataPtr);
+		PaletteDataPtr = nullptr;
+
+		TVoxelDataOctreeLeafMemoryUsage<FVoxelValue>::Decrease(PaletteMemorySize, bDirty, Memory);
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -346,6 +426,10 @@ class TVoxelDataOctreeLeafData<FVoxelMaterial>
 	// Data in Channels is assumed constant: compression won't try to compress it again
 	bool bUseChannels = false;
 	bool bDirty = false;
+	// Bit I is set if Channels_DataPtr[I] is palette encoded, see TVoxelDataOctreeLeafPalette
+	uint32 Channels_PaletteMask = 0;
+
+	using FChannelPalette = TVoxelDataOctreeLeafPalette<uint8>;
 
 	friend class FVoxelSaveBuilder;
 	friend class FVoxelSaveLoader;
@@ -389,12 +473,13 @@ public:
 		// without including cached memory usage into dirty memory usage
 		if (bUseChannels)
 		{
-			for (auto& DataPtr : Channels_DataPtr)
+			for (int32 Channel = 0; Channel < NumChannels; Channel++)
 			{
-				if (DataPtr)
+				if (Channels_DataPtr[Channel])
 				{
-					TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(Channels_MemorySize, bOldDirty, Memory);
-					TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(Channels_MemorySize, bNewDirty, Memory);
+					const int32 ChannelMemorySize = Channels_GetMemorySize(Channel);
+					TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(ChannelMemorySize, bOldDirty, Memory);
+					TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(ChannelMemorySize, bNewDirty, Memory);
 				}
 			}
 		}
@@ -430,14 +515,26 @@ public:
 		bUseChannels = Source.bUseChannels;
 		if (Source.bUseChannels)
 		{
+			Channels_SingleValue = Source.Channels_SingleValue;
+			Channels_PaletteMask = Source.Channels_PaletteMask;
+			
 			for (int32 Channel = 0; Channel < NumChannels; Channel++)
 			{
 				auto* SourceDataPtr = Source.Channels_DataPtr[Channel];
-				if (SourceDataPtr)
+				if (!SourceDataPtr)
+				{
+					continue;
+				}
+				
+				auto*& DataPtr = Channels_DataPtr[Channel];
+				if (Channels_PaletteMask & (1 << Channel))
+				{
+					DataPtr = FChannelPalette::Copy(SourceDataPtr);
+					TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(FChannelPalette::GetAllocationSize(DataPtr), bDirty, Memory);
+				}
+				else
 				{
-					auto*& DataPtr = Channels_DataPtr[Channel];
 					Channels_Allocate(DataPtr, Memory);
-
 					FMemory::Memcpy(DataPtr, SourceDataPtr, Channels_MemorySize);
 				}
 			}
@@ -446,6 +543,7 @@ public:
 		{
 			if (Source.Main_DataPtr)
 			{
+				Main_Allocate(Memory);
 				FMemory::Memcpy(Main_DataPtr, Source.Main_DataPtr, Main_MemorySize);
 			}
 		}
@@ -458,13 +556,7 @@ public:
 		SetIsDirty(false, Memory);
 		if (bUseChannels)
 		{
-			for (auto& DataPtr : Channels_DataPtr)
-			{
-				if (DataPtr)
-				{
-					Channels_Deallocate(DataPtr, Memory);
-				}
-			}
+			Channels_DeallocateAll(Memory);
 		}
 		else
 		{
@@ -537,12 +629,33 @@ public:
 		}
 		checkVoxelSlow(DoNotCompressChannel != DoNotCompressAnyChannel);
 
+		const bool bUsePalette = FVoxelDataOctreeLeafPaletteSettings::IsEnabled();
+		TUniquePtr<FChannelPalette::FEncoder> Encoder;
+		
 		// Create channels
 		for (int32 Channel = 0; Channel < NumChannels; Channel++)
 		{
 			if (DoNotCompressChannel & (1 << Channel))
 			{
 				uint8* RESTRICT& DataPtr = Channels_DataPtr[Channel];
+
+				if (bUsePalette)
+				{
+					if (!Encoder)
+					{
+						Encoder = MakeUnique<FChannelPalette::FEncoder>();
+					}
+					
+					// Typically the material index channels: a handful of distinct values
+					if (FChannelPalette::Analyze([&](int32 Index) { return Main_DataPtr[Index].GetRaw(Channel); }, *Encoder))
+					{
+						DataPtr = FChannelPalette::Allocate(*Encoder);
+						Channels_PaletteMask |= 1 << Channel;
+						TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(FChannelPalette::GetAllocationSize(DataPtr), bDirty, Memory);
+						continue;
+					}
+				}
+				
 				Channels_Allocate(DataPtr, Memory);
 
 				// Copy data from main
@@ -600,13 +713,7 @@ public:
 			}
 
 			// Free channels
-			for (auto& DataPtr : Channels_DataPtr)
-			{
-				if (DataPtr)
-				{
-					Channels_Deallocate(DataPtr, Memory);
-				}
-			}
+			Channels_DeallocateAll(Memory);
 			bUseChannels = false;
 		}
 		checkVoxelSlow(!bUseChannels);
@@ -671,7 +778,14 @@ private:
 		{
 			if (const uint8* RESTRICT const DataPtr = Channels_DataPtr[Channel])
 			{
-				Material.GetRaw(Channel) = DataPtr[Index];
+				if (Channels_PaletteMask & (1 << Channel))
+				{
+					Material.GetRaw(Channel) = FChannelPalette::Get(DataPtr, Index);
+				}
+				else
+				{
+					Material.GetRaw(Channel) = DataPtr[Index];
+				}
 			}
 			else
 			{
@@ -690,7 +804,7 @@ private:
 		VOXEL_SLOW_FUNCTION_COUNTER();
 		
 		check(!Main_DataPtr);
-		Main_DataPtr = static_cast<FVoxelMaterial*>(FMemory::Malloc(Main_MemorySize));
+		Main_DataPtr = FVoxelDataOctreeLeafAllocator::Allocate<FVoxelMaterial>(EVoxelDataOctreeLeafBuffer::Materials);
 
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(Main_MemorySize, bDirty, Memory);
 	}
@@ -699,7 +813,7 @@ private:
 		VOXEL_SLOW_FUNCTION_COUNTER();
 
 		check(Main_DataPtr);
-		FMemory::Free(Main_DataPtr);
+		FVoxelDataOctreeLeafAllocator::Free(EVoxelDataOctreeLeafBuffer::Materials, Main_DataPtr);
 		Main_DataPtr = nullptr;
 
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(Main_MemorySize, bDirty, Memory);
@@ -710,18 +824,60 @@ private:
 		VOXEL_SLOW_FUNCTION_COUNTER();
 
 		check(!DataPtr);
-		DataPtr = static_cast<uint8*>(FMemory::Malloc(Channels_MemorySize));
+		DataPtr = FVoxelDataOctreeLeafAllocator::Allocate<uint8>(EVoxelDataOctreeLeafBuffer::MaterialChannel);
 
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(Channels_MemorySize, bDirty, Memory);
 	}
-	void Channels_Deallocate(uint8* RESTRICT& DataPtr, const IVoxelDataOctreeMemory& Memory) const
+	void Channels_Deallocate(int32 Channel, const IVoxelDataOctreeMemory& Memory)
 	{
 		VOXEL_SLOW_FUNCTION_COUNTER();
 
+		uint8* RESTRICT& DataPtr = Channels_DataPtr[Channel];
 		check(DataPtr);
-		FMemory::Free(DataPtr);
+
+		const int32 ChannelMemorySize = Channels_GetMemorySize(Channel);
+		if (Channels_PaletteMask & (1 << Channel))
+		{
+			FChannelPalette::Free(DataPtr);
+			Channels_PaletteMask &= ~(1 << Channel);
+		}
+		else
+		{
+			FVoxelDataOctreeLeafAllocator::Free(EVoxelDataOctreeLeafBuffer::MaterialChannel, DataPtr);
+		}
 		DataPtr = nullptr;
 
-		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(Channels_MemorySize, bDirty, Memory);
+		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(ChannelMemorySize, bDirty, Memory);
+	}
+	void Channels_DeallocateAll(const IVoxelDataOctreeMemory& Memory)
+	{
+		for (int32 Channel = 0; Channel < NumChannels; Channel++)
+		{
+			if (Channels_DataPtr[Channel])
+			{
+				Channels_Deallocate(Channel, Memory);
+			}
+		}
+		checkVoxelSlow(Channels_PaletteMask == 0);
+	}
+	
+	FORCEINLINE int32 Channels_GetMemorySize(int32 Channel) const
+	{
+		checkVoxelSlow(Channels_DataPtr[Channel]);
+		return Channels_PaletteMask & (1 << Channel) ? FChannelPalette::GetAllocationSize(Channels_DataPtr[Channel]) : Channels_MemorySize;
+	}
+	// Used by saves
+	void Channels_CopyTo(int32 Channel, uint8* RESTRICT DestPtr) const
+	{
+		const uint8* RESTRICT DataPtr = Channels_DataPtr[Channel];
+		checkVoxelSlow(DataPtr);
+		if (Channels_PaletteMask & (1 << Channel))
+		{
+			FChannelPalette::Decode(DataPtr, DestPtr);
+		}
+		else
+		{
+			FMemory::Memcpy(DestPtr, DataPtr, Channels_MemorySize);
+		}
 	}	
 };
\ No newline at end of file
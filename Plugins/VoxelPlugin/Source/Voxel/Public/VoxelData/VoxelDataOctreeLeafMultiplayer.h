@@ -6,6 +6,7 @@
 #include "VoxelValue.h"
 #include "VoxelMaterial.h"
 #include "VoxelDiff.h"
+#include "VoxelContainers/VoxelStaticArray.h"
 #include "VoxelUtilities/VoxelMiscUtilities.h"
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Multiplayer Memory"), STAT_VoxelMultiplayerMemory, STATGROUP_VoxelMemory, VOXEL_API);
@@ -31,38 +32,114 @@ struct TEmptyArray
 	}
 };
 
+// The voxels of a leaf edited since the previous sync, sorted by index, with their values at the previous sync and now
+template<typename T>
+struct TVoxelMultiplayerDiff
+{
+	TArray<FVoxelCellIndex> Indices;
+	TArray<T> OldValues;
+	TArray<T> NewValues;
+
+	int32 Num() const
+	{
+		return Indices.Num();
+	}
+};
+
+struct FVoxelMultiplayerLeafDiff
+{
+	// Min of the leaf
+	FIntVector Position;
+	TVoxelMultiplayerDiff<FVoxelValue> Values;
+	TVoxelMultiplayerDiff<FVoxelMaterial> Materials;
+};
+
 class FVoxelDataOctreeLeafMultiplayer
 {
 public:
-	struct FDirty
+	FVoxelDataOctreeLeafMultiplayer()
 	{
-		// TODO bit arrays would be better
-		TSet<FVoxelCellIndex> Values;
-		TSet<FVoxelCellIndex> Materials;
-	};
-	FDirty Dirty;
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelMultiplayerMemory, sizeof(FVoxelDataOctreeLeafMultiplayer));
+	}
+	~FVoxelDataOctreeLeafMultiplayer()
+	{
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelMultiplayerMemory, sizeof(FVoxelDataOctreeLeafMultiplayer) + AllocatedSize);
+	}
 
 public:
+	// Only the first change of an index since the last sync is recorded, as that's the value the clients have
 	template<typename T>
-	FORCEINLINE void MarkIndexDirty(FVoxelCellIndex Index)
+	FORCEINLINE void MarkIndexDirty(FVoxelCellIndex Index, T OldValue)
 	{
-		FVoxelUtilities::TValuesMaterialsSelector<T>::Get(Dirty).Add(Index);
+		auto& DirtyT = FVoxelUtilities::TValuesMaterialsSelector<T>::Get(Dirty);
+		if (!DirtyT.Test(Index))
+		{
+			DirtyT.Set(Index);
+
+			auto& OldValuesT = FVoxelUtilities::TValuesMaterialsSelector<T>::Get(OldValues);
+			const bool bReallocates = OldValuesT.Num() == OldValuesT.Max();
+			OldValuesT.Emplace(Index, OldValue);
+			if (bReallocates)
+			{
+				UpdateStats();
+			}
+		}
 	}
-	
-	template<typename T, typename TData>
-	void AddToDiffQueueAndReset(const TData& Data, TArray<TVoxelDiff<T>>& OutDiffQueue)
+
+	// GetValue: T(FVoxelCellIndex). Indices that were changed back to their old value are skipped
+	template<typename T, typename TGetValue>
+	void AddToDiffAndReset(TGetValue GetValue, TVoxelMultiplayerDiff<T>& OutDiff)
 	{
 		auto& DirtyT = FVoxelUtilities::TValuesMaterialsSelector<T>::Get(Dirty);
-		for (int32 Index : DirtyT)
+		auto& OldValuesT = FVoxelUtilities::TValuesMaterialsSelector<T>::Get(OldValues);
+
+		OldValuesT.Sort([](const TVoxelDiff<T>& A, const TVoxelDiff<T>& B) { return A.Index < B.Index; });
+
+		OutDiff.Indices.Reserve(OutDiff.Indices.Num() + OldValuesT.Num());
+		OutDiff.OldValues.Reserve(OutDiff.OldValues.Num() + OldValuesT.Num());
+		OutDiff.NewValues.Reserve(OutDiff.NewValues.Num() + OldValuesT.Num());
+		for (const TVoxelDiff<T>& OldValue : OldValuesT)
 		{
-			OutDiffQueue.Emplace(Index, Data.Get(Index));
+			DirtyT.Clear(OldValue.Index);
+
+			const T NewValue = GetValue(OldValue.Index);
+			if (NewValue != OldValue.Value)
+			{
+				OutDiff.Indices.Add(OldValue.Index);
+				OutDiff.OldValues.Add(OldValue.Value);
+				OutDiff.NewValues.Add(NewValue);
+			}
 		}
-		DirtyT.Empty();
+		// Free the memory: most leaves are not edited again before the next sync
+		OldValuesT.Empty();
+		UpdateStats();
 	}
 
 	template<typename T>
-	bool IsNetworkDirty()
+	bool IsNetworkDirty() const
 	{
-		return FVoxelUtilities::TValuesMaterialsSelector<T>::Get(Dirty).Num() > 0;
+		return FVoxelUtilities::TValuesMaterialsSelector<T>::Get(OldValues).Num() > 0;
 	}
-};
\ No newline at end of file
+
+private:
+	struct FDirty
+	{
+		TVoxelStaticBitArray<VOXELS_PER_DATA_CHUNK> Values = ForceInit;
+		TVoxelStaticBitArray<VOXELS_PER_DATA_CHUNK> Materials = ForceInit;
+	};
+	struct FOldValues
+	{
+		TArray<TVoxelDiff<FVoxelValue>> Values;
+		TArray<TVoxelDiff<FVoxelMaterial>> Materials;
+	};
+	FDirty Dirty;
+	FOldValues OldValues;
+	uint32 AllocatedSize = 0;
+
+	void UpdateStats()
+	{
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelMultiplayerMemory, AllocatedSize);
+		AllocatedSize = OldValues.Values.GetAllocatedSize() + OldValues.Materials.GetAllocatedSize();
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelMultiplayerMemory, AllocatedSize);
+	}
+};
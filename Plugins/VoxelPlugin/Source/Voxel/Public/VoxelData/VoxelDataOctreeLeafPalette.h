@@ -0,0 +1,223 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Voxel Palette Saved Memory"), STAT_VoxelDataOctreePaletteSavedMemory, STATGROUP_VoxelMemory, VOXEL_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Palette Buffers Count"), STAT_VoxelDataOctreePaletteBuffersCount, STATGROUP_VoxelCounters, VOXEL_API);
+
+struct VOXEL_API FVoxelDataOctreeLeafPaletteSettings
+{
+	// voxel.data.UsePaletteCompression
+	static bool IsEnabled();
+};
+
+/**
+ * Palette encoding of a leaf buffer: up to 256 distinct values, and 1/2/4/8 bits per voxel to index them
+ * The encoded data is a single allocation: FHeader, then T Palette[PaletteSize], then the packed indices
+ * Indices never straddle a byte, so decoding a voxel is a shift and a mask
+ */
+template<typename T>
+struct TVoxelDataOctreeLeafPalette
+{
+	static_assert(sizeof(T) <= sizeof(uint32) && std::is_trivially_copyable_v<T>, "");
+
+	static constexpr int32 MaxPaletteSize = 256;
+	static constexpr int32 UncompressedSize = VOXELS_PER_DATA_CHUNK * sizeof(T);
+
+	struct FHeader
+	{
+		uint8 NumBits = 0;
+		uint8 Padding = 0;
+		uint16 PaletteSize = 0;
+	};
+
+	// Result of Analyze, used to write the encoded data
+	struct FEncoder
+	{
+		int32 NumBits = 0;
+		int32 PaletteSize = 0;
+		T Palette[MaxPaletteSize];
+		uint8 Indices[VOXELS_PER_DATA_CHUNK];
+	};
+
+	FORCEINLINE static int32 GetIndicesOffset(int32 PaletteSize)
+	{
+		return Align(sizeof(FHeader) + PaletteSize * sizeof(T), 8);
+	}
+	FORCEINLINE static int32 GetAllocationSize(int32 NumBits, int32 PaletteSize)
+	{
+		return GetIndicesOffset(PaletteSize) + VOXELS_PER_DATA_CHUNK * NumBits / 8;
+	}
+	FORCEINLINE static int32 GetAllocationSize(const uint8* RESTRICT Data)
+	{
+		const FHeader& Header = *reinterpret_cast<const FHeader*>(Data);
+		return GetAllocationSize(Header.NumBits, Header.PaletteSize);
+	}
+
+public:
+	FORCEINLINE static T Get(const uint8* RESTRICT Data, int32 Index)
+	{
+		checkVoxelSlow(0 <= Index && Index < VOXELS_PER_DATA_CHUNK);
+
+		const FHeader& Header = *reinterpret_cast<const FHeader*>(Data);
+		const T* RESTRICT Palette = reinterpret_cast<const T*>(Data + sizeof(FHeader));
+		const uint8* RESTRICT Indices = Data + GetIndicesOffset(Header.PaletteSize);
+
+		const int32 Bit = Index * Header.NumBits;
+		const int32 PaletteIndex = (Indices[Bit >> 3] >> (Bit & 7)) & ((1 << Header.NumBits) - 1);
+		checkVoxelSlow(PaletteIndex < Header.PaletteSize);
+		return Palette[PaletteIndex];
+	}
+
+	static void Decode(const uint8* RESTRICT Data, T* RESTRICT OutData)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+
+		const FHeader& Header = *reinterpret_cast<const FHeader*>(Data);
+		const T* RESTRICT Palette = reinterpret_cast<const T*>(Data + sizeof(FHeader));
+		const uint8* RESTRICT Indices = Data + GetIndicesOffset(Header.PaletteSize);
+
+		const int32 NumBits = Header.NumBits;
+		const int32 ValuesPerByte = 8 / NumBits;
+		const int32 Mask = (1 << NumBits) - 1;
+		for (int32 ByteIndex = 0; ByteIndex < VOXELS_PER_DATA_CHUNK / ValuesPerByte; ByteIndex++)
+		{
+			const int32 Byte = Indices[ByteIndex];
+			for (int32 SubIndex = 0; SubIndex < ValuesPerByte; SubIndex++)
+			{
+				*OutData++ = Palette[(Byte >> (SubIndex * NumBits)) & Mask];
+			}
+		}
+	}
+
+public:
+	// Returns false if there are too many distinct values, or if the palette would not save memory
+	// Getter(Index) returns the value of the voxel Index, so that a single material channel can be encoded
+	template<typename TGetter>
+	static bool Analyze(TGetter Getter, FEncoder& Encoder)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+
+		// Open addressing, stores palette indices + 1
+		constexpr int32 HashSize = 2 * MaxPaletteSize;
+		uint16 HashTable[HashSize];
+		FMemory::Memzero(HashTable);
+
+		int32 PaletteSize = 0;
+		T LastValue = Getter(0);
+		int32 LastIndex = -1;
+
+		for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			const T Value = Getter(Index);
+			if (LastIndex != -1 && Value == LastValue)
+			{
+				// Runs are very common
+				Encoder.Indices[Index] = LastIndex;
+				continue;
+			}
+
+			uint32 Key = 0;
+			FMemory::Memcpy(&Key, &Value, sizeof(T));
+
+			uint32 Slot = (Key * 2654435761u) >> 23;
+			while (true)
+			{
+				Slot &= HashSize - 1;
+				const int32 Entry = HashTable[Slot];
+				if (Entry == 0)
+				{
+					if (PaletteSize == MaxPaletteSize)
+					{
+						return false;
+					}
+					Encoder.Palette[PaletteSize] = Value;
+					HashTable[Slot] = ++PaletteSize;
+					LastIndex = PaletteSize - 1;
+					break;
+				}
+				if (Encoder.Palette[Entry - 1] == Value)
+				{
+					LastIndex = Entry - 1;
+					break;
+				}
+				Slot++;
+			}
+
+			LastValue = Value;
+			Encoder.Indices[Index] = LastIndex;
+		}
+
+		Encoder.PaletteSize = PaletteSize;
+		Encoder.NumBits =
+			PaletteSize <= 2 ? 1 :
+			PaletteSize <= 4 ? 2 :
+			PaletteSize <= 16 ? 4 :
+			8;
+
+		return GetAllocationSize(Encoder.NumBits, PaletteSize) < UncompressedSize;
+	}
+
+	// Data must be GetAllocationSize(Encoder.NumBits, Encoder.PaletteSize) bytes
+	static void Write(const FEncoder& Encoder, uint8* RESTRICT Data)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+
+		FHeader& Header = *reinterpret_cast<FHeader*>(Data);
+		Header = {};
+		Header.NumBits = Encoder.NumBits;
+		Header.PaletteSize = Encoder.PaletteSize;
+
+		FMemory::Memcpy(Data + sizeof(FHeader), Encoder.Palette, Encoder.PaletteSize * sizeof(T));
+
+		uint8* RESTRICT Indices = Data + GetIndicesOffset(Encoder.PaletteSize);
+
+		const int32 NumBits = Encoder.NumBits;
+		const int32 ValuesPerByte = 8 / NumBits;
+		for (int32 ByteIndex = 0; ByteIndex < VOXELS_PER_DATA_CHUNK / ValuesPerByte; ByteIndex++)
+		{
+			int32 Byte = 0;
+			for (int32 SubIndex = 0; SubIndex < ValuesPerByte; SubIndex++)
+			{
+				Byte |= Encoder.Indices[ByteIndex * ValuesPerByte + SubIndex] << (SubIndex * NumBits);
+			}
+			Indices[ByteIndex] = Byte;
+		}
+	}
+
+public:
+	static uint8* Allocate(const FEncoder& Encoder)
+	{
+		const int32 Size = GetAllocationSize(Encoder.NumBits, Encoder.PaletteSize);
+		uint8* Data = static_cast<uint8*>(FMemory::Malloc(Size));
+		Write(Encoder, Data);
+		OnAllocated(Size);
+		return Data;
+	}
+	static uint8* Copy(const uint8* RESTRICT Source)
+	{
+		const int32 Size = GetAllocationSize(Source);
+		uint8* Data = static_cast<uint8*>(FMemory::Malloc(Size));
+		FMemory::Memcpy(Data, Source, Size);
+		OnAllocated(Size);
+		return Data;
+	}
+	static void Free(uint8* Data)
+	{
+		checkVoxelSlow(Data);
+		const int32 Size = GetAllocationSize(Data);
+		DEC_MEMORY_STAT_BY(STAT_VoxelDataOctreePaletteSavedMemory, UncompressedSize - Size);
+		DEC_DWORD_STAT(STAT_VoxelDataOctreePaletteBuffersCount);
+		FMemory::Free(Data);
+	}
+
+private:
+	FORCEINLINE static void OnAllocated(int32 Size)
+	{
+		INC_MEMORY_STAT_BY(STAT_VoxelDataOctreePaletteSavedMemory, UncompressedSize - Size);
+		INC_DWORD_STAT(STAT_VoxelDataOctreePaletteBuffersCount);
+	}
+};
@@ -20,6 +20,15 @@ enum class EVoxelUndoRedo
 	Redo
 };
 
+struct FVoxelUndoRedoFrameStats
+{
+	int32 HistoryPosition = -1;
+	// Number of leaves with data for this frame
+	int32 NumLeaves = 0;
+	int32 NumCompressedLeaves = 0;
+	int64 AllocatedSize = 0;
+};
+
 class VOXEL_API FVoxelDataOctreeLeafUndoRedo
 {
 public:
@@ -28,6 +37,9 @@ public:
 
 	void ClearFrames(const FVoxelDataOctreeLeaf& Leaf);
 	void SaveFrame(const FVoxelDataOctreeLeaf& Leaf, int32 HistoryPosition);
+	// Compresses the undo frames below the top voxel.data.UndoRedo.NumUncompressedFrames
+	// Redo frames are never compressed, as they are dropped by the next SaveFrame
+	void CompressOldUndoFrames();
 
 	template<typename T>
 	void ClearFramesOfType();
@@ -35,6 +47,14 @@ public:
 	template<EVoxelUndoRedo Type>
 	void UndoRedo(const IVoxelData& Data, FVoxelDataOctreeLeaf& Leaf, int32 HistoryPosition);
 
+	// Removes the bottom of the undo stack if it's the frame of HistoryPosition
+	void RemoveOldestUndoFrame(int32 HistoryPosition);
+	// OutStats[HistoryPosition - MinHistoryPosition] is the stats of HistoryPosition
+	void AddFramesStats(int32 MinHistoryPosition, TArray<FVoxelUndoRedoFrameStats>& OutStats) const;
+
+	// Memory used by the undo and redo frames of all the leaves, of all the datas. Thread safe
+	static int64 GetFramesAllocatedSize();
+
 public:
 	template<EVoxelUndoRedo Type>
 	inline bool CanUndoRedo(int32 HistoryPosition) const
@@ -86,10 +106,7 @@ private:
 			, bMaterialsDirty(Leaf.Materials.IsDirty())
 		{
 		}
-		~FFrame()
-		{
-			DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelUndoRedoMemory, AllocatedSize);
-		}
+		~FFrame();
 		
 		int32 HistoryPosition = -1;
 		
@@ -98,15 +115,37 @@ private:
 
 		TArray<TModifiedValue<FVoxelValue>> Values;
 		TArray<TModifiedValue<FVoxelMaterial>> Materials;
+
+		// Values and Materials are empty when compressed, see Compress
+		TArray<uint8> CompressedData;
+		int32 UncompressedSize = 0;
+		int32 NumCompressedValues = 0;
+		int32 NumCompressedMaterials = 0;
+		uint8 Codec = 0;
+		// Set when compressing didn't save memory, so that it's not tried again
+		bool bNotWorthCompressing = false;
 		
 		mutable uint32 AllocatedSize = 0;
 		
 		void UpdateStats() const;
+
+		void Compress();
+		void Decompress();
 		
+		inline bool IsCompressed() const
+		{
+			return CompressedData.Num() > 0;
+		}
 		inline bool IsEmpty() const
 		{
-			return Values.Num() == 0 && Materials.Num() == 0;
+			return Values.Num() == 0 && Materials.Num() == 0 && !IsCompressed();
 		}
+
+	private:
+		template<typename T>
+		static void Encode(TArray<TModifiedValue<T>>& Data, TArray<uint8>& Out);
+		template<typename T>
+		static void Decode(const uint8*& Ptr, int32 Num, TArray<TModifiedValue<T>>& OutData);
 	};
 	struct FAlreadyModified
 	{
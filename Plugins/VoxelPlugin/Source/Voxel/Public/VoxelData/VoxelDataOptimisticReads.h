@@ -0,0 +1,65 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelIntBox.h"
+#include <atomic>
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Optimistic Reads"), STAT_VoxelDataOptimisticReads, STATGROUP_VoxelCounters, VOXEL_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Optimistic Reads Fallbacks"), STAT_VoxelDataOptimisticReadsFallbacks, STATGROUP_VoxelCounters, VOXEL_API);
+
+/**
+ * Lets FVoxelData::Lock(Read) skip the octree mutexes
+ *
+ * Every data octree node has a version that is odd while the node is locked for write
+ * An optimistic reader publishes its bounds in a slot, then checks that no node in its bounds is odd: if one is, it falls back to locking
+ * A writer bumps the versions of the nodes it locked, then waits for the published readers intersecting them
+ * Both sides use sequentially consistent atomics, so either the reader sees the odd version or the writer sees the reader
+ *
+ * Readers never block, and new readers never delay a waiting writer: they see its odd versions and queue on the node mutexes like before
+ * The octree structure is only ever extended under a write lock, and is only destroyed in ClearData which blocks optimistic reads first
+ */
+class VOXEL_API FVoxelDataOptimisticReads
+{
+public:
+	static constexpr int32 NumSlots = 64;
+
+	// voxel.data.OptimisticReads. Always false with DO_THREADSAFE_CHECKS, as IsLockedForRead would fail
+	static bool IsEnabled();
+
+public:
+	// Publishes Bounds. Returns the slot to pass to Leave, or -1 if optimistic reads are blocked or if all the slots are in use
+	int32 Enter(const FVoxelIntBox& Bounds);
+	void Leave(int32 SlotIndex);
+
+	// Must be called after the versions of the write locked nodes have been bumped
+	// Waits for all the readers that were published before then and that intersect Bounds
+	void WaitForReaders(const FVoxelIntBox& Bounds) const;
+
+	// Makes Enter fail and waits for all the current readers
+	void Block();
+	void Unblock();
+
+private:
+	enum : uint64
+	{
+		State_Free = 0,
+		// Bounds are being written
+		State_Claimed = 1,
+		State_Published = 2,
+		State_Mask = 3
+	};
+
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FSlot
+	{
+		// Sequence << 2 | State. The sequence is incremented on Leave so that writers don't wait on a reader that entered after them
+		std::atomic<uint64> State{ State_Free };
+		// Only read by writers when published, and checked against State after being read
+		FVoxelIntBox Bounds;
+	};
+
+	FSlot Slots[NumSlots];
+	std::atomic<int32> NumBlockers{ 0 };
+};
@@ -134,7 +134,7 @@ void FVoxelDataUtilities::SetEntireDataAsDirtyAndCopyFrom(const FVoxelData& Sour
 			{
 				DataHolder.CreateData(DestData, [&](T* RESTRICT DataPtr)
 				{
-					TVoxelQueryZone<T> QueryZone(Leaf.GetBounds(), DataPtr);
+					TVoxelQueryZone<T> QueryZone = TVoxelQueryZone<T>::ForDataChunk(Leaf.GetBounds(), DataPtr);
 					SourceBottomNode.GetFromGeneratorAndAssets(*SourceData.Generator, QueryZone, 0); // Note: make sure to use the source generator!
 				});
 				DataHolder.Compress(DestData); // To save memory
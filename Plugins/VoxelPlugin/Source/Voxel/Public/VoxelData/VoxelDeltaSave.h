@@ -0,0 +1,74 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+class FVoxelData;
+struct FVoxelObjectArchiveEntry;
+struct FVoxelUncompressedWorldSaveImpl;
+
+namespace FVoxelDeltaSaveVersion
+{
+	enum Type : int32
+	{
+		Initial,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+}
+
+/**
+ * Autosaves a data to a base save file and to an append-only journal of delta saves, in BasePath + ".deltas"
+ * Each delta only has the chunks written since the previous one, so its cost is proportional to the edits since then (see FVoxelData::GetDeltaSave)
+ * The deltas are compacted into a new base save when there are too many of them, or when the delta chain of the data is broken
+ * Not thread safe
+ */
+class VOXEL_API FVoxelDeltaSaveWriter
+{
+public:
+	FVoxelDeltaSaveWriter(const TVoxelSharedRef<FVoxelData>& Data, const FString& BasePath);
+
+	// Appends a delta save to the journal, or compacts if needed. Returns false if the files could not be written
+	bool Save();
+	// Writes a new base save and empties the journal
+	bool Compact();
+
+	int32 GetNumDeltas() const
+	{
+		return NumDeltas;
+	}
+	int64 GetJournalSize() const
+	{
+		return JournalSize;
+	}
+
+	/**
+	 * Replays the journal on the base save. Deltas of another base save are skipped, and the replay stops at the first truncated or corrupted delta
+	 * The data has no delta chain after being loaded from OutSave: the next Save will compact
+	 * @param	BasePath			Path of the base save
+	 * @param	OutSave				The merged save, to load with FVoxelData::LoadFromSave
+	 * @param	OutObjects			Objects referenced by the placeable items of OutSave
+	 * @return false if the base save could not be read
+	 */
+	static bool Load(const FString& BasePath, FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects);
+
+	static FString GetJournalPath(const FString& BasePath)
+	{
+		return BasePath + TEXT(".deltas");
+	}
+
+private:
+	const TVoxelWeakPtr<FVoxelData> Data;
+	const FString BasePath;
+	const FString JournalPath;
+
+	// Guid of the base save written by the last Compact
+	FGuid BaseGuid;
+	int32 NumDeltas = 0;
+	int64 BaseSize = 0;
+	int64 JournalSize = 0;
+};
@@ -0,0 +1,167 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelIntBox.h"
+#include "VoxelData/VoxelSave.h"
+
+class FVoxelData;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Region Saves Memory"), STAT_VoxelRegionSavesMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+namespace FVoxelRegionSaveVersion
+{
+	enum Type : int32
+	{
+		Initial,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+}
+
+struct FVoxelRegionSaveEntry
+{
+	// Min of the region bounds
+	FIntVector Position;
+	int32 NumChunks = 0;
+
+	// Relative to the end of the directory
+	int64 Offset = 0;
+	int32 CompressedSize = 0;
+	int32 UncompressedSize = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FVoxelRegionSaveEntry& Entry)
+	{
+		Ar << Entry.Position;
+		Ar << Entry.NumChunks;
+
+		Ar << Entry.Offset;
+		Ar << Entry.CompressedSize;
+		Ar << Entry.UncompressedSize;
+
+		return Ar;
+	}
+};
+
+/**
+ * World save split in regions of DATA_CHUNK_SIZE << RegionDepth voxels, each one compressed on its own
+ * The file starts with a directory of the regions, which is the only part read when opening it:
+ * the regions are then decompressed on demand from a mapping of the file, and can be loaded in any order
+ */
+class VOXEL_API FVoxelRegionWorldSave
+{
+public:
+	FVoxelRegionWorldSave() = default;
+	~FVoxelRegionWorldSave();
+
+	// Regions are data octree nodes: RegionDepth must be between 0 and the save depth
+	static bool Write(
+		const FVoxelUncompressedWorldSaveImpl& Save,
+		const TArray<FVoxelObjectArchiveEntry>& Objects,
+		int32 RegionDepth,
+		const FString& Path);
+	static TVoxelSharedPtr<const FVoxelRegionWorldSave> Open(const FString& Path);
+
+public:
+	int32 GetDepth() const
+	{
+		return Depth;
+	}
+	FGuid GetGuid() const
+	{
+		return Guid;
+	}
+	int32 GetRegionSize() const
+	{
+		return DATA_CHUNK_SIZE << RegionDepth;
+	}
+	int32 NumRegions() const
+	{
+		return Regions.Num();
+	}
+	const FVoxelRegionSaveEntry& GetRegion(int32 RegionIndex) const
+	{
+		return Regions[RegionIndex];
+	}
+	FVoxelIntBox GetRegionBounds(int32 RegionIndex) const
+	{
+		return FVoxelIntBox(Regions[RegionIndex].Position, Regions[RegionIndex].Position + FIntVector(GetRegionSize()));
+	}
+	bool IsMemoryMapped() const
+	{
+		return MappedRegion.IsValid();
+	}
+
+	// Save with the chunks of a single region. Thread safe
+	bool ReadRegion(int32 RegionIndex, FVoxelUncompressedWorldSaveImpl& OutSave) const;
+	// Save without any chunk, with the placeable items of the world
+	void GetItemsSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects) const;
+
+private:
+	int32 Version = -1;
+	FGuid Guid;
+	int32 Depth = -1;
+	int32 RegionDepth = -1;
+	uint64 UserFlags = 0;
+
+	TArray<FVoxelRegionSaveEntry> Regions;
+	// The placeable items are stored as they were in the uncompressed save, with its version (see FVoxelSaveVersion)
+	int32 ItemsVersion = -1;
+	TArray<uint8> PlaceableItems;
+	TArray<FVoxelObjectArchiveEntry> Objects;
+
+	// Either mapped...
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// ...or owned
+	TArray64<uint8> OwnedData;
+
+	// Start of the region blocks
+	const uint8* BlocksData = nullptr;
+	int64 BlocksSize = 0;
+
+	int64 AllocatedSize = 0;
+
+	bool SerializeDirectory(FArchive& Ar);
+};
+
+// The regions of a region save that are loaded in a data. Owned by the data, see FVoxelData::SetRegionSaveLoader
+// Thread safe: regions can be loaded by the streamer on the game thread and by GetSave on any thread
+class VOXEL_API FVoxelRegionSaveLoader
+{
+public:
+	const TVoxelSharedRef<const FVoxelRegionWorldSave> Save;
+
+	explicit FVoxelRegionSaveLoader(const TVoxelSharedRef<const FVoxelRegionWorldSave>& Save);
+
+	int32 GetNumRegionsLeft() const;
+
+	// Regions not loaded yet that intersect any of Bounds, the ones closest to Positions first
+	void GetRegionsToLoad(const TArray<FVoxelIntBox>& Bounds, const TArray<FIntVector>& Positions, TArray<int32>& OutRegions) const;
+
+	// Decompresses the regions in parallel and loads them in Data, each under a write lock of its bounds only
+	// Regions already loaded are skipped. Returns false if some regions are corrupted
+	bool LoadRegions(FVoxelData& Data, const TArray<int32>& RegionIndices);
+	bool LoadAllRegions(FVoxelData& Data);
+	// Loads the regions intersecting Bounds, so that writes are applied on top of the saved chunks. Called by FVoxelData::Lock on write locks
+	// No-op when called from a region load, ie from the write locks it takes itself
+	void LoadRegionsBeforeWrite(FVoxelData& Data, const FVoxelIntBox& Bounds);
+
+	// Bounds of the chunks loaded since the last call, that need to be remeshed
+	void PopBoundsToUpdate(TArray<FVoxelIntBox>& OutBounds);
+
+private:
+	// Locked during the entire load, so that regions loaded by another thread are finished when LoadAllRegions returns
+	FCriticalSection LoadSection;
+
+	mutable FCriticalSection Section;
+	TBitArray<> LoadedRegions;
+	int32 NumRegionsLeft = 0;
+	TArray<FVoxelIntBox> BoundsToUpdate;
+};
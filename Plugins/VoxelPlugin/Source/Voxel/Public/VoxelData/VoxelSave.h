@@ -32,6 +32,8 @@ namespace FVoxelSaveVersion
 		SHARED_StoreSpawnerMatricesRelativeToComponent,
 		StoreMaterialChannelsIndividuallyAndRemoveFoliage,
 		ProperlySerializePlaceableItemsObjects,
+		// Only changes FVoxelCompressedWorldSaveImpl::CompressedData: see UVoxelSaveUtilities::CompressVoxelSave
+		BlockCompression,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -163,6 +165,8 @@ private:
 
 	friend class FVoxelSaveBuilder;
 	friend class FVoxelSaveLoader;
+	friend class FVoxelRegionWorldSave;
+	friend class UVoxelSaveUtilities;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "VoxelSave.h"
+#include "VoxelUtilities/VoxelSerializationUtilities.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "VoxelSaveUtilities.generated.h"
 
@@ -15,11 +16,29 @@ class IVoxelDataOctreeMemory;
 template<typename T>
 class TVoxelDataOctreeLeafData;
 
+struct FVoxelSaveChunkRef
+{
+	const FVoxelUncompressedWorldSaveImpl* Save = nullptr;
+	int32 ChunkIndex = -1;
+};
+
 class FVoxelSaveBuilder
 {
 public:
 	explicit FVoxelSaveBuilder(int32 Depth);
 
+	// Copies chunks of other saves as is, in order, without going through a data. Guid, depth and user flags are the ones of HeaderSave
+	// Placeable items are not copied
+	static void CopyChunks(
+		const FVoxelUncompressedWorldSaveImpl& HeaderSave,
+		const TArray<FVoxelSaveChunkRef>& Chunks,
+		FVoxelUncompressedWorldSaveImpl& OutSave);
+	// Merges saves of the same world: the chunks of later saves replace the ones of earlier saves. Used to replay delta saves
+	// Chunks are sorted in the data octree order, as expected by FVoxelData::LoadFromSave. Placeable items are the ones of the last save
+	static void MergeSaves(
+		const TArray<const FVoxelUncompressedWorldSaveImpl*>& Saves,
+		FVoxelUncompressedWorldSaveImpl& OutSave);
+
 	void AddChunk(
 		const FIntVector& Position,
 		const TVoxelDataOctreeLeafData<FVoxelValue>& Values,
@@ -87,9 +106,22 @@ class VOXEL_API UVoxelSaveUtilities : public UBlueprintFunctionLibrary
 public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel|Data|Save")
 	static void CompressVoxelSave(const FVoxelUncompressedWorldSave& UncompressedSave, FVoxelCompressedWorldSave& OutCompressedSave);
-	static void CompressVoxelSave(const FVoxelUncompressedWorldSaveImpl& UncompressedSave, FVoxelCompressedWorldSaveImpl& OutCompressedSave);
+	/**
+	 * The save is split into blocks of voxel.data.SaveCompressionBlockSize KB, that are compressed in parallel
+	 * Each block has a checksum: a corrupted block only loses its chunks (see voxel.data.RecoverCorruptedSaves)
+	 * @param	Codec				Defaults to voxel.data.SaveCompressionCodec
+	 * @param	CompressionLevel	Only used by Zlib
+	 */
+	static void CompressVoxelSave(
+		const FVoxelUncompressedWorldSaveImpl& UncompressedSave,
+		FVoxelCompressedWorldSaveImpl& OutCompressedSave,
+		EVoxelCompressionCodec::Type Codec = EVoxelCompressionCodec::Max,
+		EVoxelCompressionLevel::Type CompressionLevel = EVoxelCompressionLevel::VoxelDefault);
 
 	UFUNCTION(BlueprintCallable, Category = "Voxel|Data|Save")
 	static bool DecompressVoxelSave(const FVoxelCompressedWorldSave& CompressedSave, FVoxelUncompressedWorldSave& OutUncompressedSave);
 	static bool DecompressVoxelSave(const FVoxelCompressedWorldSaveImpl& CompressedSave, FVoxelUncompressedWorldSaveImpl& OutUncompressedSave);
+
+private:
+	static bool DecompressVoxelSaveBlocks(const FVoxelCompressedWorldSaveImpl& CompressedSave, FVoxelUncompressedWorldSaveImpl& OutUncompressedSave);
 };
\ No newline at end of file
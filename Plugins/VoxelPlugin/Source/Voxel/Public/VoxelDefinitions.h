@@ -82,6 +82,14 @@
 #define DATA_CHUNK_SIZE 16
 #endif
 
+// Memory layout of the data chunks buffers
+// 0: linear, X + DATA_CHUNK_SIZE * Y + DATA_CHUNK_SIZE * DATA_CHUNK_SIZE * Z
+// 1: Morton (Z-order): neighbors are closer in memory, better for the edit tools reading neighborhoods
+// Saves are always written in linear order. Run voxel.data.BenchmarkLayouts to compare both on your machine
+#ifndef VOXEL_DATA_CHUNK_MORTON_LAYOUT
+#define VOXEL_DATA_CHUNK_MORTON_LAYOUT 0
+#endif
+
 // No tessellation support on some platforms
 #ifndef ENABLE_TESSELLATION
 #define ENABLE_TESSELLATION 0
@@ -110,12 +118,6 @@
 #define VOXEL_DATA_ACCELERATOR_STATS VOXEL_DEBUG
 #endif
 
-// No support for indices optimizations on some platforms
-// Note: I have yet to find any performance improvements due to this
-#ifndef ENABLE_OPTIMIZE_INDICES
-#define ENABLE_OPTIMIZE_INDICES PLATFORM_WINDOWS
-#endif
-
 #ifndef EIGHT_BITS_VOXEL_VALUE
 #define EIGHT_BITS_VOXEL_VALUE 0
 #endif
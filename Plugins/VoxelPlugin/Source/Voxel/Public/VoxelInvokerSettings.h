@@ -17,6 +17,10 @@ struct FVoxelInvokerSettings
 	int32 LODToSet = 0;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
 	FVoxelIntBox LODBounds;
+	// Where the invoker is predicted to be, relative to its current position
+	// LODBounds are swept along it, and the priorities are computed from the whole path
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
+	FIntVector PredictedOffset = FIntVector(0);
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
 	bool bUseForCollisions = false;
@@ -27,4 +31,48 @@ struct FVoxelInvokerSettings
 	bool bUseForNavmesh = false;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
 	FVoxelIntBox NavmeshBounds;
+
+public:
+	// Bounds of LODBounds swept along PredictedOffset
+	FVoxelIntBox GetLODPathBounds() const
+	{
+		return LODBounds.Union(LODBounds.Translate(PredictedOffset));
+	}
+	// Whether Bounds intersects LODBounds swept along PredictedOffset
+	bool IntersectLODPath(const FVoxelIntBox& Bounds) const
+	{
+		if (PredictedOffset == FIntVector::ZeroValue)
+		{
+			return LODBounds.Intersect(Bounds);
+		}
+
+		// Find the times in [0, 1] at which LODBounds + Time * PredictedOffset intersects Bounds, one axis at a time
+		double MinTime = 0;
+		double MaxTime = 1;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			const int64 Offset = PredictedOffset[Axis];
+			// Intersect along this axis if Bounds.Min - LODBounds.Max < Time * Offset < Bounds.Max - LODBounds.Min
+			const int64 Low = int64(Bounds.Min[Axis]) - LODBounds.Max[Axis];
+			const int64 High = int64(Bounds.Max[Axis]) - LODBounds.Min[Axis];
+			if (Offset == 0)
+			{
+				if (Low >= 0 || High <= 0)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const double TimeA = double(Low) / Offset;
+			const double TimeB = double(High) / Offset;
+			MinTime = FMath::Max(MinTime, FMath::Min(TimeA, TimeB));
+			MaxTime = FMath::Min(MaxTime, FMath::Max(TimeA, TimeB));
+			if (MinTime >= MaxTime)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 };
\ No newline at end of file
@@ -332,7 +332,7 @@ public:
 			GetU0() == Other.GetU0() &&
 			GetU1() == Other.GetU1() &&
 			GetU2() == Other.GetU2() &&
-			GetV3() == Other.GetU3() &&
+			GetU3() == Other.GetU3() &&
 			GetV0() == Other.GetV0() &&
 			GetV1() == Other.GetV1() &&
 			GetV2() == Other.GetV2() &&
@@ -348,7 +348,7 @@ public:
 			GetU0() != Other.GetU0() ||
 			GetU1() != Other.GetU1() ||
 			GetU2() != Other.GetU2() ||
-			GetV3() != Other.GetU3() ||
+			GetU3() != Other.GetU3() ||
 			GetV0() != Other.GetV0() ||
 			GetV1() != Other.GetV1() ||
 			GetV2() != Other.GetV2() ||
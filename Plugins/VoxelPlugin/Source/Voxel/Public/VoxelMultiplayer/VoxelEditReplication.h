@@ -0,0 +1,94 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelIntBox.h"
+
+class FVoxelData;
+struct FVoxelMultiplayerLeafDiff;
+
+namespace FVoxelEditReplicationVersion
+{
+	enum Type : int32
+	{
+		Initial,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+}
+
+/**
+ * Replicates the voxel edits of a server data to clients, independently of the transport
+ * At each sync tick the leaves edited since the previous one are gathered. Each client then gets packets with its pending leaves, closest to its invokers first
+ * A leaf is encoded as a run length encoded mask of its edited voxels, and the XOR of their new values with the ones the client has. Packets are compressed
+ *
+ * Packets need to be received in order and without losses, eg with TCP
+ * Clients need to start from the same state as the server data, eg by loading a save of it taken right before being added
+ * Only edits going through FVoxelData::Set are replicated (see FVoxelData::GetMultiplayerDiffs)
+ * Not thread safe
+ */
+class VOXEL_API FVoxelEditReplicationServer
+{
+public:
+	// Data must have bEnableMultiplayer
+	explicit FVoxelEditReplicationServer(const TVoxelSharedRef<FVoxelData>& Data);
+
+	int32 AddClient();
+	void RemoveClient(int32 ClientId);
+
+	// Clients with no invokers get their leaves in the order they were first edited
+	void SetClientInvokers(int32 ClientId, const TArray<FIntVector>& InvokerPositions);
+
+	// Gathers the edits since the previous tick. Should be called at the sync rate, eg AVoxelWorld::MultiplayerSyncRate
+	void Tick();
+
+	// Returns false if there's nothing to send to this client. Packets are at most voxel.multiplayer.MaxPacketSize, unless a single leaf is bigger
+	bool GetNextPacket(int32 ClientId, TArray<uint8>& OutPacket);
+
+	int32 GetNumPendingLeaves(int32 ClientId) const;
+
+private:
+	struct FClient
+	{
+		TArray<FIntVector> Invokers;
+		// Diffs of a leaf are in edit order, and are merged when sent
+		TMap<FIntVector, TArray<TVoxelSharedRef<const FVoxelMultiplayerLeafDiff>>> PendingLeaves;
+
+		// Pending leaves in send order, from NumSentLeaves. New leaves are added at the end, and sorted by distance to the invokers when needed
+		TArray<FIntVector> SendOrder;
+		int32 NumSentLeaves = 0;
+		bool bNeedsSort = false;
+
+		// Next leaf to send, already encoded as it didn't fit in the previous packet. Reset if it gets new diffs
+		FIntVector EncodedLeaf;
+		TArray<uint8> EncodedLeafPayload;
+	};
+
+	// Sorts SendOrder by distance to the invokers. Done at most once per Tick or SetClientInvokers
+	static void SortPendingLeaves(FClient& Client);
+
+	const TVoxelWeakPtr<FVoxelData> Data;
+	TMap<int32, FClient> Clients;
+	int32 NextClientId = 0;
+};
+
+class VOXEL_API FVoxelEditReplicationClient
+{
+public:
+	explicit FVoxelEditReplicationClient(const TVoxelSharedRef<FVoxelData>& Data);
+
+	/**
+	 * Applies a packet of FVoxelEditReplicationServer::GetNextPacket. No lock required: only the leaves in the packet are locked
+	 * @param	Packet				The packet
+	 * @param	OutBoundsToUpdate	Bounds of the edited leaves
+	 * @return false if the packet is corrupted. Nothing is applied then, and the client needs to be synced again from a save
+	 */
+	bool ApplyPacket(const TArray<uint8>& Packet, TArray<FVoxelIntBox>& OutBoundsToUpdate);
+
+private:
+	const TVoxelWeakPtr<FVoxelData> Data;
+};
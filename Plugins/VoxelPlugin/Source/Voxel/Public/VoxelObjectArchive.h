@@ -16,6 +16,20 @@ struct FVoxelObjectArchiveEntry
 	// Zero is reserved for nullptr
 	UPROPERTY(VisibleAnywhere, Category = "Entry")
 	int32 Index = -1;
+
+	// As a soft object path, for archives with no linker to serialize objects with
+	friend FArchive& operator<<(FArchive& Ar, FVoxelObjectArchiveEntry& Entry)
+	{
+		FString ObjectPath = Entry.Object.ToString();
+		Ar << ObjectPath;
+		Ar << Entry.Index;
+
+		if (Ar.IsLoading())
+		{
+			Entry.Object = TSoftObjectPtr<UObject>(FSoftObjectPath(ObjectPath));
+		}
+		return Ar;
+	}
 };
 
 // Reader must be called from the game thread
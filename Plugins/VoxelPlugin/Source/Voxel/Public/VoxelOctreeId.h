@@ -17,4 +17,9 @@ struct FVoxelOctreeId
 	{
 		return Position != Other.Position || Height != Other.Height;
 	}
+
+	FORCEINLINE friend uint32 GetTypeHash(const FVoxelOctreeId& Id)
+	{
+		return HashCombine(GetTypeHash(Id.Position), Id.Height);
+	}
 };
\ No newline at end of file
@@ -4,6 +4,46 @@
 
 #include "CoreMinimal.h"
 #include "VoxelIntBox.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+// Clock advanced by the invokers movements, in voxels, shared by all the invokers arrays
+// A priority computed by FVoxelPriorityHandler after GetStamp returned Stamp differs from the current one by at most GetMovementSince(Stamp)
+class VOXEL_API FVoxelInvokersMovement
+{
+public:
+	FORCEINLINE static uint64 GetStamp()
+	{
+		return Clock.GetValue();
+	}
+	FORCEINLINE static uint32 GetMovementSince(uint64 Stamp)
+	{
+		// +1 for the rounding in FVoxelPriorityHandler::GetPriority
+		return FMath::Min<uint64>(Clock.GetValue() - Stamp + 1, MAX_uint32);
+	}
+	FORCEINLINE static void Add(uint64 Movement)
+	{
+		Clock.Add(Movement);
+	}
+
+private:
+	static FThreadSafeCounter64 Clock;
+};
+
+// Invoker position, and where it is predicted to be. See FVoxelInvokerSettings::PredictedOffset
+struct FVoxelInvokerPath
+{
+	FIntVector Position = FIntVector(0);
+	FIntVector PredictedOffset = FIntVector(0);
+
+	// Number of points of the path used to compute the priorities, not counting the start
+	static constexpr int32 NumSamples = 8;
+
+	FORCEINLINE FIntVector GetSample(int32 Index) const
+	{
+		checkVoxelSlow(0 <= Index && Index <= NumSamples);
+		return Position + PredictedOffset * Index / NumSamples;
+	}
+};
 
 // Somewhat thread safe array
 class FInvokerPositionsArray
@@ -12,7 +52,7 @@ public:
 	FInvokerPositionsArray() = default;
 	explicit FInvokerPositionsArray(int32 NewMax)
 		: Max(NewMax)
-		, Data(reinterpret_cast<FIntVector*>(FMemory::Malloc(sizeof(FIntVector) * NewMax, alignof(FIntVector))))
+		, Data(reinterpret_cast<FVoxelInvokerPath*>(FMemory::Malloc(sizeof(FVoxelInvokerPath) * NewMax, alignof(FVoxelInvokerPath))))
 	{
 	}
 	~FInvokerPositionsArray()
@@ -20,11 +60,29 @@ public:
 		FMemory::Free(Data);
 	}
 
-	void Set(const TArray<FIntVector>& Array)
+	void Set(const TArray<FVoxelInvokerPath>& Array)
 	{
 		check(Array.Num() <= Max);
+		
+		// The distance to the closest invoker changes at most by how much the invokers moved,
+		// but can change arbitrarily if invokers are added or removed
+		uint64 Movement = Array.Num() == Num ? 0 : MAX_uint32;
 		for (int32 Index = 0; Index < Array.Num(); Index++)
 		{
+			if (Array.Num() == Num)
+			{
+				const FVoxelInvokerPath& Old = Data[Index];
+				const FVoxelInvokerPath& New = Array[Index];
+				// The path samples are interpolated between the start and the end, so they move at most as much as one of them
+				const FIntVector StartMovement = New.Position - Old.Position;
+				const FIntVector EndMovement = StartMovement + New.PredictedOffset - Old.PredictedOffset;
+				Movement = FMath::Max<uint64>(Movement, FMath::CeilToInt(FMath::Max(FVector(StartMovement).Size(), FVector(EndMovement).Size())));
+				if (Old.PredictedOffset != FIntVector(0) || New.PredictedOffset != FIntVector(0))
+				{
+					// GetSample rounds each coordinate towards 0: the old and new rounding errors differ by less than 2 per axis
+					Movement += 4;
+				}
+			}
 			Data[Index] = Array[Index];
 		}
 		// Make sure all the data is written before updating Num
@@ -32,6 +90,12 @@ public:
 		Num = Array.Num();
 		// Force Num update
 		FPlatformMisc::MemoryBarrier();
+
+		// Must be done after the positions are written: priorities are computed after reading the stamp
+		if (Movement > 0)
+		{
+			FVoxelInvokersMovement::Add(Movement);
+		}
 	}
 	FORCEINLINE int32 GetMax() const
 	{
@@ -41,7 +105,7 @@ public:
 	{
 		return Num;
 	}
-	FORCEINLINE FIntVector Get(int32 Index) const
+	FORCEINLINE const FVoxelInvokerPath& Get(int32 Index) const
 	{
 		checkVoxelSlow(Index < Num);
 		return Data[Index];
@@ -50,7 +114,7 @@ public:
 private:
 	int32 Num = 0;
 	const int32 Max = 0;
-	FIntVector* RESTRICT const Data = nullptr;
+	FVoxelInvokerPath* RESTRICT const Data = nullptr;
 };
 
 struct FVoxelPriorityHandler
@@ -65,13 +129,22 @@ struct FVoxelPriorityHandler
 	{
 	}
 
+	// Only depends on the invokers paths, see FVoxelInvokersMovement
+	// The distance to an invoker is the distance to the closest point of its predicted path
 	inline uint32 GetPriority() const
 	{
 		uint64 Distance = MAX_uint64;
 		for (int32 Index = 0; Index < InvokersPositions->GetNum(); Index++)
 		{
-			const FIntVector Position = InvokersPositions->Get(Index);
-			Distance = FMath::Min(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint(Position));
+			const FVoxelInvokerPath& Path = InvokersPositions->Get(Index);
+			Distance = FMath::Min(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint(Path.Position));
+			if (Path.PredictedOffset != FIntVector(0))
+			{
+				for (int32 Sample = 1; Sample <= FVoxelInvokerPath::NumSamples; Sample++)
+				{
+					Distance = FMath::Min(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint(Path.GetSample(Sample)));
+				}
+			}
 		}
 		return MAX_uint32 - uint32(FMath::Sqrt(float(Distance)));
 	}
@@ -52,6 +52,17 @@ public:
 		check(Data);
 	}
 
+	// To fill the buffer of a data chunk, which might not be linear: see VOXEL_DATA_CHUNK_MORTON_LAYOUT
+	static TVoxelQueryZone<T> ForDataChunk(const FVoxelIntBox& ChunkBounds, T* Data)
+	{
+		check(ChunkBounds.Size() == FIntVector(DATA_CHUNK_SIZE));
+		TVoxelQueryZone<T> QueryZone(ChunkBounds, Data);
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		QueryZone.bMortonLayout = true;
+#endif
+		return QueryZone;
+	}
+
 	FORCEINLINE void Set(int32 X, int32 Y, int32 Z, T Value)
 	{
 		checkVoxelSlow(Bounds.Contains(X, Y, Z));
@@ -72,6 +83,14 @@ public:
 		checkVoxelSlow(0 <= LocalY && LocalY < ArraySize.Y);
 		checkVoxelSlow(0 <= LocalZ && LocalZ < ArraySize.Z);
 
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		if (bMortonLayout)
+		{
+			Data[FVoxelUtilities::MortonEncode3D(LocalX, LocalY, LocalZ)] = Value;
+			return;
+		}
+#endif
+
 		const int32 Index = LocalX + ArraySize.X * LocalY + ArraySize.X * ArraySize.Y * LocalZ;
 		Data[Index] = Value;
 	}
@@ -80,7 +99,11 @@ public:
 	{
 		FVoxelIntBox LocalBounds = Bounds.Overlap(InBounds);
 		LocalBounds = LocalBounds.MakeMultipleOfRoundUp(Step);
-		return TVoxelQueryZone<T>(LocalBounds, Offset, ArraySize, LOD, Data);
+		TVoxelQueryZone<T> QueryZone(LocalBounds, Offset, ArraySize, LOD, Data);
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+		QueryZone.bMortonLayout = bMortonLayout;
+#endif
+		return QueryZone;
 	}
 
 private:
@@ -88,6 +111,9 @@ private:
 	const FIntVector Offset;
 	const FIntVector ArraySize;
 	const uint32 LOD;
+#if VOXEL_DATA_CHUNK_MORTON_LAYOUT
+	bool bMortonLayout = false;
+#endif
 	
 	TVoxelQueryZone(const FVoxelIntBox& Bounds, const FIntVector& Offset, const FIntVector& ArraySize, int32 LOD, T* Data)
 		: Step(1 << LOD)
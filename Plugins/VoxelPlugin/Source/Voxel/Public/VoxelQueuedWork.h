@@ -26,4 +26,9 @@ public:
 	// Voxel works are usually quite long, so it's worth it to compute all the priorities
 	// Must be thread safe
 	virtual uint32 GetPriority() const = 0;
+
+	// Return true if GetPriority is computed by a FVoxelPriorityHandler, ie only changes when the invokers move
+	// The thread pool can then only recompute the priorities that might change the scheduling, see FVoxelInvokersMovement
+	// Else, the priority is recomputed every PriorityDuration
+	virtual bool HasInvokerDistancePriority() const { return false; }
 };
\ No newline at end of file
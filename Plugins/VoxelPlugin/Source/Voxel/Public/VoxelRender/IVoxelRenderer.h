@@ -13,6 +13,7 @@
 
 struct FVoxelMaterialIndices;
 class FInvokerPositionsArray;
+struct FVoxelInvokerPath;
 class IVoxelPool;
 class FVoxelData;
 class FVoxelDebugManager;
@@ -69,6 +70,7 @@ struct FVoxelRendererSettingsBase
 
 	const EVoxelRenderType RenderType;
 	const uint32 RenderSharpness;
+	const bool bGreedyCubicMeshing;
 	const bool bCreateMaterialInstances;
 	const bool bDitherChunks;
 	const float ChunksDitheringDuration;
@@ -89,6 +91,9 @@ struct FVoxelRendererSettingsBase
 	const bool bRenderWorld;
 
 	const float MeshUpdatesBudget;
+	// In bytes, MAX_int64 if no limit
+	const int64 MeshUpdatesSizeBudget;
+	const bool bStreamMeshUpdates;
 
 	const TArray<uint8> HolesMaterials;
 	const TMap<uint8, FVoxelMeshConfig> MaterialsMeshConfigs;
@@ -96,6 +101,7 @@ struct FVoxelRendererSettingsBase
 	const bool bMergeChunks;
 	const int32 ChunksClustersSize;
 	const bool bDoNotMergeCollisionsAndNavmesh;
+	const bool bPoolClustersBuffers;
 
 	const bool bStaticWorld;
 
@@ -168,6 +174,8 @@ public:
 	virtual void UpdateLODs(uint64 InUpdateIndex, const TArray<FVoxelChunkUpdate>& ChunkUpdates) = 0;
 
 	virtual int32 GetTaskCount() const = 0;
+	// True if the chunk is visible and its mesh is up to date with its LOD
+	virtual bool IsChunkShown(uint64 ChunkId) const = 0;
 
 	virtual void RecomputeMeshPositions() = 0;
 	virtual void ApplyNewMaterials() = 0;
@@ -177,7 +185,7 @@ public:
 	//~ End IVoxelRenderer Interface
 
 	// Called by LOD manager
-	void SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities);
+	void SetInvokersPositionsForPriorities(const TArray<FVoxelInvokerPath>& NewInvokersPositionsForPriorities);
 	
 	// Used by render chunks to compute the priorities
 	inline const TVoxelSharedRef<FInvokerPositionsArray>& GetInvokersPositionsForPriorities() const
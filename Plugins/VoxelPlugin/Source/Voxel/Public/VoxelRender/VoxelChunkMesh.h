@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "VoxelMinimal.h"
-#include "VoxelRender/VoxelProcMeshTangent.h"
+#include "VoxelRender/VoxelPackedVertex.h"
 #include "VoxelRender/VoxelMaterialIndices.h"
 
 class FVoxelData;
@@ -13,16 +13,20 @@ struct FVoxelRendererSettingsBase;
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Chunk Mesh Memory"), STAT_VoxelChunkMeshMemory, STATGROUP_VoxelMemory, VOXEL_API);
 
+// The vertices are packed, see VoxelPackedVertex.h. They are only unpacked when copied to the GPU buffers
 struct VOXEL_API FVoxelChunkMeshBuffers
 {
+	// LOD of the chunk, needed to unpack the positions
+	int32 LOD = 0;
+
 	TArray<uint32> Indices;
-	TArray<FVector> Positions;
+	TArray<FVoxelPackedPosition> Positions;
 
 	// Will not be set if bRenderWorld is false
-	TArray<FVector> Normals;
-	TArray<FVoxelProcMeshTangent> Tangents;
+	TArray<FVoxelPackedNormal> Normals;
+	TArray<FVoxelPackedTangent> Tangents;
 	TArray<FColor> Colors;
-	TArray<TArray<FVector2D>> TextureCoordinates;
+	TArray<TArray<FVector2f>> TextureCoordinates;
 
 	FBox Bounds;
 	FGuid Guid; // Use to avoid rebuilding collisions when the mesh didn't change
@@ -37,8 +41,18 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 	{
 		return Positions.Num();
 	}
+	inline FVector GetPosition(int32 Index) const
+	{
+		return Positions[Index].Unpack(LOD);
+	}
+	// Only valid once Shrink is called
+	inline int32 GetAllocatedSize() const
+	{
+		return LastAllocatedSize;
+	}
 
 	void BuildAdjacency(TArray<uint32>& OutAdjacencyIndices) const;
+	// Reorders the triangles for the GPU vertex cache, then the vertices in the order they are used. See FVoxelMeshOptimizer
 	void OptimizeIndices();
 	void Shrink();
 	void ComputeBounds();
@@ -43,6 +43,13 @@ public:
 		TArray<uint32>& OutIndices,
 		TArray<FVector>& OutVertices);
 
+	static TUniquePtr<FVoxelMesherBase> GetMesher(
+		const FVoxelRendererSettings& Settings,
+		int32 LOD,
+		const FIntVector& ChunkPosition,
+		bool bIsTransitionTask,
+		uint8 TransitionsMask);
+
 private:
 	// Important: do not allow public delete
 	virtual ~FVoxelMesherAsyncWork() override;
@@ -51,16 +58,9 @@ private:
 	virtual void DoWork() override final;
 	virtual void PostDoWork() override final;
 	virtual uint32 GetPriority() const override final;
+	virtual bool HasInvokerDistancePriority() const override final { return true; }
 	//~ End FVoxelAsyncWork Interface
 
-	static TUniquePtr<FVoxelMesherBase> GetMesher(
-		const FVoxelRendererSettings& Settings,
-		int32 LOD,
-		const FIntVector& ChunkPosition,
-		bool bIsTransitionTask,
-		uint8 TransitionsMask);
-	
-	
 	const TVoxelWeakPtr<FVoxelDefaultRenderer> Renderer;
 	const FVoxelPriorityHandler PriorityHandler;
 
@@ -0,0 +1,52 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelEnums.h"
+#include "Commandlets/Commandlet.h"
+#include "VoxelMeshingBenchmark.generated.h"
+
+struct VOXEL_API FVoxelMeshingBenchmarkSettings
+{
+	// Paths of the generator classes, eg /Script/VoxelGraph.VoxelExample_Planet
+	TArray<FString> Generators;
+	TArray<EVoxelRenderType> RenderTypes;
+	TArray<int32> LODs;
+
+	// Per LOD, the chunks are the first NumChunksPerDirection chunks that might contain the surface when going from the world center along -X, +X, -Y, +Y, -Z and +Z
+	int32 NumChunksPerDirection = 8;
+	int32 NumThreads = 8;
+	uint32 WorldSizeInVoxels = 1 << 15;
+
+	// Sets the default generators, render types and LODs
+	FVoxelMeshingBenchmarkSettings();
+
+	// Parses -Generators=A,B -RenderTypes=MarchingCubes,Cubic -LODs=0,1 -NumChunksPerDirection=8 -NumThreads=8 -WorldSize=32768
+	void Parse(const TCHAR* Params);
+};
+
+namespace FVoxelMeshingBenchmark
+{
+	// Meshes the chunks of every generator with every render type. Returns false if a generator could not be loaded
+	VOXEL_API bool Run(const FVoxelMeshingBenchmarkSettings& Settings, FString& OutJson);
+}
+
+/**
+ * Runs FVoxelMeshingBenchmark outside of the editor and writes the results to a JSON file, eg:
+ * UnrealEditor-Cmd MyProject.uproject -run=VoxelMeshingBenchmark -nullrhi -Output=Results.json
+ * See FVoxelMeshingBenchmarkSettings::Parse for the other arguments
+ * Returns 1 if a generator could not be loaded
+ */
+UCLASS()
+class VOXEL_API UVoxelMeshingBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVoxelMeshingBenchmarkCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
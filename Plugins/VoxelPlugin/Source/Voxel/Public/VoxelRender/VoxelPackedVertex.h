@@ -0,0 +1,119 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelRender/VoxelProcMeshTangent.h"
+
+// Compact vertex attributes stored in the chunk meshes until they are copied to the GPU buffers
+
+// Position relative to the chunk, in 16 bits fixed point
+// Covers [-RENDER_CHUNK_SIZE / 2, 3 * RENDER_CHUNK_SIZE / 2[ in units of the LOD step, with a precision of 1/1024 of a step for 32-sized chunks
+struct FVoxelPackedPosition
+{
+	uint16 X = 0;
+	uint16 Y = 0;
+	uint16 Z = 0;
+
+	static constexpr int32 Offset = RENDER_CHUNK_SIZE / 2;
+	static constexpr int32 Scale = 65536 / (2 * RENDER_CHUNK_SIZE);
+	static_assert(Scale * 2 * RENDER_CHUNK_SIZE == 65536, "RENDER_CHUNK_SIZE must be a power of 2 less than 65536");
+
+	FVoxelPackedPosition() = default;
+	FVoxelPackedPosition(const FVector& Position, int32 LOD)
+	{
+		const FVector Value = (Position / double(1 << LOD) + Offset) * Scale;
+		ensureVoxelSlowNoSideEffects(
+			-0.5 <= Value.X && Value.X < 65535.5 &&
+			-0.5 <= Value.Y && Value.Y < 65535.5 &&
+			-0.5 <= Value.Z && Value.Z < 65535.5);
+
+		X = FMath::Clamp<int32>(FMath::RoundToInt(Value.X), 0, MAX_uint16);
+		Y = FMath::Clamp<int32>(FMath::RoundToInt(Value.Y), 0, MAX_uint16);
+		Z = FMath::Clamp<int32>(FMath::RoundToInt(Value.Z), 0, MAX_uint16);
+	}
+
+	// Exact: the steps are powers of 2
+	FORCEINLINE FVector Unpack(int32 LOD) const
+	{
+		return (FVector(X, Y, Z) / Scale - Offset) * double(1 << LOD);
+	}
+};
+
+// Unit vector, octahedral encoding in 2x16 bits
+struct FVoxelPackedNormal
+{
+	int16 X = 0;
+	int16 Y = 0;
+
+	FVoxelPackedNormal() = default;
+	FVoxelPackedNormal(const FVector& Normal)
+	{
+		const FVector2D Octahedron = ToOctahedron(Normal);
+		X = FMath::RoundToInt(Octahedron.X * MAX_int16);
+		Y = FMath::RoundToInt(Octahedron.Y * MAX_int16);
+	}
+
+	FORCEINLINE FVector Unpack() const
+	{
+		return FromOctahedron(FVector2D(X, Y) / MAX_int16);
+	}
+
+public:
+	FORCEINLINE static double SignNotZero(double Value)
+	{
+		return Value >= 0 ? 1 : -1;
+	}
+	// Returns a point of [-1, 1]^2
+	static FVector2D ToOctahedron(const FVector& Vector)
+	{
+		const double Norm = FMath::Abs(Vector.X) + FMath::Abs(Vector.Y) + FMath::Abs(Vector.Z);
+		if (Norm == 0)
+		{
+			return FVector2D::ZeroVector;
+		}
+
+		const FVector2D Point = FVector2D(Vector.X, Vector.Y) / Norm;
+		if (Vector.Z >= 0)
+		{
+			return Point;
+		}
+		return FVector2D(
+			(1 - FMath::Abs(Point.Y)) * SignNotZero(Point.X),
+			(1 - FMath::Abs(Point.X)) * SignNotZero(Point.Y));
+	}
+	static FVector FromOctahedron(const FVector2D& Point)
+	{
+		FVector Vector(Point.X, Point.Y, 1 - FMath::Abs(Point.X) - FMath::Abs(Point.Y));
+		if (Vector.Z < 0)
+		{
+			Vector.X = (1 - FMath::Abs(Point.Y)) * SignNotZero(Point.X);
+			Vector.Y = (1 - FMath::Abs(Point.X)) * SignNotZero(Point.Y);
+		}
+		return Vector.GetSafeNormal();
+	}
+};
+
+// Same as FVoxelPackedNormal for TangentX, with 15 bits for Y: its lowest bit is bFlipTangentY
+struct FVoxelPackedTangent
+{
+	int16 X = 0;
+	int16 Y = 0;
+
+	FVoxelPackedTangent() = default;
+	FVoxelPackedTangent(const FVoxelProcMeshTangent& Tangent)
+	{
+		const FVector2D Octahedron = FVoxelPackedNormal::ToOctahedron(Tangent.TangentX);
+		X = FMath::RoundToInt(Octahedron.X * MAX_int16);
+		Y = 2 * FMath::RoundToInt(Octahedron.Y * (MAX_int16 / 2)) + Tangent.bFlipTangentY;
+	}
+
+	FORCEINLINE FVoxelProcMeshTangent Unpack() const
+	{
+		const bool bFlipTangentY = Y & 1;
+		return FVoxelProcMeshTangent(
+			FVoxelPackedNormal::FromOctahedron(FVector2D(double(X) / MAX_int16, double((Y - bFlipTangentY) / 2) / (MAX_int16 / 2))),
+			bFlipTangentY);
+	}
+};
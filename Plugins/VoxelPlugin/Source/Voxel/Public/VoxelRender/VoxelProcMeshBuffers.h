@@ -8,6 +8,7 @@
 #include "VoxelRawStaticIndexBuffer.h"
 
 class FVoxelProcMeshBuffersRenderData;
+struct FVoxelClusterBufferAllocation;
 
 DECLARE_STATS_GROUP(TEXT("Voxel Proc Mesh Memory"), STATGROUP_VoxelProcMeshMemory, STATCAT_Advanced);
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Proc Mesh Memory"), STAT_VoxelProcMeshMemory, STATGROUP_VoxelMemory, VOXEL_API);
@@ -17,6 +18,34 @@ DECLARE_VOXEL_MEMORY_STAT(TEXT("Colors"), STAT_VoxelProcMeshMemory_Colors, STATG
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Adjacency"), STAT_VoxelProcMeshMemory_Adjacency, STATGROUP_VoxelProcMeshMemory, VOXEL_API);
 DECLARE_VOXEL_MEMORY_STAT(TEXT("UVs & Tangents"), STAT_VoxelProcMeshMemory_UVs_Tangents, STATGROUP_VoxelProcMeshMemory, VOXEL_API);
 
+// A chunk merged into proc mesh buffers: its vertices and indices are contiguous
+struct FVoxelProcMeshBuffersChunk
+{
+	// Invalid if the mesh isn't shown
+	FGuid MainGuid;
+	FGuid TransitionGuid;
+	// 0 if the main chunk vertices are not translated
+	uint8 TransitionsMask = 0;
+
+	int32 FirstVertex = 0;
+	int32 NumVertices = 0;
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+
+	inline const FGuid& GetKey() const
+	{
+		return MainGuid.IsValid() ? MainGuid : TransitionGuid;
+	}
+	inline bool HasSameVertices(const FVoxelProcMeshBuffersChunk& Other) const
+	{
+		return
+			MainGuid == Other.MainGuid &&
+			TransitionGuid == Other.TransitionGuid &&
+			TransitionsMask == Other.TransitionsMask &&
+			NumVertices == Other.NumVertices;
+	}
+};
+
 struct VOXEL_API FVoxelProcMeshBuffers
 {
 	// We'll be initializing/releasing a single buffer multiple times, so need to keep the data on the CPU!
@@ -34,6 +63,11 @@ struct VOXEL_API FVoxelProcMeshBuffers
 	/** Local bounds of this section */
 	FBox LocalBounds = FBox(ForceInit);
 
+	// Set by FVoxelRenderUtilities::MergeSections_AnyThread
+	TArray<FVoxelProcMeshBuffersChunk> Chunks;
+	// If set, these buffers are drawn from the cluster buffer pool and their own render resources are never initialized
+	TVoxelSharedPtr<const FVoxelClusterBufferAllocation> ClusterBufferAllocation;
+
 	inline int32 GetNumVertices() const
 	{
 		return VertexBuffers.PositionVertexBuffer.GetNumVertices();
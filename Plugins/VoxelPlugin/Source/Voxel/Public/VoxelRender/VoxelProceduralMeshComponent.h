@@ -82,6 +82,8 @@ private:
 	bool bClearProcMeshBuffersOnFinishUpdate = false;
 	// Distance field bias
 	float DistanceFieldSelfShadowBias = 0.f;
+	// Send the new sections to the existing scene proxy instead of recreating it, see AVoxelWorld::bStreamMeshUpdates
+	bool bStreamSectionsUpdates = false;
 	
 public:
 	UVoxelProceduralMeshComponent();
@@ -112,6 +114,11 @@ public:
 	void ClearSections(EVoxelProcMeshSectionUpdate Update);
 	void FinishSectionsUpdates();
 
+	inline TVoxelSharedPtr<const FVoxelProcMeshBuffers> GetProcMeshSectionBuffers(int32 Index) const
+	{
+		return ProcMeshSections.IsValidIndex(Index) ? ProcMeshSections[Index].Buffers : nullptr;
+	}
+
 	template<typename F>
 	inline void IterateSectionsSettings(F Lambda)
 	{
@@ -145,6 +152,10 @@ public:
 	FMaterialRelevance GetMaterialRelevance(ERHIFeatureLevel::Type InFeatureLevel) const;	
 	
 private:
+	bool NeedsSceneProxy() const;
+	// Returns false if the scene proxy needs to be recreated instead
+	bool StreamSectionsToSceneProxy();
+
 	void UpdatePhysicalMaterials();
 	void UpdateLocalBounds();
 	void UpdateNavigation();
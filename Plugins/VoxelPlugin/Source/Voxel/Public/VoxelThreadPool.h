@@ -6,10 +6,10 @@
 #include "HAL/PlatformAffinity.h"
 #include "HAL/ThreadSafeBool.h"
 #include "VoxelMinimal.h"
-#include <queue>
 
 class IVoxelQueuedWork;
 class FVoxelQueuedThread;
+class FVoxelWorkStealingQueue;
 
 class VOXEL_API FVoxelQueuedThreadPoolStats
 {
@@ -26,6 +26,16 @@ private:
 	TMap<FName, double> Times;
 };
 
+enum class EVoxelQueuedThreadPoolScheduler : uint8
+{
+	// All the works are in a single queue behind a single lock: priorities are exact, but all the threads contend on that lock
+	GlobalQueue,
+	// Every thread has its own queue, bucketed by priority category, and idle threads steal from the others
+	// Priority categories are respected across threads. Priorities within a category are exact per thread only,
+	// as queued works are spread across the threads
+	WorkStealing
+};
+
 struct VOXEL_API FVoxelQueuedThreadPoolSettings
 {
 	const FString PoolName;
@@ -33,13 +43,15 @@ struct VOXEL_API FVoxelQueuedThreadPoolSettings
 	const uint32 StackSize;
 	const EThreadPriority ThreadPriority;
 	const bool bConstantPriorities;
+	const EVoxelQueuedThreadPoolScheduler Scheduler;
 
 	FVoxelQueuedThreadPoolSettings(
 		const FString& PoolName, 
 		uint32 NumThreads, 
 		uint32 StackSize, 
 		EThreadPriority ThreadPriority, 
-		bool bConstantPriorities);
+		bool bConstantPriorities,
+		EVoxelQueuedThreadPoolScheduler Scheduler = EVoxelQueuedThreadPoolScheduler::GlobalQueue);
 };
 
 class VOXEL_API FVoxelQueuedThreadPool : public TVoxelSharedFromThis<FVoxelQueuedThreadPool>
@@ -54,7 +66,11 @@ public:
 	{
 		// Not really thread safe, only use this for debug
 		// Also count active threads
-		return (Settings.bConstantPriorities ? StaticQueuedWorks.size() : QueuedWorks.Num()) + GetNumThreads() - QueuedThreads.Num();
+		const int32 NumQueuedWorks =
+			Settings.Scheduler == EVoxelQueuedThreadPoolScheduler::WorkStealing
+			? NumWorkStealingQueuedWorks.GetValue()
+			: QueuedWorks.Num();
+		return NumQueuedWorks + GetNumThreads() - QueuedThreads.Num();
 	}
 	int32 GetNumThreads() const
 	{
@@ -73,8 +89,12 @@ public:
 private:
 	explicit FVoxelQueuedThreadPool(const FVoxelQueuedThreadPoolSettings& Settings);
 
+	// One per thread, only used by EVoxelQueuedThreadPoolScheduler::WorkStealing
+	// Must be created before the threads
+	const TArray<TUniquePtr<FVoxelWorkStealingQueue>> WorkStealingQueues;
 	const TArray<TUniquePtr<FVoxelQueuedThread>> AllThreads;
 
+	// With WorkStealing, only locked when threads go idle & to wake them up
 	FCriticalSection Section;
 	TArray<FVoxelQueuedThread*> QueuedThreads;
 
@@ -82,6 +102,8 @@ private:
 	{
 		IVoxelQueuedWork* Work;
 		double NextPriorityUpdateTime;
+		// FVoxelInvokersMovement stamp when the priority was computed
+		uint64 PriorityStamp;
 		uint32 PriorityCategory;
 		uint32 Priority;
 		int32 PriorityOffset;
@@ -93,6 +115,7 @@ private:
 			int32 PriorityOffset)
 			: Work(Work)
 			, NextPriorityUpdateTime(0)
+			, PriorityStamp(0)
 			, PriorityCategory(PriorityCategory)
 			, Priority(0)
 			, PriorityOffset(PriorityOffset)
@@ -110,8 +133,64 @@ private:
 			return GetPriority() < Other.GetPriority();
 		}
 	};
-	TArray<FQueuedWorkInfo> QueuedWorks;
-	std::priority_queue<FQueuedWorkInfo> StaticQueuedWorks;
+
+	// Works popped by decreasing priority. Not thread safe
+	// With constant priorities, this is a heap
+	// Else, works with an invoker distance priority (see IVoxelQueuedWork::HasInvokerDistancePriority) are bucketed in distance bands:
+	// when popping, only the bands that might contain the best work given how much the invokers moved are recomputed,
+	// and all the bands are rebuilt once the invokers moved by more than voxel.threading.PriorityRebuildDistance
+	// Other works are all recomputed every PriorityDuration
+	class FWorkQueue
+	{
+	public:
+		explicit FWorkQueue(bool bConstantPriorities)
+			: bConstantPriorities(bConstantPriorities)
+		{
+		}
+
+		FORCEINLINE int32 Num() const
+		{
+			return Works.Num() + NewWorks.Num() + NumBandedWorks;
+		}
+
+		void Add(FQueuedWorkInfo WorkInfo, double Time);
+		IVoxelQueuedWork* Pop();
+		// Best priority among the ones already computed, without recomputing any. Num() must be > 0
+		uint64 GetTopCachedPriority() const;
+		// Returns the number of works abandoned
+		int32 AbandonAll();
+
+	private:
+		bool bConstantPriorities;
+
+		// With constant priorities, a heap with all the works
+		// Else, the works without an invoker distance priority
+		TArray<FQueuedWorkInfo> Works;
+
+		// Works with an invoker distance priority not yet computed
+		TArray<FQueuedWorkInfo> NewWorks;
+		// Works with an invoker distance priority, by GetBandKey
+		TMap<uint64, TArray<FQueuedWorkInfo>> Bands;
+		// Keys of Bands, by decreasing priority
+		TArray<uint64> BandKeys;
+		int32 NumBandedWorks = 0;
+		// All the banded priorities were computed after this FVoxelInvokersMovement stamp
+		uint64 BandsStamp = 0;
+
+		void AddToBand(const FQueuedWorkInfo& WorkInfo);
+		void RebuildBands(double Time);
+	};
+	FWorkQueue QueuedWorks;
+
+	// Works in all the WorkStealingQueues
+	FThreadSafeCounter NumWorkStealingQueuedWorks;
+	// Round robin used to spread the works across the WorkStealingQueues
+	uint32 NextWorkStealingQueue = 0;
 	
 	FThreadSafeBool TimeToDie = false;
+
+	IVoxelQueuedWork* GetNextJob_WorkStealing(FVoxelQueuedThread& Thread);
+	void AddQueuedWorks_WorkStealing(TArrayView<IVoxelQueuedWork* const> InQueuedWorks, uint32 PriorityCategory, int32 PriorityOffset);
+
+	friend class FVoxelWorkStealingQueue;
 };
\ No newline at end of file
@@ -767,7 +767,7 @@ void FVoxelSphereToolsImpl::RevertSphereToGenerator(TData& InData, const FVoxelV
 			}
 
 			TVoxelStaticArray<Type, VOXELS_PER_DATA_CHUNK> Values;
-			TVoxelQueryZone<Type> QueryZone(Leaf.GetBounds(), Values);
+			TVoxelQueryZone<Type> QueryZone = TVoxelQueryZone<Type>::ForDataChunk(Leaf.GetBounds(), Values.GetData());
 			Leaf.GetFromGeneratorAndAssets<Type>(*Data.Generator, QueryZone, 0);
 
 			const FIntVector Min = Leaf.GetMin();
@@ -291,6 +291,32 @@ public:
 		const FVoxelCompressedWorldSaveImpl& Save, 
 		const TArray<FVoxelObjectArchiveEntry>& Objects);
 
+	/**
+	 * Write a save of the world split in regions to a file, that can then be loaded lazily with LoadFromRegionSaveFile
+	 * @param	World			The voxel world
+	 * @param	Path			The file to write
+	 * @param	RegionDepth		Regions are 16 << RegionDepth voxels wide. Small regions are loaded faster, big ones compress better
+	 * @return	If the file was written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Data", meta = (DefaultToSelf = "World"))
+	static bool SaveToRegionSaveFile(
+		AVoxelWorld* World,
+		const FString& Path,
+		int32 RegionDepth = 4);
+	
+	/**
+	 * Load from a region save file. Only the regions close to the invokers are loaded right away,
+	 * the other ones are loaded as the invokers get close to them (see voxel.data.RegionSaveLoadDistance)
+	 * Edits done in a region before it is loaded are kept. Getting a save of the world loads all the regions
+	 * @param	World			The voxel world
+	 * @param	Path			The file written by SaveToRegionSaveFile
+	 * @return	If the load was successful
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Data", meta = (DefaultToSelf = "World"))
+	static bool LoadFromRegionSaveFile(
+		AVoxelWorld* World,
+		const FString& Path);
+
 public:
 	// Bounds.Extend(2) must be locked!
 	// Bounds can be FVoxelIntBox::Infinite
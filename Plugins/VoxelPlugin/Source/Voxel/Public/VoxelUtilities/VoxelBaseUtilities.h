@@ -302,6 +302,35 @@ namespace FVoxelUtilities
 		return (((Value + (Value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
 	}
 
+	// Inserts two zeros between each of the 10 low bits of Value
+	FORCEINLINE constexpr uint32 MortonSpread3(uint32 Value)
+	{
+		Value &= 0x000003FF;
+		Value = (Value | (Value << 16)) & 0x030000FF;
+		Value = (Value | (Value <<  8)) & 0x0300F00F;
+		Value = (Value | (Value <<  4)) & 0x030C30C3;
+		Value = (Value | (Value <<  2)) & 0x09249249;
+		return Value;
+	}
+	FORCEINLINE constexpr uint32 MortonCompact3(uint32 Value)
+	{
+		Value &= 0x09249249;
+		Value = (Value ^ (Value >>  2)) & 0x030C30C3;
+		Value = (Value ^ (Value >>  4)) & 0x0300F00F;
+		Value = (Value ^ (Value >>  8)) & 0xFF0000FF;
+		Value = (Value ^ (Value >> 16)) & 0x000003FF;
+		return Value;
+	}
+	// Z-order index, X being the lowest bit. Coordinates must be < 1024
+	FORCEINLINE constexpr uint32 MortonEncode3D(uint32 X, uint32 Y, uint32 Z)
+	{
+		return MortonSpread3(X) | (MortonSpread3(Y) << 1) | (MortonSpread3(Z) << 2);
+	}
+	FORCEINLINE FIntVector MortonDecode3D(uint32 Index)
+	{
+		return FIntVector(MortonCompact3(Index), MortonCompact3(Index >> 1), MortonCompact3(Index >> 2));
+	}
+
 	// Returns distance to voxel with Density
 	FORCEINLINE float GetAbsDistanceFromDensities(float Density, float OtherDensity)
 	{
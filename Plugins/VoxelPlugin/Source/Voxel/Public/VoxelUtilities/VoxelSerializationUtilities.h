@@ -47,6 +47,21 @@ namespace EVoxelCompressionLevel
 	};
 }
 
+namespace EVoxelCompressionCodec
+{
+	enum Type : uint8
+	{
+		// Uses the compression level
+		Zlib,
+		// Much faster, but compresses less. Ignores the compression level
+		LZ4,
+		// Ignores the compression level. Falls back to Zlib if the engine doesn't have it
+		Oodle,
+
+		Max
+	};
+}
+
 namespace FVoxelSerializationUtilities
 {
 	VOXEL_API void SerializeValues(FArchive& Archive, TNoGrowArray<FVoxelValue>& Values, uint32 ValueConfigFlag, FVoxelSerializationVersion::Type VoxelCustomVersion);
@@ -111,5 +126,25 @@ namespace FVoxelSerializationUtilities
 
 	VOXEL_API bool DecompressData(const TArray<uint8>& CompressedData, TArray64<uint8>& UncompressedData);
 
+	// Resolves EVoxelCompressionLevel::VoxelDefault to the voxel settings one
+	VOXEL_API int32 GetCompressionLevel(EVoxelCompressionLevel::Type CompressionLevel);
+	// Codec to use for Codec: falls back to Zlib if Codec is not available
+	VOXEL_API EVoxelCompressionCodec::Type GetAvailableCodec(EVoxelCompressionCodec::Type Codec);
+
+	// Compresses a single block, with no header: the codec and the uncompressed size need to be stored by the caller. Thread safe
+	VOXEL_API bool CompressBlock(
+		EVoxelCompressionCodec::Type Codec,
+		EVoxelCompressionLevel::Type CompressionLevel,
+		const uint8* UncompressedData,
+		int32 UncompressedSize,
+		TArray<uint8>& OutCompressedData);
+	// Thread safe. Returns false if the block is corrupted
+	VOXEL_API bool DecompressBlock(
+		EVoxelCompressionCodec::Type Codec,
+		const uint8* CompressedData,
+		int32 CompressedSize,
+		uint8* OutUncompressedData,
+		int32 UncompressedSize);
+
 	VOXEL_API void TestCompression(int64 Size, EVoxelCompressionLevel::Type CompressionLevel);
 }
\ No newline at end of file
@@ -41,6 +41,8 @@ class IVoxelSpawnerManager;
 class FVoxelMultiplayerManager;
 class FVoxelInstancedMeshManager;
 class FVoxelToolRenderingManager;
+class FVoxelRegionSaveLoader;
+class FVoxelRegionSaveStreamer;
 struct FVoxelLODDynamicSettings;
 struct FVoxelUncompressedWorldSave;
 struct FVoxelRendererDynamicSettings;
@@ -353,6 +355,13 @@ public:
 	// Visually, it will give a more "sharp" look, 1 being the sharpest, 2 3 etc being less and less sharp
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, UIMin = 0, UIMax = 10, ClampMin = 0))
 	int32 RenderSharpness = 0;
+
+	// For cubic only
+	// If true, adjacent faces with the same direction and material will be merged into bigger quads, greatly reducing the vertex and index counts, as well as the collision cooking time
+	// Only merges faces in Global UVs: in the other UV configs, the UVs are per voxel
+	// Can create T-junctions between the quads, which might show as small cracks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+	bool bGreedyCubicMeshing = false;
 	
 	// If true, a dynamic instance will be created for each chunk. Else, the material will be used directly
 	// Disable this if you want to use dynamic material instances as voxel world materials
@@ -387,7 +396,8 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
 	bool bStaticWorld = false;
 	
-	// If true, the mesh indices will be sorted to improve GPU cache performance. Adds a cost to the async mesh building. If you don't see any perf difference, leave it off
+	// If true, the triangles and vertices of the chunks will be reordered to improve GPU cache performance. Adds a small cost to the async mesh building
+	// Use the meshing benchmark to see the cache miss ratio before and after
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
 	bool bOptimizeIndices = false;
 
@@ -439,6 +449,12 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, EditCondition = "bMergeChunks"))
 	bool bDoNotMergeCollisionsAndNavmesh = true;
 
+	// If true, the merged chunks are drawn from a few large vertex & index buffers shared by all the clusters, instead of each cluster having its own buffers
+	// Rebuilding a cluster then only uploads the chunks that changed, and does not create new GPU buffers
+	// Not used when ray tracing is enabled. Use voxel.renderer.LogClusterBufferPools to see the pool usage
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, EditCondition = "bMergeChunks"))
+	bool bPoolClustersBuffers = false;
+
 	// Increases the chunks bounding boxes, useful when using tessellation
 	// Setting it to 0 can cause issues on flat worlds
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
@@ -593,6 +609,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, ClampMin = 0.001))
 	float MeshUpdatesBudget = 1000;
 
+	// Max size in kilobytes of the mesh buffers sent to the renderer per tick. 0 for no limit
+	// At least one mesh is updated per tick. Use this if many chunks finishing their update in the same frame lead to spikes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, ClampMin = 0))
+	int32 MeshUpdatesSizeBudget = 0;
+
+	// If true, the new sections of meshes that are already rendered will be sent to their existing scene proxy,
+	// instead of recreating the proxy on every update. Much cheaper on the game thread when lots of chunks are updated at once
+	// The proxy is still recreated if the materials of the mesh changed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender))
+	bool bStreamMeshUpdates = false;
+
 	// The rate at which events are fired (number of updates per seconds). Used for foliage spawning, foliage collision, binded BP events...
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, UIMin = 1, UIMax = 60))
 	float EventsTickRate = 15;
@@ -648,6 +675,9 @@ public:
 	
 	FVoxelIntBox GetWorldBounds() const;
 	FIntVector GetWorldOffset() const { return *WorldOffset; }
+
+	// Loads the regions of a region save as the invokers get close to them. Loader must be the region save loader of the data
+	void StreamRegionSave(const TVoxelSharedRef<FVoxelRegionSaveLoader>& Loader);
 	
 public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel|General")
@@ -801,6 +831,7 @@ private:
 	TVoxelSharedPtr<IVoxelLODManager> LODManager;
 	TVoxelSharedPtr<FVoxelEventManager> EventManager;
 	TVoxelSharedPtr<FVoxelToolRenderingManager> ToolRenderingManager;
+	TVoxelSharedPtr<FVoxelRegionSaveStreamer> RegionSaveStreamer;
 
 	TVoxelSharedRef<FIntVector> WorldOffset = MakeVoxelShared<FIntVector>(FIntVector::ZeroValue);
 	TVoxelSharedRef<FVoxelLODDynamicSettings> LODDynamicSettings = TVoxelSharedPtr<FVoxelLODDynamicSettings>().ToSharedRef(); // else the VTABLE constructor doesn't compile...
@@ -71,10 +71,6 @@ public class Voxel : ModuleRules
 
         SetupModulePhysicsSupport(Target);
 
-        if (Target.Platform == UnrealTargetPlatform.Win64)
-        {
-            PrivateDependencyModuleNames.Add("ForsythTriOptimizer");
-        }
         PrivateDependencyModuleNames.Add("zlib");
 
         if (Target.Configuration == UnrealTargetConfiguration.DebugGame ||
@@ -0,0 +1,648 @@
+// Copyright 2020 Phyronnaz
+
+#include "MyVoxelPlanetMap.h"
+#include "VoxelUtilities/VoxelBaseUtilities.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Planet Maps Memory"), STAT_MyVoxelPlanetMapMemory, STATGROUP_VoxelMemory, );
+DEFINE_VOXEL_MEMORY_STAT(STAT_MyVoxelPlanetMapMemory);
+
+namespace FMyVoxelPlanetMapImpl
+{
+	static FCriticalSection CacheSection;
+	static TMap<FString, TVoxelWeakPtr<const FMyVoxelPlanetMap>> Cache;
+
+	int64 GetHeaderSize(uint32 Version)
+	{
+		// Layout & TileSize were added at the end of the header
+		return Version == FMyVoxelPlanetMapVersion::Initial ? STRUCT_OFFSET(FMyVoxelPlanetMapHeader, Layout) : sizeof(FMyVoxelPlanetMapHeader);
+	}
+
+	int64 GetMipsLayout(const FMyVoxelPlanetMapHeader& Header, int32 NumMips, uint64 OutOffsets[FMyVoxelPlanetMapHeader::MaxMips])
+	{
+		const int32 TypeSize = FMyVoxelPlanetMap::GetValueTypeSize(EMyVoxelPlanetMapValueType::Type(Header.ValueType));
+		const int64 NumFaces = Header.Layout == EMyVoxelPlanetMapLayout::CubeTiled ? 6 : 1;
+
+		int64 Offset = Align(GetHeaderSize(Header.Version), 16);
+		for (int32 Mip = 0; Mip < NumMips; Mip++)
+		{
+			const int64 SizeX = FMath::Max(1, Header.SizeX >> Mip);
+			const int64 SizeY = FMath::Max(1, Header.SizeY >> Mip);
+			OutOffsets[Mip] = Offset;
+			Offset = Align(Offset + NumFaces * SizeX * SizeY * TypeSize, 16);
+		}
+		return Offset;
+	}
+
+	bool IsHeaderValid(const FMyVoxelPlanetMapHeader& Header, int64 FileSize, const FString& Path)
+	{
+		if (FileSize < int64(sizeof(FMyVoxelPlanetMapHeader)) || Header.Magic != FMyVoxelPlanetMapHeader::MagicValue)
+		{
+			LOG_VOXEL(Error, TEXT("%s is not a planet map"), *Path);
+			return false;
+		}
+		if (Header.Version < FMyVoxelPlanetMapVersion::Initial || Header.Version > FMyVoxelPlanetMapVersion::LatestVersion)
+		{
+			LOG_VOXEL(Error, TEXT("%s: unsupported planet map version %u (expected %u). Please convert it again"), *Path, Header.Version, uint32(FMyVoxelPlanetMapVersion::LatestVersion));
+			return false;
+		}
+		if (Header.ValueType > EMyVoxelPlanetMapValueType::Float ||
+			Header.NumMips <= 0 || Header.NumMips > FMyVoxelPlanetMapHeader::MaxMips ||
+			Header.SizeX <= 0 || Header.SizeY <= 0)
+		{
+			LOG_VOXEL(Error, TEXT("%s: corrupted planet map header"), *Path);
+			return false;
+		}
+		if (Header.Layout == EMyVoxelPlanetMapLayout::CubeTiled &&
+			(Header.NumMips != 1 || Header.SizeX != Header.SizeY || !FMath::IsPowerOfTwo(Header.TileSize) || Header.SizeX % Header.TileSize != 0))
+		{
+			LOG_VOXEL(Error, TEXT("%s: corrupted cube planet map header"), *Path);
+			return false;
+		}
+		if (Header.Layout > EMyVoxelPlanetMapLayout::CubeTiled)
+		{
+			LOG_VOXEL(Error, TEXT("%s: unknown planet map layout %u"), *Path, Header.Layout);
+			return false;
+		}
+
+		uint64 Offsets[FMyVoxelPlanetMapHeader::MaxMips];
+		const int64 ExpectedSize = GetMipsLayout(Header, Header.NumMips, Offsets);
+		if (FileSize < ExpectedSize || FMemory::Memcmp(Offsets, Header.MipOffsets, Header.NumMips * sizeof(uint64)) != 0)
+		{
+			LOG_VOXEL(Error, TEXT("%s: truncated or corrupted planet map (size %lld, expected %lld)"), *Path, FileSize, ExpectedSize);
+			return false;
+		}
+		return true;
+	}
+
+	template<typename T>
+	void Downsample(const T* RESTRICT Src, int32 SrcSizeX, int32 SrcSizeY, T* RESTRICT Dst, int32 DstSizeX, int32 DstSizeY)
+	{
+		for (int32 X = 0; X < DstSizeX; X++)
+		{
+			const int32 X0 = FMath::Min(2 * X, SrcSizeX - 1);
+			const int32 X1 = FMath::Min(2 * X + 1, SrcSizeX - 1);
+			for (int32 Y = 0; Y < DstSizeY; Y++)
+			{
+				const int32 Y0 = FMath::Min(2 * Y, SrcSizeY - 1);
+				const int32 Y1 = FMath::Min(2 * Y + 1, SrcSizeY - 1);
+				const double Sum =
+					double(Src[int64(X0) * SrcSizeY + Y0]) +
+					double(Src[int64(X1) * SrcSizeY + Y0]) +
+					double(Src[int64(X0) * SrcSizeY + Y1]) +
+					double(Src[int64(X1) * SrcSizeY + Y1]);
+				Dst[int64(X) * DstSizeY + Y] = TIsFloatingPoint<T>::Value ? T(Sum / 4) : T(FMath::RoundToDouble(Sum / 4));
+			}
+		}
+	}
+
+	FORCEINLINE bool IsWhitespace(uint8 Char)
+	{
+		return Char == ' ' || Char == '\n' || Char == '\r' || Char == '\t';
+	}
+
+	// Minimal integer parser: much faster than std::getline + std::stoi
+	FORCEINLINE bool ParseInt(const uint8*& Ptr, const uint8* End, int64& OutValue)
+	{
+		while (Ptr < End && IsWhitespace(*Ptr))
+		{
+			Ptr++;
+		}
+		if (Ptr == End)
+		{
+			return false;
+		}
+
+		bool bNegative = false;
+		if (*Ptr == '-' || *Ptr == '+')
+		{
+			bNegative = *Ptr == '-';
+			Ptr++;
+		}
+
+		const uint8* Start = Ptr;
+		int64 Value = 0;
+		while (Ptr < End && '0' <= *Ptr && *Ptr <= '9')
+		{
+			Value = Value * 10 + (*Ptr - '0');
+			Ptr++;
+		}
+		// Skip any decimal part
+		while (Ptr < End && !IsWhitespace(*Ptr))
+		{
+			Ptr++;
+		}
+
+		OutValue = bNegative ? -Value : Value;
+		return Ptr != Start;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FMyVoxelPlanetMap::~FMyVoxelPlanetMap()
+{
+	// Region must be released before its handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_MyVoxelPlanetMapMemory, AllocatedSize);
+}
+
+TVoxelSharedPtr<const FMyVoxelPlanetMap> FMyVoxelPlanetMap::LoadBinary(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FScopeLock Lock(&FMyVoxelPlanetMapImpl::CacheSection);
+
+	if (const TVoxelWeakPtr<const FMyVoxelPlanetMap>* CachedMap = FMyVoxelPlanetMapImpl::Cache.Find(Path))
+	{
+		if (TVoxelSharedPtr<const FMyVoxelPlanetMap> Map = CachedMap->Pin())
+		{
+			return Map;
+		}
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return nullptr;
+	}
+
+	const TVoxelSharedRef<FMyVoxelPlanetMap> Map = MakeVoxelShared<FMyVoxelPlanetMap>();
+
+	const uint8* FileData = nullptr;
+	int64 FileSize = 0;
+
+	Map->MappedHandle = TUniquePtr<IMappedFileHandle>(PlatformFile.OpenMapped(*Path));
+	if (Map->MappedHandle.IsValid())
+	{
+		FileSize = Map->MappedHandle->GetFileSize();
+		Map->MappedRegion = TUniquePtr<IMappedFileRegion>(Map->MappedHandle->MapRegion(0, FileSize));
+	}
+
+	if (Map->MappedRegion.IsValid())
+	{
+		FileData = Map->MappedRegion->GetMappedPtr();
+	}
+	else
+	{
+		// Platform without memory mapping support: read it instead
+		Map->MappedHandle.Reset();
+		if (!FFileHelper::LoadFileToArray(Map->OwnedData, *Path))
+		{
+			LOG_VOXEL(Error, TEXT("Failed to read planet map %s"), *Path);
+			return nullptr;
+		}
+		FileData = Map->OwnedData.GetData();
+		FileSize = Map->OwnedData.Num();
+		Map->UpdateStats();
+	}
+
+	if (FileSize >= FMyVoxelPlanetMapImpl::GetHeaderSize(FMyVoxelPlanetMapVersion::Initial))
+	{
+		FMemory::Memcpy(&Map->Header, FileData, FMyVoxelPlanetMapImpl::GetHeaderSize(FMyVoxelPlanetMapVersion::Initial));
+		if (Map->Header.Version != FMyVoxelPlanetMapVersion::Initial && FileSize >= int64(sizeof(FMyVoxelPlanetMapHeader)))
+		{
+			FMemory::Memcpy(&Map->Header, FileData, sizeof(FMyVoxelPlanetMapHeader));
+		}
+	}
+	if (!FMyVoxelPlanetMapImpl::IsHeaderValid(Map->Header, FileSize, Path))
+	{
+		return nullptr;
+	}
+
+	Map->UpdateMips(FileData);
+
+	LOG_VOXEL(Log, TEXT("Loaded planet map %s: %dx%d, %d mips%s"),
+		*Path,
+		Map->Header.SizeX,
+		Map->Header.SizeY,
+		Map->Header.NumMips,
+		Map->IsMemoryMapped() ? TEXT(", memory-mapped") : TEXT(""));
+
+	FMyVoxelPlanetMapImpl::Cache.Add(Path, Map);
+	return Map;
+}
+
+TVoxelSharedPtr<FMyVoxelPlanetMap> FMyVoxelPlanetMap::LoadText(const FString& Path, EMyVoxelPlanetMapValueType::Type ValueType)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	TArray64<uint8> Text;
+	if (!FFileHelper::LoadFileToArray(Text, *Path, FILEREAD_Silent))
+	{
+		return nullptr;
+	}
+
+	const uint8* Ptr = Text.GetData();
+	const uint8* End = Ptr + Text.Num();
+
+	int64 SizeX = 0;
+	int64 SizeY = 0;
+	if (!FMyVoxelPlanetMapImpl::ParseInt(Ptr, End, SizeX) ||
+		!FMyVoxelPlanetMapImpl::ParseInt(Ptr, End, SizeY) ||
+		SizeX <= 0 || SizeY <= 0 || SizeX > MAX_int32 || SizeY > MAX_int32)
+	{
+		LOG_VOXEL(Error, TEXT("%s: invalid text planet map header"), *Path);
+		return nullptr;
+	}
+
+	const TVoxelSharedRef<FMyVoxelPlanetMap> Map = MakeVoxelShared<FMyVoxelPlanetMap>();
+	Map->Header.ValueType = ValueType;
+	Map->Header.SizeX = SizeX;
+	Map->Header.SizeY = SizeY;
+	Map->Header.NumMips = 1;
+	Map->OwnedData.SetNumZeroed(FMyVoxelPlanetMapImpl::GetMipsLayout(Map->Header, 1, Map->Header.MipOffsets));
+
+	int64 MinValue = MAX_int64;
+	int64 MaxValue = MIN_int64;
+
+	uint8* const Data = Map->OwnedData.GetData() + Map->Header.MipOffsets[0];
+	const int64 Num = SizeX * SizeY;
+	for (int64 Index = 0; Index < Num; Index++)
+	{
+		int64 Value = 0;
+		if (!FMyVoxelPlanetMapImpl::ParseInt(Ptr, End, Value))
+		{
+			LOG_VOXEL(Error, TEXT("%s: expected %lld values, found %lld"), *Path, Num, Index);
+			return nullptr;
+		}
+
+		MinValue = FMath::Min(MinValue, Value);
+		MaxValue = FMath::Max(MaxValue, Value);
+
+		switch (ValueType)
+		{
+		case EMyVoxelPlanetMapValueType::Int16: reinterpret_cast<int16*>(Data)[Index] = FMath::Clamp<int64>(Value, MIN_int16, MAX_int16); break;
+		case EMyVoxelPlanetMapValueType::Int32: reinterpret_cast<int32*>(Data)[Index] = FMath::Clamp<int64>(Value, MIN_int32, MAX_int32); break;
+		case EMyVoxelPlanetMapValueType::Float: reinterpret_cast<float*>(Data)[Index] = Value; break;
+		default: ensure(false);
+		}
+	}
+
+	if (ValueType == EMyVoxelPlanetMapValueType::Int16 && (MinValue < MIN_int16 || MaxValue > MAX_int16))
+	{
+		LOG_VOXEL(Warning, TEXT("%s: values in [%lld, %lld] do not fit in int16 and have been clamped"), *Path, MinValue, MaxValue);
+	}
+
+	Map->Header.MinValue = MinValue;
+	Map->Header.MaxValue = MaxValue;
+	Map->UpdateMips(Map->OwnedData.GetData());
+	Map->UpdateStats();
+
+	return Map;
+}
+
+TVoxelSharedPtr<FMyVoxelPlanetMap> FMyVoxelPlanetMap::CreateCubeMap(int32 FaceSize, int32 TileSize, EMyVoxelPlanetMapValueType::Type ValueType, TFunctionRef<float(const FVector3f& Direction)> SampleDirection)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!ensure(FMath::IsPowerOfTwo(TileSize) && FaceSize > 0 && FaceSize % TileSize == 0))
+	{
+		return nullptr;
+	}
+
+	const TVoxelSharedRef<FMyVoxelPlanetMap> Map = MakeVoxelShared<FMyVoxelPlanetMap>();
+	Map->Header.ValueType = ValueType;
+	Map->Header.Layout = EMyVoxelPlanetMapLayout::CubeTiled;
+	Map->Header.TileSize = TileSize;
+	Map->Header.SizeX = FaceSize;
+	Map->Header.SizeY = FaceSize;
+	Map->Header.NumMips = 1;
+	Map->OwnedData.SetNumZeroed(FMyVoxelPlanetMapImpl::GetMipsLayout(Map->Header, 1, Map->Header.MipOffsets));
+	Map->UpdateMips(Map->OwnedData.GetData());
+
+	uint8* const Data = Map->OwnedData.GetData() + Map->Header.MipOffsets[0];
+
+	TArray<TVoxelRange<float>> RowRanges;
+	RowRanges.SetNumUninitialized(6 * FaceSize);
+
+	ParallelFor(6 * FaceSize, [&](int32 RowIndex)
+	{
+		const int32 Face = RowIndex / FaceSize;
+		const int32 Y = RowIndex % FaceSize;
+
+		float Min = PositiveInfinity<float>();
+		float Max = NegativeInfinity<float>();
+
+		for (int32 X = 0; X < FaceSize; X++)
+		{
+			const float Value = SampleDirection(FaceToDirection(Face, X, Y, FaceSize));
+			Min = FMath::Min(Min, Value);
+			Max = FMath::Max(Max, Value);
+
+			const int64 Index = Map->GetCubeIndex(Face, X, Y);
+			switch (ValueType)
+			{
+			case EMyVoxelPlanetMapValueType::Int16: reinterpret_cast<int16*>(Data)[Index] = FMath::Clamp<int32>(FMath::RoundToInt(Value), MIN_int16, MAX_int16); break;
+			case EMyVoxelPlanetMapValueType::Int32: reinterpret_cast<int32*>(Data)[Index] = FMath::RoundToInt(Value); break;
+			case EMyVoxelPlanetMapValueType::Float: reinterpret_cast<float*>(Data)[Index] = Value; break;
+			default: ensure(false);
+			}
+		}
+
+		RowRanges[RowIndex] = { Min, Max };
+	});
+
+	TVoxelRange<float> Range = RowRanges[0];
+	for (const TVoxelRange<float>& RowRange : RowRanges)
+	{
+		Range = TVoxelRange<float>::Union(Range, RowRange);
+	}
+	Map->Header.MinValue = Range.Min;
+	Map->Header.MaxValue = Range.Max;
+	Map->UpdateStats();
+
+	return Map;
+}
+
+bool FMyVoxelPlanetMap::ConvertTextToBinary(const FString& TextPath, const FString& BinaryPath, EMyVoxelPlanetMapValueType::Type ValueType, int32 NumMips)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TVoxelSharedPtr<FMyVoxelPlanetMap> Map = LoadText(TextPath, ValueType);
+	if (!Map)
+	{
+		LOG_VOXEL(Error, TEXT("Failed to convert %s: could not read it"), *TextPath);
+		return false;
+	}
+
+	Map->BuildMips(NumMips);
+	if (!Map->SaveBinary(BinaryPath))
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write %s"), *BinaryPath);
+		return false;
+	}
+
+	Invalidate(BinaryPath);
+
+	LOG_VOXEL(Log, TEXT("Converted %s to %s (%d mips)"), *TextPath, *BinaryPath, Map->GetNumMips());
+	return true;
+}
+
+void FMyVoxelPlanetMap::Invalidate(const FString& Path)
+{
+	FScopeLock Lock(&FMyVoxelPlanetMapImpl::CacheSection);
+	FMyVoxelPlanetMapImpl::Cache.Remove(Path);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FMyVoxelPlanetMap::BuildMips(int32 NumMips)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!ensure(!IsMemoryMapped() && !IsCubeMap() && OwnedData.Num() > 0))
+	{
+		return;
+	}
+
+	int32 MaxNumMips = 1;
+	while (MaxNumMips < FMyVoxelPlanetMapHeader::MaxMips && ((Header.SizeX >> MaxNumMips) > 0 || (Header.SizeY >> MaxNumMips) > 0))
+	{
+		MaxNumMips++;
+	}
+	NumMips = FMath::Clamp(NumMips, 1, MaxNumMips);
+
+	FMyVoxelPlanetMapHeader NewHeader = Header;
+	NewHeader.NumMips = NumMips;
+
+	TArray64<uint8> NewData;
+	NewData.SetNumZeroed(FMyVoxelPlanetMapImpl::GetMipsLayout(NewHeader, NumMips, NewHeader.MipOffsets));
+
+	const int32 TypeSize = GetValueTypeSize(GetValueType());
+	FMemory::Memcpy(
+		NewData.GetData() + NewHeader.MipOffsets[0],
+		OwnedData.GetData() + Header.MipOffsets[0],
+		int64(Header.SizeX) * Header.SizeY * TypeSize);
+
+	for (int32 Mip = 1; Mip < NumMips; Mip++)
+	{
+		const int32 SrcSizeX = FMath::Max(1, Header.SizeX >> (Mip - 1));
+		const int32 SrcSizeY = FMath::Max(1, Header.SizeY >> (Mip - 1));
+		const int32 DstSizeX = FMath::Max(1, Header.SizeX >> Mip);
+		const int32 DstSizeY = FMath::Max(1, Header.SizeY >> Mip);
+
+		uint8* Src = NewData.GetData() + NewHeader.MipOffsets[Mip - 1];
+		uint8* Dst = NewData.GetData() + NewHeader.MipOffsets[Mip];
+
+		switch (GetValueType())
+		{
+		case EMyVoxelPlanetMapValueType::Int16: FMyVoxelPlanetMapImpl::Downsample(reinterpret_cast<int16*>(Src), SrcSizeX, SrcSizeY, reinterpret_cast<int16*>(Dst), DstSizeX, DstSizeY); break;
+		case EMyVoxelPlanetMapValueType::Int32: FMyVoxelPlanetMapImpl::Downsample(reinterpret_cast<int32*>(Src), SrcSizeX, SrcSizeY, reinterpret_cast<int32*>(Dst), DstSizeX, DstSizeY); break;
+		case EMyVoxelPlanetMapValueType::Float: FMyVoxelPlanetMapImpl::Downsample(reinterpret_cast<float*>(Src), SrcSizeX, SrcSizeY, reinterpret_cast<float*>(Dst), DstSizeX, DstSizeY); break;
+		default: ensure(false);
+		}
+	}
+
+	Header = NewHeader;
+	OwnedData = MoveTemp(NewData);
+	UpdateMips(OwnedData.GetData());
+	UpdateStats();
+}
+
+bool FMyVoxelPlanetMap::SaveBinary(const FString& Path) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!ensure(!IsMemoryMapped() && OwnedData.Num() >= int64(sizeof(FMyVoxelPlanetMapHeader))))
+	{
+		return false;
+	}
+
+	// OwnedData already has the file layout, only the header needs to be written in
+	TArray64<uint8> FileData = OwnedData;
+	FMemory::Memcpy(FileData.GetData(), &Header, sizeof(FMyVoxelPlanetMapHeader));
+
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(Path));
+	return FFileHelper::SaveArrayToFile(FileData, *Path);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FMyVoxelPlanetMap::UpdateMips(const uint8* FileData)
+{
+	Mips.Reset();
+	for (int32 Mip = 0; Mip < Header.NumMips; Mip++)
+	{
+		FMip& MipData = Mips.Emplace_GetRef();
+		MipData.SizeX = FMath::Max(1, Header.SizeX >> Mip);
+		MipData.SizeY = FMath::Max(1, Header.SizeY >> Mip);
+		MipData.Data = FileData + Header.MipOffsets[Mip];
+	}
+
+	if (IsCubeMap())
+	{
+		TileShift = FMath::FloorLog2(Header.TileSize);
+		TileMask = Header.TileSize - 1;
+		TilesPerSide = Header.SizeX / Header.TileSize;
+	}
+}
+
+void FMyVoxelPlanetMap::UpdateStats()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_MyVoxelPlanetMapMemory, AllocatedSize);
+	AllocatedSize = OwnedData.GetAllocatedSize();
+	INC_VOXEL_MEMORY_STAT_BY(STAT_MyVoxelPlanetMapMemory, AllocatedSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FMyVoxelPlanetMapRanges::FMyVoxelPlanetMapRanges(const FMyVoxelPlanetMap& Map)
+	: SizeX(Map.GetSizeX())
+	, SizeY(Map.GetSizeY())
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	check(SizeX > 0 && SizeY > 0);
+	ensure(!Map.IsCubeMap());
+
+	{
+		FLevel& Level = Levels.Emplace_GetRef();
+		Level.Shift = BaseCellShift;
+		Level.SizeX = FVoxelUtilities::DivideCeil(SizeX, BaseCellSize);
+		Level.SizeY = FVoxelUtilities::DivideCeil(SizeY, BaseCellSize);
+		Level.Data.SetNumUninitialized(Level.SizeX * Level.SizeY);
+
+		const auto BuildLevel0 = [&](const auto* RESTRICT Texels)
+		{
+			for (int32 CellX = 0; CellX < Level.SizeX; CellX++)
+			{
+				for (int32 CellY = 0; CellY < Level.SizeY; CellY++)
+				{
+					float Min = PositiveInfinity<float>();
+					float Max = NegativeInfinity<float>();
+
+					const int32 EndX = FMath::Min((CellX + 1) << BaseCellShift, SizeX);
+					const int32 EndY = FMath::Min((CellY + 1) << BaseCellShift, SizeY);
+					for (int32 X = CellX << BaseCellShift; X < EndX; X++)
+					{
+						for (int32 Y = CellY << BaseCellShift; Y < EndY; Y++)
+						{
+							const float Value = Texels[int64(X) * SizeY + Y];
+							Min = FMath::Min(Min, Value);
+							Max = FMath::Max(Max, Value);
+						}
+					}
+
+					Level.Data[CellX * Level.SizeY + CellY] = { Min, Max };
+				}
+			}
+		};
+
+		switch (Map.GetValueType())
+		{
+		case EMyVoxelPlanetMapValueType::Int16: BuildLevel0(Map.GetRawData<int16>()); break;
+		case EMyVoxelPlanetMapValueType::Int32: BuildLevel0(Map.GetRawData<int32>()); break;
+		case EMyVoxelPlanetMapValueType::Float: BuildLevel0(Map.GetRawData<float>()); break;
+		default: ensure(false);
+		}
+	}
+
+	while (Levels.Last().SizeX > 1 || Levels.Last().SizeY > 1)
+	{
+		const FLevel& Previous = Levels.Last();
+
+		FLevel Level;
+		Level.Shift = Previous.Shift + 1;
+		Level.SizeX = FVoxelUtilities::DivideCeil(Previous.SizeX, 2);
+		Level.SizeY = FVoxelUtilities::DivideCeil(Previous.SizeY, 2);
+		Level.Data.SetNumUninitialized(Level.SizeX * Level.SizeY);
+
+		for (int32 X = 0; X < Level.SizeX; X++)
+		{
+			for (int32 Y = 0; Y < Level.SizeY; Y++)
+			{
+				const int32 X0 = 2 * X;
+				const int32 Y0 = 2 * Y;
+				const int32 X1 = FMath::Min(2 * X + 1, Previous.SizeX - 1);
+				const int32 Y1 = FMath::Min(2 * Y + 1, Previous.SizeY - 1);
+				Level.Data[X * Level.SizeY + Y] = TVoxelRange<float>::Union(
+					Previous.Get(X0, Y0),
+					Previous.Get(X1, Y0),
+					Previous.Get(X0, Y1),
+					Previous.Get(X1, Y1));
+			}
+		}
+
+		Levels.Add(MoveTemp(Level));
+	}
+
+	for (const FLevel& Level : Levels)
+	{
+		AllocatedSize += Level.Data.GetAllocatedSize();
+	}
+	INC_VOXEL_MEMORY_STAT_BY(STAT_MyVoxelPlanetMapMemory, AllocatedSize);
+}
+
+FMyVoxelPlanetMapRanges::~FMyVoxelPlanetMapRanges()
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_MyVoxelPlanetMapMemory, AllocatedSize);
+}
+
+TVoxelRange<float> FMyVoxelPlanetMapRanges::GetRange(int32 MinX, int32 MaxX, int32 MinY, int32 MaxY) const
+{
+	MinX = FMath::Clamp(MinX, 0, SizeX - 1);
+	MaxX = FMath::Clamp(MaxX, 0, SizeX - 1);
+	MinY = FMath::Clamp(MinY, 0, SizeY - 1);
+	MaxY = FMath::Clamp(MaxY, 0, SizeY - 1);
+	ensureVoxelSlow(MinX <= MaxX && MinY <= MaxY);
+
+	// Find the first level where the query spans at most 4x4 cells
+	int32 LevelIndex = 0;
+	while (LevelIndex < Levels.Num() - 1)
+	{
+		const int32 Shift = Levels[LevelIndex].Shift;
+		if ((MaxX >> Shift) - (MinX >> Shift) < 4 &&
+			(MaxY >> Shift) - (MinY >> Shift) < 4)
+		{
+			break;
+		}
+		LevelIndex++;
+	}
+
+	const FLevel& Level = Levels[LevelIndex];
+
+	TVoxelRange<float> Range = Level.Get(MinX >> Level.Shift, MinY >> Level.Shift);
+	for (int32 X = MinX >> Level.Shift; X <= MaxX >> Level.Shift; X++)
+	{
+		for (int32 Y = MinY >> Level.Shift; Y <= MaxY >> Level.Shift; Y++)
+		{
+			Range = TVoxelRange<float>::Union(Range, Level.Get(X, Y));
+		}
+	}
+	return Range;
+}
+
+TVoxelRange<float> FMyVoxelPlanetMapRanges::GetRangeWrapX(int32 MinX, int32 MaxX, int32 MinY, int32 MaxY) const
+{
+	if (MaxX - MinX + 1 >= SizeX)
+	{
+		return GetRange(0, SizeX - 1, MinY, MaxY);
+	}
+
+	MinX = ((MinX % SizeX) + SizeX) % SizeX;
+	MaxX = ((MaxX % SizeX) + SizeX) % SizeX;
+	if (MinX <= MaxX)
+	{
+		return GetRange(MinX, MaxX, MinY, MaxY);
+	}
+
+	// Crossing the seam
+	return TVoxelRange<float>::Union(
+		GetRange(MinX, SizeX - 1, MinY, MaxY),
+		GetRange(0, MaxX, MinY, MaxY));
+}
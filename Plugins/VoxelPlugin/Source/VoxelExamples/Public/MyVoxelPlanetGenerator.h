@@ -14,6 +14,7 @@
 #include "Windows/WindowsWindow.h"
 #include <windows.h>
 #include "FastNoiseLite.h"
+#include "MyVoxelPlanetMap.h"
 #include "MyVoxelPlanetGenerator.generated.h"
 
 UCLASS(Blueprintable)
@@ -39,17 +40,41 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator")
         float Epsilon = 1;
 
+	// Binary planet map (.vpmap), memory-mapped and shared by every instance. If empty, map.vpmap next to the executable is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography")
+		FString TopographyMapPath;
+
+	// Legacy text map, only parsed if no binary map is found. Use ConvertTopographyToBinary to get rid of it. If empty, PlanetMaps/denoised.txt in the project content folder is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography")
+		FString TopographyTextPath;
+
+	// Binary biome map (.vpmap). If empty, biomes.vpmap next to the executable is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography")
+		FString BiomesMapPath;
+
+	// Number of mips written by ConvertTopographyToBinary
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography", meta = (ClampMin = 1, ClampMax = 16))
+		int32 TopographyMapNumMips = 8;
+
+	// Sample the topography from a tiled cube map instead of the equirectangular map: no trig per voxel, better locality
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography")
+		bool bUseCubeMapTopography = false;
+
+	// Cube map written by ConvertTopographyToCubeMap. If empty, map_cube.vpmap next to the executable is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography")
+		FString TopographyCubeMapPath;
+
+	// Size of each of the 6 faces of the cube map. Must be a multiple of 32
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generator|Topography", meta = (ClampMin = 32))
+		int32 TopographyCubeMapFaceSize = 4096;
 
 	UTexture2D* PlanetTopography = nullptr;
-	int* FormatedTopographyImageData = nullptr;
-	int* FormatedBiomesImageData = nullptr;
-	static int* StaticFormatedTopographyImageData;
-	static int* StaticFormatedBiomesImageData;
-    int gX, gY;
-	int gbX, gbY;
-	static int gsX, gsY;
-	static int gbsX, gbsY;
-	static bool dataPopulated;;
+	TVoxelSharedPtr<const FMyVoxelPlanetMap> TopographyMap;
+	TVoxelSharedPtr<const FMyVoxelPlanetMap> BiomesMap;
+	TVoxelSharedPtr<const FMyVoxelPlanetMapRanges> TopographyRanges;
+	TVoxelSharedPtr<const FMyVoxelPlanetMap> TopographyCubeMap;
+    int gX = 0, gY = 0;
+	int gbX = 0, gbY = 0;
 	TArray<float> Epsilons;
 	float SmoothingMethod = 1;
 	int SmoothSize = 3;
@@ -124,6 +149,19 @@ public:
 
 	UFUNCTION(BlueprintCallable, CallInEditor)
 	void ReloadPlanetTopography();
+
+	// Offline converter: writes TopographyTextPath as a binary map to the topography map path
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Generator|Topography")
+	void ConvertTopographyToBinary();
+
+	// One-time converter: resamples the current topography into a tiled cube map
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Generator|Topography")
+	void ConvertTopographyToCubeMap();
+
+	FString GetTopographyMapPath() const;
+	FString GetTopographyTextPath() const;
+	FString GetTopographyCubeMapPath() const;
+	FString GetBiomesMapPath() const;
 	//~ End UVoxelGenerator Interface
 };
 
@@ -142,17 +180,35 @@ public:
 
 	TVoxelRange<v_flt> GetValueRangeImpl(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const;
 
+	// Batched path: the spherical projection is done 4 voxels at a time along Z
+	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override;
+
 	virtual FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override final;
 	//~ End FVoxelGeneratorInstance Interface
+
+	// Per-voxel reference path, same results as GetValues
+	void GetValuesScalar(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		Super::GetValues(QueryZone, LOD, Items);
+	}
+
 	FVector2D generateUV(FVector pos)const;
+	// generateUV for 4 positions at once
+	static void generateUV4(const VectorRegister4Float& X, const VectorRegister4Float& Y, const VectorRegister4Float& Z, VectorRegister4Float& OutU, VectorRegister4Float& OutV);
 	FVector FindTangentAtPoint(FVector position, float thetaOffset, float phiOffset) const;
 	float getTopographyAt(FVector2D uv) const;
+	// Uses the cube map if loaded, else getTopographyAt(generateUV(pos))
+	float getTopographyAtPosition(const FVector& pos) const;
 	float getBiomeAt(FVector2D uv) const;
+	// Conservative range of getTopographyAt over a lat/long footprint, in radians
+	TVoxelRange<v_flt> getTopographyRange(v_flt MinLatitude, v_flt MaxLatitude, v_flt MinLongitude, v_flt MaxLongitude) const;
 
 private:
 	std::uniform_real_distribution<float> urd;
-	int* FormatedTopographyImageData = nullptr;
-	int* FormatedBiomesImageData = nullptr;
+	const TVoxelSharedPtr<const FMyVoxelPlanetMap> TopographyMap;
+	const TVoxelSharedPtr<const FMyVoxelPlanetMap> BiomesMap;
+	const TVoxelSharedPtr<const FMyVoxelPlanetMapRanges> TopographyRanges;
+	const TVoxelSharedPtr<const FMyVoxelPlanetMap> TopographyCubeMap;
     int gX, gY;
 	int gbX, gbY;
     bool firstLookup = true;
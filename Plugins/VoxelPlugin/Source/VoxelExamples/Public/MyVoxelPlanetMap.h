@@ -0,0 +1,316 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelRange.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace EMyVoxelPlanetMapValueType
+{
+	enum Type : uint32
+	{
+		Int16,
+		Int32,
+		Float
+	};
+}
+
+namespace EMyVoxelPlanetMapLayout
+{
+	enum Type : uint32
+	{
+		// Index = X * SizeY + Y, sampled through generateUV
+		Equirectangular,
+		// 6 faces of SizeX * SizeX texels (+X, -X, +Y, -Y, +Z, -Z), each split in TileSize * TileSize tiles stored contiguously
+		CubeTiled
+	};
+}
+
+namespace FMyVoxelPlanetMapVersion
+{
+	enum Type : uint32
+	{
+		Initial = 1,
+		CubeMapLayout,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+}
+
+/**
+ * On-disk header of a .vpmap file. The file is laid out so that it can be memory-mapped and sampled in place:
+ * header, then every mip one after the other, each starting at MipOffsets[Mip] (16 bytes aligned).
+ * Equirectangular texels are stored column-major (Index = X * SizeY + Y), the same order as the legacy text maps.
+ */
+struct FMyVoxelPlanetMapHeader
+{
+	static constexpr uint32 MagicValue = 0x504D5056; // "VPMP"
+	static constexpr int32 MaxMips = 16;
+
+	uint32 Magic = MagicValue;
+	uint32 Version = FMyVoxelPlanetMapVersion::LatestVersion;
+	uint32 ValueType = EMyVoxelPlanetMapValueType::Int32;
+	int32 NumMips = 0;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	float MinValue = 0;
+	float MaxValue = 0;
+	uint64 MipOffsets[MaxMips] = {};
+	// Added in CubeMapLayout
+	uint32 Layout = EMyVoxelPlanetMapLayout::Equirectangular;
+	uint32 TileSize = 0;
+	uint32 Padding[2] = {};
+};
+static_assert(sizeof(FMyVoxelPlanetMapHeader) % 16 == 0, "Mip data must stay aligned");
+
+/**
+ * Read-only planet topography/biome map, shared by every generator instance.
+ * Binary maps are memory-mapped: loading is O(page faults) and the memory is paid once per process.
+ */
+class VOXELEXAMPLES_API FMyVoxelPlanetMap
+{
+public:
+	struct FMip
+	{
+		int32 SizeX = 0;
+		int32 SizeY = 0;
+		const void* Data = nullptr;
+	};
+
+	FMyVoxelPlanetMap() = default;
+	~FMyVoxelPlanetMap();
+
+	// Memory-maps a .vpmap file. Maps are cached by path: loading the same file twice returns the same map
+	static TVoxelSharedPtr<const FMyVoxelPlanetMap> LoadBinary(const FString& Path);
+	// Parses a legacy text map (SizeX, SizeY then one integer per line). Slow, only used as a fallback & by the converter
+	static TVoxelSharedPtr<FMyVoxelPlanetMap> LoadText(const FString& Path, EMyVoxelPlanetMapValueType::Type ValueType = EMyVoxelPlanetMapValueType::Int32);
+	// Offline converter: text map -> binary map
+	static bool ConvertTextToBinary(const FString& TextPath, const FString& BinaryPath, EMyVoxelPlanetMapValueType::Type ValueType, int32 NumMips);
+	// One-time converter to the cube layout: SampleDirection is called with the (non normalized) direction of every texel center
+	static TVoxelSharedPtr<FMyVoxelPlanetMap> CreateCubeMap(int32 FaceSize, int32 TileSize, EMyVoxelPlanetMapValueType::Type ValueType, TFunctionRef<float(const FVector3f& Direction)> SampleDirection);
+
+	// Drop the cached map for Path, so that the next LoadBinary reads it again
+	static void Invalidate(const FString& Path);
+
+public:
+	// Builds box-filtered mips until both dimensions reach 1 or NumMips is reached. Only valid on maps we own
+	void BuildMips(int32 NumMips);
+	bool SaveBinary(const FString& Path) const;
+
+public:
+	FORCEINLINE int32 GetSizeX() const { return Header.SizeX; }
+	FORCEINLINE int32 GetSizeY() const { return Header.SizeY; }
+	FORCEINLINE int32 GetNumMips() const { return Mips.Num(); }
+	FORCEINLINE float GetMinValue() const { return Header.MinValue; }
+	FORCEINLINE float GetMaxValue() const { return Header.MaxValue; }
+	FORCEINLINE EMyVoxelPlanetMapValueType::Type GetValueType() const { return EMyVoxelPlanetMapValueType::Type(Header.ValueType); }
+	FORCEINLINE const FMip& GetMip(int32 Mip) const { return Mips[Mip]; }
+	FORCEINLINE bool IsMemoryMapped() const { return MappedRegion.IsValid(); }
+	FORCEINLINE bool IsCubeMap() const { return Header.Layout == EMyVoxelPlanetMapLayout::CubeTiled; }
+
+	static int32 GetValueTypeSize(EMyVoxelPlanetMapValueType::Type ValueType)
+	{
+		switch (ValueType)
+		{
+		case EMyVoxelPlanetMapValueType::Int16: return sizeof(int16);
+		case EMyVoxelPlanetMapValueType::Int32: return sizeof(int32);
+		case EMyVoxelPlanetMapValueType::Float: return sizeof(float);
+		default: ensure(false); return 0;
+		}
+	}
+
+	template<typename T>
+	FORCEINLINE const T* GetRawData(int32 Mip = 0) const
+	{
+		checkVoxelSlow(sizeof(T) == GetValueTypeSize(GetValueType()));
+		return static_cast<const T*>(Mips[Mip].Data);
+	}
+
+	FORCEINLINE float GetValue(int32 X, int32 Y, int32 Mip = 0) const
+	{
+		const FMip& MipData = Mips[Mip];
+		checkVoxelSlow(!IsCubeMap());
+		checkVoxelSlow(0 <= X && X < MipData.SizeX && 0 <= Y && Y < MipData.SizeY);
+		return GetValueAtIndex(MipData, int64(X) * MipData.SizeY + Y);
+	}
+
+public:
+	FORCEINLINE int32 GetFaceSize() const { return Header.SizeX; }
+
+	FORCEINLINE int64 GetCubeIndex(int32 Face, int32 X, int32 Y) const
+	{
+		checkVoxelSlow(IsCubeMap());
+		checkVoxelSlow(0 <= Face && Face < 6 && 0 <= X && X < Header.SizeX && 0 <= Y && Y < Header.SizeX);
+
+		const int32 TileX = X >> TileShift;
+		const int32 TileY = Y >> TileShift;
+		const int32 LocalX = X & TileMask;
+		const int32 LocalY = Y & TileMask;
+		return
+			int64(Face) * Header.SizeX * Header.SizeX +
+			(int64(TileX + TileY * TilesPerSide) << (2 * TileShift)) +
+			(LocalX + (LocalY << TileShift));
+	}
+	FORCEINLINE float GetCubeValue(int32 Face, int32 X, int32 Y) const
+	{
+		return GetValueAtIndex(Mips[0], GetCubeIndex(Face, X, Y));
+	}
+
+	// Projects a direction on the cube: no trig, and the direction does not need to be normalized
+	FORCEINLINE static void DirectionToFace(const FVector3f& Direction, int32 FaceSize, int32& OutFace, float& OutX, float& OutY)
+	{
+		const FVector3f Abs = Direction.GetAbs();
+
+		float Major;
+		float S;
+		float T;
+		if (Abs.X >= Abs.Y && Abs.X >= Abs.Z)
+		{
+			OutFace = Direction.X >= 0 ? 0 : 1;
+			Major = Abs.X;
+			S = Direction.Y;
+			T = Direction.Z;
+		}
+		else if (Abs.Y >= Abs.Z)
+		{
+			OutFace = Direction.Y >= 0 ? 2 : 3;
+			Major = Abs.Y;
+			S = Direction.X;
+			T = Direction.Z;
+		}
+		else
+		{
+			OutFace = Direction.Z >= 0 ? 4 : 5;
+			Major = Abs.Z;
+			S = Direction.X;
+			T = Direction.Y;
+		}
+
+		// [-1, 1] -> texel space, texel centers at integer coordinates
+		const float Scale = 0.5f * FaceSize / FMath::Max(Major, SMALL_NUMBER);
+		OutX = S * Scale + 0.5f * FaceSize - 0.5f;
+		OutY = T * Scale + 0.5f * FaceSize - 0.5f;
+	}
+	// Inverse of DirectionToFace, not normalized
+	FORCEINLINE static FVector3f FaceToDirection(int32 Face, float X, float Y, int32 FaceSize)
+	{
+		const float S = (X + 0.5f) / (0.5f * FaceSize) - 1.f;
+		const float T = (Y + 0.5f) / (0.5f * FaceSize) - 1.f;
+		const float Major = Face % 2 == 0 ? 1.f : -1.f;
+		switch (Face / 2)
+		{
+		case 0: return FVector3f(Major, S, T);
+		case 1: return FVector3f(S, Major, T);
+		default: return FVector3f(S, T, Major);
+		}
+	}
+
+	// Bilinear sample of a cube map. Bilinear weights are clamped at face borders
+	FORCEINLINE float SampleCube(const FVector3f& Direction) const
+	{
+		const int32 FaceSize = Header.SizeX;
+
+		int32 Face;
+		float X;
+		float Y;
+		DirectionToFace(Direction, FaceSize, Face, X, Y);
+
+		X = FMath::Clamp<float>(X, 0, FaceSize - 1);
+		Y = FMath::Clamp<float>(Y, 0, FaceSize - 1);
+
+		const int32 X0 = FMath::FloorToInt(X);
+		const int32 Y0 = FMath::FloorToInt(Y);
+		const int32 X1 = FMath::Min(X0 + 1, FaceSize - 1);
+		const int32 Y1 = FMath::Min(Y0 + 1, FaceSize - 1);
+		const float AlphaX = X - X0;
+		const float AlphaY = Y - Y0;
+
+		return FMath::BiLerp(
+			GetCubeValue(Face, X0, Y0),
+			GetCubeValue(Face, X1, Y0),
+			GetCubeValue(Face, X0, Y1),
+			GetCubeValue(Face, X1, Y1),
+			AlphaX,
+			AlphaY);
+	}
+
+private:
+	FORCEINLINE float GetValueAtIndex(const FMip& MipData, int64 Index) const
+	{
+		switch (Header.ValueType)
+		{
+		case EMyVoxelPlanetMapValueType::Int16: return static_cast<const int16*>(MipData.Data)[Index];
+		case EMyVoxelPlanetMapValueType::Int32: return static_cast<const int32*>(MipData.Data)[Index];
+		default: checkVoxelSlow(Header.ValueType == EMyVoxelPlanetMapValueType::Float); return static_cast<const float*>(MipData.Data)[Index];
+		}
+	}
+
+private:
+	FMyVoxelPlanetMapHeader Header;
+	TArray<FMip, TInlineAllocator<FMyVoxelPlanetMapHeader::MaxMips>> Mips;
+
+	// Either mapped...
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// ...or owned
+	TArray64<uint8> OwnedData;
+
+	// Cube layout
+	int32 TileShift = 0;
+	int32 TileMask = 0;
+	int32 TilesPerSide = 0;
+
+	void UpdateMips(const uint8* FileData);
+	void UpdateStats();
+	int64 AllocatedSize = 0;
+};
+
+/**
+ * Min/max pyramid over a planet map, used to compute conservative value ranges.
+ * Level 0 cells cover BaseCellSize x BaseCellSize texels, every next level halves the resolution.
+ */
+class VOXELEXAMPLES_API FMyVoxelPlanetMapRanges
+{
+public:
+	static constexpr int32 BaseCellShift = 4;
+	static constexpr int32 BaseCellSize = 1 << BaseCellShift;
+
+	explicit FMyVoxelPlanetMapRanges(const FMyVoxelPlanetMap& Map);
+	~FMyVoxelPlanetMapRanges();
+
+	// Range of the texels in [MinX, MaxX] x [MinY, MaxY] (inclusive, clamped to the map). Does not wrap
+	TVoxelRange<float> GetRange(int32 MinX, int32 MaxX, int32 MinY, int32 MaxY) const;
+	// Same, but X wraps around the map (MinX can be negative & MaxX can be >= SizeX)
+	TVoxelRange<float> GetRangeWrapX(int32 MinX, int32 MaxX, int32 MinY, int32 MaxY) const;
+
+	FORCEINLINE TVoxelRange<float> GetGlobalRange() const
+	{
+		return Levels.Last().Data[0];
+	}
+
+private:
+	struct FLevel
+	{
+		int32 Shift = 0;
+		int32 SizeX = 0;
+		int32 SizeY = 0;
+		TArray<TVoxelRange<float>> Data;
+
+		FORCEINLINE const TVoxelRange<float>& Get(int32 X, int32 Y) const
+		{
+			checkVoxelSlow(0 <= X && X < SizeX && 0 <= Y && Y < SizeY);
+			return Data[X * SizeY + Y];
+		}
+	};
+
+	const int32 SizeX;
+	const int32 SizeY;
+	TArray<FLevel> Levels;
+	int64 AllocatedSize = 0;
+};